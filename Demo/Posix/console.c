@@ -0,0 +1,73 @@
+// console.c
+//
+// The framebuffer console of Drivers/video.c, for the POSIX simulator.  Lines
+// go to stdout, without the colour.  FreeRTOS+TCP's debug output comes here
+// too, through vLoggingPrintf().
+//
+// As on the target, lines are queued for the console task once
+// startConsole() has been called (see Drivers/logring.h), and printed
+// straight away before then.  A task can be preempted while inside stdio,
+// holding its lock, so the printing is done in a critical section (see
+// port.c).
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include "video.h"
+#include "logring.h"
+
+char loaded = 0;
+
+static void prvPrintLine(const char* message, int colour) {
+	(void)colour;
+
+	taskENTER_CRITICAL();
+	fputs(message, stdout);
+	fputc('\n', stdout);
+	fflush(stdout);
+	taskEXIT_CRITICAL();
+}
+
+void startConsole(unsigned long priority) {
+	LogRingStart(prvPrintLine, priority);
+}
+
+void println(const char* message, int colour) {
+	if(loaded == 0) return; //as on the target, nothing until main says so
+
+	if(LogRingRunning()) {
+		LogRingWrite(message, colour);
+	} else {
+		prvPrintLine(message, colour);
+	}
+}
+
+void printHex(const char* message, int hexi, int colour) {
+	char line[LOG_RING_LINE_LENGTH];
+
+	snprintf(line, sizeof(line), "%s%08X", message, (unsigned int)hexi);
+	println(line, colour);
+}
+
+//FreeRTOS+TCP's lines end in a newline, which println() adds itself
+void vLoggingPrintf(const char *pcFormat, ...) {
+	char line[LOG_RING_LINE_LENGTH];
+	va_list args;
+	size_t length;
+
+	if(loaded == 0) return;
+
+	va_start(args, pcFormat);
+	vsnprintf(line, sizeof(line), pcFormat, args);
+	va_end(args);
+
+	length = strlen(line);
+	if(length > 0 && line[length - 1] == '\n') {
+		line[length - 1] = '\0';
+	}
+	println(line, WHITE_TEXT);
+}
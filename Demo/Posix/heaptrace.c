@@ -0,0 +1,65 @@
+// heaptrace.c
+//
+// The allocation trace recorder, see heaptrace.h.  Both hooks are called with
+// the scheduler suspended.  Each live block gets a slot number, the lowest
+// free one, so a trace can be replayed with a table of heapTRACE_SLOTS
+// pointers whatever addresses the heap hands out.  Sizes are as the heap sees
+// them, including its block header, and are recorded in the units of this
+// 64 bit host.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "heaptrace.h"
+
+#define heapTRACE_SLOTS		256
+
+static FILE *pxTraceFile = NULL;
+static int iTraceOpened = 0;
+static void *pvSlots[heapTRACE_SLOTS];
+
+//opens the file named by FREERTOS_HEAP_TRACE on the first call, NULL if none
+static FILE *prvTraceFile(void) {
+	const char *pcName;
+
+	if(!iTraceOpened) {
+		iTraceOpened = 1;
+		pcName = getenv("FREERTOS_HEAP_TRACE");
+		if(pcName != NULL) {
+			pxTraceFile = fopen(pcName, "w");
+		}
+	}
+	return pxTraceFile;
+}
+
+void vHeapTraceMalloc(void *pv, size_t xSize) {
+	FILE *pxFile = prvTraceFile();
+	int i;
+
+	if(pxFile == NULL || pv == NULL) return;
+
+	for(i = 0; i < heapTRACE_SLOTS; i++) {
+		if(pvSlots[i] == NULL) {
+			pvSlots[i] = pv;
+			fprintf(pxFile, "\t{ heapTRACE_ALLOC, %d, %lu },\n", i, (unsigned long)xSize);
+			fflush(pxFile);
+			return;
+		}
+	}
+}
+
+void vHeapTraceFree(void *pv) {
+	FILE *pxFile = prvTraceFile();
+	int i;
+
+	if(pxFile == NULL) return;
+
+	for(i = 0; i < heapTRACE_SLOTS; i++) {
+		if(pvSlots[i] == pv) {
+			pvSlots[i] = NULL;
+			fprintf(pxFile, "\t{ heapTRACE_FREE, %d, 0 },\n", i);
+			fflush(pxFile);
+			return;
+		}
+	}
+}
@@ -0,0 +1,19 @@
+// heaptrace.h
+//
+// Records the simulator's heap traffic, when the FREERTOS_HEAP_TRACE
+// environment variable names a file to write it to.  The trace is written as
+// rows of the table in Demo/bench/heap_trace.h, which the heap benchmark
+// replays against each allocator on the target.
+
+#ifndef HEAPTRACE_H
+#define HEAPTRACE_H
+
+#include <stddef.h>
+
+void vHeapTraceMalloc(void *pv, size_t xSize);
+void vHeapTraceFree(void *pv);
+
+#define traceMALLOC( pvAddress, uiSize )	vHeapTraceMalloc( ( pvAddress ), ( uiSize ) )
+#define traceFREE( pvAddress, uiSize )		vHeapTraceFree( ( pvAddress ) )
+
+#endif
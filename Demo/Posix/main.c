@@ -0,0 +1,174 @@
+// main.c
+//
+// The POSIX simulator's entry point (make posix).  Runs the kernel and the
+// FreeRTOS+TCP stack as a Linux process, with the TCP echo server of
+// Demo/main.c on port 2056 of a TAP device (see NetworkInterfacePosix.c) and
+// a heartbeat task standing in for the LEDs.
+//
+//   ./freertos-posix                 runs until interrupted
+//   ./freertos-posix <seconds>       ends the scheduler after that long
+//   ./freertos-posix check           runs the checks of tickcheck.c instead
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include "video.h"
+#include "logring.h"
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+#include "tickcheck.h"
+
+#define HEARTBEAT_DELAY			1000
+#define tcpechoSHUTDOWN_DELAY	( pdMS_TO_TICKS( 5000 ) )
+
+static portTickType xRunTime = 0;
+
+static void prvServeConnection(Socket_t xConnectedSocket);
+
+//prints the tick count once a second, and ends the scheduler once xRunTime
+//ticks have gone by, if set
+static void heartbeatTask(void *pvParameters) {
+	portTickType xLastWake = xTaskGetTickCount();
+	(void)pvParameters;
+
+	while(1) {
+		vTaskDelayUntil(&xLastWake, HEARTBEAT_DELAY);
+		printHex("tick ", (int)xTaskGetTickCount(), WHITE_TEXT);
+
+		if(xRunTime != 0 && xTaskGetTickCount() >= xRunTime) {
+			vTaskEndScheduler();
+		}
+	}
+}
+
+//serves one connection at a time.  As in Demo/main.c the listening socket is
+//reused for the connection, as accept() does not return otherwise
+static void serverListenTask(void *pvParameters) {
+	static const portTickType xReceiveTimeOut = portMAX_DELAY;
+	const portBASE_TYPE xBacklog = 1;
+	portBASE_TYPE xReuseSocket = pdTRUE;
+	struct freertos_sockaddr server, client;
+	socklen_t cli_size = sizeof(client);
+	Socket_t listen_sock, connect_sock;
+	(void)pvParameters;
+
+	while(!FreeRTOS_IsNetworkUp()) {
+		vTaskDelay(pdMS_TO_TICKS(500UL));
+	}
+	println("Network is UP", BLUE_TEXT);
+
+	for(;;) {
+		listen_sock = FreeRTOS_socket(FREERTOS_AF_INET, FREERTOS_SOCK_STREAM, FREERTOS_IPPROTO_TCP);
+		if(listen_sock == FREERTOS_INVALID_SOCKET) {
+			println("Socket is NOT valid", RED_TEXT);
+			vTaskDelay(pdMS_TO_TICKS(1000UL));
+			continue;
+		}
+
+		FreeRTOS_setsockopt(listen_sock, 0, FREERTOS_SO_RCVTIMEO, &xReceiveTimeOut, sizeof(xReceiveTimeOut));
+		FreeRTOS_setsockopt(listen_sock, 0, FREERTOS_SO_REUSE_LISTEN_SOCKET, (void *)&xReuseSocket, sizeof(xReuseSocket));
+
+		memset(&server, 0, sizeof(server));
+		server.sin_port = FreeRTOS_htons(2056);
+		FreeRTOS_bind(listen_sock, &server, sizeof(server));
+		FreeRTOS_listen(listen_sock, xBacklog);
+		println("Server listening on port 2056", BLUE_TEXT);
+
+		connect_sock = FreeRTOS_accept(listen_sock, &client, &cli_size);
+		if(connect_sock == NULL || connect_sock == FREERTOS_INVALID_SOCKET) {
+			FreeRTOS_closesocket(listen_sock);
+			continue;
+		}
+
+		println("Connection accepted", BLUE_TEXT);
+		prvServeConnection(connect_sock);
+	}
+}
+
+//echoes until the client closes the connection, then closes the socket
+static void prvServeConnection(Socket_t xConnectedSocket) {
+	static const portTickType xReceiveTimeOut = pdMS_TO_TICKS(5000);
+	static const portTickType xSendTimeOut = pdMS_TO_TICKS(5000);
+	portTickType xTimeOnShutdown;
+	long lBytes, lSent, lTotalSent;
+	unsigned char *pucRxBuffer;
+
+	pucRxBuffer = (unsigned char *)pvPortMalloc(ipconfigTCP_MSS);
+
+	if(pucRxBuffer != NULL) {
+		FreeRTOS_setsockopt(xConnectedSocket, 0, FREERTOS_SO_RCVTIMEO, &xReceiveTimeOut, sizeof(xReceiveTimeOut));
+		FreeRTOS_setsockopt(xConnectedSocket, 0, FREERTOS_SO_SNDTIMEO, &xSendTimeOut, sizeof(xSendTimeOut));
+
+		for(;;) {
+			lBytes = FreeRTOS_recv(xConnectedSocket, pucRxBuffer, ipconfigTCP_MSS, 0);
+			if(lBytes < 0) {
+				break;
+			}
+
+			lSent = 0;
+			lTotalSent = 0;
+			while(lSent >= 0 && lTotalSent < lBytes) {
+				lSent = FreeRTOS_send(xConnectedSocket, pucRxBuffer + lTotalSent, lBytes - lTotalSent, 0);
+				lTotalSent += lSent;
+			}
+			if(lSent < 0) {
+				break;
+			}
+		}
+	}
+
+	FreeRTOS_shutdown(xConnectedSocket, FREERTOS_SHUT_RDWR);
+
+	//wait for the shutdown to take effect, indicated by FreeRTOS_recv()
+	//returning an error
+	xTimeOnShutdown = xTaskGetTickCount();
+	do {
+		if(pucRxBuffer == NULL || FreeRTOS_recv(xConnectedSocket, pucRxBuffer, ipconfigTCP_MSS, 0) < 0) break;
+	} while((xTaskGetTickCount() - xTimeOnShutdown) < tcpechoSHUTDOWN_DELAY);
+
+	vPortFree(pucRxBuffer);
+	FreeRTOS_closesocket(xConnectedSocket);
+}
+
+int main(int argc, char *argv[]) {
+	//the same addresses as the target, see Demo/main.c
+	const unsigned char ucIPAddress[ 4 ] = {10, 10, 206, 100 };
+	const unsigned char ucNetMask[ 4 ] = {255, 255, 255, 0};
+	const unsigned char ucGatewayAddress[ 4 ] = {10, 10, 206, 1};
+	const unsigned char ucDNSServerAddress[ 4 ] = {10, 10, 206, 1};
+	const unsigned char ucMACAddress[ 6 ] = {0x02, 0x27, 0xEB, 0xA0, 0xE8, 0x54};
+
+	if(argc > 1 && strcmp(argv[1], "check") == 0) {
+		return runTickCheck();
+	}
+
+	if(argc > 1) {
+		xRunTime = (portTickType)atoi(argv[1]) * configTICK_RATE_HZ;
+	}
+
+	FreeRTOS_IPInit(ucIPAddress, ucNetMask, ucGatewayAddress, ucDNSServerAddress, ucMACAddress);
+
+	xTaskCreate(serverListenTask, "server", 1024, NULL, 0, NULL);
+	xTaskCreate(heartbeatTask, "heartbeat", 256, NULL, 0, NULL);
+
+#if ( configUSE_HEAP_STATS == 1 )
+	vHeapStatsStartReporter(10000, tskIDLE_PRIORITY + 1);
+#endif
+
+	startConsole(tskIDLE_PRIORITY + 1);
+
+	loaded = 1;
+
+	println("Starting task scheduler", GREEN_TEXT);
+
+	vTaskStartScheduler();
+
+	//back here after vTaskEndScheduler(), with the console task gone
+	LogRingStop();
+	println("Scheduler ended", GREEN_TEXT);
+	return 0;
+}
@@ -0,0 +1,14 @@
+#ifndef MEM_H
+#define MEM_H
+
+//Stands in for Drivers/mem.h in the POSIX simulator (make posix), whose
+//include path puts Demo/Posix first.  The C library provides the rest of
+//the functions on the host, and declaring them again with the target's
+//signatures would clash with it.
+
+#include <stdlib.h>
+#include <string.h>
+
+void *memcpy2(void *dest, const void *src, size_t n);
+
+#endif
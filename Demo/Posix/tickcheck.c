@@ -0,0 +1,203 @@
+// tickcheck.c
+//
+// See tickcheck.h.  The only tasks are the ones below, so the idle task
+// suppresses the tick whenever they are all delayed, and a wrong
+// xNextTaskUnblockTime shows up as a task that wakes late or never.  make
+// posix-check runs this under a timeout for the second case.
+//
+// Once the delay check is done the same task checks the timer service's
+// wheel, and then ends the scheduler.
+
+#include <stdio.h>
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <timers.h>
+
+#include "tickcheck.h"
+
+#define CHECK_LONG_DELAY	5000
+#define CHECK_FIRST_DELAY	140
+#define CHECK_BUSY_UNTIL	170
+#define CHECK_SECOND_DELAY	10
+
+//one shot timer periods, out of order.  Level 0 of the wheel covers 32
+//ticks and level 1 1024, so 31 is filed straight in a level 0 slot, 32 to
+//700 cascade once and 1100 twice.  Periods a tick apart are started
+//shortest first, so that a tick between starting them cannot make them
+//expire together
+static const portTickType xTimerPeriods[] = {700, 5, 1100, 40, 31, 32, 33};
+#define CHECK_TIMERS		(sizeof(xTimerPeriods) / sizeof(xTimerPeriods[0]))
+#define CHECK_TIMERS_WAIT	1200
+
+//the period of a one shot timer is changed well before it expires, and an
+//auto reload timer's after its first expiry
+#define CHECK_LONG_PERIOD	500
+#define CHECK_SHORT_PERIOD	50
+#define CHECK_RELOAD_PERIOD	20
+#define CHECK_RELOAD_NEW	70
+#define CHECK_RELOADS		3
+
+static portTickType xStart;
+static int iFailures = 1;
+
+//the expiries seen by the callbacks, in the order they came
+static unsigned long ulExpiredIDs[CHECK_TIMERS + CHECK_RELOADS + 1];
+static portTickType xExpiredAt[CHECK_TIMERS + CHECK_RELOADS + 1];
+static volatile unsigned uExpired;
+
+//only here so the wheel holds an event far beyond the others
+static void longDelayTask(void *pvParameters) {
+	(void)pvParameters;
+
+	for(;;) {
+		vTaskDelay(CHECK_LONG_DELAY);
+	}
+}
+
+//runs in the timer service task
+static void recordExpiry(xTimerHandle xTimer) {
+	if(uExpired < sizeof(xExpiredAt) / sizeof(xExpiredAt[0])) {
+		ulExpiredIDs[uExpired] = (unsigned long)pvTimerGetTimerID(xTimer);
+		xExpiredAt[uExpired] = xTaskGetTickCount();
+		uExpired++;
+	}
+}
+
+//a tick can come between reading xStarted and starting the timer, which
+//then expires a tick after xStarted plus its period
+static int expiredOnTime(portTickType xExpired, portTickType xStarted, portTickType xPeriod) {
+	portTickType xLate = xExpired - xStarted - xPeriod;
+
+	return xLate == 0 || xLate == 1;
+}
+
+//starts one shot timers of the periods above together, and expects them to
+//expire shortest first, each on time
+static void checkTimers(void) {
+	xTimerHandle xTimers[CHECK_TIMERS];
+	portTickType xStarted;
+	unsigned i, uPrevious = CHECK_TIMERS;
+	int iFailed = 0;
+
+	uExpired = 0;
+	for(i = 0; i < CHECK_TIMERS; i++) {
+		xTimers[i] = xTimerCreate((const signed char *)"check", xTimerPeriods[i], pdFALSE, (void *)(unsigned long)i, recordExpiry);
+	}
+
+	xStarted = xTaskGetTickCount();
+	for(i = 0; i < CHECK_TIMERS; i++) {
+		xTimerStart(xTimers[i], 0);
+	}
+	vTaskDelay(CHECK_TIMERS_WAIT);
+
+	if(uExpired != CHECK_TIMERS) {
+		iFailed = 1;
+	}
+	for(i = 0; i < uExpired; i++) {
+		unsigned uTimer = (unsigned)ulExpiredIDs[i];
+
+		printf("tickcheck: timer of %u expired at %u\n", (unsigned)xTimerPeriods[uTimer], (unsigned)(xExpiredAt[i] - xStarted));
+		if(!expiredOnTime(xExpiredAt[i], xStarted, xTimerPeriods[uTimer])) {
+			iFailed = 1;
+		}
+		if(uPrevious != CHECK_TIMERS && xTimerPeriods[uTimer] < xTimerPeriods[uPrevious]) {
+			iFailed = 1;
+		}
+		uPrevious = uTimer;
+	}
+
+	for(i = 0; i < CHECK_TIMERS; i++) {
+		xTimerDelete(xTimers[i], 0);
+	}
+	iFailures += iFailed;
+}
+
+//a new period counts from when it is set, and an auto reload timer keeps
+//the new one
+static void checkChangePeriod(void) {
+	xTimerHandle xOneShot, xReload;
+	portTickType xChanged;
+	unsigned i;
+	int iFailed = 0;
+
+	xOneShot = xTimerCreate((const signed char *)"oneshot", CHECK_LONG_PERIOD, pdFALSE, (void *)0, recordExpiry);
+	uExpired = 0;
+	xTimerStart(xOneShot, 0);
+	vTaskDelay(CHECK_SHORT_PERIOD);
+	xChanged = xTaskGetTickCount();
+	xTimerChangePeriod(xOneShot, CHECK_SHORT_PERIOD, 0);
+	vTaskDelay(CHECK_LONG_PERIOD);
+
+	if(uExpired != 1 || !expiredOnTime(xExpiredAt[0], xChanged, CHECK_SHORT_PERIOD)) {
+		iFailed = 1;
+	}
+	printf("tickcheck: changed period expired %u times, first at %u\n", uExpired, uExpired ? (unsigned)(xExpiredAt[0] - xChanged) : 0);
+	xTimerDelete(xOneShot, 0);
+
+	xReload = xTimerCreate((const signed char *)"reload", CHECK_RELOAD_PERIOD, pdTRUE, (void *)1, recordExpiry);
+	uExpired = 0;
+	xTimerStart(xReload, 0);
+	while(uExpired == 0) {
+		vTaskDelay(1);
+	}
+	xChanged = xTaskGetTickCount();
+	xTimerChangePeriod(xReload, CHECK_RELOAD_NEW, 0);
+	vTaskDelay(CHECK_RELOAD_NEW * CHECK_RELOADS + CHECK_RELOAD_NEW / 2);
+	xTimerStop(xReload, 0);
+
+	//the first expiry is at the old period, the rest at the new
+	if(uExpired != CHECK_RELOADS + 1) {
+		iFailed = 1;
+	}
+	for(i = 1; i < uExpired; i++) {
+		if(!expiredOnTime(xExpiredAt[i], xChanged, CHECK_RELOAD_NEW * i)) {
+			iFailed = 1;
+		}
+	}
+	printf("tickcheck: auto reload expired %u times after its period changed\n", uExpired - 1);
+	xTimerDelete(xReload, 0);
+
+	iFailures += iFailed;
+}
+
+//delays, then runs on while the wheel is left behind the tick count, then
+//delays again.  The second delay was once filed relative to where the wheel
+//had stopped, giving a next event before the tick count, and with tickless
+//idle the task was not woken
+static void shortDelayTask(void *pvParameters) {
+	portTickType xBefore, xAfter;
+	(void)pvParameters;
+
+	vTaskDelay(CHECK_FIRST_DELAY);
+	while((xTaskGetTickCount() - xStart) < CHECK_BUSY_UNTIL) {
+	}
+
+	xBefore = xTaskGetTickCount();
+	vTaskDelay(CHECK_SECOND_DELAY);
+	xAfter = xTaskGetTickCount();
+
+	//a tick can come between reading the count and blocking
+	if((xAfter - xBefore) == CHECK_SECOND_DELAY || (xAfter - xBefore) == CHECK_SECOND_DELAY + 1) {
+		iFailures = 0;
+	}
+	printf("tickcheck: delayed at %u, woken at %u\n", (unsigned)(xBefore - xStart), (unsigned)(xAfter - xStart));
+
+	checkTimers();
+	checkChangePeriod();
+
+	vTaskEndScheduler();
+	for(;;) {
+	}
+}
+
+int runTickCheck(void) {
+	xTaskCreate(longDelayTask, "long", 256, NULL, tskIDLE_PRIORITY + 1, NULL);
+	xTaskCreate(shortDelayTask, "short", 256, NULL, tskIDLE_PRIORITY + 1, NULL);
+
+	xStart = xTaskGetTickCount();
+	vTaskStartScheduler();
+
+	printf("tickcheck: %s\n", iFailures == 0 ? "passed" : "FAILED");
+	return iFailures;
+}
@@ -0,0 +1,12 @@
+// tickcheck.h
+//
+// Checks of the delayed task wheel with tickless idle, and of the timer
+// service's wheel (./freertos-posix check, run by make posix-check).
+
+#ifndef TICKCHECK_H
+#define TICKCHECK_H
+
+//runs the checks under the scheduler, returns 0 if they all passed
+int runTickCheck(void);
+
+#endif
@@ -0,0 +1,112 @@
+// bench.c
+//
+// Result reporting shared by the benchmarks, and the task that runs them.
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include "video.h"
+#include "uart.h"
+#include "benchmark.h"
+
+/* One result line, to the screen and the serial port. */
+__attribute__((no_instrument_function))
+static void prvEmit(const char *pcLine) {
+	println(pcLine, WHITE_TEXT);
+	UartPuts(pcLine);
+	UartPuts("\n");
+}
+
+__attribute__((no_instrument_function))
+static char *prvAppendString(char *pcDest, const char *pcSrc) {
+	while(*pcSrc) {
+		*pcDest++ = *pcSrc++;
+	}
+	return pcDest;
+}
+
+__attribute__((no_instrument_function))
+static char *prvAppendDecimal(char *pcDest, unsigned long ulValue) {
+	char cDigits[10];
+	int i = 0;
+
+	do {
+		cDigits[i++] = '0' + (ulValue % 10);
+		ulValue /= 10;
+	} while(ulValue);
+
+	while(i) {
+		*pcDest++ = cDigits[--i];
+	}
+	return pcDest;
+}
+
+/**
+ *	Prints "BENCH <name> iters=<n> us=<total> ns/op=<per iteration>".
+ **/
+__attribute__((no_instrument_function))
+void vBenchReport(const char *pcName, unsigned long ulIterations, unsigned long ulMicroseconds) {
+	char cLine[96];
+	char *p = cLine;
+	unsigned long long ullNanoseconds = (unsigned long long) ulMicroseconds * 1000ULL;
+
+	p = prvAppendString(p, "BENCH ");
+	p = prvAppendString(p, pcName);
+	p = prvAppendString(p, " iters=");
+	p = prvAppendDecimal(p, ulIterations);
+	p = prvAppendString(p, " us=");
+	p = prvAppendDecimal(p, ulMicroseconds);
+	p = prvAppendString(p, " ns/op=");
+	p = prvAppendDecimal(p, ulIterations ? (unsigned long) (ullNanoseconds / ulIterations) : 0);
+	*p = '\0';
+
+	prvEmit(cLine);
+}
+
+/**
+ *	Prints "BENCH <name> <key>=<value>", for results that are not a rate.
+ **/
+__attribute__((no_instrument_function))
+void vBenchReportValue(const char *pcName, const char *pcKey, unsigned long ulValue) {
+	char cLine[96];
+	char *p = cLine;
+
+	p = prvAppendString(p, "BENCH ");
+	p = prvAppendString(p, pcName);
+	p = prvAppendString(p, " ");
+	p = prvAppendString(p, pcKey);
+	p = prvAppendString(p, "=");
+	p = prvAppendDecimal(p, ulValue);
+	*p = '\0';
+
+	prvEmit(cLine);
+}
+
+__attribute__((no_instrument_function))
+static void prvBenchmarkTask(void *pvParameters) {
+	prvEmit("BENCH start");
+
+	vBenchSwitch();
+	vBenchNotify();
+	vBenchQueue();
+	vBenchMutex();
+	vBenchDelay();
+	vBenchIrq();
+	vBenchWheel();
+	vBenchHeap();
+	vBenchPool();
+	vBenchMem();
+
+	prvEmit("BENCH done");
+	vTaskDelete(NULL);
+}
+
+/**
+ *	Creates the task that runs the benchmarks one after another.  uxPriority
+ *	should be above every other task in the application, and below
+ *	configMAX_PRIORITIES - 1.
+ **/
+void vStartBenchmarks(unsigned portBASE_TYPE uxPriority) {
+	UartInit();
+	xTaskCreate(prvBenchmarkTask, (signed char *) "bench", configMINIMAL_STACK_SIZE * 4, NULL, uxPriority, NULL);
+}
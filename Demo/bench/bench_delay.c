@@ -0,0 +1,72 @@
+// bench_delay.c
+//
+// How closely vTaskDelay() wakes a task at the top priority on time.  The
+// task delays again as soon as it wakes, so each delay starts just after a
+// tick and should last exactly that many tick periods.  Longer delays let
+// the idle task sleep tickless, which the wakeup then has to recover from.
+//
+//   delay.1        - the interval between wakeups, in us, for delays of
+//   delay.5          1 and 5 ticks.  min_us, avg_us and max_us, and
+//                    jitter_us, the largest distance from the ideal.
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include "video.h"
+#include "benchmark.h"
+
+#define DELAY_SAMPLES_1		1000UL
+#define DELAY_SAMPLES_5		200UL
+
+#define DELAY_PERIOD_US		( 1000000UL / configTICK_RATE_HZ )
+
+__attribute__((no_instrument_function))
+static void prvMeasureDelay(const char *pcName, portTickType xTicks, unsigned long ulSamples) {
+	unsigned long ulIdeal = xTicks * DELAY_PERIOD_US;
+	unsigned long ulLast, ulNow, ulInterval, ulTotal = 0, ulMin = ~0UL, ulMax = 0, ulJitter = 0, i;
+
+	/* Line up with the tick. */
+	vTaskDelay(1);
+	ulLast = benchGET_TIME_US();
+
+	for(i = 0; i < ulSamples; i++) {
+		vTaskDelay(xTicks);
+		ulNow = benchGET_TIME_US();
+		ulInterval = ulNow - ulLast;
+		ulLast = ulNow;
+
+		ulTotal += ulInterval;
+		if(ulInterval < ulMin) {
+			ulMin = ulInterval;
+		}
+		if(ulInterval > ulMax) {
+			ulMax = ulInterval;
+		}
+		if(ulInterval > ulIdeal && ulInterval - ulIdeal > ulJitter) {
+			ulJitter = ulInterval - ulIdeal;
+		}
+		if(ulInterval < ulIdeal && ulIdeal - ulInterval > ulJitter) {
+			ulJitter = ulIdeal - ulInterval;
+		}
+	}
+
+	vBenchReportValue(pcName, "min_us", ulMin);
+	vBenchReportValue(pcName, "avg_us", ulTotal / ulSamples);
+	vBenchReportValue(pcName, "max_us", ulMax);
+	vBenchReportValue(pcName, "jitter_us", ulJitter);
+}
+
+/**
+ *	Runs in the benchmark task, see vStartBenchmarks().
+ **/
+__attribute__((no_instrument_function))
+void vBenchDelay(void) {
+	unsigned portBASE_TYPE uxPriority = uxTaskPriorityGet(NULL);
+
+	vTaskPrioritySet(NULL, configMAX_PRIORITIES - 1);
+
+	prvMeasureDelay("delay.1", 1, DELAY_SAMPLES_1);
+	prvMeasureDelay("delay.5", 5, DELAY_SAMPLES_5);
+
+	vTaskPrioritySet(NULL, uxPriority);
+}
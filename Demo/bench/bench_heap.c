@@ -0,0 +1,116 @@
+// bench_heap.c
+//
+// heap_4 against heap_tlsf, replaying the allocation trace of heap_trace.h
+// HEAP_REPEATS times on a private copy of each (bench_heap_4.c and
+// bench_heap_tlsf.c).  Blocks still live at the end of a pass are freed
+// before the next, and that is counted in the total time but not in iters.
+// The longest single call is reported alongside the total.
+//
+//   heap4.trace      - iters is the number of pvPortMalloc() and vPortFree()
+//   tlsf.trace         calls.  "failed" counts allocations that returned NULL.
+//   heap4.fragmented - the same, with HEAP_FRAGMENTS small blocks allocated
+//   tlsf.fragmented    first and every other one freed, leaving holes too
+//                      small for most of the trace's requests.
+//
+// heap_4 walks its free list past every hole that is too small; heap_tlsf
+// goes straight to a size class that fits.
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include "video.h"
+#include "benchmark.h"
+#include "heap_trace.h"
+
+#define HEAP_REPEATS	50
+#define HEAP_FRAGMENTS	256
+#define HEAP_FRAGMENT_SIZE	24
+
+void *pvBenchHeap4Malloc(size_t xWantedSize);
+void vBenchHeap4Free(void *pv);
+void *pvBenchTlsfMalloc(size_t xWantedSize);
+void vBenchTlsfFree(void *pv);
+
+typedef struct {
+	const char *pcName;
+	const char *pcFragmentedName;
+	void *(*pvMalloc)(size_t xWantedSize);
+	void (*vFree)(void *pv);
+} xBenchHeap;
+
+static const xBenchHeap xHeaps[] = {
+	{ "heap4.trace", "heap4.fragmented", pvBenchHeap4Malloc, vBenchHeap4Free },
+	{ "tlsf.trace", "tlsf.fragmented", pvBenchTlsfMalloc, vBenchTlsfFree },
+};
+
+static void *pvSlots[heapTRACE_SLOTS];
+static void *pvFragments[HEAP_FRAGMENTS];
+
+__attribute__((no_instrument_function))
+static void prvReplay(const xBenchHeap *pxHeap, const char *pcName) {
+	unsigned long ulStart, ulEnd, ulOpStart, ulOpEnd, ulMax = 0, ulOps = 0, ulFailed = 0;
+	unsigned long r, i;
+	const xHeapTraceOp *pxOp;
+
+	ulStart = benchGET_TIME_US();
+	for(r = 0; r < HEAP_REPEATS; r++) {
+		for(i = 0; i < sizeof(xHeapTrace) / sizeof(xHeapTrace[0]); i++) {
+			pxOp = &xHeapTrace[i];
+
+			ulOpStart = benchGET_TIME_US();
+			if(pxOp->ucOp == heapTRACE_ALLOC) {
+				pvSlots[pxOp->ucSlot] = pxHeap->pvMalloc(pxOp->usSize);
+				if(pvSlots[pxOp->ucSlot] == NULL) {
+					ulFailed++;
+				}
+			} else {
+				pxHeap->vFree(pvSlots[pxOp->ucSlot]);
+				pvSlots[pxOp->ucSlot] = NULL;
+			}
+			ulOpEnd = benchGET_TIME_US();
+
+			if(ulOpEnd - ulOpStart > ulMax) {
+				ulMax = ulOpEnd - ulOpStart;
+			}
+			ulOps++;
+		}
+
+		for(i = 0; i < heapTRACE_SLOTS; i++) {
+			pxHeap->vFree(pvSlots[i]);
+			pvSlots[i] = NULL;
+		}
+	}
+	ulEnd = benchGET_TIME_US();
+
+	vBenchReport(pcName, ulOps, ulEnd - ulStart);
+	vBenchReportValue(pcName, "max_us", ulMax);
+	vBenchReportValue(pcName, "failed", ulFailed);
+}
+
+/**
+ *	Runs in the benchmark task, see vStartBenchmarks().
+ **/
+__attribute__((no_instrument_function))
+void vBenchHeap(void) {
+	const xBenchHeap *pxHeap;
+	unsigned long i, j;
+
+	for(i = 0; i < sizeof(xHeaps) / sizeof(xHeaps[0]); i++) {
+		pxHeap = &xHeaps[i];
+
+		prvReplay(pxHeap, pxHeap->pcName);
+
+		for(j = 0; j < HEAP_FRAGMENTS; j++) {
+			pvFragments[j] = pxHeap->pvMalloc(HEAP_FRAGMENT_SIZE);
+		}
+		for(j = 0; j < HEAP_FRAGMENTS; j += 2) {
+			pxHeap->vFree(pvFragments[j]);
+		}
+
+		prvReplay(pxHeap, pxHeap->pcFragmentedName);
+
+		for(j = 1; j < HEAP_FRAGMENTS; j += 2) {
+			pxHeap->vFree(pvFragments[j]);
+		}
+	}
+}
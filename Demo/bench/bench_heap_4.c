@@ -0,0 +1,19 @@
+// bench_heap_4.c
+//
+// A private copy of heap_4.c for bench_heap.c, with its own heap array and
+// its public functions renamed, so it can be replayed alongside the heap the
+// kernel is built with.
+
+#define pvPortMalloc			pvBenchHeap4Malloc
+#define vPortFree				vBenchHeap4Free
+#define xPortGetFreeHeapSize	xBenchHeap4GetFreeHeapSize
+#define vPortInitialiseBlocks	vBenchHeap4InitialiseBlocks
+#define allocated				xBenchHeap4Allocated
+#define vPortGetHeapStats		vBenchHeap4GetHeapStats
+#define xPortGetMinimumEverFreeHeapSize	xBenchHeap4GetMinimumEverFreeHeapSize
+
+/* Replays are not the kernel's allocations, keep them out of heapstats.c. */
+#define traceMALLOC( pvAddress, uiSize )
+#define traceFREE( pvAddress, uiSize )
+
+#include "../../FreeRTOS/Source/portable/MemMang/heap_4.c"
@@ -0,0 +1,18 @@
+// bench_heap_tlsf.c
+//
+// A private copy of heap_tlsf.c for bench_heap.c, with its own heap array and
+// its public functions renamed, so it can be replayed alongside the heap the
+// kernel is built with.
+
+#define pvPortMalloc			pvBenchTlsfMalloc
+#define vPortFree				vBenchTlsfFree
+#define xPortGetFreeHeapSize	xBenchTlsfGetFreeHeapSize
+#define vPortInitialiseBlocks	vBenchTlsfInitialiseBlocks
+#define vPortGetHeapStats		vBenchTlsfGetHeapStats
+#define xPortGetMinimumEverFreeHeapSize	xBenchTlsfGetMinimumEverFreeHeapSize
+
+/* Replays are not the kernel's allocations, keep them out of heapstats.c. */
+#define traceMALLOC( pvAddress, uiSize )
+#define traceFREE( pvAddress, uiSize )
+
+#include "../../FreeRTOS/Source/portable/MemMang/heap_tlsf.c"
@@ -0,0 +1,123 @@
+// bench_irq.c
+//
+// Interrupt to task latency.  System timer compare channel 3 raises IRQ 3
+// at a time set in advance, so the latencies are measured from the moment
+// the interrupt was raised.  The handler wakes a task at the top priority
+// with a notification while the benchmark task spins at a lower one.
+//
+//   irq.entry      - from the compare match to the first line of the
+//                    handler.  min_us, avg_us and max_us.
+//   irq.wake       - from the compare match to the woken task running.
+//
+// Channels 0 and 2 belong to the GPU and channel 1 wakes the tickless idle
+// (see port.c), so channel 3 is the only one free.
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include "interrupts.h"
+#include "video.h"
+#include "benchmark.h"
+
+#define IRQ_SAMPLES			1000UL
+#define IRQ_LEAD_US			50UL		/* Compare match this far ahead. */
+#define IRQ_TIMEOUT			10			/* ticks */
+
+#define IRQ_CHANNEL			3
+#define IRQ_NUMBER			3			/* System timer match n is IRQ n. */
+
+#define benchTIMER_CS		( ( volatile unsigned long * ) 0x3f003000 )
+#define benchTIMER_C3		( ( volatile unsigned long * ) 0x3f003018 )
+
+static xTaskHandle xWaiter;
+static volatile unsigned long ulEntryTime;
+static volatile int bIrqDone;
+
+typedef struct {
+	unsigned long ulMin, ulMax, ulTotal;
+} IrqStats;
+
+__attribute__((no_instrument_function))
+static void prvCompareISR(int nIRQ, void *pParam) {
+	unsigned long ulNow = benchGET_TIME_US();
+	portBASE_TYPE xWoken = pdFALSE;
+
+	*benchTIMER_CS = (1 << IRQ_CHANNEL);	// Acknowledge the match.
+	ulEntryTime = ulNow;
+
+	vTaskNotifyGiveFromISR(xWaiter, &xWoken);
+	if(xWoken) {
+		portYIELD_FROM_ISR();
+	}
+}
+
+__attribute__((no_instrument_function))
+static void prvAddSample(IrqStats *pxStats, unsigned long ulSample) {
+	pxStats->ulTotal += ulSample;
+	if(ulSample < pxStats->ulMin) {
+		pxStats->ulMin = ulSample;
+	}
+	if(ulSample > pxStats->ulMax) {
+		pxStats->ulMax = ulSample;
+	}
+}
+
+__attribute__((no_instrument_function))
+static void prvReport(const char *pcName, IrqStats *pxStats) {
+	vBenchReportValue(pcName, "min_us", pxStats->ulMin);
+	vBenchReportValue(pcName, "avg_us", pxStats->ulTotal / IRQ_SAMPLES);
+	vBenchReportValue(pcName, "max_us", pxStats->ulMax);
+}
+
+__attribute__((no_instrument_function))
+static void prvWaiterTask(void *pvParameters) {
+	IrqStats xEntry = { ~0UL, 0, 0 }, xWake = { ~0UL, 0, 0 };
+	unsigned long ulMatch, ulWoken, i;
+
+	for(i = 0; i < IRQ_SAMPLES; i++) {
+		taskENTER_CRITICAL();
+		ulMatch = benchGET_TIME_US() + IRQ_LEAD_US;
+		*benchTIMER_C3 = ulMatch;
+		taskEXIT_CRITICAL();
+
+		if(ulTaskNotifyTake(pdTRUE, IRQ_TIMEOUT) == 0) {
+			println("irq: no interrupt from the system timer", RED_TEXT);
+			break;
+		}
+		ulWoken = benchGET_TIME_US();
+
+		prvAddSample(&xEntry, ulEntryTime - ulMatch);
+		prvAddSample(&xWake, ulWoken - ulMatch);
+	}
+
+	if(i == IRQ_SAMPLES) {
+		prvReport("irq.entry", &xEntry);
+		prvReport("irq.wake", &xWake);
+	}
+
+	bIrqDone = 1;
+	vTaskSuspend(NULL);
+}
+
+/**
+ *	Runs in the benchmark task, see vStartBenchmarks().
+ **/
+__attribute__((no_instrument_function))
+void vBenchIrq(void) {
+	bIrqDone = 0;
+	*benchTIMER_CS = (1 << IRQ_CHANNEL);
+
+	RegisterInterrupt(IRQ_NUMBER, prvCompareISR, NULL);
+	EnableInterrupt(IRQ_NUMBER);
+
+	/* Runs straight away and sets the first compare match. */
+	xTaskCreate(prvWaiterTask, (signed char *) "birq_wait", configMINIMAL_STACK_SIZE * 2, NULL, configMAX_PRIORITIES - 1, &xWaiter);
+
+	/* Keep the CPU busy, so the wakeup is always a preemption. */
+	while(!bIrqDone) {
+		;
+	}
+
+	DisableInterrupt(IRQ_NUMBER);
+	vTaskDelete(xWaiter);
+}
@@ -0,0 +1,202 @@
+// bench_mem.c
+//
+// The memory routines of Drivers/mem.c against the byte loops they replaced,
+// at sizes from a word to 64KB, 1514 being a full Ethernet frame.  Each
+// result is the throughput in bytes per thousand CPU cycles, from the PMU
+// cycle counter:
+//
+//   BENCH mem.<routine>.<size>.loop bytes_per_kcycle=<n>    the byte loop
+//   BENCH mem.<routine>.<size>.mem bytes_per_kcycle=<n>     Drivers/mem.c
+//
+//   memcpy      - source and destination word aligned.
+//   memcpy.odd  - the source one byte past a word boundary.
+//   memmove     - 4 bytes up, over its own source.  The old memmove()
+//                 went through a copy on the stack as big as the move, which
+//                 the benchmark task does not have, so its loop is a plain
+//                 backwards byte copy.
+//   memset, memcmp (of equal buffers), strlen.
+//
+// The host has its own version of this, membench.c in the top directory.
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include "video.h"
+#include "mem.h"
+#include "benchmark.h"
+
+/* Bytes moved for each result, whatever the size of a call. */
+#define MEM_BYTES			( 1024UL * 1024UL )
+
+#define MEM_MAX_SIZE		65536UL
+
+typedef enum {
+	eMemcpy,
+	eMemcpyOdd,
+	eMemmove,
+	eMemset,
+	eMemcmp,
+	eStrlen,
+	eMemOps
+} eMemOp;
+
+static const char * const pcOpNames[eMemOps] = {
+	"memcpy", "memcpy.odd", "memmove", "memset", "memcmp", "strlen"
+};
+
+static const unsigned long ulSizes[] = { 4, 64, 1514, 4096, MEM_MAX_SIZE };
+
+static unsigned char ucSource[MEM_MAX_SIZE + 64] __attribute__((aligned(64)));
+static unsigned char ucDest[MEM_MAX_SIZE + 64] __attribute__((aligned(64)));
+
+/* What Drivers/mem.c used to do. */
+__attribute__((no_instrument_function))
+static void prvLoopCopy(void *dest, const void *src, size_t n) {
+	char *dp = dest;
+	const char *sp = src;
+	while(n--)
+		*dp++ = *sp++;
+}
+
+__attribute__((no_instrument_function))
+static void prvLoopMove(void *dest, const void *src, size_t n) {
+	char *dp = (char *) dest + n;
+	const char *sp = (const char *) src + n;
+	while(n--)
+		*--dp = *--sp;
+}
+
+__attribute__((no_instrument_function))
+static void prvLoopSet(void *s, int c, size_t n) {
+	unsigned char *p = s;
+	while(n--)
+		*p++ = (unsigned char) c;
+}
+
+__attribute__((no_instrument_function))
+static int prvLoopCompare(const void *s1, const void *s2, size_t n) {
+	const unsigned char *p1 = s1, *p2 = s2;
+	while(n--)
+		if(*p1 != *p2)
+			return *p1 - *p2;
+		else
+			p1++, p2++;
+	return 0;
+}
+
+__attribute__((no_instrument_function))
+static size_t prvLoopLength(const char *s) {
+	size_t i;
+	for(i = 0; s[i] != '\0'; i++) ;
+	return i;
+}
+
+__attribute__((no_instrument_function))
+static char *prvAppendString(char *pcDest, const char *pcSrc) {
+	while(*pcSrc) {
+		*pcDest++ = *pcSrc++;
+	}
+	return pcDest;
+}
+
+__attribute__((no_instrument_function))
+static char *prvAppendDecimal(char *pcDest, unsigned long ulValue) {
+	char cDigits[10];
+	int i = 0;
+
+	do {
+		cDigits[i++] = '0' + (ulValue % 10);
+		ulValue /= 10;
+	} while(ulValue);
+
+	while(i) {
+		*pcDest++ = cDigits[--i];
+	}
+	return pcDest;
+}
+
+__attribute__((no_instrument_function))
+static void prvCyclesStart(void) {
+	/* PMCR: count every cycle, from zero.  PMCNTENSET: the cycle counter. */
+	__asm volatile ("mcr p15, 0, %0, c9, c12, 0" : : "r" (0x5UL));
+	__asm volatile ("mcr p15, 0, %0, c9, c12, 1" : : "r" (0x80000000UL));
+}
+
+__attribute__((no_instrument_function))
+static inline unsigned long prvCycles(void) {
+	unsigned long ulCycles;
+
+	__asm volatile ("mrc p15, 0, %0, c9, c13, 0" : "=r" (ulCycles));
+	return ulCycles;
+}
+
+/**
+ *	Runs one routine on xSize bytes until MEM_BYTES have gone through it,
+ *	and returns the cycles taken.
+ **/
+__attribute__((no_instrument_function))
+static unsigned long prvRun(eMemOp eOp, int iLoop, size_t xSize) {
+	unsigned long ulCalls = MEM_BYTES / xSize, i, ulStart;
+	volatile size_t xSink = 0;
+
+	memset(ucSource, 0x5A, xSize + 8);
+	ucSource[xSize] = '\0';
+	memset(ucDest, 0x5A, xSize + 8);
+
+	ulStart = prvCycles();
+	for(i = 0; i < ulCalls; i++) {
+		switch(eOp) {
+		case eMemcpy:
+			iLoop ? prvLoopCopy(ucDest, ucSource, xSize) : (void) memcpy(ucDest, ucSource, xSize);
+			break;
+		case eMemcpyOdd:
+			iLoop ? prvLoopCopy(ucDest, ucSource + 1, xSize) : (void) memcpy(ucDest, ucSource + 1, xSize);
+			break;
+		case eMemmove:
+			iLoop ? prvLoopMove(ucDest + 4, ucDest, xSize) : (void) memmove(ucDest + 4, ucDest, xSize);
+			break;
+		case eMemset:
+			iLoop ? prvLoopSet(ucDest, (int) i, xSize) : (void) memset(ucDest, (int) i, xSize);
+			break;
+		case eMemcmp:
+			/* ucDest matches ucSource, so the whole size is compared. */
+			xSink += iLoop ? prvLoopCompare(ucDest, ucSource, xSize) : memcmp(ucDest, ucSource, xSize);
+			break;
+		default:
+			xSink += iLoop ? prvLoopLength((const char *) ucSource) : strlen((const char *) ucSource);
+			break;
+		}
+	}
+	return prvCycles() - ulStart;
+}
+
+/**
+ *	Runs in the benchmark task, see vStartBenchmarks().
+ **/
+__attribute__((no_instrument_function))
+void vBenchMem(void) {
+	char cName[40];
+	unsigned long ulCycles, s;
+	int iOp, iLoop;
+	char *p;
+
+	prvCyclesStart();
+
+	for(iOp = 0; iOp < eMemOps; iOp++) {
+		for(s = 0; s < sizeof(ulSizes) / sizeof(ulSizes[0]); s++) {
+			for(iLoop = 1; iLoop >= 0; iLoop--) {
+				ulCycles = prvRun((eMemOp) iOp, iLoop, ulSizes[s]);
+
+				p = prvAppendString(cName, "mem.");
+				p = prvAppendString(p, pcOpNames[iOp]);
+				p = prvAppendString(p, ".");
+				p = prvAppendDecimal(p, ulSizes[s]);
+				p = prvAppendString(p, iLoop ? ".loop" : ".mem");
+				*p = '\0';
+
+				vBenchReportValue(cName, "bytes_per_kcycle",
+						(unsigned long) (((unsigned long long) (MEM_BYTES / ulSizes[s]) * ulSizes[s] * 1000ULL) / (ulCycles ? ulCycles : 1)));
+			}
+		}
+	}
+}
@@ -0,0 +1,72 @@
+// bench_mutex.c
+//
+// Mutex take and give, with and without another task waiting.
+//
+//   mutex.uncontended  - xSemaphoreTake() then xSemaphoreGive() in the
+//                        benchmark task, nothing else wants the mutex.
+//   mutex.contended    - the benchmark task holds the mutex when it wakes a
+//                        task at the top priority, which blocks on it and
+//                        lends the holder its priority.  The give hands the
+//                        mutex over, disinherits and switches; the waiter
+//                        gives it back and waits to be woken again.  Four
+//                        switches per iteration.
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+
+#include "video.h"
+#include "benchmark.h"
+
+#define MUTEX_ITERATIONS	10000UL
+
+static xSemaphoreHandle xMutex;
+
+__attribute__((no_instrument_function))
+static void prvContender(void *pvParameters) {
+	for(;;) {
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		xSemaphoreTake(xMutex, portMAX_DELAY);
+		xSemaphoreGive(xMutex);
+	}
+}
+
+/**
+ *	Runs in the benchmark task, see vStartBenchmarks().
+ **/
+__attribute__((no_instrument_function))
+void vBenchMutex(void) {
+	xTaskHandle xContender;
+	unsigned long ulStart, ulEnd, i;
+
+	xMutex = xSemaphoreCreateMutex();
+	if(xMutex == NULL) {
+		println("mutex: no memory for the mutex", RED_TEXT);
+		return;
+	}
+
+	ulStart = benchGET_TIME_US();
+	for(i = 0; i < MUTEX_ITERATIONS; i++) {
+		xSemaphoreTake(xMutex, portMAX_DELAY);
+		xSemaphoreGive(xMutex);
+	}
+	ulEnd = benchGET_TIME_US();
+
+	vBenchReport("mutex.uncontended", MUTEX_ITERATIONS, ulEnd - ulStart);
+
+	/* Waits for its notification straight away. */
+	xTaskCreate(prvContender, (signed char *) "bmx_cont", configMINIMAL_STACK_SIZE, NULL, configMAX_PRIORITIES - 1, &xContender);
+
+	ulStart = benchGET_TIME_US();
+	for(i = 0; i < MUTEX_ITERATIONS; i++) {
+		xSemaphoreTake(xMutex, portMAX_DELAY);
+		xTaskNotifyGive(xContender);
+		xSemaphoreGive(xMutex);
+	}
+	ulEnd = benchGET_TIME_US();
+
+	vBenchReport("mutex.contended", MUTEX_ITERATIONS, ulEnd - ulStart);
+
+	vTaskDelete(xContender);
+	vQueueDelete(xMutex);
+}
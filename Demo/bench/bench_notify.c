@@ -0,0 +1,97 @@
+// bench_notify.c
+//
+// Cost of signalling a task with a direct to task notification, against
+// doing the same with a binary semaphore.
+//
+//   notify.signal  - xTaskNotifyGive() then ulTaskNotifyTake() in the same
+//   sem.signal       task, or xSemaphoreGive() then xSemaphoreTake().  No
+//                    task switch, so this is the bare cost of the primitive.
+//   notify.wake    - waking a task at the top priority that is blocked in
+//   sem.wake         ulTaskNotifyTake() or xSemaphoreTake().  Two switches
+//                    per iteration, as the woken task blocks again.
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+
+#include "video.h"
+#include "benchmark.h"
+
+#define NOTIFY_ITERATIONS	10000UL
+
+static xSemaphoreHandle xSemaphore;
+
+__attribute__((no_instrument_function))
+static void prvNotifyTaker(void *pvParameters) {
+	for(;;) {
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+	}
+}
+
+__attribute__((no_instrument_function))
+static void prvSemaphoreTaker(void *pvParameters) {
+	for(;;) {
+		xSemaphoreTake(xSemaphore, portMAX_DELAY);
+	}
+}
+
+/**
+ *	Runs in the benchmark task, see vStartBenchmarks().
+ **/
+__attribute__((no_instrument_function))
+void vBenchNotify(void) {
+	xTaskHandle xSelf = xTaskGetCurrentTaskHandle();
+	xTaskHandle xTaker;
+	unsigned long ulStart, ulEnd, i;
+
+	vSemaphoreCreateBinary(xSemaphore);
+	if(xSemaphore == NULL) {
+		println("notify: no memory for the semaphore", RED_TEXT);
+		return;
+	}
+	xSemaphoreTake(xSemaphore, 0);
+
+	/* Signal ourselves, nothing ever blocks. */
+	ulStart = benchGET_TIME_US();
+	for(i = 0; i < NOTIFY_ITERATIONS; i++) {
+		xTaskNotifyGive(xSelf);
+		ulTaskNotifyTake(pdTRUE, 0);
+	}
+	ulEnd = benchGET_TIME_US();
+
+	vBenchReport("notify.signal", NOTIFY_ITERATIONS, ulEnd - ulStart);
+
+	ulStart = benchGET_TIME_US();
+	for(i = 0; i < NOTIFY_ITERATIONS; i++) {
+		xSemaphoreGive(xSemaphore);
+		xSemaphoreTake(xSemaphore, 0);
+	}
+	ulEnd = benchGET_TIME_US();
+
+	vBenchReport("sem.signal", NOTIFY_ITERATIONS, ulEnd - ulStart);
+
+	/* Wake a higher priority task.  It blocks straight away when created. */
+	xTaskCreate(prvNotifyTaker, (signed char *) "bnt_notify", configMINIMAL_STACK_SIZE, NULL, configMAX_PRIORITIES - 1, &xTaker);
+
+	ulStart = benchGET_TIME_US();
+	for(i = 0; i < NOTIFY_ITERATIONS; i++) {
+		xTaskNotifyGive(xTaker);
+	}
+	ulEnd = benchGET_TIME_US();
+
+	vBenchReport("notify.wake", NOTIFY_ITERATIONS, ulEnd - ulStart);
+	vTaskDelete(xTaker);
+
+	xTaskCreate(prvSemaphoreTaker, (signed char *) "bnt_sem", configMINIMAL_STACK_SIZE, NULL, configMAX_PRIORITIES - 1, &xTaker);
+
+	ulStart = benchGET_TIME_US();
+	for(i = 0; i < NOTIFY_ITERATIONS; i++) {
+		xSemaphoreGive(xSemaphore);
+	}
+	ulEnd = benchGET_TIME_US();
+
+	vBenchReport("sem.wake", NOTIFY_ITERATIONS, ulEnd - ulStart);
+	vTaskDelete(xTaker);
+
+	vQueueDelete(xSemaphore);
+}
@@ -0,0 +1,77 @@
+// bench_pool.c
+//
+// The bookkeeping USPi does for every USB transfer, which is every received
+// or sent Ethernet frame: a TDWHCITransferStageData per transfer stage, taken
+// when the stage is started and given back from the channel interrupt.
+//
+//   usb.stage.malloc  - malloc() and free() of one, as USPi did before: the
+//                       FreeRTOS heap inside USPi's critical section.
+//   usb.stage.pool    - ObjectPoolAllocate() and ObjectPoolFree() on the
+//                       driver's own pool (dwhcipools.h), as it does now.
+//   usb.control.*     - the same for a control message: its setup data and a
+//                       stage for each of the setup, data and status stages.
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include <uspios.h>
+#include <uspi/dwhcipools.h>
+#include <uspi/dwhcixferstagedata.h>
+#include <uspi/usb.h>
+
+#include "video.h"
+#include "benchmark.h"
+
+#define POOL_ITERATIONS		10000UL
+
+/**
+ *	Runs in the benchmark task, see vStartBenchmarks().
+ **/
+__attribute__((no_instrument_function))
+void vBenchPool(void) {
+	void *pvStage[3], *pvSetup;
+	unsigned long ulStart, ulEnd, i, j;
+
+	ulStart = benchGET_TIME_US();
+	for(i = 0; i < POOL_ITERATIONS; i++) {
+		pvStage[0] = malloc(sizeof(TDWHCITransferStageData));
+		free(pvStage[0]);
+	}
+	ulEnd = benchGET_TIME_US();
+	vBenchReport("usb.stage.malloc", POOL_ITERATIONS, ulEnd - ulStart);
+
+	ulStart = benchGET_TIME_US();
+	for(i = 0; i < POOL_ITERATIONS; i++) {
+		pvStage[0] = ObjectPoolAllocate(&DWHCIStageDataPool, sizeof(TDWHCITransferStageData));
+		ObjectPoolFree(&DWHCIStageDataPool, pvStage[0]);
+	}
+	ulEnd = benchGET_TIME_US();
+	vBenchReport("usb.stage.pool", POOL_ITERATIONS, ulEnd - ulStart);
+
+	ulStart = benchGET_TIME_US();
+	for(i = 0; i < POOL_ITERATIONS; i++) {
+		pvSetup = malloc(sizeof(TSetupData));
+		for(j = 0; j < 3; j++) {
+			pvStage[j] = malloc(sizeof(TDWHCITransferStageData));
+			free(pvStage[j]);
+		}
+		free(pvSetup);
+	}
+	ulEnd = benchGET_TIME_US();
+	vBenchReport("usb.control.malloc", POOL_ITERATIONS, ulEnd - ulStart);
+
+	ulStart = benchGET_TIME_US();
+	for(i = 0; i < POOL_ITERATIONS; i++) {
+		pvSetup = ObjectPoolAllocate(&DWHCISetupDataPool, sizeof(TSetupData));
+		for(j = 0; j < 3; j++) {
+			pvStage[j] = ObjectPoolAllocate(&DWHCIStageDataPool, sizeof(TDWHCITransferStageData));
+			ObjectPoolFree(&DWHCIStageDataPool, pvStage[j]);
+		}
+		ObjectPoolFree(&DWHCISetupDataPool, pvSetup);
+	}
+	ulEnd = benchGET_TIME_US();
+	vBenchReport("usb.control.pool", POOL_ITERATIONS, ulEnd - ulStart);
+
+	vBenchReportValue("usb.stage.pool", "high_water", ObjectPoolGetHighWater(&DWHCIStageDataPool));
+	vBenchReportValue("usb.stage.pool", "misses", ObjectPoolGetMisses(&DWHCIStageDataPool));
+}
@@ -0,0 +1,78 @@
+// bench_queue.c
+//
+// Queue ping-pong: the benchmark task sends an item to a task at the top
+// priority, which sends it straight back on a second queue.  Each iteration
+// copies the item into and out of both queues and switches task twice.
+//
+//   queue.pingpong.4     - 4, 64 and 1024 byte items.  kbytes_per_s counts
+//   queue.pingpong.64      the bytes moved in both directions.
+//   queue.pingpong.1024
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <queue.h>
+
+#include "video.h"
+#include "benchmark.h"
+
+#define QUEUE_ITERATIONS	5000UL
+#define QUEUE_MAX_ITEM		1024
+
+static xQueueHandle xPing;
+static xQueueHandle xPong;
+
+/* Too big for the task stacks. */
+static unsigned char ucItem[QUEUE_MAX_ITEM];
+static unsigned char ucEcho[QUEUE_MAX_ITEM];
+
+__attribute__((no_instrument_function))
+static void prvEchoTask(void *pvParameters) {
+	for(;;) {
+		xQueueReceive(xPing, ucEcho, portMAX_DELAY);
+		xQueueSend(xPong, ucEcho, portMAX_DELAY);
+	}
+}
+
+__attribute__((no_instrument_function))
+static void prvPingPong(const char *pcName, unsigned long ulItemSize) {
+	xTaskHandle xEcho;
+	unsigned long ulStart, ulEnd, i;
+	unsigned long long ullBytes;
+
+	xPing = xQueueCreate(1, ulItemSize);
+	xPong = xQueueCreate(1, ulItemSize);
+	if(xPing == NULL || xPong == NULL) {
+		println("queue: no memory for the queues", RED_TEXT);
+		return;
+	}
+
+	/* Blocks on xPing straight away. */
+	xTaskCreate(prvEchoTask, (signed char *) "bq_echo", configMINIMAL_STACK_SIZE, NULL, configMAX_PRIORITIES - 1, &xEcho);
+
+	ulStart = benchGET_TIME_US();
+	for(i = 0; i < QUEUE_ITERATIONS; i++) {
+		xQueueSend(xPing, ucItem, portMAX_DELAY);
+		xQueueReceive(xPong, ucItem, portMAX_DELAY);
+	}
+	ulEnd = benchGET_TIME_US();
+
+	vBenchReport(pcName, QUEUE_ITERATIONS, ulEnd - ulStart);
+
+	/* Bytes per millisecond is kilobytes per second. */
+	ullBytes = 2ULL * ulItemSize * QUEUE_ITERATIONS * 1000ULL;
+	vBenchReportValue(pcName, "kbytes_per_s", (ulEnd - ulStart) ? (unsigned long) (ullBytes / (ulEnd - ulStart)) : 0);
+
+	vTaskDelete(xEcho);
+	vQueueDelete(xPing);
+	vQueueDelete(xPong);
+}
+
+/**
+ *	Runs in the benchmark task, see vStartBenchmarks().
+ **/
+__attribute__((no_instrument_function))
+void vBenchQueue(void) {
+	prvPingPong("queue.pingpong.4", 4);
+	prvPingPong("queue.pingpong.64", 64);
+	prvPingPong("queue.pingpong.1024", 1024);
+}
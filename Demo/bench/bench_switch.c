@@ -0,0 +1,82 @@
+// bench_switch.c
+//
+// Context switch cost, to compare the generic ready list search with
+// configUSE_PORT_OPTIMISED_TASK_SELECTION.  Run it once with each setting.
+//
+//   switch.yield   - two tasks at the same priority passing the CPU with
+//                    taskYIELD(), two switches per iteration.
+//   switch.resume  - a task at priority 1 resuming one at the top priority,
+//                    which then suspends itself again.  Two switches per
+//                    iteration, and the second one has to find the next
+//                    task from the top of the ready lists all the way down.
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include "video.h"
+#include "benchmark.h"
+
+#define SWITCH_ITERATIONS	10000UL
+
+static xTaskHandle xTopTask;
+static volatile int bYieldDone;
+
+__attribute__((no_instrument_function))
+static void prvYieldPartner(void *pvParameters) {
+	while(!bYieldDone) {
+		taskYIELD();
+	}
+	vTaskDelete(NULL);
+}
+
+__attribute__((no_instrument_function))
+static void prvTopTask(void *pvParameters) {
+	for(;;) {
+		vTaskSuspend(NULL);
+	}
+}
+
+/**
+ *	Runs in the benchmark task, see vStartBenchmarks().
+ **/
+__attribute__((no_instrument_function))
+void vBenchSwitch(void) {
+	unsigned portBASE_TYPE uxPriority = uxTaskPriorityGet(NULL);
+	unsigned long ulStart, ulEnd, i;
+
+	#if ( configUSE_PORT_OPTIMISED_TASK_SELECTION == 1 )
+	println("switch: CLZ task selection", WHITE_TEXT);
+	#else
+	println("switch: generic task selection", WHITE_TEXT);
+	#endif
+
+	/* Yield between two tasks of equal priority. */
+	bYieldDone = 0;
+	xTaskCreate(prvYieldPartner, (signed char *) "bsw_yield", configMINIMAL_STACK_SIZE, NULL, uxPriority, NULL);
+	taskYIELD();
+
+	ulStart = benchGET_TIME_US();
+	for(i = 0; i < SWITCH_ITERATIONS; i++) {
+		taskYIELD();
+	}
+	ulEnd = benchGET_TIME_US();
+	bYieldDone = 1;
+
+	vBenchReport("switch.yield", SWITCH_ITERATIONS, ulEnd - ulStart);
+
+	/* Drop to priority 1 and wake a task at the top priority.  It suspends
+	itself straight away when it is created. */
+	vTaskPrioritySet(NULL, 1);
+	xTaskCreate(prvTopTask, (signed char *) "bsw_top", configMINIMAL_STACK_SIZE, NULL, configMAX_PRIORITIES - 1, &xTopTask);
+
+	ulStart = benchGET_TIME_US();
+	for(i = 0; i < SWITCH_ITERATIONS; i++) {
+		vTaskResume(xTopTask);
+	}
+	ulEnd = benchGET_TIME_US();
+
+	vBenchReport("switch.resume", SWITCH_ITERATIONS, ulEnd - ulStart);
+
+	vTaskDelete(xTopTask);
+	vTaskPrioritySet(NULL, uxPriority);
+}
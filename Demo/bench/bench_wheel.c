@@ -0,0 +1,164 @@
+// bench_wheel.c
+//
+// Filing WHEEL_TIMERS timeouts in a sorted xList, as the kernel does without
+// configUSE_TIMING_WHEEL, against filing them in a timing wheel.  Each
+// operation runs in its own critical section, as it would in the kernel, and
+// the longest one is reported alongside the total.
+//
+//   list.insert    - vListInsert() of timeouts spread over WHEEL_SPAN ticks.
+//   wheel.insert     The list walks further as it fills; the wheel does not.
+//   list.expire    - collect the expired timeouts a tick at a time, stepping
+//   wheel.expire     straight to the next expiry as a tickless kernel would.
+//                    iters is the number of steps.  The wheel's longest step
+//                    includes moving a slot down a level.
+//
+// The worst case is reported as "BENCH <name> max_us=<n>".
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <list.h>
+
+#include "video.h"
+#include "benchmark.h"
+
+#if ( configUSE_TIMING_WHEEL == 1 )
+#include <wheel.h>
+#endif
+
+#define WHEEL_TIMERS	1024
+#define WHEEL_SPAN		100000UL	/* ticks */
+
+static xListItem xItems[WHEEL_TIMERS];
+
+/* The same pseudo random expiry times for both structures. */
+__attribute__((no_instrument_function))
+static void prvSetExpiryTimes(portTickType xTimeNow) {
+	unsigned long ulSeed = 12345UL;
+	int i;
+
+	for(i = 0; i < WHEEL_TIMERS; i++) {
+		ulSeed = (ulSeed * 1103515245UL) + 12345UL;
+		vListInitialiseItem(&xItems[i]);
+		listSET_LIST_ITEM_VALUE(&xItems[i], xTimeNow + 1 + ((ulSeed >> 8) % WHEEL_SPAN));
+	}
+}
+
+__attribute__((no_instrument_function))
+static void prvBenchList(void) {
+	static xList xList;
+	unsigned long ulStart, ulTime, ulTotal = 0, ulMax = 0, ulSteps = 0;
+	portTickType xTimeNow = 0;
+	int i;
+
+	vListInitialise(&xList);
+	prvSetExpiryTimes(xTimeNow);
+
+	for(i = 0; i < WHEEL_TIMERS; i++) {
+		taskENTER_CRITICAL();
+		ulStart = benchGET_TIME_US();
+		vListInsert(&xList, &xItems[i]);
+		ulTime = benchGET_TIME_US() - ulStart;
+		taskEXIT_CRITICAL();
+
+		ulTotal += ulTime;
+		if(ulTime > ulMax) {
+			ulMax = ulTime;
+		}
+	}
+
+	vBenchReport("list.insert", WHEEL_TIMERS, ulTotal);
+	vBenchReportValue("list.insert", "max_us", ulMax);
+
+	ulTotal = 0;
+	ulMax = 0;
+	while(listLIST_IS_EMPTY(&xList) == pdFALSE) {
+		taskENTER_CRITICAL();
+		ulStart = benchGET_TIME_US();
+		xTimeNow = listGET_ITEM_VALUE_OF_HEAD_ENTRY(&xList);
+		while(listLIST_IS_EMPTY(&xList) == pdFALSE && listGET_ITEM_VALUE_OF_HEAD_ENTRY(&xList) <= xTimeNow) {
+			vListRemove(xList.xListEnd.pxNext);
+		}
+		ulTime = benchGET_TIME_US() - ulStart;
+		taskEXIT_CRITICAL();
+
+		ulSteps++;
+		ulTotal += ulTime;
+		if(ulTime > ulMax) {
+			ulMax = ulTime;
+		}
+	}
+
+	vBenchReport("list.expire", ulSteps, ulTotal);
+	vBenchReportValue("list.expire", "max_us", ulMax);
+}
+
+#if ( configUSE_TIMING_WHEEL == 1 )
+
+__attribute__((no_instrument_function))
+static void prvBenchWheel(void) {
+	static xTimingWheel xWheel;
+	unsigned long ulStart, ulTime, ulTotal = 0, ulMax = 0, ulSteps = 0, ulExpired = 0;
+	portTickType xTimeNow = 0;
+	int i;
+
+	vWheelInitialise(&xWheel);
+	prvSetExpiryTimes(xTimeNow);
+
+	for(i = 0; i < WHEEL_TIMERS; i++) {
+		taskENTER_CRITICAL();
+		ulStart = benchGET_TIME_US();
+		vWheelInsert(&xWheel, &xItems[i], xTimeNow);
+		ulTime = benchGET_TIME_US() - ulStart;
+		taskEXIT_CRITICAL();
+
+		ulTotal += ulTime;
+		if(ulTime > ulMax) {
+			ulMax = ulTime;
+		}
+	}
+
+	vBenchReport("wheel.insert", WHEEL_TIMERS, ulTotal);
+	vBenchReportValue("wheel.insert", "max_us", ulMax);
+
+	ulTotal = 0;
+	ulMax = 0;
+	while(xWheelIsEmpty(&xWheel) == pdFALSE) {
+		taskENTER_CRITICAL();
+		ulStart = benchGET_TIME_US();
+		xTimeNow = wheelGET_NEXT_EVENT(&xWheel);
+		while(pxWheelGetExpired(&xWheel, xTimeNow) != NULL) {
+			ulExpired++;
+		}
+		ulTime = benchGET_TIME_US() - ulStart;
+		taskEXIT_CRITICAL();
+
+		ulSteps++;
+		ulTotal += ulTime;
+		if(ulTime > ulMax) {
+			ulMax = ulTime;
+		}
+	}
+
+	if(ulExpired != WHEEL_TIMERS) {
+		println("wheel: lost timers", RED_TEXT);
+	}
+
+	vBenchReport("wheel.expire", ulSteps, ulTotal);
+	vBenchReportValue("wheel.expire", "max_us", ulMax);
+}
+
+#endif
+
+/**
+ *	Runs in the benchmark task, see vStartBenchmarks().
+ **/
+__attribute__((no_instrument_function))
+void vBenchWheel(void) {
+	prvBenchList();
+
+	#if ( configUSE_TIMING_WHEEL == 1 )
+	prvBenchWheel();
+	#else
+	println("wheel: configUSE_TIMING_WHEEL is 0, skipped", WHITE_TEXT);
+	#endif
+}
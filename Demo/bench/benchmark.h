@@ -0,0 +1,54 @@
+// benchmark.h
+//
+// Shared helpers for the on-target benchmarks.
+//
+// Every benchmark times itself with the free running 1MHz system timer and
+// reports one line per result:
+//
+//   BENCH <name> iters=<n> us=<total> ns/op=<per iteration>
+//
+// or, for a single measurement such as a worst case,
+//
+//   BENCH <name> <key>=<value>
+//
+// Lines go to the screen and to UART0 (see Drivers/uart.h), between
+// "BENCH start" and "BENCH done", so a script can collect them from the
+// board's serial port or from QEMU:
+//
+//   make clean && make qemu BENCHMARK=1 > results.txt
+//
+// make qemu ticks from the system timer, as QEMU does not model the SP804
+// (see port.c).  QEMU's timings are not the board's, so compare results from
+// the same one.
+//
+// Build with "make BENCHMARK=1" (or "make bench") to run them from main() in
+// place of the demo.
+
+#ifndef _BENCHMARK_H_
+#define _BENCHMARK_H_
+
+#include <FreeRTOS.h>
+
+/* Lower 32 bits of the 1MHz BCM system timer. */
+#define benchTIMER_CLO		( ( volatile unsigned long * ) 0x3f003004 )
+#define benchGET_TIME_US()	( *benchTIMER_CLO )
+
+void vBenchReport( const char *pcName, unsigned long ulIterations, unsigned long ulMicroseconds );
+void vBenchReportValue( const char *pcName, const char *pcKey, unsigned long ulValue );
+
+/* The benchmarks.  Each one runs to completion in the calling task, which
+is left at the priority it started at. */
+void vBenchSwitch( void );
+void vBenchNotify( void );
+void vBenchQueue( void );
+void vBenchMutex( void );
+void vBenchDelay( void );
+void vBenchIrq( void );
+void vBenchWheel( void );
+void vBenchHeap( void );
+void vBenchPool( void );
+void vBenchMem( void );
+
+void vStartBenchmarks( unsigned portBASE_TYPE uxPriority );
+
+#endif
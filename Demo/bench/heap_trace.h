@@ -0,0 +1,786 @@
+// heap_trace.h
+//
+// An allocation trace for bench_heap.c, recorded from the POSIX simulator
+// (see Demo/Posix/heaptrace.c) while it brought up FreeRTOS+TCP and echoed
+// 48 messages of 10 to 6000 bytes over six TCP connections.  It covers the
+// tasks, queues and semaphores created at start up, the stream buffers and
+// sockets of each connection, and the network buffers in between.
+//
+// Sizes are as the heap saw them on the 64 bit host, block header included,
+// and are replayed as they stand: the headers make up, roughly, for the
+// pointers being twice the size of the target's.  A slot is an index into
+// a table of the blocks live at that point.
+
+#ifndef _HEAP_TRACE_H_
+#define _HEAP_TRACE_H_
+
+#define heapTRACE_ALLOC		0
+#define heapTRACE_FREE		1
+
+/* Slots used by the trace. */
+#define heapTRACE_SLOTS		22
+
+typedef struct
+{
+	unsigned char ucOp;
+	unsigned char ucSlot;
+	unsigned short usSize;
+} xHeapTraceOp;
+
+static const xHeapTraceOp xHeapTrace[] =
+{
+	{ heapTRACE_ALLOC, 0, 184 },
+	{ heapTRACE_ALLOC, 1, 832 },
+	{ heapTRACE_ALLOC, 2, 184 },
+	{ heapTRACE_ALLOC, 3, 32 },
+	{ heapTRACE_ALLOC, 4, 200 },
+	{ heapTRACE_ALLOC, 5, 8216 },
+	{ heapTRACE_ALLOC, 6, 200 },
+	{ heapTRACE_ALLOC, 7, 8216 },
+	{ heapTRACE_ALLOC, 8, 200 },
+	{ heapTRACE_ALLOC, 9, 2072 },
+	{ heapTRACE_ALLOC, 10, 200 },
+	{ heapTRACE_ALLOC, 11, 1048 },
+	{ heapTRACE_ALLOC, 12, 200 },
+	{ heapTRACE_ALLOC, 13, 8216 },
+	{ heapTRACE_ALLOC, 14, 584 },
+	{ heapTRACE_ALLOC, 15, 80 },
+	{ heapTRACE_ALLOC, 16, 1560 },
+	{ heapTRACE_FREE, 16, 0 },
+	{ heapTRACE_ALLOC, 16, 1560 },
+	{ heapTRACE_FREE, 16, 0 },
+	{ heapTRACE_ALLOC, 16, 1560 },
+	{ heapTRACE_FREE, 16, 0 },
+	{ heapTRACE_ALLOC, 16, 1560 },
+	{ heapTRACE_ALLOC, 17, 26648 },
+	{ heapTRACE_ALLOC, 18, 112 },
+	{ heapTRACE_FREE, 18, 0 },
+	{ heapTRACE_FREE, 16, 0 },
+	{ heapTRACE_ALLOC, 16, 1560 },
+	{ heapTRACE_FREE, 16, 0 },
+	{ heapTRACE_ALLOC, 16, 1560 },
+	{ heapTRACE_ALLOC, 18, 5912 },
+	{ heapTRACE_ALLOC, 19, 288 },
+	{ heapTRACE_FREE, 19, 0 },
+	{ heapTRACE_FREE, 16, 0 },
+	{ heapTRACE_ALLOC, 16, 1488 },
+	{ heapTRACE_ALLOC, 19, 5912 },
+	{ heapTRACE_ALLOC, 20, 288 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 104 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 104 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 21, 288 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 288 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 21, 288 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 288 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 168 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 168 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1488 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1488 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 168 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 168 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 168 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1488 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1488 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 21, 104 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_FREE, 16, 0 },
+	{ heapTRACE_FREE, 18, 0 },
+	{ heapTRACE_FREE, 19, 0 },
+	{ heapTRACE_FREE, 15, 0 },
+	{ heapTRACE_FREE, 14, 0 },
+	{ heapTRACE_ALLOC, 14, 584 },
+	{ heapTRACE_ALLOC, 15, 80 },
+	{ heapTRACE_ALLOC, 16, 112 },
+	{ heapTRACE_FREE, 16, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 16, 1560 },
+	{ heapTRACE_FREE, 16, 0 },
+	{ heapTRACE_ALLOC, 16, 1560 },
+	{ heapTRACE_ALLOC, 18, 5912 },
+	{ heapTRACE_ALLOC, 19, 1488 },
+	{ heapTRACE_FREE, 19, 0 },
+	{ heapTRACE_FREE, 16, 0 },
+	{ heapTRACE_ALLOC, 16, 1488 },
+	{ heapTRACE_ALLOC, 19, 5912 },
+	{ heapTRACE_ALLOC, 20, 1488 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 288 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 288 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 21, 1488 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1488 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 21, 1488 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1488 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 20, 248 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 104 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 104 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 21, 104 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 104 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 20, 248 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 104 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_FREE, 16, 0 },
+	{ heapTRACE_FREE, 18, 0 },
+	{ heapTRACE_FREE, 19, 0 },
+	{ heapTRACE_FREE, 15, 0 },
+	{ heapTRACE_FREE, 14, 0 },
+	{ heapTRACE_ALLOC, 14, 584 },
+	{ heapTRACE_ALLOC, 15, 80 },
+	{ heapTRACE_ALLOC, 16, 112 },
+	{ heapTRACE_FREE, 16, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 16, 1560 },
+	{ heapTRACE_FREE, 16, 0 },
+	{ heapTRACE_ALLOC, 16, 1560 },
+	{ heapTRACE_ALLOC, 18, 5912 },
+	{ heapTRACE_ALLOC, 19, 1488 },
+	{ heapTRACE_FREE, 19, 0 },
+	{ heapTRACE_FREE, 16, 0 },
+	{ heapTRACE_ALLOC, 16, 1488 },
+	{ heapTRACE_ALLOC, 19, 5912 },
+	{ heapTRACE_ALLOC, 20, 1488 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1488 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1488 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 21, 1488 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1488 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 20, 248 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1488 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1488 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 21, 104 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 104 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 21, 288 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 288 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 21, 104 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 104 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 21, 104 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_FREE, 16, 0 },
+	{ heapTRACE_FREE, 18, 0 },
+	{ heapTRACE_FREE, 19, 0 },
+	{ heapTRACE_FREE, 15, 0 },
+	{ heapTRACE_FREE, 14, 0 },
+	{ heapTRACE_ALLOC, 14, 584 },
+	{ heapTRACE_ALLOC, 15, 80 },
+	{ heapTRACE_ALLOC, 16, 112 },
+	{ heapTRACE_FREE, 16, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 16, 1560 },
+	{ heapTRACE_FREE, 16, 0 },
+	{ heapTRACE_ALLOC, 16, 1560 },
+	{ heapTRACE_ALLOC, 18, 5912 },
+	{ heapTRACE_ALLOC, 19, 104 },
+	{ heapTRACE_FREE, 19, 0 },
+	{ heapTRACE_FREE, 16, 0 },
+	{ heapTRACE_ALLOC, 16, 1488 },
+	{ heapTRACE_ALLOC, 19, 5912 },
+	{ heapTRACE_ALLOC, 20, 104 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 20, 248 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 288 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 288 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 20, 248 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 104 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 104 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 21, 1488 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1488 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 21, 104 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 104 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 168 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 168 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 104 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_FREE, 16, 0 },
+	{ heapTRACE_FREE, 18, 0 },
+	{ heapTRACE_FREE, 19, 0 },
+	{ heapTRACE_FREE, 15, 0 },
+	{ heapTRACE_FREE, 14, 0 },
+	{ heapTRACE_ALLOC, 14, 584 },
+	{ heapTRACE_ALLOC, 15, 80 },
+	{ heapTRACE_ALLOC, 16, 112 },
+	{ heapTRACE_FREE, 16, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 16, 1560 },
+	{ heapTRACE_FREE, 16, 0 },
+	{ heapTRACE_ALLOC, 16, 1560 },
+	{ heapTRACE_ALLOC, 18, 5912 },
+	{ heapTRACE_ALLOC, 19, 1488 },
+	{ heapTRACE_FREE, 19, 0 },
+	{ heapTRACE_FREE, 16, 0 },
+	{ heapTRACE_ALLOC, 16, 1488 },
+	{ heapTRACE_ALLOC, 19, 5912 },
+	{ heapTRACE_ALLOC, 20, 1488 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1488 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1488 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 21, 1488 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1488 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 20, 248 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 20, 248 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1488 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1488 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 21, 1488 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1488 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 21, 104 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 104 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 21, 104 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_FREE, 16, 0 },
+	{ heapTRACE_FREE, 18, 0 },
+	{ heapTRACE_FREE, 19, 0 },
+	{ heapTRACE_FREE, 15, 0 },
+	{ heapTRACE_FREE, 14, 0 },
+	{ heapTRACE_ALLOC, 14, 584 },
+	{ heapTRACE_ALLOC, 15, 80 },
+	{ heapTRACE_ALLOC, 16, 112 },
+	{ heapTRACE_FREE, 16, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 16, 1560 },
+	{ heapTRACE_FREE, 16, 0 },
+	{ heapTRACE_ALLOC, 16, 1560 },
+	{ heapTRACE_ALLOC, 18, 5912 },
+	{ heapTRACE_ALLOC, 19, 1488 },
+	{ heapTRACE_FREE, 19, 0 },
+	{ heapTRACE_FREE, 16, 0 },
+	{ heapTRACE_ALLOC, 16, 1488 },
+	{ heapTRACE_ALLOC, 19, 5912 },
+	{ heapTRACE_ALLOC, 20, 1488 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 168 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 168 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1552 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 248 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 248 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 288 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 288 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 21, 1488 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 1488 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 21, 104 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 104 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 21, 104 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 104 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 21, 104 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_ALLOC, 21, 104 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_ALLOC, 21, 104 },
+	{ heapTRACE_FREE, 21, 0 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_FREE, 20, 0 },
+	{ heapTRACE_ALLOC, 20, 1560 },
+	{ heapTRACE_FREE, 16, 0 },
+	{ heapTRACE_FREE, 18, 0 },
+	{ heapTRACE_FREE, 19, 0 },
+	{ heapTRACE_FREE, 15, 0 },
+	{ heapTRACE_FREE, 14, 0 },
+	{ heapTRACE_ALLOC, 14, 584 },
+	{ heapTRACE_ALLOC, 15, 80 },
+	{ heapTRACE_ALLOC, 16, 104 },
+	{ heapTRACE_FREE, 16, 0 },
+};
+
+#endif
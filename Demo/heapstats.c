@@ -0,0 +1,361 @@
+//heapstats.c
+//
+//heap instrumentation
+//
+//the traceMALLOC and traceFREE hooks (see heapstats.h) keep a table of the
+//live allocations: the block, its size, the address pvPortMalloc() was called
+//from and the snapshot it was made in.  the table is open addressed on the
+//block, so a hook costs a few probes and never allocates.  the hooks run
+//inside the heap's own scheduler suspension, and IRQs are masked around the
+//table as USPi allocates from its interrupt handlers
+//
+//vHeapStatsDump() prints the state of the heap, from vPortGetHeapStats(), and
+//the live allocations grouped by call site:
+//
+//   HEAP free=<bytes> min_free=<low water mark> largest=<largest free block> ...
+//   HEAP site=0x0001a2b4 live=<blocks> bytes=<bytes> new=<blocks>
+//
+//"new" counts the blocks still live that were allocated since the last
+//vHeapStatsSnapshot().  under steady traffic it should drop back to zero for
+//every site between dumps; a site that has new blocks dump after dump, with
+//its bytes growing, is leaking
+//
+//the sites are return addresses.  name them on the host with heapsyms, from
+//the kernel.syms the build writes:
+//
+//   heapsyms kernel.syms < console.log
+
+#include <FreeRTOS.h>
+
+#if ( configUSE_HEAP_STATS == 1 )
+
+#include <task.h>
+#include <video.h>
+
+#ifndef POSIX_SIM
+	#include "uart.h"
+#endif
+
+#if ( ( heapstatsMAX_LIVE & ( heapstatsMAX_LIVE - 1 ) ) != 0 )
+	#error heapstatsMAX_LIVE must be a power of two.
+#endif
+
+typedef struct xHEAPSTATS_ENTRY
+{
+	void *pv;							/* The block handed out, NULL if the entry is empty. */
+	size_t xSize;						/* As asked for, rounded up by the heap. */
+	void *pvSite;						/* Where pvPortMalloc() was called from. */
+	unsigned long ulGeneration;			/* The snapshot the block was allocated in. */
+} xHeapStatsEntryType;
+
+typedef struct xHEAPSTATS_SITE
+{
+	void *pvSite;
+	unsigned long ulLive;
+	unsigned long ulBytes;
+	unsigned long ulNew;
+} xHeapStatsSiteType;
+
+static xHeapStatsEntryType xLive[ heapstatsMAX_LIVE ];
+static unsigned long ulLiveCount = 0;
+static unsigned long ulDropped = 0;		/* Allocations the table had no room for. */
+static unsigned long ulFailed = 0;		/* Allocations the heap could not satisfy. */
+static unsigned long ulGeneration = 0;
+
+/* Set by vHeapStatsSetCaller() for the next allocation only. */
+static void *pvNextCaller = NULL;
+
+/* Only the reporter uses this, but it is too big for its stack. */
+static xHeapStatsSiteType xSites[ heapstatsMAX_SITES ];
+
+#ifndef POSIX_SIM
+
+__attribute__((no_instrument_function))
+static inline unsigned long prvHeapStatsMaskInterrupts( void ) {
+	unsigned long ulCPSR;
+
+	__asm volatile ("mrs %0, cpsr\n\t"
+					"cpsid i" : "=r" (ulCPSR) : : "memory");
+	return ulCPSR;
+}
+
+__attribute__((no_instrument_function))
+static inline void prvHeapStatsRestoreInterrupts( unsigned long ulCPSR ) {
+	__asm volatile ("msr cpsr_c, %0" : : "r" (ulCPSR) : "memory");
+}
+
+#else
+
+//the simulator never allocates from its signal handlers
+#define prvHeapStatsMaskInterrupts()		( 0UL )
+#define prvHeapStatsRestoreInterrupts( x )	( ( void ) ( x ) )
+
+#endif
+
+/**
+ *	The entry a block is looked for from.  Blocks are at least 8 byte
+ *	aligned, so the low bits say nothing.
+ **/
+__attribute__((no_instrument_function))
+static unsigned long prvHeapStatsHome(void *pv) {
+	unsigned long ulKey = (unsigned long) pv >> 3;
+
+	ulKey ^= ulKey >> 11;
+	return ulKey & (heapstatsMAX_LIVE - 1);
+}
+
+__attribute__((no_instrument_function))
+void vHeapStatsMalloc(void *pv, size_t xSize, void *pvCaller) {
+	unsigned long ulCPSR = prvHeapStatsMaskInterrupts();
+	unsigned long i;
+
+	if(pvNextCaller != NULL) {
+		pvCaller = pvNextCaller;
+		pvNextCaller = NULL;
+	}
+
+	if(pv == NULL) {
+		ulFailed++;
+	} else if(ulLiveCount >= heapstatsMAX_LIVE - 1) {
+		/* One entry is always left empty, to end the probes. */
+		ulDropped++;
+	} else {
+		for(i = prvHeapStatsHome(pv); xLive[i].pv != NULL; i = (i + 1) & (heapstatsMAX_LIVE - 1)) {
+		}
+		xLive[i].pv = pv;
+		xLive[i].xSize = xSize;
+		xLive[i].pvSite = pvCaller;
+		xLive[i].ulGeneration = ulGeneration;
+		ulLiveCount++;
+	}
+
+	prvHeapStatsRestoreInterrupts(ulCPSR);
+}
+
+/**
+ *	Removes a block from the table, moving back the entries after it that
+ *	would no longer be found past the hole.  Blocks allocated while the table
+ *	was full are not in it, and are ignored.
+ **/
+__attribute__((no_instrument_function))
+void vHeapStatsFree(void *pv) {
+	unsigned long ulCPSR = prvHeapStatsMaskInterrupts();
+	unsigned long i, j, ulHome;
+
+	for(i = prvHeapStatsHome(pv); xLive[i].pv != NULL; i = (i + 1) & (heapstatsMAX_LIVE - 1)) {
+		if(xLive[i].pv == pv) {
+			break;
+		}
+	}
+
+	if(xLive[i].pv != NULL) {
+		for(j = (i + 1) & (heapstatsMAX_LIVE - 1); xLive[j].pv != NULL; j = (j + 1) & (heapstatsMAX_LIVE - 1)) {
+			ulHome = prvHeapStatsHome(xLive[j].pv);
+
+			/* Leave the entry where it is if its home is after the hole,
+			going round from the hole to the entry. */
+			if((i <= j) ? (i < ulHome && ulHome <= j) : (i < ulHome || ulHome <= j)) {
+				continue;
+			}
+
+			xLive[i] = xLive[j];
+			i = j;
+		}
+
+		xLive[i].pv = NULL;
+		ulLiveCount--;
+	}
+
+	prvHeapStatsRestoreInterrupts(ulCPSR);
+}
+
+/**
+ *	Makes the next allocation count against pvCaller instead of the caller
+ *	of pvPortMalloc(), for wrappers such as USPi's malloc().  Call it with
+ *	IRQs masked, right before pvPortMalloc().
+ **/
+__attribute__((no_instrument_function))
+void vHeapStatsSetCaller(void *pvCaller) {
+	pvNextCaller = pvCaller;
+}
+
+/**
+ *	Starts a new generation, so the next dump counts as new only what is
+ *	allocated from now on.
+ **/
+__attribute__((no_instrument_function))
+void vHeapStatsSnapshot(void) {
+	unsigned long ulCPSR = prvHeapStatsMaskInterrupts();
+
+	ulGeneration++;
+	prvHeapStatsRestoreInterrupts(ulCPSR);
+}
+
+/**
+ *	Totals the table by call site into xSites.  The last site also takes
+ *	everything once the others are used up.  Returns the sites filled in.
+ **/
+__attribute__((no_instrument_function))
+static unsigned long prvHeapStatsGroup(void) {
+	unsigned long ulCPSR = prvHeapStatsMaskInterrupts();
+	unsigned long i, s, ulSites = 0;
+
+	for(i = 0; i < heapstatsMAX_LIVE; i++) {
+		if(xLive[i].pv == NULL) {
+			continue;
+		}
+
+		for(s = 0; s < ulSites && xSites[s].pvSite != xLive[i].pvSite; s++) {
+		}
+
+		if(s == ulSites) {
+			if(ulSites < heapstatsMAX_SITES) {
+				xSites[s].pvSite = xLive[i].pvSite;
+				xSites[s].ulLive = 0;
+				xSites[s].ulBytes = 0;
+				xSites[s].ulNew = 0;
+				ulSites++;
+			} else {
+				s = heapstatsMAX_SITES - 1;
+			}
+		}
+
+		xSites[s].ulLive++;
+		xSites[s].ulBytes += xLive[i].xSize;
+		if(xLive[i].ulGeneration == ulGeneration) {
+			xSites[s].ulNew++;
+		}
+	}
+
+	prvHeapStatsRestoreInterrupts(ulCPSR);
+	return ulSites;
+}
+
+/* One line, to the screen and the serial port. */
+__attribute__((no_instrument_function))
+static void prvHeapStatsEmit(const char *pcLine) {
+#ifndef POSIX_SIM
+	static int iUartReady = 0;
+
+	if(!iUartReady) {
+		UartInit();
+		iUartReady = 1;
+	}
+	UartPuts(pcLine);
+	UartPuts("\n");
+#endif
+	println(pcLine, WHITE_TEXT);
+}
+
+__attribute__((no_instrument_function))
+static char *prvAppendString(char *pcDest, const char *pcSrc) {
+	while(*pcSrc) {
+		*pcDest++ = *pcSrc++;
+	}
+	return pcDest;
+}
+
+__attribute__((no_instrument_function))
+static char *prvAppendDecimal(char *pcDest, const char *pcKey, unsigned long ulValue) {
+	char cDigits[20];
+	int i = 0;
+
+	pcDest = prvAppendString(pcDest, pcKey);
+	do {
+		cDigits[i++] = '0' + (ulValue % 10);
+		ulValue /= 10;
+	} while(ulValue);
+
+	while(i) {
+		*pcDest++ = cDigits[--i];
+	}
+	return pcDest;
+}
+
+/* All the digits of an address, so heapsyms can find them. */
+__attribute__((no_instrument_function))
+static char *prvAppendAddress(char *pcDest, const char *pcKey, void *pv) {
+	unsigned long ulValue = (unsigned long) pv;
+	int iShift;
+
+	pcDest = prvAppendString(pcDest, pcKey);
+	pcDest = prvAppendString(pcDest, "0x");
+	for(iShift = sizeof(ulValue) * 8 - 4; iShift >= 0; iShift -= 4) {
+		*pcDest++ = "0123456789abcdef"[(ulValue >> iShift) & 0xF];
+	}
+	return pcDest;
+}
+
+/**
+ *	Prints the heap and the live allocations by call site, most bytes first.
+ *	The table is walked with IRQs masked, which for a full table of sites
+ *	takes some tens of microseconds.
+ **/
+__attribute__((no_instrument_function))
+void vHeapStatsDump(void) {
+	xHeapStats xStats;
+	xHeapStatsSiteType xSwap;
+	unsigned long ulSites, i, j, ulBiggest;
+	char cLine[160];
+	char *p;
+
+	vPortGetHeapStats(&xStats);
+
+	p = prvAppendString(cLine, "HEAP");
+	p = prvAppendDecimal(p, " free=", xStats.xAvailableHeapSpaceInBytes);
+	p = prvAppendDecimal(p, " min_free=", xStats.xMinimumEverFreeBytesRemaining);
+	p = prvAppendDecimal(p, " largest=", xStats.xSizeOfLargestFreeBlockInBytes);
+	p = prvAppendDecimal(p, " smallest=", xStats.xSizeOfSmallestFreeBlockInBytes);
+	p = prvAppendDecimal(p, " free_blocks=", xStats.xNumberOfFreeBlocks);
+	p = prvAppendDecimal(p, " allocs=", xStats.xNumberOfSuccessfulAllocations);
+	p = prvAppendDecimal(p, " frees=", xStats.xNumberOfSuccessfulFrees);
+	p = prvAppendDecimal(p, " failed=", ulFailed);
+	p = prvAppendDecimal(p, " live=", ulLiveCount);
+	p = prvAppendDecimal(p, " dropped=", ulDropped);
+	*p = '\0';
+	prvHeapStatsEmit(cLine);
+
+	ulSites = prvHeapStatsGroup();
+
+	for(i = 0; i < ulSites; i++) {
+		ulBiggest = i;
+		for(j = i + 1; j < ulSites; j++) {
+			if(xSites[j].ulBytes > xSites[ulBiggest].ulBytes) {
+				ulBiggest = j;
+			}
+		}
+		xSwap = xSites[i];
+		xSites[i] = xSites[ulBiggest];
+		xSites[ulBiggest] = xSwap;
+
+		p = prvAppendAddress(cLine, "HEAP site=", xSites[i].pvSite);
+		p = prvAppendDecimal(p, " live=", xSites[i].ulLive);
+		p = prvAppendDecimal(p, " bytes=", xSites[i].ulBytes);
+		p = prvAppendDecimal(p, " new=", xSites[i].ulNew);
+		*p = '\0';
+		prvHeapStatsEmit(cLine);
+	}
+}
+
+__attribute__((no_instrument_function))
+static void prvHeapStatsReporterTask(void *pvParameters) {
+	const portTickType xPeriod = (portTickType) (unsigned long) pvParameters / portTICK_RATE_MS;
+	portTickType xLastWake = xTaskGetTickCount();
+
+	for(;;) {
+		vTaskDelayUntil(&xLastWake, xPeriod);
+		vHeapStatsDump();
+		vHeapStatsSnapshot();
+	}
+}
+
+/**
+ *	Starts a task that dumps the heap every ulPeriodMs and then takes a
+ *	snapshot, so each dump's "new" column covers the period before it.
+ **/
+__attribute__((no_instrument_function))
+void vHeapStatsStartReporter(unsigned long ulPeriodMs, unsigned long ulPriority) {
+	xTaskCreate(prvHeapStatsReporterTask, "heapstats", 256, (void *) ulPeriodMs, ulPriority, NULL);
+}
+
+#endif /* configUSE_HEAP_STATS */
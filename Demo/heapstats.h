@@ -0,0 +1,45 @@
+//heapstats.h
+//
+//heap instrumentation, see heapstats.c
+//
+//this header is pulled in by FreeRTOSConfig.h when configUSE_HEAP_STATS is
+//1, before any of the FreeRTOS types exist, so it only uses plain C types.
+//the trace macros below are expanded inside pvPortMalloc() and vPortFree()
+
+#ifndef _HEAPSTATS_H_
+#define _HEAPSTATS_H_
+
+#include <stddef.h>
+
+/* Live allocations that can be tracked at once.  Must be a power of two.
+Entries are 16 bytes.  Allocations beyond it are counted as dropped. */
+#ifndef heapstatsMAX_LIVE
+	#define heapstatsMAX_LIVE			1024
+#endif
+
+/* Call sites a dump can tell apart.  The rest are added to one line. */
+#ifndef heapstatsMAX_SITES
+	#define heapstatsMAX_SITES			64
+#endif
+
+void vHeapStatsMalloc( void *pv, size_t xSize, void *pvCaller );
+void vHeapStatsFree( void *pv );
+
+void vHeapStatsSetCaller( void *pvCaller );
+
+void vHeapStatsDump( void );
+void vHeapStatsSnapshot( void );
+void vHeapStatsStartReporter( unsigned long ulPeriodMs, unsigned long ulPriority );
+
+/* The allocator hooks.  pvPortMalloc() is built in a file of its own, so the
+return address it sees is that of its caller.  An allocator that is not the
+kernel's, such as the benchmark's private heap copies, defines its own empty
+hooks first. */
+#ifndef traceMALLOC
+	#define traceMALLOC( pvAddress, uiSize )	vHeapStatsMalloc( ( pvAddress ), ( uiSize ), __builtin_return_address( 0 ) )
+#endif
+#ifndef traceFREE
+	#define traceFREE( pvAddress, uiSize )		vHeapStatsFree( ( pvAddress ) )
+#endif
+
+#endif
@@ -12,6 +12,9 @@
 #include "interrupts.h"
 #include "gpio.h"
 #include "video.h"
+#include "heapregions.h"
+#include "mmu.h"
+#include "mailbox.h"
 #include "FreeRTOS_IP.h"
 #include "FreeRTOS_Sockets.h"
 
@@ -19,6 +22,10 @@
 //   include private header
 #include "FreeRTOS_IP_Private.h"
 
+#ifdef BENCHMARK
+#include "bench/benchmark.h"
+#endif
+
 #define ACCELERATE_LED_GPIO 23
 #define BRAKE_LED_GPIO 		24
 #define CLUTCH_LED_GPIO 	25
@@ -183,6 +190,7 @@ void serverListenTask(){
                             lSent = FreeRTOS_send(connect_sock, totalBuffer, totalBytes - lTotalSent, 0);
                             lTotalSent += lSent;
                         }
+                        free(totalBuffer);
                         // if (lSent < 0) break;
 
                     }
@@ -296,6 +304,10 @@ uint8_t *pucRxBuffer;
 }
 
 int main(void) {
+	//caches on, then give the heap the RAM, before anything is allocated
+	MMUInit();
+	HeapRegionsInit();
+
 	SetGpioFunction(ACCELERATE_LED_GPIO, 1);
 	SetGpioFunction(BRAKE_LED_GPIO, 1);
 	SetGpioFunction(CLUTCH_LED_GPIO, 1);	
@@ -308,7 +320,13 @@ int main(void) {
 
 	DisableInterrupts();
 	InitInterruptController();
+	//mailbox answers by interrupt from here on, once the scheduler runs
+	MailboxInit();
 
+#ifdef BENCHMARK
+	//benchmarks run on their own, without the network and LED tasks
+	vStartBenchmarks(configMAX_PRIORITIES - 2);
+#else
 	//ensure the IP and gateway match the router settings!
 	//const unsigned char ucIPAddress[ 4 ] = {192, 168, 1, 42};
 	const unsigned char ucIPAddress[ 4 ] = {10, 10, 206, 100 };
@@ -326,6 +344,21 @@ int main(void) {
 	xTaskCreate(taskBrake, "LED_B", 128, NULL, 0, NULL);
 	xTaskCreate(taskClutch, "LED_C", 128, NULL, 0, NULL);
 
+#if ( configUSE_TRACE_RECORDER == 1 )
+	//read it with "tracedump <ip> 2057 > trace.json"
+	vTraceStartDrain(2057, ipconfigIP_TASK_PRIORITY);
+#endif
+
+#if ( configUSE_HEAP_STATS == 1 )
+	//prints the heap and the live allocations by call site every 10 seconds,
+	//read the sites with "heapsyms kernel.syms < console.log"
+	vHeapStatsStartReporter(10000, tskIDLE_PRIORITY + 1);
+#endif
+#endif
+
+	//println() only queues lines from here on, this task draws them
+	startConsole(tskIDLE_PRIORITY + 1);
+
 	//set to 0 for no debug, 1 for debug, or 2 for GCC instrumentation (if enabled in config)
 	loaded = 1;
 
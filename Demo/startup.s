@@ -6,6 +6,17 @@
 .extern vPortYieldProcessor
 .extern DisableInterrupts
 .extern main
+.extern vPortSecondaryCoreStart
+.extern MMUEnable
+.extern vPortUndefinedHandler
+
+;@ Core 0 runs main() on the SVC stack at SVC_STACK_TOP.  Each secondary core n
+;@ gets the 1MB slot below SVC_STACK_TOP - n MB for its SVC, IRQ and FIQ stacks.
+.equ SVC_STACK_TOP,			0x8000000
+.equ CORE_STACK_SLOT_SHIFT,	20
+.equ CORE_IRQ_STACK_OFFSET,	0x80000
+.equ CORE_FIQ_STACK_OFFSET,	0xC0000
+.equ CORE_UND_STACK_OFFSET,	0xE0000
 	.section .init
 	.globl _start
 ;; 
@@ -26,7 +37,7 @@ _start:
 
 	;@ Here we create an exception address table! This means that reset/hang/irq can be absolute addresses
 reset_handler:      .word reset
-undefined_handler:  .word undefined_instruction
+undefined_handler:  .word vPortUndefinedHandler
 swi_handler:        .word vPortYieldProcessor
 prefetch_handler:   .word prefetch_abort
 data_handler:       .word data_abort
@@ -81,10 +92,21 @@ continueBoot:
     msr cpsr_c,r0
     mov sp,#0x4000
 
+    ;@ (PSR_UND_MODE|PSR_FIQ_DIS|PSR_IRQ_DIS), below the FIQ stack.
+    mov r0,#0xDB
+    msr cpsr_c,r0
+    mov sp,#0x2000
+
     ;@ (PSR_SVC_MODE|PSR_FIQ_DIS|PSR_IRQ_DIS)
     mov r0,#0xD3
     msr cpsr_c,r0
-	mov sp,#0x8000000
+	mov sp,#SVC_STACK_TOP
+
+	bl enable_vfp_access
+
+	;@ No current task yet (TPIDRPRW holds the current TCB on SMP builds).
+	mov r0,#0
+	mcr p15,0,r0,c13,c0,4
 
 	ldr r0, =__bss_start
 	ldr r1, =__bss_end
@@ -103,6 +125,59 @@ zero_loop:
 	;@ 	mov	sp,#0x1000000
 	b main									;@ We're ready?? Lets start main execution!
 
+;@	Secondary cores start here once xPortStartScheduler() posts this address to
+;@	their mailbox 3 (SMP builds only, see port.c).
+.globl _secondary_start
+_secondary_start:
+	cpsid if
+
+	mrs r0, cpsr_all
+	and r0, r0, #0x1F
+	cmp r0, #0x1A
+	bne secondaryNotHyped
+
+	ldr r1, =secondaryNotHyped
+	msr ELR_hyp, r1
+	mov r1, #0xD3				;@ (PSR_SVC_MODE|PSR_FIQ_DIS|PSR_IRQ_DIS)
+	msr SPSR_hyp, r1
+	eret
+
+secondaryNotHyped:
+	mrc p15,0,r4,c0,c0,5		;@ MPIDR, core number in bits 1:0.
+	and r4, r4, #3
+	mov r5, #SVC_STACK_TOP
+	sub r5, r5, r4, lsl #CORE_STACK_SLOT_SHIFT
+
+    mov r0,#0xD2				;@ (PSR_IRQ_MODE|PSR_FIQ_DIS|PSR_IRQ_DIS)
+    msr cpsr_c,r0
+	sub sp, r5, #CORE_IRQ_STACK_OFFSET
+
+    mov r0,#0xD1				;@ (PSR_FIQ_MODE|PSR_FIQ_DIS|PSR_IRQ_DIS)
+    msr cpsr_c,r0
+	sub sp, r5, #CORE_FIQ_STACK_OFFSET
+
+    mov r0,#0xDB				;@ (PSR_UND_MODE|PSR_FIQ_DIS|PSR_IRQ_DIS)
+    msr cpsr_c,r0
+	sub sp, r5, #CORE_UND_STACK_OFFSET
+
+    mov r0,#0xD3				;@ (PSR_SVC_MODE|PSR_FIQ_DIS|PSR_IRQ_DIS)
+    msr cpsr_c,r0
+	mov sp, r5
+
+	bl enable_vfp_access
+	bl MMUEnable				;@ The table core 0 built in MMUInit().
+	b vPortSecondaryCoreStart
+
+;@	Lets this core use the VFP/NEON coprocessors (CPACR cp10 and cp11 full
+;@	access).  FPEXC.EN is left clear, so the first VFP instruction traps to
+;@	vPortUndefinedHandler, which hands out the registers (see port.c).
+enable_vfp_access:
+	mrc p15,0,r0,c1,c0,2
+	orr r0, r0, #(0xF << 20)
+	mcr p15,0,r0,c1,c0,2
+	isb
+	bx lr
+
 .section .text
 
 undefined_instruction:
@@ -1,69 +1,334 @@
 //trace.c
 //authored by Jared Hull
 //
-//use the GCC flag -finstrument-functions to enable tracing
-//these trace functions will output the pointer to
-//the function in which they are called by gcc
-//to find the function name, look at the kernel.map
-
-//you must add __attribute__((no_instrument_function))
+//binary kernel event recorder
+//
+//the kernel trace macros (see trace.h) and the GCC function instrumentation
+//hooks write fixed size records, stamped with the 1MHz system timer, into a
+//ring per core.  nothing is formatted or printed on the target
+//
+//each ring has one writer, its own core, which masks IRQs for the few
+//instructions it takes to fill a slot, and one reader, the drain task.
+//no lock is shared between cores.  when a ring is full new records are
+//dropped and counted, and a traceEVENT_LOST record is written once there
+//is room again
+//
+//vTraceStartDrain() serves the records on a TCP port.  read them on the
+//host with tracedump, which writes Chrome/Perfetto trace JSON
+//
+//use the GCC flag -finstrument-functions to also record function calls,
+//and set loaded to 2 in main.  the function addresses can be looked up
+//in kernel.map.  you must add __attribute__((no_instrument_function))
 //to any function you do not want traced
-//especially ones which are printing out the trace
 
+#include <FreeRTOS.h>
+
+#if ( configUSE_TRACE_RECORDER == 1 )
+
+#include <task.h>
 #include <video.h>
-int depth = 0;
+
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+
+#if ( configUSE_TRACE_FACILITY != 1 )
+	#error The trace recorder needs configUSE_TRACE_FACILITY to name the running tasks.
+#endif
+
+/* Lower 32 bits of the 1MHz BCM system timer. */
+#define traceTIMER_CLO			( *( volatile unsigned long * ) 0x3f003004 )
+
+/* Records the drain task copies out and sends at a time. */
+#define traceDRAIN_BATCH		64
+
+/* How long the drain task sleeps when every ring is empty. */
+#define traceDRAIN_PERIOD		( 10 / portTICK_RATE_MS )
+
+typedef struct xTRACE_RING
+{
+	volatile unsigned long ulHead;		/* Records written, only changed by the owning core. */
+	volatile unsigned long ulTail;		/* Records read, only changed by the drain. */
+	unsigned long ulDropped;			/* Records dropped since the last traceEVENT_LOST. */
+	xTraceRecordType xRecords[ traceRING_LENGTH ];
+} xTraceRingType;
+
+static xTraceRingType xTraceRings[ configNUM_CORES ];
+
+static xTraceRecordType xDrainBuffer[ traceDRAIN_BATCH ];
 
 __attribute__((no_instrument_function))
-void __cyg_profile_func_enter (void *this_fn, void *call_site){
-	if(loaded == 2){
-		int intflag;
-		__asm volatile ("mrs %0, cpsr" : "=r" (intflag));
-		//uspi_EnterCritical();
-
-		depth++;
-		char m[depth + 1];
-		for(int i = 0; i < depth; i++){
-			m[i] = ' ';
+static inline unsigned long prvTraceMaskInterrupts( void ) {
+	unsigned long ulCPSR;
+
+	__asm volatile ("mrs %0, cpsr\n\t"
+					"cpsid i" : "=r" (ulCPSR) : : "memory");
+	return ulCPSR;
+}
+
+__attribute__((no_instrument_function))
+static inline void prvTraceRestoreInterrupts( unsigned long ulCPSR ) {
+	__asm volatile ("msr cpsr_c, %0" : : "r" (ulCPSR) : "memory");
+}
+
+/**
+ *	Appends one record to the ring of the calling core, which must have IRQs
+ *	masked.  Returns 0 if the ring is full.
+ **/
+__attribute__((no_instrument_function))
+static int prvTraceWrite(xTraceRingType *pxRing, unsigned long ulCore, unsigned char ucEvent, unsigned short usArg, unsigned long ulObject, unsigned long ulArg) {
+	unsigned long ulHead = pxRing->ulHead;
+	xTraceRecordType *pxRecord;
+
+	if(ulHead - pxRing->ulTail >= traceRING_LENGTH) {
+		return 0;
+	}
+
+	pxRecord = &pxRing->xRecords[ulHead & (traceRING_LENGTH - 1)];
+	pxRecord->ulTimestamp = traceTIMER_CLO;
+	pxRecord->ucEvent = ucEvent;
+	pxRecord->ucCore = (unsigned char) ulCore;
+	pxRecord->usArg = usArg;
+	pxRecord->ulObject = ulObject;
+	pxRecord->ulArg = ulArg;
+
+	/* Publish the record only once it is complete. */
+	__asm volatile ("dmb" : : : "memory");
+	pxRing->ulHead = ulHead + 1;
+	return 1;
+}
+
+__attribute__((no_instrument_function))
+static void prvTraceRecord(unsigned char ucEvent, unsigned short usArg, unsigned long ulObject, unsigned long ulArg) {
+	unsigned long ulCPSR = prvTraceMaskInterrupts();
+	unsigned long ulCore = portGET_CORE_ID();
+	xTraceRingType *pxRing = &xTraceRings[ulCore];
+
+	if(pxRing->ulDropped != 0) {
+		if(prvTraceWrite(pxRing, ulCore, traceEVENT_LOST, 0, 0, pxRing->ulDropped)) {
+			pxRing->ulDropped = 0;
 		}
-		m[depth + 0] = 0; //null termination
+	}
+
+	if(pxRing->ulDropped != 0 || !prvTraceWrite(pxRing, ulCore, ucEvent, usArg, ulObject, ulArg)) {
+		pxRing->ulDropped++;
+	}
+
+	prvTraceRestoreInterrupts(ulCPSR);
+}
+
+__attribute__((no_instrument_function))
+void vTraceRecord(unsigned char ucEvent, unsigned long ulObject, unsigned long ulArg) {
+	prvTraceRecord(ucEvent, 0, ulObject, ulArg);
+}
+
+/**
+ *	Records a task's priority and name, 4 characters per record, so the
+ *	decoder can label its switches.
+ **/
+__attribute__((no_instrument_function))
+void vTraceTaskCreate(unsigned long ulTask, const char *pcName, unsigned long ulPriority) {
+	unsigned short usOffset;
+	unsigned long ulChars;
+	int i, iEnd = 0;
 
-		if((intflag & 0x80)){
-			m[0] = '#';
-			printHex(m, (int)this_fn, 0xFF007F00); //green for call
-			//uspi_LeaveCritical();
-			return;
+	prvTraceRecord(traceEVENT_TASK_CREATE, 0, ulTask, ulPriority);
+
+	for(usOffset = 0; usOffset < configMAX_TASK_NAME_LEN && !iEnd; usOffset += 4) {
+		ulChars = 0;
+		for(i = 0; i < 4 && usOffset + i < configMAX_TASK_NAME_LEN; i++) {
+			if(pcName[usOffset + i] == '\0') {
+				iEnd = 1;
+				break;
+			}
+			ulChars |= (unsigned long) (unsigned char) pcName[usOffset + i] << (i * 8);
 		}
+		prvTraceRecord(traceEVENT_TASK_NAME, usOffset, ulTask, ulChars);
+	}
+}
+
+/**
+ *	Copies up to ulMaxRecords unread records out of the rings, core by core.
+ *	Returns the number copied.  Only one task may read.
+ **/
+__attribute__((no_instrument_function))
+unsigned long ulTraceRead(xTraceRecordType *pxBuffer, unsigned long ulMaxRecords) {
+	unsigned long ulCopied = 0;
+	unsigned long ulCore, ulHead, ulTail;
+	xTraceRingType *pxRing;
+
+	for(ulCore = 0; ulCore < configNUM_CORES && ulCopied < ulMaxRecords; ulCore++) {
+		pxRing = &xTraceRings[ulCore];
+		ulHead = pxRing->ulHead;
+		ulTail = pxRing->ulTail;
+
+		/* Read the records only after seeing the head that published them. */
+		__asm volatile ("dmb" : : : "memory");
 
-		m[0] = '.';
-		printHex(m, (int)this_fn, 0xFF00FF00); //green for call
-		//uspi_LeaveCritical();
+		while(ulTail != ulHead && ulCopied < ulMaxRecords) {
+			pxBuffer[ulCopied++] = pxRing->xRecords[ulTail & (traceRING_LENGTH - 1)];
+			ulTail++;
+		}
+
+		/* Hand the slots back only once they have been copied. */
+		__asm volatile ("dmb" : : : "memory");
+		pxRing->ulTail = ulTail;
 	}
+
+	return ulCopied;
 }
 
+/**
+ *	Throws away everything recorded so far.
+ **/
 __attribute__((no_instrument_function))
-void __cyg_profile_func_exit  (void *this_fn, void *call_site){
-	if(loaded == 2){
-		int intflag;
-		__asm volatile ("mrs %0, cpsr" : "=r" (intflag));
-		//uspi_EnterCritical();
+void vTraceDiscard(void) {
+	unsigned long ulCore;
 
-		char m[depth + 1];
-		for(int i = 0; i < depth; i++){
-			m[i] = ' ';
+	for(ulCore = 0; ulCore < configNUM_CORES; ulCore++) {
+		xTraceRings[ulCore].ulTail = xTraceRings[ulCore].ulHead;
+	}
+}
+
+/**
+ *	Names the tasks that already exist, for a reader that has only just
+ *	connected.
+ **/
+__attribute__((no_instrument_function))
+static void prvTraceNameTasks(void) {
+	xTaskStatusType *pxStatus;
+	unsigned portBASE_TYPE uxTasks, x;
+
+	uxTasks = uxTaskGetNumberOfTasks();
+	pxStatus = pvPortMalloc(uxTasks * sizeof(xTaskStatusType));
+	if(pxStatus == NULL) {
+		return;
+	}
+
+	uxTasks = uxTaskGetSystemState(pxStatus, uxTasks, NULL);
+	for(x = 0; x < uxTasks; x++) {
+		vTraceTaskCreate((unsigned long) pxStatus[x].xHandle, (const char *) pxStatus[x].pcTaskName, pxStatus[x].uxCurrentPriority);
+	}
+
+	vPortFree(pxStatus);
+}
+
+__attribute__((no_instrument_function))
+static int prvTraceSend(Socket_t xSocket, const void *pvData, int iLength) {
+	const char *pcData = pvData;
+	int iSent;
+
+	while(iLength > 0) {
+		iSent = FreeRTOS_send(xSocket, pcData, iLength, 0);
+		if(iSent < 0) {
+			return -1;
 		}
-		m[depth + 0] = 0; //null termination
-
-		if((intflag & 0x80)){
-			m[0] = '#';
-			printHex(m, (int)this_fn, 0xFF7F0000); //red for return
-			depth--;
-			//uspi_LeaveCritical();
-			return;
+		pcData += iSent;
+		iLength -= iSent;
+	}
+	return 0;
+}
+
+/**
+ *	Streams the rings to one TCP client at a time.  Each connection gets a
+ *	xTraceStreamHeaderType, the names of the running tasks and then the
+ *	records as they are made, oldest first per core.
+ **/
+__attribute__((no_instrument_function))
+static void prvTraceDrainTask(void *pvParameters) {
+	const portTickType xDelay500ms = 500 / portTICK_RATE_MS;
+	const portTickType xReceiveTimeOut = portMAX_DELAY;
+	const portBASE_TYPE xReuseSocket = pdTRUE;
+	xTraceStreamHeaderType xHeader;
+	struct freertos_sockaddr xServer, xClient;
+	socklen_t xClientSize = sizeof(xClient);
+	Socket_t xListen, xConnection;
+	unsigned long ulRecords;
+
+	while(!FreeRTOS_IsNetworkUp()) {
+		vTaskDelay(xDelay500ms);
+	}
+
+	xListen = FreeRTOS_socket(FREERTOS_AF_INET, FREERTOS_SOCK_STREAM, FREERTOS_IPPROTO_TCP);
+	if(xListen == FREERTOS_INVALID_SOCKET) {
+		println("trace: no socket", RED_TEXT);
+		vTaskDelete(NULL);
+	}
+
+	FreeRTOS_setsockopt(xListen, 0, FREERTOS_SO_RCVTIMEO, &xReceiveTimeOut, sizeof(xReceiveTimeOut));
+	FreeRTOS_setsockopt(xListen, 0, FREERTOS_SO_REUSE_LISTEN_SOCKET, (void *) &xReuseSocket, sizeof(xReuseSocket));
+
+	xServer.sin_port = FreeRTOS_htons((unsigned short) (unsigned long) pvParameters);
+	FreeRTOS_bind(xListen, &xServer, sizeof(xServer));
+	FreeRTOS_listen(xListen, 1);
+
+	xHeader.ulMagic = traceSTREAM_MAGIC;
+	xHeader.usVersion = traceSTREAM_VERSION;
+	xHeader.usRecordSize = sizeof(xTraceRecordType);
+	xHeader.ulTimerHz = 1000000UL;
+	xHeader.ulCores = configNUM_CORES;
+
+	for(;;) {
+		xConnection = FreeRTOS_accept(xListen, &xClient, &xClientSize);
+		if(xConnection == NULL || xConnection == FREERTOS_INVALID_SOCKET) {
+			continue;
+		}
+
+		/* Start from now rather than from whatever filled the rings while
+		nobody was reading. */
+		vTraceDiscard();
+		prvTraceNameTasks();
+
+		if(prvTraceSend(xConnection, &xHeader, sizeof(xHeader)) == 0) {
+			for(;;) {
+				ulRecords = ulTraceRead(xDrainBuffer, traceDRAIN_BATCH);
+				if(ulRecords == 0) {
+					vTaskDelay(traceDRAIN_PERIOD);
+					continue;
+				}
+				if(prvTraceSend(xConnection, xDrainBuffer, ulRecords * sizeof(xTraceRecordType)) < 0) {
+					break;
+				}
+			}
 		}
 
-		m[0] = '.';
-		printHex(m, (int)this_fn, 0xFFFF0000); //red for return
-		depth--;
-		//uspi_LeaveCritical();
+		FreeRTOS_shutdown(xConnection, FREERTOS_SHUT_RDWR);
+		FreeRTOS_closesocket(xConnection);
 	}
-}
\ No newline at end of file
+}
+
+/**
+ *	Starts the task serving the trace on usPort.  Give it a priority at least
+ *	as high as the busiest task being traced, or the rings fill up under load.
+ **/
+__attribute__((no_instrument_function))
+void vTraceStartDrain(unsigned short usPort, unsigned long ulPriority) {
+	xTaskCreate(prvTraceDrainTask, "trace", 256, (void *) (unsigned long) usPort, ulPriority, NULL);
+}
+
+__attribute__((no_instrument_function))
+void __cyg_profile_func_enter (void *this_fn, void *call_site){
+	if(loaded == 2){
+		vTraceRecord(traceEVENT_FUNC_ENTER, (unsigned long) this_fn, (unsigned long) call_site);
+	}
+}
+
+__attribute__((no_instrument_function))
+void __cyg_profile_func_exit  (void *this_fn, void *call_site){
+	if(loaded == 2){
+		vTraceRecord(traceEVENT_FUNC_EXIT, (unsigned long) this_fn, (unsigned long) call_site);
+	}
+}
+
+#else
+
+//nothing to record into, but -finstrument-functions builds still link
+
+__attribute__((no_instrument_function))
+void __cyg_profile_func_enter (void *this_fn, void *call_site){
+}
+
+__attribute__((no_instrument_function))
+void __cyg_profile_func_exit  (void *this_fn, void *call_site){
+}
+
+#endif /* configUSE_TRACE_RECORDER */
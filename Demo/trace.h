@@ -0,0 +1,78 @@
+//trace.h
+//
+//binary kernel event recorder, see trace.c
+//
+//this header is pulled in by FreeRTOSConfig.h when configUSE_TRACE_RECORDER
+//is 1, before any of the FreeRTOS types exist, so it only uses plain C types.
+//the trace macros below are expanded inside tasks.c, queue.c and portisr.c
+
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+/* Records held per core before the oldest unread one would be overwritten.
+Must be a power of two.  Records are 16 bytes. */
+#ifndef traceRING_LENGTH
+	#define traceRING_LENGTH			1024
+#endif
+
+/* Event codes, shared with the host decoder (tracedump.c). */
+#define traceEVENT_TASK_SWITCHED_IN		1	/* ulObject = TCB, ulArg = priority. */
+#define traceEVENT_TASK_CREATE			2	/* ulObject = TCB, ulArg = priority. */
+#define traceEVENT_TASK_NAME			3	/* ulObject = TCB, ulArg = 4 name characters, usArg = offset into the name. */
+#define traceEVENT_TASK_DELETE			4	/* ulObject = TCB. */
+#define traceEVENT_QUEUE_SEND			5	/* ulObject = queue, ulArg = messages waiting before the send. */
+#define traceEVENT_QUEUE_SEND_FROM_ISR	6
+#define traceEVENT_QUEUE_RECEIVE		7
+#define traceEVENT_BLOCKING_ON_QUEUE_SEND		8
+#define traceEVENT_BLOCKING_ON_QUEUE_RECEIVE	9
+#define traceEVENT_ISR_ENTER			10
+#define traceEVENT_ISR_EXIT				11
+#define traceEVENT_FUNC_ENTER			12	/* ulObject = function, ulArg = call site (-finstrument-functions). */
+#define traceEVENT_FUNC_EXIT			13
+#define traceEVENT_LOST					14	/* ulArg = records dropped because the ring was full. */
+
+/* First bytes sent on a drain connection, followed by the records. */
+#define traceSTREAM_MAGIC				0x52545246UL	/* "FRTR" */
+#define traceSTREAM_VERSION				1
+
+typedef struct xTRACE_RECORD
+{
+	unsigned long ulTimestamp;			/* Microseconds, from the 1MHz system timer. */
+	unsigned char ucEvent;
+	unsigned char ucCore;
+	unsigned short usArg;
+	unsigned long ulObject;
+	unsigned long ulArg;
+} xTraceRecordType;
+
+typedef struct xTRACE_STREAM_HEADER
+{
+	unsigned long ulMagic;
+	unsigned short usVersion;
+	unsigned short usRecordSize;
+	unsigned long ulTimerHz;
+	unsigned long ulCores;
+} xTraceStreamHeaderType;
+
+void vTraceRecord( unsigned char ucEvent, unsigned long ulObject, unsigned long ulArg );
+void vTraceTaskCreate( unsigned long ulTask, const char *pcName, unsigned long ulPriority );
+
+unsigned long ulTraceRead( xTraceRecordType *pxBuffer, unsigned long ulMaxRecords );
+void vTraceDiscard( void );
+
+void vTraceStartDrain( unsigned short usPort, unsigned long ulPriority );
+
+/* The kernel hooks.  pxCurrentTCB and the TCB and queue structures are in
+scope where these are expanded. */
+#define traceTASK_SWITCHED_IN()						vTraceRecord( traceEVENT_TASK_SWITCHED_IN, ( unsigned long ) pxCurrentTCB, ( unsigned long ) pxCurrentTCB->uxPriority )
+#define traceTASK_CREATE( pxNewTCB )				vTraceTaskCreate( ( unsigned long ) ( pxNewTCB ), ( const char * ) ( pxNewTCB )->pcTaskName, ( unsigned long ) ( pxNewTCB )->uxPriority )
+#define traceTASK_DELETE( pxTaskToDelete )			vTraceRecord( traceEVENT_TASK_DELETE, ( unsigned long ) ( pxTaskToDelete ), 0UL )
+#define traceQUEUE_SEND( pxQueue )					vTraceRecord( traceEVENT_QUEUE_SEND, ( unsigned long ) ( pxQueue ), ( unsigned long ) ( pxQueue )->uxMessagesWaiting )
+#define traceQUEUE_SEND_FROM_ISR( pxQueue )			vTraceRecord( traceEVENT_QUEUE_SEND_FROM_ISR, ( unsigned long ) ( pxQueue ), ( unsigned long ) ( pxQueue )->uxMessagesWaiting )
+#define traceQUEUE_RECEIVE( pxQueue )				vTraceRecord( traceEVENT_QUEUE_RECEIVE, ( unsigned long ) ( pxQueue ), ( unsigned long ) ( pxQueue )->uxMessagesWaiting )
+#define traceBLOCKING_ON_QUEUE_SEND( pxQueue )		vTraceRecord( traceEVENT_BLOCKING_ON_QUEUE_SEND, ( unsigned long ) ( pxQueue ), ( unsigned long ) ( pxQueue )->uxMessagesWaiting )
+#define traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue )	vTraceRecord( traceEVENT_BLOCKING_ON_QUEUE_RECEIVE, ( unsigned long ) ( pxQueue ), ( unsigned long ) ( pxQueue )->uxMessagesWaiting )
+#define traceISR_ENTER()							vTraceRecord( traceEVENT_ISR_ENTER, 0UL, 0UL )
+#define traceISR_EXIT()								vTraceRecord( traceEVENT_ISR_EXIT, 0UL, 0UL )
+
+#endif
@@ -314,6 +314,7 @@ typedef struct xDNSTail DNSTail_t;
 	const xMiniListItem* xEnd = ( const xMiniListItem* )listGET_END_MARKER( &xCallbackList );
 
 		vTaskSuspendAll();
+		taskSMP_ENTER_CRITICAL();
 		{
 			for( pxIterator  = ( const xListItem * ) listGET_NEXT( xEnd );
 				 pxIterator != ( const xListItem * ) xEnd;
@@ -335,6 +336,7 @@ typedef struct xDNSTail DNSTail_t;
 				}
 			}
 		}
+		taskSMP_EXIT_CRITICAL();
 		xTaskResumeAll();
 
 		if( listLIST_IS_EMPTY( &xCallbackList ) )
@@ -375,9 +377,11 @@ typedef struct xDNSTail DNSTail_t;
 			listSET_LIST_ITEM_OWNER( &( pxCallback->xListItem ), ( void* ) pxCallback );
 			listSET_LIST_ITEM_VALUE( &( pxCallback->xListItem ), xIdentifier );
 			vTaskSuspendAll();
+			taskSMP_ENTER_CRITICAL();
 			{
 				vListInsertEnd( &xCallbackList, &pxCallback->xListItem );
 			}
+			taskSMP_EXIT_CRITICAL();
 			xTaskResumeAll();
 		}
 	}
@@ -392,6 +396,7 @@ typedef struct xDNSTail DNSTail_t;
 		const xMiniListItem* xEnd = ( const xMiniListItem* )listGET_END_MARKER( &xCallbackList );
 
 		vTaskSuspendAll();
+		taskSMP_ENTER_CRITICAL();
 		{
 			for( pxIterator  = ( const xListItem * ) listGET_NEXT( xEnd );
 				 pxIterator != ( const xListItem * ) xEnd;
@@ -411,6 +416,7 @@ typedef struct xDNSTail DNSTail_t;
 				}
 			}
 		}
+		taskSMP_EXIT_CRITICAL();
 		xTaskResumeAll();
 	}
 #endif	/* ipconfigDNS_USE_CALLBACKS != 0 */
@@ -1079,6 +1079,7 @@ xList *pxSocketList;
 				#if( ipconfigETHERNET_DRIVER_FILTERS_PACKETS == 1 )
 				{
 					vTaskSuspendAll();
+					taskSMP_ENTER_CRITICAL();
 				}
 				#endif /* ipconfigETHERNET_DRIVER_FILTERS_PACKETS */
 
@@ -1087,6 +1088,7 @@ xList *pxSocketList;
 
 				#if( ipconfigETHERNET_DRIVER_FILTERS_PACKETS == 1 )
 				{
+					taskSMP_EXIT_CRITICAL();
 					xTaskResumeAll();
 				}
 				#endif /* ipconfigETHERNET_DRIVER_FILTERS_PACKETS */
@@ -1213,6 +1215,7 @@ NetworkBufferDescriptor_t *pxNetworkBuffer;
 		#if( ipconfigETHERNET_DRIVER_FILTERS_PACKETS == 1 )
 		{
 			vTaskSuspendAll();
+			taskSMP_ENTER_CRITICAL();
 		}
 		#endif /* ipconfigETHERNET_DRIVER_FILTERS_PACKETS */
 
@@ -1220,6 +1223,7 @@ NetworkBufferDescriptor_t *pxNetworkBuffer;
 
 		#if( ipconfigETHERNET_DRIVER_FILTERS_PACKETS == 1 )
 		{
+			taskSMP_EXIT_CRITICAL();
 			xTaskResumeAll();
 		}
 		#endif /* ipconfigETHERNET_DRIVER_FILTERS_PACKETS */
@@ -1832,7 +1836,9 @@ void vWakeUpSocketUser( FreeRTOS_Socket_t *pxSocket )
 	{
 		portBASE_TYPE bFound;
 		vTaskSuspendAll();
+		taskSMP_ENTER_CRITICAL();
 		bFound = pxListFindListItemWithValue( &xBoundUdpSocketsList, ( portTickType ) usPortNr ) != NULL;
+		taskSMP_EXIT_CRITICAL();
 		xTaskResumeAll();
 		return bFound;
 	}
@@ -2029,6 +2035,7 @@ void vWakeUpSocketUser( FreeRTOS_Socket_t *pxSocket )
 			{
 				/* Is there a new client? */
 				vTaskSuspendAll();
+				taskSMP_ENTER_CRITICAL();
 				{
 					if( pxSocket->u.xTcp.bits.bReuseSocket == pdFALSE )
 					{
@@ -2053,6 +2060,7 @@ void vWakeUpSocketUser( FreeRTOS_Socket_t *pxSocket )
 						}
 					}
 				}
+				taskSMP_EXIT_CRITICAL();
 				xTaskResumeAll();
 
 				if( pxClientSocket != NULL )
@@ -2421,6 +2429,7 @@ void vWakeUpSocketUser( FreeRTOS_Socket_t *pxSocket )
 						/* Now suspend the scheduler: sending the last data	and
 						setting bCloseRequested must be done together */
 						vTaskSuspendAll();
+						taskSMP_ENTER_CRITICAL();
 						pxSocket->u.xTcp.bits.bCloseRequested = pdTRUE;
 					}
 
@@ -2431,6 +2440,7 @@ void vWakeUpSocketUser( FreeRTOS_Socket_t *pxSocket )
 						/* Now when the IP-task transmits the data, it will also
 						see	that bCloseRequested is true and include the FIN
 						flag to start closure of the connection. */
+						taskSMP_EXIT_CRITICAL();
 						xTaskResumeAll();
 					}
 
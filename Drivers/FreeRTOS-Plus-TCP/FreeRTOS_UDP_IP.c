@@ -303,6 +303,7 @@ UDPPacket_t *pxUDPPacket = (UDPPacket_t *) pxNetworkBuffer->pucEthernetBuffer;
 		if( xReturn == pdPASS )
 		{
 			vTaskSuspendAll();
+			taskSMP_ENTER_CRITICAL();
 			{
 				if( xReturn == pdPASS )
 				{
@@ -315,6 +316,7 @@ UDPPacket_t *pxUDPPacket = (UDPPacket_t *) pxNetworkBuffer->pucEthernetBuffer;
 					taskEXIT_CRITICAL();
 				}
 			}
+			taskSMP_EXIT_CRITICAL();
 			xTaskResumeAll();
 
 			/* Set the socket's receive event */
@@ -61,14 +61,34 @@
 #include <mem.h>
 
 #define FreeRTOS_debug_print = 1
+#ifndef POSIX_SIM
 #define FreeRTOS_debug_printf( MSG ) println(MSG, 0xFFFFFFFF);
+#else
+/* MSG is a bracketed printf() argument list, which the simulator can format
+(see Demo/Posix/console.c). */
+void vLoggingPrintf( const char *pcFormat, ... );
+#define FreeRTOS_debug_printf( MSG ) vLoggingPrintf MSG
+#endif
 
 /*Optional: ipconfigPACKET_FILLER_SIZE This option is a bit tricky:
 it makes sure that all 32-bit fields in the network packets are 32-bit aligned.
 This means that the 14-byte Ethernet header should start at a 16-bit offset.
 Therefore ipconfigPACKET_FILLER_SIZE is defined a 2 (bytes).
-I think that most EMAC's have an option to set this 2-byte offset for both incoming and outgoing packets.*/
-#define ipconfigPACKET_FILLER_SIZE 0
+I think that most EMAC's have an option to set this 2-byte offset for both incoming and outgoing packets.
+Here it is 8 instead, to leave room in front of each frame for the two command
+words the LAN9514 wants when sending (see portable/NetworkInterface.c).*/
+#define ipconfigPACKET_FILLER_SIZE 8
+
+//The driver receives frames straight into network buffers (see
+//portable/NetworkInterface.c), rather than copying them in.
+#define ipconfigZERO_COPY_RX_DRIVER 1
+
+//The USB DMA writes the frames, so the storage of each network buffer comes
+//from USPi's malloc(), which gives every block whole cache lines of its own.
+#ifndef POSIX_SIM
+#define ipconfigNETWORK_BUFFER_MALLOC( xSize ) malloc( xSize )
+#define ipconfigNETWORK_BUFFER_FREE( pvBuffer ) free( pvBuffer )
+#endif
 
 #define portTICK_PERIOD_MS portTICK_RATE_MS
 #define pdMS_TO_TICKS( xTimeInMs ) ( ( portTickType ) xTimeInMs * ( configTICK_RATE_HZ / ( ( portTickType ) 1000 ) ) )
@@ -459,4 +459,12 @@ from the FreeRTOSIPConfig.h configuration header file. */
 	#define ipconfigDNS_USE_CALLBACKS 0
 #endif
 
+/* The storage of a network buffer (BufferAllocation_2.c) is obtained and
+returned with these, so a port can give it an allocator of its own, for
+instance one that aligns the storage for DMA. */
+#ifndef ipconfigNETWORK_BUFFER_MALLOC
+	#define ipconfigNETWORK_BUFFER_MALLOC( xSize )		pvPortMalloc( xSize )
+	#define ipconfigNETWORK_BUFFER_FREE( pvBuffer )		vPortFree( pvBuffer )
+#endif
+
 #endif /* FREERTOS_DEFAULT_IP_CONFIG_H */
@@ -202,7 +202,7 @@ uint8_t *pucEthernetBuffer;
 	/* Allocate a buffer large enough to store the requested Ethernet frame size
 	and a pointer to a network buffer structure (hence the addition of
 	ipBUFFER_PADDING bytes). */
-	pucEthernetBuffer = ( uint8_t * ) pvPortMalloc( *pxRequestedSizeBytes + ipBUFFER_PADDING );
+	pucEthernetBuffer = ( uint8_t * ) ipconfigNETWORK_BUFFER_MALLOC( *pxRequestedSizeBytes + ipBUFFER_PADDING );
 	configASSERT( pucEthernetBuffer );
 
 	if( pucEthernetBuffer != NULL )
@@ -225,7 +225,7 @@ void vReleaseNetworkBuffer( uint8_t *pucEthernetBuffer )
 	if( pucEthernetBuffer != NULL )
 	{
 		pucEthernetBuffer -= ipBUFFER_PADDING;
-		vPortFree( ( void * ) pucEthernetBuffer );
+		ipconfigNETWORK_BUFFER_FREE( ( void * ) pucEthernetBuffer );
 	}
 }
 /*-----------------------------------------------------------*/
@@ -267,7 +267,7 @@ size_t uxCount;
 		{
 			/* Extra space is obtained so a pointer to the network buffer can
 			be stored at the beginning of the buffer. */
-			pxReturn->pucEthernetBuffer = ( uint8_t * ) pvPortMalloc( xRequestedSizeBytes + ipBUFFER_PADDING );
+			pxReturn->pucEthernetBuffer = ( uint8_t * ) ipconfigNETWORK_BUFFER_MALLOC( xRequestedSizeBytes + ipBUFFER_PADDING );
 
 			if( pxReturn->pucEthernetBuffer == NULL )
 			{
@@ -11,91 +11,313 @@
 #include "NetworkBufferManagement.h"
 #include "NetworkInterface.h"
 
-/* The queue used to pass events into the IP-task for processing. */
-xQueueHandle xOutputQueue = NULL;
+#include <uspi.h>
 
-typedef struct OutputInfo_asdf{
-	int pNetworkBufferDescriptor_t;
-	int portBASE_TYPE bReleaseAfterSend;
-} OutputInfo;
+/* The poll task, notified by prvFrameSent() when a frame has gone out and its
+buffer can be released, and by prvFrameReceived() when a receive buffer has
+been used up. */
+static xTaskHandle xPollTask = NULL;
 
-void ethernetPollTask(){
-	unsigned char *pucUseBuffer;
-	int ulReceiveCount, ulResult;
-	static NetworkBufferDescriptor_t *pxNextNetworkBufferDescriptor = NULL;
-	const unsigned portBASE_TYPE xMinDescriptorsToLeave = 2UL;
-	const portTickType xBlockTime = pdMS_TO_TICKS( 100UL );
-	static IPStackEvent_t xRxEvent = { eNetworkRxEvent, NULL };
+/* Frames handed to the adapter to send.  The IP task queues them straight from
+xNetworkInterfaceOutput(), and the adapter sends them from the network buffer
+itself: the two command words it wants in front of a frame go into the
+USPI_TX_HEADROOM bytes of padding before pucEthernetBuffer (see
+ipconfigPACKET_FILLER_SIZE), so the frame is never copied.  A buffer is only
+released once the adapter is done with it. */
+#define niTX_BUFFERS			USPI_TX_QUEUE_SIZE
 
-	//create a queue to store addresses of NetworkBufferDescriptors
-	xOutputQueue = xQueueCreate( ( unsigned portBASE_TYPE ) ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS, 4 );
+#if( ipBUFFER_PADDING < 4 + USPI_TX_HEADROOM )
+	#error The network buffer padding has no room for the transmit command words
+#endif
 
-	for( ;; ){
-		//send any waiting packets first
-		for(int i = 0; i < uxQueueMessagesWaiting(xOutputQueue); i++){
-println("try send", 0xFF0000cc);
-			OutputInfo out;
-			xQueueReceive(xOutputQueue, &out, 1000);
-			NetworkBufferDescriptor_t * const pxDescriptor = (NetworkBufferDescriptor_t*)out.pNetworkBufferDescriptor_t;
-			//for(int i = 0; i < pxDescriptor->xDataLength; i++){printHex("", ((char*)pxDescriptor->pucEthernetBuffer)[i], 0xFFFFFFFF);}
-			USPiSendFrame((void *)pxDescriptor->pucEthernetBuffer, pxDescriptor->xDataLength);
-			if(out.bReleaseAfterSend) vReleaseNetworkBufferAndDescriptor( pxDescriptor );
-println("sent", 0xFF0000cc);
+/* How long xNetworkInterfaceOutput() waits for the adapter to take a frame when
+niTX_BUFFERS are queued already. */
+#define niTX_WAIT				pdMS_TO_TICKS( 20UL )
+
+/* Counts the frames that can still be queued to send, given back as their
+buffers are released. */
+static xSemaphoreHandle xTxSlots = NULL;
+
+/* Buffers whose frames have been sent, to be released by the poll task, as the
+interrupt cannot release them itself. */
+static xQueueHandle xTxDoneQueue = NULL;
+
+/* When 1 the adapter packs the frames it has into one USB transfer (see
+USPiEnableReceiveBurst()), which saves the transfer overhead of every frame,
+the larger part of the cost of small ones such as ACKs.  The poll task then
+copies each frame out of the burst into a network buffer of its own.  When 0
+each frame is received straight into a network buffer instead, one transfer
+apiece and without a copy.  0 until receive figures for both modes show the
+copy is worth it. */
+#ifndef niRX_BURST
+	#define niRX_BURST			0
+#endif
+
+#if( niRX_BURST == 1 )
+
+/* Burst buffers kept queued with the adapter.  The USB interrupt passes each
+one to the poll task once filled, which hands its frames to the IP task and
+queues it again.  They come from USPi's malloc(), as DMA buffers must have
+their cache lines to themselves. */
+#define niRX_BURSTS				4
+
+#if( niRX_BURSTS > USPI_RX_QUEUE_SIZE )
+	#error USPi cannot queue that many burst buffers
+#endif
+
+typedef struct xRX_BURST
+{
+	void *pvBuffer;
+	unsigned uxLength;		/* Of the burst received, 0 if none. */
+} RxBurst_t;
+
+/* Burst buffers given back by the interrupt. */
+static xQueueHandle xRxBurstQueue = NULL;
+
+#else
+
+/* Receive buffers kept queued with the adapter.  The USB interrupt fills them
+in turn and passes each frame straight to the IP task, so the poll task only
+has to put new buffers in their place.
+
+A buffer is handed to the adapter USPI_RX_HEADROOM bytes before its
+pucEthernetBuffer, so that the receive status lands in the padding in front of
+the frame and the frame itself lands where the stack wants it, without being
+copied.  The first bytes of the padding hold the pointer back to the
+descriptor, which the adapter does not touch.  The buffers are written by DMA,
+so FreeRTOSIPConfig.h has their storage come from USPi's malloc(), which starts
+it on a cache line and pads it to the end of its last one. */
+#define niRX_BUFFERS			USPI_RX_QUEUE_SIZE
+#define niRX_BUFFER_SIZE		( USPI_FRAME_BUFFER_SIZE - USPI_RX_HEADROOM )
+
+#if( ipBUFFER_PADDING < 4 + USPI_RX_HEADROOM )
+	#error The network buffer padding has no room for the receive status
+#endif
+
+/* Buffers queued with the adapter. */
+static volatile unsigned portBASE_TYPE uxRxQueued = 0;
+
+/* Buffers the interrupt gave back empty, to be queued again. */
+static xQueueHandle xRxReturnQueue = NULL;
+
+#endif /* niRX_BURST */
+
+/* How long the poll task sleeps when it has nothing to do, in case it could
+not queue all the receive buffers it wanted to last time. */
+#define niIDLE_PERIOD			pdMS_TO_TICKS( 100UL )
+
+extern xQueueHandle xNetworkEventQueue;
+
+/* Called from the USB interrupt once a frame queued by xNetworkInterfaceOutput()
+has been sent, or has failed. */
+static void prvFrameSent( void *pvFrame, int bOK, void *pvParam )
+{
+NetworkBufferDescriptor_t *pxDescriptor = ( NetworkBufferDescriptor_t * ) pvParam;
+portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+
+	configASSERT( pvFrame == ( void * ) pxDescriptor->pucEthernetBuffer );
+	( void ) pvFrame;
+
+	if( bOK )
+	{
+		iptraceNETWORK_INTERFACE_TRANSMIT();
+	}
+
+	/* There is always room, a slot is only given back once the buffer has
+	been taken out of the queue again. */
+	xQueueSendToBackFromISR( xTxDoneQueue, &pxDescriptor, &xHigherPriorityTaskWoken );
+
+	vTaskNotifyGiveFromISR( xPollTask, &xHigherPriorityTaskWoken );
+
+	if( xHigherPriorityTaskWoken )
+	{
+		portYIELD_FROM_ISR();
+	}
+}
+
+#if( niRX_BURST == 1 )
+
+/* Called from the USB interrupt once a burst buffer queued by prvRxBursts() has
+been filled, or has failed with nLength 0. */
+static void prvBurstReceived( void *pvBuffer, unsigned nLength, void *pvParam )
+{
+RxBurst_t xBurst;
+portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+
+	( void ) pvParam;
+
+	xBurst.pvBuffer = pvBuffer;
+	xBurst.uxLength = nLength;
+
+	/* There is always room, the queue holds every burst buffer. */
+	xQueueSendToBackFromISR( xRxBurstQueue, &xBurst, &xHigherPriorityTaskWoken );
+
+	vTaskNotifyGiveFromISR( xPollTask, &xHigherPriorityTaskWoken );
+
+	if( xHigherPriorityTaskWoken )
+	{
+		portYIELD_FROM_ISR();
+	}
+}
+
+/* Hands the frames of the bursts given back to the IP task, each in a network
+buffer of its own size, and queues the burst buffers with the adapter again. */
+static void prvRxBursts( void )
+{
+RxBurst_t xBurst;
+NetworkBufferDescriptor_t *pxDescriptor;
+IPStackEvent_t xRxEvent = { eNetworkRxEvent, NULL };
+void *pvFrame;
+unsigned uxOffset, uxFrameLength;
+
+	while( xQueueReceive( xRxBurstQueue, &xBurst, 0 ) == pdPASS )
+	{
+		uxOffset = 0;
+		while( ( pvFrame = USPiGetBurstFrame( xBurst.pvBuffer, xBurst.uxLength, &uxOffset, &uxFrameLength ) ) != NULL )
+		{
+			pxDescriptor = pxGetNetworkBufferWithDescriptor( ( size_t ) uxFrameLength, 0 );
+			if( pxDescriptor == NULL )
+			{
+				iptraceETHERNET_RX_EVENT_LOST();
+				continue;
+			}
+
+			memcpy( pxDescriptor->pucEthernetBuffer, pvFrame, uxFrameLength );
+			pxDescriptor->xDataLength = ( size_t ) uxFrameLength;
+			xRxEvent.pvData = ( void * ) pxDescriptor;
+
+			if( xSendEventStructToIPTask( &xRxEvent, 0 ) == pdPASS )
+			{
+				iptraceNETWORK_INTERFACE_RECEIVE();
+			}
+			else
+			{
+				vReleaseNetworkBufferAndDescriptor( pxDescriptor );
+				iptraceETHERNET_RX_EVENT_LOST();
+			}
 		}
 
-		/* If pxNextNetworkBufferDescriptor was not left pointing at a valid
-		descriptor then allocate one now. */
-		if( ( pxNextNetworkBufferDescriptor == NULL ) && ( uxGetNumberOfFreeNetworkBuffers() > xMinDescriptorsToLeave ) )
+		if( !USPiReceiveFrameAsync( xBurst.pvBuffer, prvBurstReceived, NULL ) )
 		{
-			pxNextNetworkBufferDescriptor = pxGetNetworkBufferWithDescriptor( ipTOTAL_ETHERNET_FRAME_SIZE, xBlockTime );
+			/* The burst buffer is given up, leaving one fewer to receive into. */
+			free( xBurst.pvBuffer );
 		}
-		if( pxNextNetworkBufferDescriptor != NULL )
+	}
+}
+
+#else
+
+/* Called from the USB interrupt once a buffer queued by prvQueueRxBuffers()
+has been filled, or has failed with nLength 0. */
+static void prvFrameReceived( void *pvFrame, unsigned nLength, void *pvParam )
+{
+NetworkBufferDescriptor_t *pxDescriptor = ( NetworkBufferDescriptor_t * ) pvParam;
+IPStackEvent_t xRxEvent = { eNetworkRxEvent, NULL };
+portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+
+	configASSERT( pvFrame == ( void * ) pxDescriptor->pucEthernetBuffer );
+	( void ) pvFrame;
+	__sync_sub_and_fetch( &uxRxQueued, 1 );
+
+	if( nLength != 0 )
+	{
+		pxDescriptor->xDataLength = ( size_t ) nLength;
+		xRxEvent.pvData = ( void * ) pxDescriptor;
+
+		if( xQueueSendToBackFromISR( xNetworkEventQueue, &xRxEvent, &xHigherPriorityTaskWoken ) == pdPASS )
 		{
-			/* Point pucUseBuffer to the buffer pointed to by the descriptor. */
-			pucUseBuffer = ( unsigned char* ) ( pxNextNetworkBufferDescriptor->pucEthernetBuffer - ipconfigPACKET_FILLER_SIZE );
+			iptraceNETWORK_INTERFACE_RECEIVE();
+			pxDescriptor = NULL;
 		}
 		else
 		{
-			/* As long as pxNextNetworkBufferDescriptor is NULL, the incoming
-			messages will be flushed and ignored. */
-			pucUseBuffer = NULL;
+			iptraceETHERNET_RX_EVENT_LOST();
 		}
+	}
+
+	if( pxDescriptor != NULL )
+	{
+		/* There is always room, the queue holds every receive buffer. */
+		xQueueSendToBackFromISR( xRxReturnQueue, &pxDescriptor, &xHigherPriorityTaskWoken );
+	}
+
+	vTaskNotifyGiveFromISR( xPollTask, &xHigherPriorityTaskWoken );
+
+	if( xHigherPriorityTaskWoken )
+	{
+		portYIELD_FROM_ISR();
+	}
+}
 
-		/* Read the next packet from the hardware into pucUseBuffer. */
-		ulResult = USPiReceiveFrame (pucUseBuffer, &ulReceiveCount);
+/* Tops the adapter up to niRX_BUFFERS receive buffers, first with the ones
+given back, then with new ones while enough are left for the stack. */
+static void prvQueueRxBuffers( void )
+{
+NetworkBufferDescriptor_t *pxDescriptor;
+const unsigned portBASE_TYPE xMinDescriptorsToLeave = 2UL;
 
-		if( ( ulResult != 1 ) || ( ulReceiveCount == 0 ) )
+	while( uxRxQueued < niRX_BUFFERS )
+	{
+		if( xQueueReceive( xRxReturnQueue, &pxDescriptor, 0 ) != pdPASS )
 		{
-			/* No data from the hardware. */
-			continue;//break;
+			if( uxGetNumberOfFreeNetworkBuffers() <= xMinDescriptorsToLeave )
+			{
+				break;
+			}
+
+			pxDescriptor = pxGetNetworkBufferWithDescriptor( niRX_BUFFER_SIZE, 0 );
+			if( pxDescriptor == NULL )
+			{
+				break;
+			}
 		}
-printHex("Frame received ", ulReceiveCount, 0xFFFFFFFF);
-if(ulReceiveCount != 0x3c) for(int i = 0; i < ulReceiveCount; i++){printHex("", ((char*)pucUseBuffer)[i], 0xFFFFFFFF);}
-		if( pxNextNetworkBufferDescriptor == NULL )
+
+		/* Counted first, the frame may arrive before the call returns. */
+		__sync_add_and_fetch( &uxRxQueued, 1 );
+
+		if( !USPiReceiveFrameAsync( pxDescriptor->pucEthernetBuffer - USPI_RX_HEADROOM, prvFrameReceived, pxDescriptor ) )
 		{
-			/* Data was read from the hardware, but no descriptor was available
-			for it, so it will be dropped. */
-			iptraceETHERNET_RX_EVENT_LOST();
-			continue;
+			__sync_sub_and_fetch( &uxRxQueued, 1 );
+			vReleaseNetworkBufferAndDescriptor( pxDescriptor );
+			break;
 		}
+	}
+}
+
+#endif /* niRX_BURST */
 
-		iptraceNETWORK_INTERFACE_RECEIVE();
-		pxNextNetworkBufferDescriptor->xDataLength = ( size_t ) ulReceiveCount;
-		xRxEvent.pvData = ( void * ) pxNextNetworkBufferDescriptor;
+void ethernetPollTask(){
+NetworkBufferDescriptor_t *pxDescriptor;
 
-		/* Send the descriptor to the IP task for processing. */
-		if( xSendEventStructToIPTask( &xRxEvent, xBlockTime ) != pdTRUE )
+	for( ;; ){
+		/* Release the buffers of the frames that have gone out. */
+		while( xQueueReceive( xTxDoneQueue, &pxDescriptor, 0 ) == pdPASS )
 		{
-			/* The buffer could not be sent to the stack so must be released 
-			again. */
-			vReleaseNetworkBufferAndDescriptor( pxNextNetworkBufferDescriptor );
-			iptraceETHERNET_RX_EVENT_LOST();
-			FreeRTOS_printf( ( "prvEMACRxPoll: Can not queue return packet!\n" ) );
+			vReleaseNetworkBufferAndDescriptor( pxDescriptor );
+			xSemaphoreGive( xTxSlots );
+		}
+
+		#if( niRX_BURST == 1 )
+		{
+			prvRxBursts();
+		}
+		#else
+		{
+			prvQueueRxBuffers();
+		}
+		#endif
+
+		/* Sleep until a buffer is to be released or replaced.  The
+		notification is shared with the USB transfers, which may already have
+		consumed it, hence the check of the queues. */
+		if( uxQueueMessagesWaiting( xTxDoneQueue ) == 0
+		#if( niRX_BURST == 1 )
+			&& uxQueueMessagesWaiting( xRxBurstQueue ) == 0
+		#endif
+			)
+		{
+			ulTaskNotifyTake( pdTRUE, niIDLE_PERIOD );
 		}
-		
-		/* Now the buffer has either been passed to the IP-task,
-		or it has been released in the code above. */
-		pxNextNetworkBufferDescriptor = NULL;
 	}
 }
 
@@ -110,15 +332,75 @@ portBASE_TYPE xNetworkInterfaceInitialise(){
 		return pdFAIL;
 	}
 
-	xTaskCreate(ethernetPollTask, "poll", 128, NULL, 0, NULL);
+	if( xTxDoneQueue == NULL )
+	{
+		xTxSlots = xSemaphoreCreateCounting( ( unsigned portBASE_TYPE ) niTX_BUFFERS, ( unsigned portBASE_TYPE ) niTX_BUFFERS );
+		xTxDoneQueue = xQueueCreate( ( unsigned portBASE_TYPE ) niTX_BUFFERS, sizeof( NetworkBufferDescriptor_t * ) );
+
+		#if( niRX_BURST == 1 )
+		{
+		RxBurst_t xBurst = { NULL, 0 };
+		portBASE_TYPE x;
+
+			xRxBurstQueue = xQueueCreate( ( unsigned portBASE_TYPE ) niRX_BURSTS, sizeof( RxBurst_t ) );
+
+			/* Given to the poll task as empty bursts, for it to queue. */
+			for( x = 0; x < niRX_BURSTS; x++ )
+			{
+				xBurst.pvBuffer = malloc( USPI_BURST_BUFFER_SIZE );
+				if( xBurst.pvBuffer != NULL )
+				{
+					xQueueSendToBack( xRxBurstQueue, &xBurst, 0 );
+				}
+			}
+		}
+		#else
+		{
+			xRxReturnQueue = xQueueCreate( ( unsigned portBASE_TYPE ) niRX_BUFFERS, sizeof( NetworkBufferDescriptor_t * ) );
+		}
+		#endif
+	}
+
+	#if( niRX_BURST == 1 )
+	{
+		if( !USPiEnableReceiveBurst() ){
+			println("Cannot enable receive bursts", 0xFFFFFFFF);
+			return pdFAIL;
+		}
+	}
+	#endif
+
+	/* It passes the received frames on in burst mode, so it runs with the IP
+	task, and needs the stack for USPi's logging. */
+	xTaskCreate(ethernetPollTask, "poll", 256, NULL, ipconfigIP_TASK_PRIORITY, &xPollTask);
 
 	return pdPASS;
 }
 
 portBASE_TYPE xNetworkInterfaceOutput( NetworkBufferDescriptor_t * const pxDescriptor, portBASE_TYPE bReleaseAfterSend ){
-	OutputInfo out;
-	out.pNetworkBufferDescriptor_t = (int)pxDescriptor;
-	out.bReleaseAfterSend = bReleaseAfterSend;
-	xQueueSendToBack(xOutputQueue, &out, 1000);
-	return 1;
+NetworkBufferDescriptor_t *pxSend = pxDescriptor;
+
+	/* The stack keeps the buffer, so the adapter gets a copy of its own. */
+	if( bReleaseAfterSend == pdFALSE )
+	{
+		pxSend = pxDuplicateNetworkBufferWithDescriptor( pxDescriptor, pxDescriptor->xDataLength );
+		if( pxSend == NULL )
+		{
+			return pdFAIL;
+		}
+	}
+
+	if( xSemaphoreTake( xTxSlots, niTX_WAIT ) == pdPASS )
+	{
+		if( USPiSendFrameAsync( pxSend->pucEthernetBuffer, pxSend->xDataLength, prvFrameSent, pxSend ) )
+		{
+			return pdPASS;
+		}
+
+		xSemaphoreGive( xTxSlots );
+	}
+
+	/* Dropped, as a busy wire would drop it. */
+	vReleaseNetworkBufferAndDescriptor( pxSend );
+	return pdFAIL;
 }
@@ -0,0 +1,169 @@
+/*
+ * Network interface for the POSIX simulator (make posix).  Frames are
+ * exchanged with the host through a Linux TAP device, so the simulated stack
+ * appears as another machine on the TAP network:
+ *
+ *   sudo ip tuntap add dev tap0 mode tap user $USER
+ *   sudo ip addr add 10.10.206.1/24 dev tap0
+ *   sudo ip link set tap0 up
+ *
+ * The device is named by the FREERTOS_TAP environment variable, tap0 if it is
+ * not set.  As with the USB adapter on the target, received frames are
+ * collected by a poll task, once a tick while there are none.
+ */
+
+#include <fcntl.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <net/if.h>
+#include <linux/if_tun.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+#include "FreeRTOS_IP_Private.h"
+#include "NetworkBufferManagement.h"
+#include "NetworkInterface.h"
+
+#include "video.h"
+
+#define posixDEFAULT_TAP	"tap0"
+
+/* The TAP device, -1 until it is opened. */
+static int iTapDevice = -1;
+
+static xTaskHandle xPollTask = NULL;
+
+static int prvOpenTap( void )
+{
+struct ifreq xRequest;
+const char *pcName = getenv( "FREERTOS_TAP" );
+int iDevice;
+
+	if( pcName == NULL )
+	{
+		pcName = posixDEFAULT_TAP;
+	}
+
+	iDevice = open( "/dev/net/tun", O_RDWR | O_NONBLOCK );
+	if( iDevice < 0 )
+	{
+		return -1;
+	}
+
+	memset( &xRequest, 0, sizeof( xRequest ) );
+	xRequest.ifr_flags = IFF_TAP | IFF_NO_PI;
+	strncpy( xRequest.ifr_name, pcName, IFNAMSIZ - 1 );
+
+	if( ioctl( iDevice, TUNSETIFF, ( void * ) &xRequest ) < 0 )
+	{
+		close( iDevice );
+		return -1;
+	}
+
+	return iDevice;
+}
+
+static void prvTapPollTask( void *pvParameters )
+{
+NetworkBufferDescriptor_t *pxDescriptor = NULL;
+const unsigned portBASE_TYPE xMinDescriptorsToLeave = 2UL;
+const portTickType xBlockTime = pdMS_TO_TICKS( 100UL );
+const portTickType xIdlePollTime = pdMS_TO_TICKS( 1UL );
+IPStackEvent_t xRxEvent = { eNetworkRxEvent, NULL };
+unsigned char ucDiscard[ ipTOTAL_ETHERNET_FRAME_SIZE ];
+ssize_t xReceived;
+
+	( void ) pvParameters;
+
+	for( ;; )
+	{
+		if( ( pxDescriptor == NULL ) && ( uxGetNumberOfFreeNetworkBuffers() > xMinDescriptorsToLeave ) )
+		{
+			pxDescriptor = pxGetNetworkBufferWithDescriptor( ipTOTAL_ETHERNET_FRAME_SIZE, xBlockTime );
+		}
+
+		if( pxDescriptor != NULL )
+		{
+			xReceived = read( iTapDevice, pxDescriptor->pucEthernetBuffer, ipTOTAL_ETHERNET_FRAME_SIZE );
+		}
+		else
+		{
+			/* No descriptor to read into, so the frame is dropped. */
+			xReceived = read( iTapDevice, ucDiscard, sizeof( ucDiscard ) );
+			if( xReceived > 0 )
+			{
+				iptraceETHERNET_RX_EVENT_LOST();
+				continue;
+			}
+		}
+
+		if( xReceived <= 0 )
+		{
+			/* Nothing waiting (EAGAIN), sleep for a tick before asking again. */
+			vTaskDelay( xIdlePollTime );
+			continue;
+		}
+
+		iptraceNETWORK_INTERFACE_RECEIVE();
+		pxDescriptor->xDataLength = ( size_t ) xReceived;
+		xRxEvent.pvData = ( void * ) pxDescriptor;
+
+		if( xSendEventStructToIPTask( &xRxEvent, xBlockTime ) != pdTRUE )
+		{
+			vReleaseNetworkBufferAndDescriptor( pxDescriptor );
+			iptraceETHERNET_RX_EVENT_LOST();
+		}
+
+		/* Now the buffer has either been passed to the IP-task,
+		or it has been released in the code above. */
+		pxDescriptor = NULL;
+	}
+}
+
+portBASE_TYPE xNetworkInterfaceInitialise( void )
+{
+	if( iTapDevice < 0 )
+	{
+		iTapDevice = prvOpenTap();
+		if( iTapDevice < 0 )
+		{
+			/* The IP task calls again later. */
+			println( "Cannot open the TAP device, see NetworkInterfacePosix.c", 0xFFFFFFFF );
+			return pdFAIL;
+		}
+	}
+
+	if( xPollTask == NULL )
+	{
+		xTaskCreate( prvTapPollTask, ( signed char * ) "poll", configEMAC_TASK_STACK_SIZE, NULL, 0, &xPollTask );
+	}
+
+	return pdPASS;
+}
+
+portBASE_TYPE xNetworkInterfaceOutput( NetworkBufferDescriptor_t * const pxDescriptor, portBASE_TYPE bReleaseAfterSend )
+{
+	/* A TAP write never blocks for long, so the frame is sent straight from
+	the IP task rather than handed over to the poll task. */
+	if( write( iTapDevice, pxDescriptor->pucEthernetBuffer, pxDescriptor->xDataLength ) >= 0 )
+	{
+		iptraceNETWORK_INTERFACE_TRANSMIT();
+	}
+
+	if( bReleaseAfterSend != pdFALSE )
+	{
+		vReleaseNetworkBufferAndDescriptor( pxDescriptor );
+	}
+
+	return pdPASS;
+}
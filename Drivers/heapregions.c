@@ -0,0 +1,113 @@
+/**
+ *	Gives the heap the board's RAM, rather than configTOTAL_HEAP_SIZE bytes of
+ *	.bss.  The ARM's share of the RAM starts at 0 and is split by the kernel
+ *	image and the boot stacks of Demo/startup.s:
+ *
+ *	  0x0000 - 0x8000            vectors and the IRQ, FIQ and UND stacks
+ *	  0x8000 - __bss_end         the kernel image
+ *	  __bss_end - .coherent      heap, up to the next 1MB boundary
+ *	  .coherent                  uncached buffers, see mmu.h
+ *	  __coherent_end - stacks    heap
+ *	  stacks - SVC_STACK_TOP     one 1MB SVC stack slot per core
+ *	  SVC_STACK_TOP - ARM end    heap
+ **/
+
+#include <FreeRTOS.h>
+
+#include "heapregions.h"
+#include "mailbox.h"
+#include "mmu.h"
+
+/* As in Demo/startup.s. */
+#define SVC_STACK_TOP			0x8000000UL
+#define CORE_STACK_SLOT_SIZE	0x100000UL
+
+/* The end of RAM in raspberrypi.ld, for when the firmware does not answer. */
+#define LINKER_RAM_END			( 0x10000UL + 0x8000000UL )
+
+/* Below this, a gap is not worth a region. */
+#define HEAP_REGION_MIN_SIZE	0x1000UL
+
+extern unsigned char __bss_end;
+extern unsigned char __coherent_start;
+extern unsigned char __coherent_end;
+
+/* Only heap_5.c provides this; the other heaps have their own array. */
+extern void vPortDefineHeapRegions( const xHeapRegion * const pxHeapRegions ) __attribute__((weak));
+
+static xHeapRegion xRegions[4];
+
+/**
+ *	Base and size of the ARM's memory, from the firmware.
+ **/
+static int GetArmMemory(unsigned long *pulBase, unsigned long *pulSize) {
+	static unsigned int mailbuffer[8] MMU_COHERENT __attribute__((aligned (16)));
+	PropertyMessage xMessage;
+	unsigned int *pulValue;
+	int attempts;
+
+	//before the scheduler, so this polls
+	for(attempts = 0; attempts < 5; attempts++) {
+		PropertyInit(&xMessage, mailbuffer, 8);
+		PropertyAddTag(&xMessage, PROPERTY_TAG_GET_ARM_MEMORY, 8, 0);
+
+		if(PropertyCall(&xMessage) == PROPERTY_OK) {
+			pulValue = PropertyGetTag(&xMessage, PROPERTY_TAG_GET_ARM_MEMORY);
+			if(pulValue && pulValue[1] != 0) {
+				*pulBase = pulValue[0];
+				*pulSize = pulValue[1];
+				return 1;
+			}
+		}
+	}
+
+	return 0;
+}
+
+unsigned long GetArmMemoryEnd(void) {
+	unsigned long ulArmBase, ulArmSize;
+
+	if(GetArmMemory(&ulArmBase, &ulArmSize)) {
+		return ulArmBase + ulArmSize;
+	}
+	return LINKER_RAM_END;
+}
+
+void HeapRegionsInit(void) {
+	unsigned long ulArmEnd = GetArmMemoryEnd();
+	unsigned long ulImageEnd = (unsigned long) &__bss_end;
+	unsigned long ulCoherentStart = (unsigned long) &__coherent_start;
+	unsigned long ulCoherentEnd = (unsigned long) &__coherent_end;
+	unsigned long ulStacksBottom = SVC_STACK_TOP - (configNUM_CORES * CORE_STACK_SLOT_SIZE);
+	int i = 0;
+
+	if(vPortDefineHeapRegions == NULL) {
+		return;
+	}
+
+	//the padding between the kernel image and the uncached section
+	if(ulCoherentStart - ulImageEnd >= HEAP_REGION_MIN_SIZE) {
+		xRegions[i].pucStartAddress = (unsigned char *) ulImageEnd;
+		xRegions[i].xSizeInBytes = ulCoherentStart - ulImageEnd;
+		i++;
+	}
+
+	//between the uncached section and the stacks
+	if(ulStacksBottom > ulCoherentEnd && ulStacksBottom <= ulArmEnd) {
+		xRegions[i].pucStartAddress = (unsigned char *) ulCoherentEnd;
+		xRegions[i].xSizeInBytes = ulStacksBottom - ulCoherentEnd;
+		i++;
+	}
+
+	//above the stacks, to the end of the ARM's memory
+	if(ulArmEnd > SVC_STACK_TOP) {
+		xRegions[i].pucStartAddress = (unsigned char *) SVC_STACK_TOP;
+		xRegions[i].xSizeInBytes = ulArmEnd - SVC_STACK_TOP;
+		i++;
+	}
+
+	xRegions[i].pucStartAddress = NULL;
+	xRegions[i].xSizeInBytes = 0;
+
+	vPortDefineHeapRegions(xRegions);
+}
@@ -0,0 +1,16 @@
+#ifndef _HEAPREGIONS_H_
+#define _HEAPREGIONS_H_
+
+/* Hands the RAM the kernel image and the boot stacks do not use to heap_5.c,
+ * as reported by the firmware (mailbox property tag 0x00010005, get ARM
+ * memory).  Must be called before anything is allocated, so first thing in
+ * main().  Does nothing when the kernel is built with a heap that has its own
+ * static array (make HEAP=heap_4). */
+
+void HeapRegionsInit	(void);
+
+/* The end of the ARM's share of the RAM, from the firmware, or the end of the
+ * RAM in raspberrypi.ld if it does not answer. */
+unsigned long GetArmMemoryEnd	(void);
+
+#endif
@@ -129,11 +129,48 @@ void USPiGetMACAddress (unsigned char Buffer[6]);
 // returns 0 on failure
 int USPiSendFrame (const void *pBuffer, unsigned nLength);
 
+// queues the frame at pFrame to be sent and returns at once, the frame is not copied
+// the USPI_TX_HEADROOM bytes in front of pFrame are overwritten, and pFrame must be
+// 4-byte aligned and stay untouched until pHandler is called from the USB interrupt,
+// with bOK 0 if the frame could not be sent. frames are sent in the order queued
+// returns 0 if USPI_TX_QUEUE_SIZE frames are queued already
+// (do not use together with USPiSendFrame ())
+#define USPI_TX_QUEUE_SIZE	8
+#define USPI_TX_HEADROOM	8
+typedef void TUSPiFrameSentHandler (void *pFrame, int bOK, void *pParam);
+int USPiSendFrameAsync (void *pFrame, unsigned nLength, TUSPiFrameSentHandler *pHandler, void *pParam);
+
 // pBuffer must have size USPI_FRAME_BUFFER_SIZE
-// returns 0 if no frame is available or on failure
+// waits until a frame is available, the adapter NAKs while it has none
+// returns 0 on failure
 #define USPI_FRAME_BUFFER_SIZE	1600
 int USPiReceiveFrame (void *pBuffer, unsigned *pResultLength);
 
+// queues pBuffer (size USPI_FRAME_BUFFER_SIZE) to receive a frame into and returns at once,
+// up to USPI_RX_QUEUE_SIZE buffers can be queued. pHandler is called from the USB interrupt
+// when the buffer is filled, in the order queued, with the frame length or 0 on failure
+// the frame is not moved: it starts at pBuffer + USPI_RX_HEADROOM, which is pFrame
+// (the first bytes hold the adapter's receive status)
+// returns 0 if the queue is full
+// (do not use together with USPiReceiveFrame ())
+#define USPI_RX_QUEUE_SIZE	8
+#define USPI_RX_HEADROOM	4
+typedef void TUSPiFrameReceivedHandler (void *pFrame, unsigned nLength, void *pParam);
+int USPiReceiveFrameAsync (void *pBuffer, TUSPiFrameReceivedHandler *pHandler, void *pParam);
+
+// lets the adapter pack several frames into one USB transfer, which saves the
+// transfer overhead of each one. afterwards buffers for USPiReceiveFrameAsync ()
+// must have size USPI_BURST_BUFFER_SIZE, and pHandler gets pBuffer itself as pFrame
+// and the length of the burst received into it (0 on failure)
+// call once, before any buffer is queued. returns 0 on failure
+#define USPI_BURST_BUFFER_SIZE	16384
+int USPiEnableReceiveBurst (void);
+
+// returns the next good frame in a burst of nLength bytes in pBuffer, starting at
+// *pOffset (0 for the first), or 0 if there are no more. *pOffset is moved behind
+// the frame, and *pFrameLength set to its length
+void *USPiGetBurstFrame (void *pBuffer, unsigned nLength, unsigned *pOffset, unsigned *pFrameLength);
+
 //
 // GamePad device
 //
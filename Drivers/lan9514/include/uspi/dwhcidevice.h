@@ -42,7 +42,7 @@ typedef struct TDWHCIDevice
 
 	TDWHCITransferStageData *m_pStageData[DWHCI_MAX_CHANNELS];
 
-	volatile boolean m_bWaiting;
+	void *m_hChannelTokens;			// counting semaphore, one token for each free channel
 
 	TDWHCIRootPort m_RootPort;
 }
@@ -0,0 +1,36 @@
+//
+// dwhcipools.h
+//
+// The object pools of the host controller driver, for what it allocates on
+// every transfer (see objectpool.h).  A pool that runs dry falls back to
+// malloc (), which ObjectPoolGetMisses () counts; size the pools so that it
+// stays at 0 (ObjectPoolGetHighWater () tells how close it came).
+//
+#ifndef _uspi_dwhcipools_h
+#define _uspi_dwhcipools_h
+
+#include <uspi/objectpool.h>
+#include <uspi/dwhci.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// one of each per channel at most
+#define DWHCI_STAGE_DATA_POOL_SIZE	DWHCI_MAX_CHANNELS
+#define DWHCI_FRAME_SCHED_POOL_SIZE	DWHCI_MAX_CHANNELS
+#define DWHCI_TEMP_BUFFER_POOL_SIZE	DWHCI_MAX_CHANNELS
+
+// one per control message in flight
+#define DWHCI_SETUP_DATA_POOL_SIZE	4
+
+extern TObjectPool DWHCIStageDataPool;		// TDWHCITransferStageData
+extern TObjectPool DWHCIFrameSchedulerPool;	// any TDWHCIFrameScheduler...
+extern TObjectPool DWHCITempBufferPool;		// u32, DMA buffer of a zero length stage
+extern TObjectPool DWHCISetupDataPool;		// TSetupData, DMA buffer of a setup stage
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,72 @@
+//
+// objectpool.h
+//
+// Fixed-size object pools, for the bookkeeping the host controller driver
+// needs for every transfer.  Get and put take constant time and do not
+// disable interrupts: the free list is a stack whose head is swapped with
+// LDREX/STREX (a compare-and-swap), so they can be called from task and
+// interrupt context alike.  The head carries a tag that changes on every
+// swap, which stops an interrupted get from popping a stale next link.
+//
+// Each object starts on a cache line of its own, so an object the controller
+// reads or writes by DMA never shares a line with its neighbours.
+//
+#ifndef _uspi_objectpool_h
+#define _uspi_objectpool_h
+
+#include <uspi/macros.h>
+#include <uspi/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define OBJECT_POOL_ALIGN		64		// L1 and L2 line length of the Cortex-A7/A53
+
+#define OBJECT_POOL_STRIDE(size)	(((size) + OBJECT_POOL_ALIGN - 1) & ~(OBJECT_POOL_ALIGN - 1))
+
+#define OBJECT_POOL_NONE		0xFFFF		// end of the free list
+
+typedef struct TObjectPool
+{
+	u8		*m_pStorage;
+	u16		*m_pNext;			// free list link of each object
+	unsigned	 m_nStride;
+	unsigned	 m_nCount;
+
+	volatile u32	 m_nHead;			// tag << 16 | first free object
+	volatile unsigned m_nUnused;			// objects never handed out yet
+
+	volatile unsigned m_nInUse;			// statistics
+	volatile unsigned m_nHighWater;
+	volatile unsigned m_nMisses;
+}
+TObjectPool;
+
+// Defines pool, with storage for nCount objects of nSize bytes, statically
+// initialised so it can be used before anything else has run.
+#define DEFINE_OBJECT_POOL(pool, nSize, nCount)						\
+	static u8 pool##Storage[OBJECT_POOL_STRIDE (nSize) * (nCount)] ALIGN (OBJECT_POOL_ALIGN);	\
+	static u16 pool##Next[nCount];							\
+	TObjectPool pool = {pool##Storage, pool##Next, OBJECT_POOL_STRIDE (nSize), (nCount),	\
+			    OBJECT_POOL_NONE, 0, 0, 0, 0}
+
+// returns 0 if all objects are in use
+void *ObjectPoolGet (TObjectPool *pThis);
+void ObjectPoolPut (TObjectPool *pThis, void *pObject);
+
+// from the pool, or from malloc () when the pool is empty (counted as a miss)
+void *ObjectPoolAllocate (TObjectPool *pThis, unsigned nSize);
+void ObjectPoolFree (TObjectPool *pThis, void *pObject);
+
+boolean ObjectPoolContains (TObjectPool *pThis, const void *pObject);
+
+unsigned ObjectPoolGetInUse (TObjectPool *pThis);
+unsigned ObjectPoolGetHighWater (TObjectPool *pThis);
+unsigned ObjectPoolGetMisses (TObjectPool *pThis);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
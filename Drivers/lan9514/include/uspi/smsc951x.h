@@ -28,6 +28,50 @@
 
 #define FRAME_BUFFER_SIZE	1600
 
+// receive buffers that can be queued at once, see SMSC951xDeviceReceiveFrameAsync ()
+#define SMSC951X_RX_QUEUE_SIZE	8
+
+// the adapter writes a status word in front of each received frame
+#define SMSC951X_RX_STATUS_SIZE	4
+
+// receive buffer size in burst mode, see SMSC951xDeviceEnableBurst ()
+#define SMSC951X_BURST_BUFFER_SIZE	16384
+
+// frames that can be queued to be sent at once, see SMSC951xDeviceSendFrameAsync ()
+#define SMSC951X_TX_QUEUE_SIZE	8
+
+// the adapter wants two command words in front of each frame sent
+#define SMSC951X_TX_HEADROOM	8
+
+// called from the USB interrupt with a received frame, pFrame points behind
+// the status word. nLength is 0 if the transfer failed or the frame was bad
+// and the buffer is only given back. in burst mode it is called with the
+// buffer itself and the length of the burst in it, see SMSC951xGetBurstFrame ()
+typedef void TSMSC951xFrameHandler (void *pFrame, unsigned nLength, void *pParam);
+
+typedef struct TSMSC951xRxRequest
+{
+	TUSBRequest m_URB;
+	void *m_pBuffer;
+	TSMSC951xFrameHandler *m_pHandler;
+	void *m_pParam;
+}
+TSMSC951xRxRequest;
+
+// called from the USB interrupt once a frame queued by
+// SMSC951xDeviceSendFrameAsync () has been sent, or has failed
+typedef void TSMSC951xFrameSentHandler (void *pFrame, boolean bOK, void *pParam);
+
+typedef struct TSMSC951xTxRequest
+{
+	TUSBRequest m_URB;
+	void *m_pFrame;
+	unsigned m_nLength;
+	TSMSC951xFrameSentHandler *m_pHandler;
+	void *m_pParam;
+}
+TSMSC951xTxRequest;
+
 typedef struct TSMSC951xDevice
 {
 	TUSBDevice m_USBDevice;
@@ -37,7 +81,20 @@ typedef struct TSMSC951xDevice
 
 	TMACAddress m_MACAddress;
 
-	u8 *m_pTxBuffer;
+	// queued receives, from m_nRxTail (at the controller if m_bRxActive) to
+	// m_nRxHead.  only one is at the controller at a time, as the data toggle
+	// of the endpoint is only advanced when a transfer completes
+	TSMSC951xRxRequest m_RxQueue[SMSC951X_RX_QUEUE_SIZE];
+	volatile unsigned m_nRxHead;
+	volatile unsigned m_nRxTail;
+	volatile boolean m_bRxActive;
+	boolean m_bBurst;
+
+	// queued sends, kept the same way for the bulk-out endpoint
+	TSMSC951xTxRequest m_TxQueue[SMSC951X_TX_QUEUE_SIZE];
+	volatile unsigned m_nTxHead;
+	volatile unsigned m_nTxTail;
+	volatile boolean m_bTxActive;
 }
 TSMSC951xDevice;
 
@@ -50,9 +107,36 @@ TMACAddress *SMSC951xDeviceGetMACAddress (TSMSC951xDevice *pThis);
 
 boolean SMSC951xDeviceSendFrame (TSMSC951xDevice *pThis, const void *pBuffer, unsigned nLength);
 
-// pBuffer must have size FRAME_BUFFER_SIZE
+// queues the frame at pFrame to be sent and returns at once, without copying it.
+// the SMSC951X_TX_HEADROOM bytes in front of pFrame are overwritten with the
+// TX command words, and the buffer must stay as it is until pHandler is called.
+// frames are sent in the order queued. returns FALSE if the queue is full
+// (do not use together with SMSC951xDeviceSendFrame ())
+boolean SMSC951xDeviceSendFrameAsync (TSMSC951xDevice *pThis, void *pFrame, unsigned nLength,
+				      TSMSC951xFrameSentHandler *pHandler, void *pParam);
+
+// pBuffer must have size FRAME_BUFFER_SIZE (not in burst mode)
 boolean SMSC951xDeviceReceiveFrame (TSMSC951xDevice *pThis, void *pBuffer, unsigned *pResultLength);
 
+// queues pBuffer (size FRAME_BUFFER_SIZE, or SMSC951X_BURST_BUFFER_SIZE in burst mode)
+// to receive a frame into and returns at once,
+// pHandler is called when it is filled. buffers are filled in the order queued.
+// the frame is left where it was received, at pBuffer + SMSC951X_RX_STATUS_SIZE
+// returns FALSE if the queue is full
+boolean SMSC951xDeviceReceiveFrameAsync (TSMSC951xDevice *pThis, void *pBuffer,
+					 TSMSC951xFrameHandler *pHandler, void *pParam);
+
+// lets the adapter pack the frames it has into one bulk-in transfer of up to
+// SMSC951X_BURST_BUFFER_SIZE bytes, each behind its status word and 4-byte aligned,
+// instead of sending one transfer per frame. only for SMSC951xDeviceReceiveFrameAsync (),
+// before any buffer is queued
+boolean SMSC951xDeviceEnableBurst (TSMSC951xDevice *pThis);
+
+// returns the next good frame of the burst of nLength bytes in pBuffer, from
+// *pOffset (0 for the first), or 0 if there are no more. *pOffset is moved on
+// behind it and *pFrameLength set to its length without CRC
+void *SMSC951xGetBurstFrame (void *pBuffer, unsigned nLength, unsigned *pOffset, unsigned *pFrameLength);
+
 // private:
 boolean SMSC951xDeviceWriteReg (TSMSC951xDevice *pThis, u32 nIndex, u32 nValue);
 boolean SMSC951xDeviceReadReg (TSMSC951xDevice *pThis, u32 nIndex, u32 *pValue);
@@ -47,6 +47,8 @@ void uspi_LeaveCritical (void);		// enable interrupts (nested calls possible)
 #define CleanDataCache()	__asm volatile ("mcr p15, 0, %0, c7, c10, 0" : : "r" (0) : "memory")
 
 void uspi_CleanAndInvalidateDataCacheRange (u32 nAddress, u32 nLength) MAXOPT;
+void uspi_CleanDataCacheRange (u32 nAddress, u32 nLength) MAXOPT;
+void uspi_InvalidateDataCacheRange (u32 nAddress, u32 nLength) MAXOPT;
 
 //
 // Barriers
@@ -69,6 +71,8 @@ void uspi_CleanAndInvalidateDataCacheRange (u32 nAddress, u32 nLength) MAXOPT;
 				__asm volatile ("mcr p15, 0, %0, c7, c5,  6" : : "r" (0) : "memory")
 
 void uspi_CleanAndInvalidateDataCacheRange (u32 nAddress, u32 nLength) MAXOPT;
+void uspi_CleanDataCacheRange (u32 nAddress, u32 nLength) MAXOPT;
+void uspi_InvalidateDataCacheRange (u32 nAddress, u32 nLength) MAXOPT;
 
 //
 // Barriers
@@ -40,7 +40,7 @@ extern "C" {
 //#define USPI_DEFAULT_KEYMAP_DE
 
 // Undefine this if you want to use your own implementation of the functions in uspi/util.h
-#define USPI_PROVIDE_MEM_FUNCTIONS	// mem*()
+//#define USPI_PROVIDE_MEM_FUNCTIONS	// mem*(), Drivers/mem.c has word and NEON versions
 #define USPI_PROVIDE_STR_FUNCTIONS	// str*()
 
 //
@@ -24,8 +24,10 @@
 //
 #include "FreeRTOS.h"
 #include "task.h"
+#include "semphr.h"
 
 #include <uspi/dwhcidevice.h>
+#include <uspi/dwhcipools.h>
 #include <uspios.h>
 #include <uspi/bcm2835.h>
 #include <uspi/synchronize.h>
@@ -79,6 +81,7 @@ void DWHCIDeviceFlushRxFIFO (TDWHCIDevice *pThis);
 boolean DWHCIDeviceTransferStage (TDWHCIDevice *pThis, TUSBRequest *pURB, boolean bIn, boolean bStatusStage);
 void DWHCIDeviceCompletionRoutine (TUSBRequest *pURB, void *pParam, void *pContext);
 boolean DWHCIDeviceTransferStageAsync (TDWHCIDevice *pThis, TUSBRequest *pURB, boolean bIn, boolean bStatusStage);
+boolean DWHCIDeviceTransferStageOnChannel (TDWHCIDevice *pThis, unsigned nChannel, TUSBRequest *pURB, boolean bIn, boolean bStatusStage);
 void DWHCIDeviceStartTransaction (TDWHCIDevice *pThis, TDWHCITransferStageData *pStageData);
 void DWHCIDeviceStartChannel (TDWHCIDevice *pThis, TDWHCITransferStageData *pStageData);
 void DWHCIDeviceChannelInterruptHandler (TDWHCIDevice *pThis, unsigned nChannel);
@@ -98,7 +101,7 @@ void DWHCIDevice (TDWHCIDevice *pThis)
 
 	pThis->m_nChannels = 0;
 	pThis->m_nChannelAllocated = 0;
-	pThis->m_bWaiting = FALSE;
+	pThis->m_hChannelTokens = 0;
 	DWHCIRootPort (&pThis->m_RootPort, pThis);
 
 	for (unsigned nChannel = 0; nChannel < DWHCI_MAX_CHANNELS; nChannel++)
@@ -235,7 +238,7 @@ int DWHCIDeviceControlMessage (TDWHCIDevice *pThis, TUSBEndpoint *pEndpoint,
 {
 	assert (pThis != 0);
 
-	TSetupData *pSetup = (TSetupData *) malloc (sizeof (TSetupData));
+	TSetupData *pSetup = (TSetupData *) ObjectPoolAllocate (&DWHCISetupDataPool, sizeof (TSetupData));
 	assert (pSetup != 0);
 
 	pSetup->bmRequestType = ucRequestType;
@@ -254,7 +257,7 @@ int DWHCIDeviceControlMessage (TDWHCIDevice *pThis, TUSBEndpoint *pEndpoint,
 		nResult = USBRequestGetResultLength (&URB);
 	}
 	
-	free (pSetup);
+	ObjectPoolFree (&DWHCISetupDataPool, pSetup);
 
 	_USBRequest (&URB);
 
@@ -409,6 +412,11 @@ boolean DWHCIDeviceInitCore (TDWHCIDevice *pThis)
 	pThis->m_nChannels = DWHCI_CORE_HW_CFG2_NUM_HOST_CHANNELS (DWHCIRegisterGet (&HWConfig2));
 	assert (4 <= pThis->m_nChannels && pThis->m_nChannels <= DWHCI_MAX_CHANNELS);
 
+	// a channel is only allocated with a token taken, and its token is
+	// given back when it is freed
+	pThis->m_hChannelTokens = xSemaphoreCreateCounting (pThis->m_nChannels, pThis->m_nChannels);
+	assert (pThis->m_hChannelTokens != 0);
+
 	TDWHCIRegister AHBConfig;
 	DWHCIRegister (&AHBConfig, DWHCI_CORE_AHB_CFG);
 	DWHCIRegisterRead (&AHBConfig);
@@ -709,28 +717,41 @@ void DWHCIDeviceFlushRxFIFO (TDWHCIDevice *pThis)
 	_DWHCIRegister (&Reset);
 }
 
+// a blocking transfer stage, on the stack of the task waiting for it
+typedef struct TDWHCICompletion
+{
+	volatile boolean m_bDone;
+	void *m_hTask;			// notified by DWHCIDeviceCompletionRoutine ()
+}
+TDWHCICompletion;
+
 boolean DWHCIDeviceTransferStage (TDWHCIDevice *pThis, TUSBRequest *pURB, boolean bIn, boolean bStatusStage)
 {
 	assert (pThis != 0);
 
+	TDWHCICompletion Completion;
+	Completion.m_bDone = FALSE;
+	Completion.m_hTask = xTaskGetCurrentTaskHandle ();
+
 	assert (pURB != 0);
-	USBRequestSetCompletionRoutine (pURB, DWHCIDeviceCompletionRoutine, 0, pThis);
+	USBRequestSetCompletionRoutine (pURB, DWHCIDeviceCompletionRoutine, &Completion, pThis);
 
-	assert (!pThis->m_bWaiting);
-	pThis->m_bWaiting = TRUE;
+	// the channels may all be busy with transfers of other tasks, sleep
+	// until one of them finishes. with a token there is a free channel
+	xSemaphoreTake ((xSemaphoreHandle) pThis->m_hChannelTokens, portMAX_DELAY);
+	unsigned nChannel = DWHCIDeviceAllocateChannel (pThis);
+	assert (nChannel < pThis->m_nChannels);
 
-	if (!DWHCIDeviceTransferStageAsync (pThis, pURB, bIn, bStatusStage))
+	if (!DWHCIDeviceTransferStageOnChannel (pThis, nChannel, pURB, bIn, bStatusStage))
 	{
-		pThis->m_bWaiting = FALSE;
-
 		return FALSE;
 	}
 
-	while (pThis->m_bWaiting)
+	// sleep until the completion routine notifies us, a notification
+	// left over from an earlier transfer just goes round the loop again
+	while (!Completion.m_bDone)
 	{
-		// do nothing
-		//portYIELD();
-		portYIELD_WITHIN_API();
+		ulTaskNotifyTake (pdTRUE, portMAX_DELAY);
 	}
 
 	return USBRequestGetStatus (pURB);
@@ -738,10 +759,21 @@ boolean DWHCIDeviceTransferStage (TDWHCIDevice *pThis, TUSBRequest *pURB, boolea
 
 void DWHCIDeviceCompletionRoutine (TUSBRequest *pURB, void *pParam, void *pContext)
 {
-	TDWHCIDevice *pThis = (TDWHCIDevice *) pContext;
-	assert (pThis != 0);
+	TDWHCICompletion *pCompletion = (TDWHCICompletion *) pParam;
+	assert (pCompletion != 0);
+
+	// called from the channel interrupt. the waiting task may return as
+	// soon as m_bDone is set, taking pCompletion with it
+	portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+	xTaskHandle hTask = (xTaskHandle) pCompletion->m_hTask;
+
+	pCompletion->m_bDone = TRUE;
+	vTaskNotifyGiveFromISR (hTask, &xHigherPriorityTaskWoken);
 
-	pThis->m_bWaiting = FALSE;
+	if (xHigherPriorityTaskWoken)
+	{
+		portYIELD_FROM_ISR ();
+	}
 }
 
 boolean DWHCIDeviceTransferStageAsync (TDWHCIDevice *pThis, TUSBRequest *pURB, boolean bIn, boolean bStatusStage)
@@ -749,14 +781,38 @@ boolean DWHCIDeviceTransferStageAsync (TDWHCIDevice *pThis, TUSBRequest *pURB, b
 	assert (pThis != 0);
 	assert (pURB != 0);
 	
-	unsigned nChannel = DWHCIDeviceAllocateChannel (pThis);
-	if (nChannel >= pThis->m_nChannels)
+	// may be called from a completion routine, so it does not wait. taking
+	// a token never wakes a task, nobody waits to give one. the FromISR
+	// call does not mask interrupts itself, and tasks submit with them
+	// enabled, so the token and the channel are taken with them disabled
+	portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+
+	uspi_EnterCritical ();
+
+	if (!xSemaphoreTakeFromISR ((xSemaphoreHandle) pThis->m_hChannelTokens, &xHigherPriorityTaskWoken))
 	{
+		uspi_LeaveCritical ();
+
 		return FALSE;
 	}
-	
+
+	unsigned nChannel = DWHCIDeviceAllocateChannel (pThis);
+	assert (nChannel < pThis->m_nChannels);
+
+	uspi_LeaveCritical ();
+
+	return DWHCIDeviceTransferStageOnChannel (pThis, nChannel, pURB, bIn, bStatusStage);
+}
+
+// nChannel has been allocated, and is freed again on failure
+boolean DWHCIDeviceTransferStageOnChannel (TDWHCIDevice *pThis, unsigned nChannel, TUSBRequest *pURB, boolean bIn, boolean bStatusStage)
+{
+	assert (pThis != 0);
+	assert (pURB != 0);
+	assert (nChannel < pThis->m_nChannels);
+
 	TDWHCITransferStageData *pStageData =
-		(TDWHCITransferStageData *) malloc (sizeof (TDWHCITransferStageData));
+		(TDWHCITransferStageData *) ObjectPoolAllocate (&DWHCIStageDataPool, sizeof (TDWHCITransferStageData));
 	assert (pStageData != 0);
 	DWHCITransferStageData (pStageData, nChannel, pURB, bIn, bStatusStage);
 
@@ -776,7 +832,7 @@ boolean DWHCIDeviceTransferStageAsync (TDWHCIDevice *pThis, TUSBRequest *pURB, b
 			DWHCIDeviceDisableChannelInterrupt (pThis, nChannel);
 
 			_DWHCITransferStageData (pStageData);
-			free (pStageData);
+			ObjectPoolFree (&DWHCIStageDataPool, pStageData);
 
 			pThis->m_pStageData[nChannel] = 0;
 			
@@ -867,7 +923,7 @@ void DWHCIDeviceStartChannel (TDWHCIDevice *pThis, TDWHCITransferStageData *pSta
 
 	uspi_CleanAndInvalidateDataCacheRange (DWHCITransferStageDataGetDMAAddress (pStageData),
 					       DWHCITransferStageDataGetBytesToTransfer (pStageData));
-	DataMemBarrier ();
+	DataSyncBarrier ();		// maintenance done before the channel starts
 
 	// set split control
 	TDWHCIRegister SplitControl;
@@ -975,7 +1031,7 @@ void DWHCIDeviceChannelInterruptHandler (TDWHCIDevice *pThis, unsigned nChannel)
 	case StageSubStateWaitForTransactionComplete: {
 		uspi_CleanAndInvalidateDataCacheRange (DWHCITransferStageDataGetDMAAddress (pStageData),
 						       DWHCITransferStageDataGetBytesToTransfer (pStageData));
-		DataMemBarrier ();
+		DataSyncBarrier ();
 
 		TDWHCIRegister TransferSize;
 		DWHCIRegister (&TransferSize, DWHCI_HOST_CHAN_XFER_SIZ (nChannel));
@@ -1044,7 +1100,7 @@ void DWHCIDeviceChannelInterruptHandler (TDWHCIDevice *pThis, unsigned nChannel)
 		DWHCIDeviceDisableChannelInterrupt (pThis, nChannel);
 	
 		_DWHCITransferStageData (pStageData);
-		free (pStageData);
+		ObjectPoolFree (&DWHCIStageDataPool, pStageData);
 		pThis->m_pStageData[nChannel] = 0;
 
 		DWHCIDeviceFreeChannel (pThis, nChannel);
@@ -1065,7 +1121,7 @@ void DWHCIDeviceChannelInterruptHandler (TDWHCIDevice *pThis, unsigned nChannel)
 			DWHCIDeviceDisableChannelInterrupt (pThis, nChannel);
 
 			_DWHCITransferStageData (pStageData);
-			free (pStageData);
+			ObjectPoolFree (&DWHCIStageDataPool, pStageData);
 			pThis->m_pStageData[nChannel] = 0;
 
 			DWHCIDeviceFreeChannel (pThis, nChannel);
@@ -1098,7 +1154,7 @@ void DWHCIDeviceChannelInterruptHandler (TDWHCIDevice *pThis, unsigned nChannel)
 			DWHCIDeviceDisableChannelInterrupt (pThis, nChannel);
 
 			_DWHCITransferStageData (pStageData);
-			free (pStageData);
+			ObjectPoolFree (&DWHCIStageDataPool, pStageData);
 			pThis->m_pStageData[nChannel] = 0;
 
 			DWHCIDeviceFreeChannel (pThis, nChannel);
@@ -1125,7 +1181,7 @@ void DWHCIDeviceChannelInterruptHandler (TDWHCIDevice *pThis, unsigned nChannel)
 				DWHCIDeviceDisableChannelInterrupt (pThis, nChannel);
 
 				_DWHCITransferStageData (pStageData);
-				free (pStageData);
+				ObjectPoolFree (&DWHCIStageDataPool, pStageData);
 				pThis->m_pStageData[nChannel] = 0;
 
 				DWHCIDeviceFreeChannel (pThis, nChannel);
@@ -1163,7 +1219,7 @@ void DWHCIDeviceChannelInterruptHandler (TDWHCIDevice *pThis, unsigned nChannel)
 		USBRequestSetStatus (pURB, 1);
 
 		_DWHCITransferStageData (pStageData);
-		free (pStageData);
+		ObjectPoolFree (&DWHCIStageDataPool, pStageData);
 		pThis->m_pStageData[nChannel] = 0;
 
 		DWHCIDeviceFreeChannel (pThis, nChannel);
@@ -1312,8 +1368,35 @@ void DWHCIDeviceFreeChannel (TDWHCIDevice *pThis, unsigned nChannel)
 	
 	assert (pThis->m_nChannelAllocated & nChannelMask);
 	pThis->m_nChannelAllocated &= ~nChannelMask;
+
+	// the token goes back with the channel, with interrupts still disabled
+	// as in DWHCIDeviceTransferStageAsync ()
+	portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+	xSemaphoreGiveFromISR ((xSemaphoreHandle) pThis->m_hChannelTokens, &xHigherPriorityTaskWoken);
 	
 	uspi_LeaveCritical ();
+
+	// wakes a task waiting for a channel in DWHCIDeviceTransferStage ().
+	// called from the channel interrupt, or from a task if a transfer
+	// could not be started, which may be inside a critical section. the
+	// task woken then runs on the next tick
+	if (xHigherPriorityTaskWoken)
+	{
+		if (portIS_INSIDE_INTERRUPT ())
+		{
+			portYIELD_FROM_ISR ();
+		}
+		else
+		{
+			u32 nFlags;
+			__asm volatile ("mrs %0, cpsr" : "=r" (nFlags));
+
+			if (!(nFlags & 0x80))		// interrupts enabled
+			{
+				portYIELD ();
+			}
+		}
+	}
 }
 
 boolean DWHCIDeviceWaitForBit (TDWHCIDevice *pThis, TDWHCIRegister *pRegister, u32 nMask, boolean bWaitUntilSet, unsigned nMsTimeout)
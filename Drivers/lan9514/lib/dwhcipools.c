@@ -0,0 +1,24 @@
+//
+// dwhcipools.c
+//
+// The object pools of the host controller driver, see dwhcipools.h.
+//
+#include <uspi/dwhcipools.h>
+#include <uspi/dwhcixferstagedata.h>
+#include <uspi/dwhciframeschedper.h>
+#include <uspi/dwhciframeschednper.h>
+#include <uspi/dwhciframeschednsplit.h>
+#include <uspi/usb.h>
+
+typedef union
+{
+	TDWHCIFrameSchedulerPeriodic	Periodic;
+	TDWHCIFrameSchedulerNonPeriodic	NonPeriodic;
+	TDWHCIFrameSchedulerNoSplit	NoSplit;
+}
+TDWHCIAnyFrameScheduler;
+
+DEFINE_OBJECT_POOL (DWHCIStageDataPool, sizeof (TDWHCITransferStageData), DWHCI_STAGE_DATA_POOL_SIZE);
+DEFINE_OBJECT_POOL (DWHCIFrameSchedulerPool, sizeof (TDWHCIAnyFrameScheduler), DWHCI_FRAME_SCHED_POOL_SIZE);
+DEFINE_OBJECT_POOL (DWHCITempBufferPool, sizeof (u32), DWHCI_TEMP_BUFFER_POOL_SIZE);
+DEFINE_OBJECT_POOL (DWHCISetupDataPool, sizeof (TSetupData), DWHCI_SETUP_DATA_POOL_SIZE);
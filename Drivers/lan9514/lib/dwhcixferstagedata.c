@@ -22,6 +22,7 @@
 #include <uspi/dwhciframeschednper.h>
 #include <uspi/dwhciframeschednsplit.h>
 #include <uspi/dwhci.h>
+#include <uspi/dwhcipools.h>
 #include <uspios.h>
 #include <uspi/assert.h>
 
@@ -91,7 +92,7 @@ void DWHCITransferStageData (TDWHCITransferStageData *pThis, unsigned nChannel,
 	else
 	{
 		assert (pThis->m_pTempBuffer == 0);
-		pThis->m_pTempBuffer = (u32 *) malloc (sizeof (u32));
+		pThis->m_pTempBuffer = (u32 *) ObjectPoolAllocate (&DWHCITempBufferPool, sizeof (u32));
 		assert (pThis->m_pTempBuffer != 0);
 		pThis->m_pBufferPointer = pThis->m_pTempBuffer;
 
@@ -108,12 +109,12 @@ void DWHCITransferStageData (TDWHCITransferStageData *pThis, unsigned nChannel,
 	{
 		if (DWHCITransferStageDataIsPeriodic (pThis))
 		{
-			pThis->m_pFrameScheduler = (TDWHCIFrameScheduler *) malloc (sizeof (TDWHCIFrameSchedulerPeriodic));
+			pThis->m_pFrameScheduler = (TDWHCIFrameScheduler *) ObjectPoolAllocate (&DWHCIFrameSchedulerPool, sizeof (TDWHCIFrameSchedulerPeriodic));
 			DWHCIFrameSchedulerPeriodic ((TDWHCIFrameSchedulerPeriodic *) pThis->m_pFrameScheduler);
 		}
 		else
 		{
-			pThis->m_pFrameScheduler = (TDWHCIFrameScheduler *) malloc (sizeof (TDWHCIFrameSchedulerNonPeriodic));
+			pThis->m_pFrameScheduler = (TDWHCIFrameScheduler *) ObjectPoolAllocate (&DWHCIFrameSchedulerPool, sizeof (TDWHCIFrameSchedulerNonPeriodic));
 			DWHCIFrameSchedulerNonPeriodic ((TDWHCIFrameSchedulerNonPeriodic *) pThis->m_pFrameScheduler);
 		}
 
@@ -124,7 +125,7 @@ void DWHCITransferStageData (TDWHCITransferStageData *pThis, unsigned nChannel,
 		if (   USBDeviceGetHubAddress (pThis->m_pDevice) == 0
 		    && pThis->m_Speed != USBSpeedHigh)
 		{
-			pThis->m_pFrameScheduler = (TDWHCIFrameScheduler *) malloc (sizeof (TDWHCIFrameSchedulerNoSplit));
+			pThis->m_pFrameScheduler = (TDWHCIFrameScheduler *) ObjectPoolAllocate (&DWHCIFrameSchedulerPool, sizeof (TDWHCIFrameSchedulerNoSplit));
 			DWHCIFrameSchedulerNoSplit ((TDWHCIFrameSchedulerNoSplit *) pThis->m_pFrameScheduler, DWHCITransferStageDataIsPeriodic (pThis));
 			assert (pThis->m_pFrameScheduler != 0);
 		}
@@ -138,7 +139,7 @@ void _DWHCITransferStageData (TDWHCITransferStageData *pThis)
 	if (pThis->m_pFrameScheduler != 0)
 	{
 		pThis->m_pFrameScheduler->_DWHCIFrameScheduler (pThis->m_pFrameScheduler);
-		free (pThis->m_pFrameScheduler);
+		ObjectPoolFree (&DWHCIFrameSchedulerPool, pThis->m_pFrameScheduler);
 		pThis->m_pFrameScheduler = 0;
 	}
 
@@ -146,7 +147,7 @@ void _DWHCITransferStageData (TDWHCITransferStageData *pThis)
 
 	if (pThis->m_pTempBuffer != 0)
 	{
-		free (pThis->m_pTempBuffer);
+		ObjectPoolFree (&DWHCITempBufferPool, pThis->m_pTempBuffer);
 		pThis->m_pTempBuffer = 0;
 	}
 
@@ -0,0 +1,154 @@
+//
+// objectpool.c
+//
+// Fixed-size object pools, see objectpool.h.
+//
+#include <uspi/objectpool.h>
+#include <uspios.h>
+#include <uspi/assert.h>
+
+#define HEAD_INDEX(head)		((head) & 0xFFFF)
+#define HEAD_NEXT_TAG(head)		(((head) + 0x10000) & 0xFFFF0000)
+
+static void ObjectPoolCountGet (TObjectPool *pThis)
+{
+	unsigned nInUse = __sync_add_and_fetch (&pThis->m_nInUse, 1);
+
+	unsigned nHighWater;
+	while ((nHighWater = pThis->m_nHighWater) < nInUse)
+	{
+		if (__sync_bool_compare_and_swap (&pThis->m_nHighWater, nHighWater, nInUse))
+		{
+			break;
+		}
+	}
+}
+
+void *ObjectPoolGet (TObjectPool *pThis)
+{
+	assert (pThis != 0);
+
+	u32 nHead, nNewHead;
+	unsigned nIndex;
+
+	do
+	{
+		nHead = pThis->m_nHead;
+		nIndex = HEAD_INDEX (nHead);
+		if (nIndex == OBJECT_POOL_NONE)
+		{
+			break;
+		}
+
+		// m_pNext[nIndex] is stale if the object has been taken meanwhile,
+		// but then the tag has moved on and the swap fails
+		nNewHead = HEAD_NEXT_TAG (nHead) | pThis->m_pNext[nIndex];
+	}
+	while (!__sync_bool_compare_and_swap (&pThis->m_nHead, nHead, nNewHead));
+
+	if (nIndex == OBJECT_POOL_NONE)
+	{
+		// the free list is empty, so take one that was never used
+		unsigned nUnused;
+		do
+		{
+			nUnused = pThis->m_nUnused;
+			if (nUnused >= pThis->m_nCount)
+			{
+				return 0;
+			}
+		}
+		while (!__sync_bool_compare_and_swap (&pThis->m_nUnused, nUnused, nUnused + 1));
+
+		nIndex = nUnused;
+	}
+
+	ObjectPoolCountGet (pThis);
+
+	return pThis->m_pStorage + nIndex * pThis->m_nStride;
+}
+
+void ObjectPoolPut (TObjectPool *pThis, void *pObject)
+{
+	assert (pThis != 0);
+	assert (ObjectPoolContains (pThis, pObject));
+
+	unsigned nIndex = ((u8 *) pObject - pThis->m_pStorage) / pThis->m_nStride;
+	u32 nHead;
+
+	do
+	{
+		nHead = pThis->m_nHead;
+		pThis->m_pNext[nIndex] = HEAD_INDEX (nHead);
+	}
+	while (!__sync_bool_compare_and_swap (&pThis->m_nHead, nHead, HEAD_NEXT_TAG (nHead) | nIndex));
+
+	__sync_sub_and_fetch (&pThis->m_nInUse, 1);
+}
+
+void *ObjectPoolAllocate (TObjectPool *pThis, unsigned nSize)
+{
+	assert (pThis != 0);
+	assert (nSize <= pThis->m_nStride);
+
+	void *pObject = ObjectPoolGet (pThis);
+	if (pObject == 0)
+	{
+		__sync_add_and_fetch (&pThis->m_nMisses, 1);
+
+		pObject = malloc (nSize);
+	}
+
+	return pObject;
+}
+
+void ObjectPoolFree (TObjectPool *pThis, void *pObject)
+{
+	assert (pThis != 0);
+
+	if (pObject == 0)
+	{
+		return;
+	}
+
+	if (ObjectPoolContains (pThis, pObject))
+	{
+		ObjectPoolPut (pThis, pObject);
+	}
+	else
+	{
+		free (pObject);
+	}
+}
+
+boolean ObjectPoolContains (TObjectPool *pThis, const void *pObject)
+{
+	assert (pThis != 0);
+
+	const u8 *pByte = (const u8 *) pObject;
+
+	return    pByte >= pThis->m_pStorage
+	       && pByte < pThis->m_pStorage + pThis->m_nStride * pThis->m_nCount
+	       && (pByte - pThis->m_pStorage) % pThis->m_nStride == 0;
+}
+
+unsigned ObjectPoolGetInUse (TObjectPool *pThis)
+{
+	assert (pThis != 0);
+
+	return pThis->m_nInUse;
+}
+
+unsigned ObjectPoolGetHighWater (TObjectPool *pThis)
+{
+	assert (pThis != 0);
+
+	return pThis->m_nHighWater;
+}
+
+unsigned ObjectPoolGetMisses (TObjectPool *pThis)
+{
+	assert (pThis != 0);
+
+	return pThis->m_nMisses;
+}
@@ -29,6 +29,7 @@
 #include <uspi/usbhostcontroller.h>
 #include <uspi/devicenameservice.h>
 #include <uspi/util.h>
+#include <uspi/synchronize.h>
 #include <uspi/assert.h>
 
 // USB vendor requests
@@ -43,6 +44,8 @@
 	#define TX_CFG_ON			0x00000004
 #define HW_CFG				0x14
 	#define HW_CFG_BIR			0x00001000
+	#define HW_CFG_MEF			0x00000020
+	#define HW_CFG_BCE			0x00000002
 #define RX_FIFO_INF			0x18
 #define PM_CTRL				0x20
 #define LED_GPIO_CFG			0x24
@@ -57,6 +60,7 @@
 #define GPIO_WAKE			0x64
 #define INT_EP_CTL			0x68
 #define BULK_IN_DLY			0x6C
+	#define BULK_IN_DLY_DEFAULT		0x00002000
 #define MAC_CR				0x100
 	#define MAC_CR_RCVOWN			0x00800000
 	#define MAC_CR_MCPAS			0x00080000
@@ -140,22 +144,21 @@ void SMSC951xDevice (TSMSC951xDevice *pThis, TUSBDevice *pDevice)
 
 	pThis->m_pEndpointBulkIn = 0;
 	pThis->m_pEndpointBulkOut = 0;
-	pThis->m_pTxBuffer = 0;
 
-	pThis->m_pTxBuffer = malloc (FRAME_BUFFER_SIZE);
-	assert (pThis->m_pTxBuffer != 0);
+	pThis->m_nRxHead = 0;
+	pThis->m_nRxTail = 0;
+	pThis->m_bRxActive = FALSE;
+	pThis->m_bBurst = FALSE;
+
+	pThis->m_nTxHead = 0;
+	pThis->m_nTxTail = 0;
+	pThis->m_bTxActive = FALSE;
 }
 
 void _SMSC951xDevice (TSMSC951xDevice *pThis)
 {
 	assert (pThis != 0);
 
-	if (pThis->m_pTxBuffer != 0)
-	{
-		free (pThis->m_pTxBuffer);
-		pThis->m_pTxBuffer = 0;
-	}
-	
 	if (pThis->m_pEndpointBulkOut != 0)
 	{
 		_USBEndpoint (pThis->m_pEndpointBulkOut);
@@ -291,6 +294,22 @@ boolean SMSC951xDeviceConfigure (TUSBDevice *pUSBDevice)
 		return FALSE;
 	}
 
+	// with HW_CFG_BIR the adapter NAKs a bulk-IN while it has no frame, and
+	// the host controller retries it by itself. otherwise it answers with a
+	// zero-length packet, and on an idle link every receive queued would
+	// complete empty at once, an interrupt and a wake of the receiving task
+	// in a loop
+	u32 nHWConfig;
+	if (   !SMSC951xDeviceReadReg (pThis, HW_CFG, &nHWConfig)
+	    || !SMSC951xDeviceWriteReg (pThis, HW_CFG, nHWConfig | HW_CFG_BIR))
+	{
+		LogWrite (FromSMSC951x, LOG_ERROR, "Cannot set bulk-in empty response");
+
+		_String (&MACString);
+
+		return FALSE;
+	}
+
 	if (   !SMSC951xDeviceWriteReg (pThis, LED_GPIO_CFG,   LED_GPIO_CFG_SPD_LED
 							     | LED_GPIO_CFG_LNK_LED
 							     | LED_GPIO_CFG_FDX_LED)
@@ -331,80 +350,353 @@ boolean SMSC951xDeviceSendFrame (TSMSC951xDevice *pThis, const void *pBuffer, un
 {
 	assert (pThis != 0);
 
-	if (nLength >= FRAME_BUFFER_SIZE-8)
+	if (nLength >= FRAME_BUFFER_SIZE-SMSC951X_TX_HEADROOM)
+	{
+		return FALSE;
+	}
+
+	// the caller's buffer has no room for the TX command words, so the frame
+	// is copied, see SMSC951xDeviceSendFrameAsync () for one that is not
+	u8 *pTxBuffer = (u8 *) malloc (nLength+SMSC951X_TX_HEADROOM);
+	if (pTxBuffer == 0)
 	{
 		return FALSE;
 	}
 
-	assert (pThis->m_pTxBuffer != 0);
 	assert (pBuffer != 0);
-	memcpy2 (pThis->m_pTxBuffer+8, pBuffer, nLength);
+	memcpy2 (pTxBuffer+SMSC951X_TX_HEADROOM, pBuffer, nLength);
 	
-	*(u32 *) &pThis->m_pTxBuffer[0] = TX_CMD_A_FIRST_SEG | TX_CMD_A_LAST_SEG | nLength;
-	*(u32 *) &pThis->m_pTxBuffer[4] = nLength;
+	*(u32 *) &pTxBuffer[0] = TX_CMD_A_FIRST_SEG | TX_CMD_A_LAST_SEG | nLength;
+	*(u32 *) &pTxBuffer[4] = nLength;
 	
 	assert (pThis->m_pEndpointBulkOut != 0);
 
-	return DWHCIDeviceTransfer (USBDeviceGetHost (&pThis->m_USBDevice), pThis->m_pEndpointBulkOut, pThis->m_pTxBuffer, nLength+8) >= 0;
+	boolean bOK = DWHCIDeviceTransfer (USBDeviceGetHost (&pThis->m_USBDevice), pThis->m_pEndpointBulkOut,
+					   pTxBuffer, nLength+SMSC951X_TX_HEADROOM) >= 0;
+
+	free (pTxBuffer);
+
+	return bOK;
 }
 
-boolean SMSC951xDeviceReceiveFrame (TSMSC951xDevice *pThis, void *pBuffer, unsigned *pResultLength)
+static void SMSC951xDeviceTxCompletionRoutine (TUSBRequest *pURB, void *pParam, void *pContext);
+
+// starts the oldest queued send, called with interrupts disabled. a send that
+// cannot be started is handed back as failed
+static void SMSC951xDeviceStartSend (TSMSC951xDevice *pThis)
 {
 	assert (pThis != 0);
 
-	assert (pThis->m_pEndpointBulkIn != 0);
-	assert (pBuffer != 0);
-	TUSBRequest URB;
-	USBRequest (&URB, pThis->m_pEndpointBulkIn, pBuffer, FRAME_BUFFER_SIZE, 0);
-
-	if (!DWHCIDeviceSubmitBlockingRequest (USBDeviceGetHost (&pThis->m_USBDevice), &URB))
+	while (!pThis->m_bTxActive && pThis->m_nTxTail != pThis->m_nTxHead)
 	{
-		_USBRequest (&URB);
+		TSMSC951xTxRequest *pRequest = &pThis->m_TxQueue[pThis->m_nTxTail % SMSC951X_TX_QUEUE_SIZE];
+
+		USBRequest (&pRequest->m_URB, pThis->m_pEndpointBulkOut,
+			    (u8 *) pRequest->m_pFrame - SMSC951X_TX_HEADROOM,
+			    pRequest->m_nLength + SMSC951X_TX_HEADROOM, 0);
+		USBRequestSetCompletionRoutine (&pRequest->m_URB, SMSC951xDeviceTxCompletionRoutine, pRequest, pThis);
+
+		pThis->m_bTxActive = TRUE;
+		if (DWHCIDeviceSubmitAsyncRequest (USBDeviceGetHost (&pThis->m_USBDevice), &pRequest->m_URB))
+		{
+			break;
+		}
+
+		// no free channel
+		pThis->m_bTxActive = FALSE;
+		pThis->m_nTxTail++;
+		_USBRequest (&pRequest->m_URB);
+
+		pRequest->m_pHandler (pRequest->m_pFrame, FALSE, pRequest->m_pParam);
+	}
+}
+
+static void SMSC951xDeviceTxCompletionRoutine (TUSBRequest *pURB, void *pParam, void *pContext)
+{
+	TSMSC951xDevice *pThis = (TSMSC951xDevice *) pContext;
+	assert (pThis != 0);
+	TSMSC951xTxRequest *pRequest = (TSMSC951xTxRequest *) pParam;
+	assert (pRequest != 0);
+
+	// called from the channel interrupt, as for receives
+	void *pFrame = pRequest->m_pFrame;
+	TSMSC951xFrameSentHandler *pHandler = pRequest->m_pHandler;
+	void *pHandlerParam = pRequest->m_pParam;
+	boolean bOK = USBRequestGetStatus (pURB);
+	_USBRequest (pURB);
+
+	pThis->m_nTxTail++;
+	pThis->m_bTxActive = FALSE;
+	SMSC951xDeviceStartSend (pThis);
+
+	pHandler (pFrame, bOK, pHandlerParam);
+}
 
+boolean SMSC951xDeviceSendFrameAsync (TSMSC951xDevice *pThis, void *pFrame, unsigned nLength,
+				      TSMSC951xFrameSentHandler *pHandler, void *pParam)
+{
+	assert (pThis != 0);
+
+	assert (pThis->m_pEndpointBulkOut != 0);
+	assert (pFrame != 0);
+	assert (((u32) pFrame & 3) == 0);
+	assert (pHandler != 0);
+
+	if (nLength >= FRAME_BUFFER_SIZE-SMSC951X_TX_HEADROOM)
+	{
 		return FALSE;
 	}
 
-	u32 nResultLength = USBRequestGetResultLength (&URB);
-	if (nResultLength < 4)				// should not happen with HW_CFG_BIR set
+	u32 *pCommand = (u32 *) ((u8 *) pFrame - SMSC951X_TX_HEADROOM);
+	pCommand[0] = TX_CMD_A_FIRST_SEG | TX_CMD_A_LAST_SEG | nLength;
+	pCommand[1] = nLength;
+
+	uspi_EnterCritical ();
+
+	if (pThis->m_nTxHead - pThis->m_nTxTail >= SMSC951X_TX_QUEUE_SIZE)
 	{
-		_USBRequest (&URB);
+		uspi_LeaveCritical ();
 
 		return FALSE;
 	}
 
+	TSMSC951xTxRequest *pRequest = &pThis->m_TxQueue[pThis->m_nTxHead % SMSC951X_TX_QUEUE_SIZE];
+	pRequest->m_pFrame = pFrame;
+	pRequest->m_nLength = nLength;
+	pRequest->m_pHandler = pHandler;
+	pRequest->m_pParam = pParam;
+	pThis->m_nTxHead++;
+
+	SMSC951xDeviceStartSend (pThis);
+
+	uspi_LeaveCritical ();
+
+	return TRUE;
+}
+
+// checks the RX status word in front of a received frame, which stays where
+// it is. returns the frame length without CRC or 0 if the frame is bad
+static unsigned SMSC951xDeviceTakeFrame (void *pBuffer, u32 nResultLength)
+{
+	if (nResultLength < SMSC951X_RX_STATUS_SIZE)	// should not happen with HW_CFG_BIR set
+	{
+		return 0;
+	}
+
 	u32 nRxStatus = *(u32 *) pBuffer;
 	if (nRxStatus & RX_STS_ERROR)
 	{
 		LogWrite (FromSMSC951x, LOG_WARNING, "RX error (status 0x%X)", nRxStatus);
 
-		_USBRequest (&URB);
-
-		return FALSE;
+		return 0;
 	}
 	
 	u32 nFrameLength = RX_STS_FRAMELEN (nRxStatus);
-	assert (nFrameLength == nResultLength-4);
+	assert (nFrameLength == nResultLength-SMSC951X_RX_STATUS_SIZE);
 	assert (nFrameLength > 4);
 	if (nFrameLength <= 4)
+	{
+		return 0;
+	}
+	nFrameLength -= 4;	// ignore CRC
+
+	//LogWrite (FromSMSC951x, LOG_DEBUG, "Frame received (status 0x%X)", nRxStatus);
+
+	return nFrameLength;
+}
+
+boolean SMSC951xDeviceReceiveFrame (TSMSC951xDevice *pThis, void *pBuffer, unsigned *pResultLength)
+{
+	assert (pThis != 0);
+
+	assert (pThis->m_pEndpointBulkIn != 0);
+	assert (!pThis->m_bBurst);
+	assert (pBuffer != 0);
+	TUSBRequest URB;
+	USBRequest (&URB, pThis->m_pEndpointBulkIn, pBuffer, FRAME_BUFFER_SIZE, 0);
+
+	if (!DWHCIDeviceSubmitBlockingRequest (USBDeviceGetHost (&pThis->m_USBDevice), &URB))
 	{
 		_USBRequest (&URB);
 
 		return FALSE;
 	}
-	nFrameLength -= 4;	// ignore CRC
 
-	//LogWrite (FromSMSC951x, LOG_DEBUG, "Frame received (status 0x%X)", nRxStatus);
+	unsigned nFrameLength = SMSC951xDeviceTakeFrame (pBuffer, USBRequestGetResultLength (&URB));
+	_USBRequest (&URB);
 
-	memcpy2 (pBuffer, (u8 *) pBuffer + 4, nFrameLength);	// overwrite RX status
+	if (nFrameLength == 0)
+	{
+		return FALSE;
+	}
+
+	// this interface returns the frame at pBuffer, see SMSC951xDeviceReceiveFrameAsync ()
+	// for one that does not copy
+	memcpy2 (pBuffer, (u8 *) pBuffer + SMSC951X_RX_STATUS_SIZE, nFrameLength);	// overwrite RX status
 
 	assert (pResultLength != 0);
 	*pResultLength = nFrameLength;
-	
-	_USBRequest (&URB);
 
 	return TRUE;
 }
 
+static void SMSC951xDeviceRxCompletionRoutine (TUSBRequest *pURB, void *pParam, void *pContext);
+
+// starts the oldest queued receive, called with interrupts disabled. a
+// receive that cannot be started is handed back with length 0
+static void SMSC951xDeviceStartReceive (TSMSC951xDevice *pThis)
+{
+	assert (pThis != 0);
+
+	while (!pThis->m_bRxActive && pThis->m_nRxTail != pThis->m_nRxHead)
+	{
+		TSMSC951xRxRequest *pRequest = &pThis->m_RxQueue[pThis->m_nRxTail % SMSC951X_RX_QUEUE_SIZE];
+
+		USBRequest (&pRequest->m_URB, pThis->m_pEndpointBulkIn, pRequest->m_pBuffer,
+			    pThis->m_bBurst ? SMSC951X_BURST_BUFFER_SIZE : FRAME_BUFFER_SIZE, 0);
+		USBRequestSetCompletionRoutine (&pRequest->m_URB, SMSC951xDeviceRxCompletionRoutine, pRequest, pThis);
+
+		pThis->m_bRxActive = TRUE;
+		if (DWHCIDeviceSubmitAsyncRequest (USBDeviceGetHost (&pThis->m_USBDevice), &pRequest->m_URB))
+		{
+			break;
+		}
+
+		// no free channel
+		pThis->m_bRxActive = FALSE;
+		pThis->m_nRxTail++;
+		_USBRequest (&pRequest->m_URB);
+
+		// the handler gets the buffer back as it was queued, as on completion
+		if (pThis->m_bBurst)
+		{
+			pRequest->m_pHandler (pRequest->m_pBuffer, 0, pRequest->m_pParam);
+		}
+		else
+		{
+			pRequest->m_pHandler ((u8 *) pRequest->m_pBuffer + SMSC951X_RX_STATUS_SIZE, 0, pRequest->m_pParam);
+		}
+	}
+}
+
+static void SMSC951xDeviceRxCompletionRoutine (TUSBRequest *pURB, void *pParam, void *pContext)
+{
+	TSMSC951xDevice *pThis = (TSMSC951xDevice *) pContext;
+	assert (pThis != 0);
+	TSMSC951xRxRequest *pRequest = (TSMSC951xRxRequest *) pParam;
+	assert (pRequest != 0);
+
+	// called from the channel interrupt. the next receive goes to the
+	// controller before this frame is looked at, so it is ready sooner
+	void *pBuffer = pRequest->m_pBuffer;
+	TSMSC951xFrameHandler *pHandler = pRequest->m_pHandler;
+	void *pHandlerParam = pRequest->m_pParam;
+	boolean bOK = USBRequestGetStatus (pURB);
+	u32 nResultLength = USBRequestGetResultLength (pURB);
+	_USBRequest (pURB);
+
+	pThis->m_nRxTail++;
+	pThis->m_bRxActive = FALSE;
+	SMSC951xDeviceStartReceive (pThis);
+
+	if (pThis->m_bBurst)
+	{
+		pHandler (pBuffer, bOK ? nResultLength : 0, pHandlerParam);
+
+		return;
+	}
+
+	pHandler ((u8 *) pBuffer + SMSC951X_RX_STATUS_SIZE,
+		  bOK ? SMSC951xDeviceTakeFrame (pBuffer, nResultLength) : 0, pHandlerParam);
+}
+
+boolean SMSC951xDeviceReceiveFrameAsync (TSMSC951xDevice *pThis, void *pBuffer,
+					 TSMSC951xFrameHandler *pHandler, void *pParam)
+{
+	assert (pThis != 0);
+
+	assert (pThis->m_pEndpointBulkIn != 0);
+	assert (pBuffer != 0);
+	assert (pHandler != 0);
+
+	uspi_EnterCritical ();
+
+	if (pThis->m_nRxHead - pThis->m_nRxTail >= SMSC951X_RX_QUEUE_SIZE)
+	{
+		uspi_LeaveCritical ();
+
+		return FALSE;
+	}
+
+	TSMSC951xRxRequest *pRequest = &pThis->m_RxQueue[pThis->m_nRxHead % SMSC951X_RX_QUEUE_SIZE];
+	pRequest->m_pBuffer = pBuffer;
+	pRequest->m_pHandler = pHandler;
+	pRequest->m_pParam = pParam;
+	pThis->m_nRxHead++;
+
+	SMSC951xDeviceStartReceive (pThis);
+
+	uspi_LeaveCritical ();
+
+	return TRUE;
+}
+
+boolean SMSC951xDeviceEnableBurst (TSMSC951xDevice *pThis)
+{
+	assert (pThis != 0);
+	assert (pThis->m_nRxHead == pThis->m_nRxTail);
+
+	// as the Linux driver for high speed: BURST_CAP counts 512 byte packets,
+	// and the adapter ends a burst early once no frame came for BULK_IN_DLY
+	u32 nHWConfig;
+	if (   !SMSC951xDeviceWriteReg (pThis, BURST_CAP, SMSC951X_BURST_BUFFER_SIZE / 512)
+	    || !SMSC951xDeviceWriteReg (pThis, BULK_IN_DLY, BULK_IN_DLY_DEFAULT)
+	    || !SMSC951xDeviceReadReg (pThis, HW_CFG, &nHWConfig)
+	    || !SMSC951xDeviceWriteReg (pThis, HW_CFG, nHWConfig | HW_CFG_MEF | HW_CFG_BCE))
+	{
+		LogWrite (FromSMSC951x, LOG_ERROR, "Cannot enable burst mode");
+
+		return FALSE;
+	}
+
+	pThis->m_bBurst = TRUE;
+
+	return TRUE;
+}
+
+void *SMSC951xGetBurstFrame (void *pBuffer, unsigned nLength, unsigned *pOffset, unsigned *pFrameLength)
+{
+	assert (pBuffer != 0);
+	assert (pOffset != 0);
+	assert (pFrameLength != 0);
+
+	u8 *pBurst = (u8 *) pBuffer;
+	while (*pOffset + SMSC951X_RX_STATUS_SIZE <= nLength)
+	{
+		unsigned nOffset = *pOffset;
+		u32 nFrameLength = RX_STS_FRAMELEN (*(u32 *) &pBurst[nOffset]);
+		if (nFrameLength > nLength - nOffset - SMSC951X_RX_STATUS_SIZE)
+		{
+			LogWrite (FromSMSC951x, LOG_WARNING, "Burst truncated");
+
+			break;
+		}
+
+		// the next status word is at the next 4-byte boundary
+		*pOffset = nOffset + ((SMSC951X_RX_STATUS_SIZE + nFrameLength + 3) & ~3);
+
+		*pFrameLength = SMSC951xDeviceTakeFrame (&pBurst[nOffset], SMSC951X_RX_STATUS_SIZE + nFrameLength);
+		if (*pFrameLength != 0)
+		{
+			return &pBurst[nOffset + SMSC951X_RX_STATUS_SIZE];
+		}
+	}
+
+	*pOffset = nLength;
+
+	return 0;
+}
+
 boolean SMSC951xDeviceWriteReg (TSMSC951xDevice *pThis, u32 nIndex, u32 nValue)
 {
 	assert (pThis != 0);
@@ -90,6 +90,42 @@ void uspi_CleanAndInvalidateDataCacheRange (u32 nAddress, u32 nLength)
 	}
 }
 
+void uspi_CleanDataCacheRange (u32 nAddress, u32 nLength)
+{
+	nLength += DATA_CACHE_LINE_LENGTH;
+
+	while (1)
+	{
+		__asm volatile ("mcr p15, 0, %0, c7, c10,  1" : : "r" (nAddress) : "memory");
+
+		if (nLength < DATA_CACHE_LINE_LENGTH)
+		{
+			break;
+		}
+
+		nAddress += DATA_CACHE_LINE_LENGTH;
+		nLength  -= DATA_CACHE_LINE_LENGTH;
+	}
+}
+
+void uspi_InvalidateDataCacheRange (u32 nAddress, u32 nLength)
+{
+	nLength += DATA_CACHE_LINE_LENGTH;
+
+	while (1)
+	{
+		__asm volatile ("mcr p15, 0, %0, c7, c6,   1" : : "r" (nAddress) : "memory");
+
+		if (nLength < DATA_CACHE_LINE_LENGTH)
+		{
+			break;
+		}
+
+		nAddress += DATA_CACHE_LINE_LENGTH;
+		nLength  -= DATA_CACHE_LINE_LENGTH;
+	}
+}
+
 #else
 
 //
@@ -126,4 +162,40 @@ void uspi_CleanAndInvalidateDataCacheRange (u32 nAddress, u32 nLength)
 	}
 }
 
+void uspi_CleanDataCacheRange (u32 nAddress, u32 nLength)
+{
+	nLength += DATA_CACHE_LINE_LENGTH_MIN;
+
+	while (1)
+	{
+		__asm volatile ("mcr p15, 0, %0, c7, c10,  1" : : "r" (nAddress) : "memory");	// DCCMVAC
+
+		if (nLength < DATA_CACHE_LINE_LENGTH_MIN)
+		{
+			break;
+		}
+
+		nAddress += DATA_CACHE_LINE_LENGTH_MIN;
+		nLength  -= DATA_CACHE_LINE_LENGTH_MIN;
+	}
+}
+
+void uspi_InvalidateDataCacheRange (u32 nAddress, u32 nLength)
+{
+	nLength += DATA_CACHE_LINE_LENGTH_MIN;
+
+	while (1)
+	{
+		__asm volatile ("mcr p15, 0, %0, c7, c6,   1" : : "r" (nAddress) : "memory");	// DCIMVAC
+
+		if (nLength < DATA_CACHE_LINE_LENGTH_MIN)
+		{
+			break;
+		}
+
+		nAddress += DATA_CACHE_LINE_LENGTH_MIN;
+		nLength  -= DATA_CACHE_LINE_LENGTH_MIN;
+	}
+}
+
 #endif
@@ -25,6 +25,26 @@
 #include <uspi/util.h>
 #include <uspi/assert.h>
 
+#if USPI_RX_QUEUE_SIZE != SMSC951X_RX_QUEUE_SIZE
+	#error USPI_RX_QUEUE_SIZE must be SMSC951X_RX_QUEUE_SIZE
+#endif
+
+#if USPI_RX_HEADROOM != SMSC951X_RX_STATUS_SIZE
+	#error USPI_RX_HEADROOM must be SMSC951X_RX_STATUS_SIZE
+#endif
+
+#if USPI_BURST_BUFFER_SIZE != SMSC951X_BURST_BUFFER_SIZE
+	#error USPI_BURST_BUFFER_SIZE must be SMSC951X_BURST_BUFFER_SIZE
+#endif
+
+#if USPI_TX_QUEUE_SIZE != SMSC951X_TX_QUEUE_SIZE
+	#error USPI_TX_QUEUE_SIZE must be SMSC951X_TX_QUEUE_SIZE
+#endif
+
+#if USPI_TX_HEADROOM != SMSC951X_TX_HEADROOM
+	#error USPI_TX_HEADROOM must be SMSC951X_TX_HEADROOM
+#endif
+
 static const char FromUSPi[] = "uspi";
 
 static TUSPiLibrary *s_pLibrary = 0;
@@ -214,6 +234,13 @@ int USPiSendFrame (const void *pBuffer, unsigned nLength)
 	return SMSC951xDeviceSendFrame (s_pLibrary->pEth0, pBuffer, nLength) ? 1 : 0;
 }
 
+int USPiSendFrameAsync (void *pFrame, unsigned nLength, TUSPiFrameSentHandler *pHandler, void *pParam)
+{
+	assert (s_pLibrary != 0);
+	assert (s_pLibrary->pEth0 != 0);
+	return SMSC951xDeviceSendFrameAsync (s_pLibrary->pEth0, pFrame, nLength, pHandler, pParam) ? 1 : 0;
+}
+
 int USPiReceiveFrame (void *pBuffer, unsigned *pResultLength)
 {
 	assert (s_pLibrary != 0);
@@ -221,6 +248,25 @@ int USPiReceiveFrame (void *pBuffer, unsigned *pResultLength)
 	return SMSC951xDeviceReceiveFrame (s_pLibrary->pEth0, pBuffer, pResultLength) ? 1 : 0;
 }
 
+int USPiReceiveFrameAsync (void *pBuffer, TUSPiFrameReceivedHandler *pHandler, void *pParam)
+{
+	assert (s_pLibrary != 0);
+	assert (s_pLibrary->pEth0 != 0);
+	return SMSC951xDeviceReceiveFrameAsync (s_pLibrary->pEth0, pBuffer, pHandler, pParam) ? 1 : 0;
+}
+
+int USPiEnableReceiveBurst (void)
+{
+	assert (s_pLibrary != 0);
+	assert (s_pLibrary->pEth0 != 0);
+	return SMSC951xDeviceEnableBurst (s_pLibrary->pEth0) ? 1 : 0;
+}
+
+void *USPiGetBurstFrame (void *pBuffer, unsigned nLength, unsigned *pOffset, unsigned *pFrameLength)
+{
+	return SMSC951xGetBurstFrame (pBuffer, nLength, pOffset, pFrameLength);
+}
+
 int USPiGamePadAvailable (void)
 {
 	assert (s_pLibrary != 0);
@@ -23,6 +23,7 @@
 #include <video.h>
 #include <mailbox.h>
 #include <mem.h>
+#include <mmu.h>
 
 __attribute__((no_instrument_function))
 void MsDelay (unsigned nMilliSeconds){
@@ -56,55 +57,53 @@ void ConnectInterrupt (unsigned nIRQ, FN_INTERRUPT_HANDLER pfnHandler, void *pPa
 	//EnableInterrupts();
 }
 
+//the USB and ethernet bring up runs in a task, so these sleep until the
+//firmware answers.  a few tries, as the first one is sometimes refused
+#define PROPERTY_ATTEMPTS	5
+
 int SetPowerStateOn (unsigned nDeviceId){
-	unsigned int mailbuffer[8] __attribute__((aligned (16)));
-
-	//set power state
-	mailbuffer[0] = 8 * 4;		//mailbuffer size
-	mailbuffer[1] = 0;			//response code
-	mailbuffer[2] = 0x00028001;	//set power state
-	mailbuffer[3] = 8;			//value buffer size
-	mailbuffer[4] = 8;			//Req. + value length (bytes)
-	mailbuffer[5] = nDeviceId;	//device id 3
-	mailbuffer[6] = 3;			//state
-	mailbuffer[7] = 0;			//terminate buffer
-
-	//spam mail until the response code is ok
-	while(mailbuffer[1] != 0x80000000){
-		mailboxWrite((int)mailbuffer, 8);
-		mailboxRead(8);
+	static unsigned int mailbuffer[8] MMU_COHERENT __attribute__((aligned (16)));
+	PropertyMessage message;
+	unsigned int *value;
+	int attempts;
+
+	for(attempts = 0; attempts < PROPERTY_ATTEMPTS; attempts++){
+		PropertyInit(&message, mailbuffer, 8);
+		value = PropertyAddTag(&message, PROPERTY_TAG_SET_POWER_STATE, 8, 8);
+		value[0] = nDeviceId;	//device id 3
+		value[1] = 3;			//state: on, and wait
+
+		if(PropertyCall(&message) == PROPERTY_OK) break;
 	}
 
-	if(!(mailbuffer[6] & 1) || (mailbuffer[6] & 2)) return 0;
+	value = PropertyGetTag(&message, PROPERTY_TAG_SET_POWER_STATE);
+	if(!value || !(value[1] & 1) || (value[1] & 2)) return 0;
 	return 1;
 }
 
 int GetMACAddress (unsigned char Buffer[6]){
-	unsigned int mailbuffer[7] __attribute__((aligned (16)));
-
-	//get MAC
-	mailbuffer[0] = 8 * 4;		//mailbuffer size
-	mailbuffer[1] = 0;			//response code
-	mailbuffer[2] = 0x00010003;	//get mac
-	mailbuffer[3] = 6;			//value buffer size
-	mailbuffer[4] = 6;			//Req. + value length (bytes)
-	mailbuffer[5] = 0;			//12 34 56 AB
-	mailbuffer[6] = 0;			//12 34 00 00
-	mailbuffer[7] = 0;			//terminate buffer
-
-	//spam mail until the response code is ok
-	while(mailbuffer[1] != 0x80000000){
-		mailboxWrite((int)mailbuffer, 8);
-		mailboxRead(8);
+	static unsigned int mailbuffer[8] MMU_COHERENT __attribute__((aligned (16)));
+	PropertyMessage message;
+	unsigned int *value;
+	int attempts;
+
+	for(attempts = 0; attempts < PROPERTY_ATTEMPTS; attempts++){
+		PropertyInit(&message, mailbuffer, 8);
+		PropertyAddTag(&message, PROPERTY_TAG_GET_MAC_ADDRESS, 6, 0);
+
+		if(PropertyCall(&message) == PROPERTY_OK) break;
 	}
 
-	//memcpy2(Buffer, *(&mailbuffer + 24), 6);
-	Buffer[0] = (char)(mailbuffer[5] >> 0);
-	Buffer[1] = (char)(mailbuffer[5] >> 8);
-	Buffer[2] = (char)(mailbuffer[5] >> 16);
-	Buffer[3] = (char)(mailbuffer[5] >> 24);
-	Buffer[4] = (char)(mailbuffer[6] >> 0);
-	Buffer[5] = (char)(mailbuffer[6] >> 8);
+	value = PropertyGetTag(&message, PROPERTY_TAG_GET_MAC_ADDRESS);
+	if(!value) return 0;
+
+	//12 34 56 AB, 12 34 00 00
+	Buffer[0] = (char)(value[0] >> 0);
+	Buffer[1] = (char)(value[0] >> 8);
+	Buffer[2] = (char)(value[0] >> 16);
+	Buffer[3] = (char)(value[0] >> 24);
+	Buffer[4] = (char)(value[1] >> 0);
+	Buffer[5] = (char)(value[1] >> 8);
 
 	return 1;
 }
@@ -136,17 +135,39 @@ void DebugHexdump (const void *pBuffer, unsigned nBufLen, const char *pSource){
 
 #endif
 
+//USPi's buffers go to the USB DMA engine, with the data cache cleaned and
+//invalidated around each transfer (see dwhcidevice.c).  a buffer sharing a
+//cache line with a heap header or another block could have its data
+//overwritten when the line is cleaned, so each block starts a cache line of
+//its own and is padded to the end of its last one.  the network buffers
+//and receive bursts of NetworkInterface.c come from here too, as the DMA
+//writes them.  the word before the block holds the address pvPortMalloc()
+//returned
 void* malloc(unsigned nSize){
+	unsigned nLines = (nSize + MMU_CACHE_LINE_SIZE - 1) & ~(MMU_CACHE_LINE_SIZE - 1);
+	unsigned char* pRaw;
+	void** pBlock = 0;
+
 	uspi_EnterCritical();
 //if(loaded == 2) println("malloc", 0xFFFFFFFF);
-	void* temp = pvPortMalloc(nSize);
+#if ( configUSE_HEAP_STATS == 1 )
+	//count the block against the USPi function asking for it, not this one
+	vHeapStatsSetCaller(__builtin_return_address(0));
+#endif
+	pRaw = pvPortMalloc(nLines + MMU_CACHE_LINE_SIZE + sizeof(void*));
 	uspi_LeaveCritical();
-	return temp;
 
+	if(pRaw != 0){
+		pBlock = (void**)(((unsigned long)pRaw + sizeof(void*) + MMU_CACHE_LINE_SIZE - 1) & ~(MMU_CACHE_LINE_SIZE - 1));
+		pBlock[-1] = pRaw;
+	}
+	return pBlock;
 }
 
 void free(void* pBlock){
+	if(pBlock == 0) return;
+
 	uspi_EnterCritical();
-	vPortFree(pBlock);
+	vPortFree(((void**)pBlock)[-1]);
 	uspi_LeaveCritical();
 }
\ No newline at end of file
@@ -0,0 +1,216 @@
+//logring.c
+//
+//the console's line queue, see logring.h
+//
+//any number of tasks and interrupts, on any core, write into the slots, and
+//the render task alone reads them.  each slot has a sequence number saying
+//whose turn it is: a writer claims position p by moving the head from p to
+//p + 1 (compare and swap, retried if another writer got there first) when
+//the slot's sequence is p, and hands the line over by setting it to p + 1.
+//the reader takes the line once the sequence is p + 1, and gives the slot
+//back to the writers of the next lap by setting it to p + LOG_RING_SLOTS.
+//a writer finding the sequence still at p - LOG_RING_SLOTS + 1 has lapped
+//the reader, so the ring is full and the line is dropped
+//
+//nothing here waits for anything, so a writer interrupted half way through
+//costs its interrupt nothing more than the next slot.  the lines behind it
+//wait until it is resumed
+//
+//the render task sleeps on its notification once it finds the ring empty.
+//the writer handing over the line at the tail, the one it is waiting for,
+//wakes it.  the writer stores the sequence before it loads the tail, and
+//the reader stores the tail before it loads the next sequence, so either
+//the reader sees the line or the writer sees the reader waiting for it
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include "logring.h"
+
+#if ( LOG_RING_SLOTS & ( LOG_RING_SLOTS - 1 ) ) != 0
+	#error LOG_RING_SLOTS must be a power of two.
+#endif
+
+#define LOG_RING_MASK			( LOG_RING_SLOTS - 1 )
+
+#define LOG_RING_STACK_SIZE		256
+
+typedef struct {
+	volatile unsigned long ulSequence;
+	int iColour;
+	char cLine[LOG_RING_LINE_LENGTH];
+} LogRingSlot;
+
+static LogRingSlot xSlots[LOG_RING_SLOTS];
+
+static volatile unsigned long ulHead;		//next position to claim
+static volatile unsigned long ulTail;		//next position to render, written by the reader alone
+static volatile unsigned long ulDropped;
+
+static LogRingRenderer pfnRenderer;
+static volatile int iRunning = 0;
+static xTaskHandle xRenderTask = NULL;
+
+//wakes the render task, from a task or an interrupt.  before the scheduler
+//starts there is nothing to wake, the task looks at the ring when it first
+//runs
+__attribute__((no_instrument_function))
+static void LogRingWake(void) {
+	portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+
+	if(xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED) {
+		return;
+	}
+
+	if(portIS_INSIDE_INTERRUPT()) {
+		vTaskNotifyGiveFromISR(xRenderTask, &xHigherPriorityTaskWoken);
+		if(xHigherPriorityTaskWoken) {
+			portYIELD_FROM_ISR();
+		}
+	} else {
+		xTaskNotifyGive(xRenderTask);
+	}
+}
+
+__attribute__((no_instrument_function))
+int LogRingWrite(const char *line, int colour) {
+	unsigned long ulPosition = ulHead;
+	LogRingSlot *pxSlot;
+	long lLap;
+	int i;
+
+	for(;;) {
+		pxSlot = &xSlots[ulPosition & LOG_RING_MASK];
+		lLap = (long) (pxSlot->ulSequence - ulPosition);
+
+		if(lLap == 0) {
+			if(__sync_bool_compare_and_swap(&ulHead, ulPosition, ulPosition + 1)) {
+				break;
+			}
+		} else if(lLap < 0) {
+			__sync_add_and_fetch(&ulDropped, 1);
+			return 0;
+		}
+		//another writer claimed it first
+		ulPosition = ulHead;
+	}
+
+	for(i = 0; i < LOG_RING_LINE_LENGTH - 1 && line[i] != '\0'; i++) {
+		pxSlot->cLine[i] = line[i];
+	}
+	pxSlot->cLine[i] = '\0';
+	pxSlot->iColour = colour;
+
+	//the line is in the slot before the reader can see it is
+	__sync_synchronize();
+	pxSlot->ulSequence = ulPosition + 1;
+
+	//the ring was empty up to this line, so the reader may be asleep
+	__sync_synchronize();
+	if(ulTail == ulPosition) {
+		LogRingWake();
+	}
+	return 1;
+}
+
+//copies the oldest line out and frees its slot, or returns 0 if there is
+//none ready
+__attribute__((no_instrument_function))
+static int LogRingRead(char *line, int *pColour) {
+	LogRingSlot *pxSlot = &xSlots[ulTail & LOG_RING_MASK];
+	int i;
+
+	if(pxSlot->ulSequence != ulTail + 1) {
+		return 0;
+	}
+	__sync_synchronize();
+
+	for(i = 0; i < LOG_RING_LINE_LENGTH && (line[i] = pxSlot->cLine[i]) != '\0'; i++) {
+		;
+	}
+	*pColour = pxSlot->iColour;
+
+	__sync_synchronize();
+	pxSlot->ulSequence = ulTail + LOG_RING_SLOTS;
+	ulTail++;
+
+	//the next sequence is loaded after the tail is stored, see the top
+	__sync_synchronize();
+	return 1;
+}
+
+__attribute__((no_instrument_function))
+static void LogRingTask(void *pvParameters) {
+	char cLine[LOG_RING_LINE_LENGTH];
+	char cDropped[] = "LOG dropped 0x00000000 lines";
+	const char cHex[] = "0123456789ABCDEF";
+	unsigned long ulReported = 0, ulNow;
+	int iColour, i;
+
+	(void) pvParameters;
+
+	for(;;) {
+		while(LogRingRead(cLine, &iColour)) {
+			pfnRenderer(cLine, iColour);
+		}
+
+		ulNow = ulDropped;
+		if(ulNow != ulReported) {
+			for(i = 0; i < 8; i++) {
+				cDropped[14 + i] = cHex[((ulNow - ulReported) >> (28 - 4 * i)) & 0xF];
+			}
+			pfnRenderer(cDropped, 0xFFFF0000);
+			ulReported = ulNow;
+		}
+
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+	}
+}
+
+__attribute__((no_instrument_function))
+void LogRingStart(LogRingRenderer pfnRender, unsigned long ulPriority) {
+	unsigned long i;
+
+	if(iRunning) {
+		return;
+	}
+
+	for(i = 0; i < LOG_RING_SLOTS; i++) {
+		xSlots[i].ulSequence = i;
+	}
+	ulHead = 0;
+	ulTail = 0;
+	pfnRenderer = pfnRender;
+
+	if(xTaskCreate(LogRingTask, "console", LOG_RING_STACK_SIZE, NULL, ulPriority, &xRenderTask) == pdPASS) {
+		__sync_synchronize();
+		iRunning = 1;
+	}
+}
+
+//for when the scheduler has stopped, and the render task with it
+__attribute__((no_instrument_function))
+void LogRingStop(void) {
+	char cLine[LOG_RING_LINE_LENGTH];
+	int iColour;
+
+	if(!iRunning) {
+		return;
+	}
+	iRunning = 0;
+	__sync_synchronize();
+
+	while(LogRingRead(cLine, &iColour)) {
+		pfnRenderer(cLine, iColour);
+	}
+}
+
+__attribute__((no_instrument_function))
+int LogRingRunning(void) {
+	return iRunning;
+}
+
+__attribute__((no_instrument_function))
+unsigned long LogRingDropped(void) {
+	return ulDropped;
+}
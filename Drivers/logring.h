@@ -0,0 +1,37 @@
+#ifndef _LOGRING_H_
+#define _LOGRING_H_
+
+/* The console's line queue.  println() and printHex() only copy their line
+ * into a slot, so tasks and interrupts never wait for the screen.  A task of
+ * low priority takes the lines out in order and hands them to the renderer.
+ * Lines that find the queue full are dropped and counted, and the renderer
+ * is told how many went missing. */
+
+/* Lines that can wait to be rendered.  Must be a power of two. */
+#ifndef LOG_RING_SLOTS
+	#define LOG_RING_SLOTS			64
+#endif
+
+/* Longest line kept, with its terminator.  Longer ones are cut short. */
+#ifndef LOG_RING_LINE_LENGTH
+	#define LOG_RING_LINE_LENGTH	120
+#endif
+
+typedef void (*LogRingRenderer)(const char *line, int colour);
+
+/* Creates the render task.  Until it is called LogRingRunning() is 0, and
+ * the console should render lines itself. */
+void LogRingStart		(LogRingRenderer pfnRender, unsigned long ulPriority);
+int LogRingRunning		(void);
+
+/* Renders the lines still queued and goes back to LogRingRunning() being 0.
+ * Only once the scheduler has stopped, as on the simulator. */
+void LogRingStop		(void);
+
+/* Queues a line from a task or an interrupt, in constant time.  Returns 0
+ * if it was dropped. */
+int LogRingWrite		(const char *line, int colour);
+
+unsigned long LogRingDropped	(void);
+
+#endif
@@ -3,7 +3,12 @@
 //
 //These functions are used for communications between the CPU and GPU
 
+#include <FreeRTOS.h>
+#include <task.h>
 #include <mailbox.h>
+#include <mmu.h>
+#include <interrupts.h>
+#include <bcm2835_intc.h>
 
 //direct memory get and set
 extern void PUT32(int dest, int src);
@@ -13,8 +18,62 @@ extern int GET32(int src);
 //mailbuffer should probably be 16 byte aligned (for gpu at least):
 //unsigned int mailbuffer[22] __attribute__((aligned (16)));
 //https://github.com/raspberrypi/firmware/wiki/Mailbox-property-interface
+//
+//with the data cache on, the buffer should be MMU_COHERENT (see mmu.h).  a
+//property buffer anywhere else is cleaned here and invalidated again when
+//the answer comes back, so it must be aligned and padded to a cache line
+#define PROPERTY_CHANNEL 8
+
+#define MAILBOX_BASE		0x3f00B880
+#define MAILBOX_READ		(MAILBOX_BASE + 0x00)
+#define MAILBOX_STATUS		(MAILBOX_BASE + 0x18)	//mailbox 0, the GPU's answers
+#define MAILBOX_CONFIG		(MAILBOX_BASE + 0x1C)
+#define MAILBOX_WRITE		(MAILBOX_BASE + 0x20)
+#define MAILBOX_WRITE_STATUS	(MAILBOX_BASE + 0x38)	//mailbox 1, to the GPU
+
+#define MAILBOX_FULL		0x80000000
+#define MAILBOX_EMPTY		0x40000000
+#define MAILBOX_IRQ_DATA	0x00000001				//config: interrupt while mailbox 0 has data
+
+#define PROPERTY_TAG_RESPONSE	0x80000000			//set in a tag's length word once answered
+
+extern unsigned char __coherent_start;
+extern unsigned char __coherent_end;
+
+static int isCached(unsigned int data_addr){
+	return data_addr < (unsigned int)&__coherent_start || data_addr >= (unsigned int)&__coherent_end;
+}
+
+//before the GPU is given a property buffer
+static void propertyOut(unsigned int data_addr){
+	if(isCached(data_addr)){
+		//the first word of a property buffer is its size in bytes
+		CleanAndInvalidateDataCacheRange(data_addr, *(unsigned int *)data_addr);
+	}
+	//the buffer is written out before the GPU is told about it
+	__asm volatile ("dsb" ::: "memory");
+}
+
+//once the GPU has answered in it
+static void propertyIn(unsigned int data_addr){
+	if(isCached(data_addr)){
+		//drop any line read in while the GPU was writing the answer.  the
+		//size word is not changed by the GPU, so the copy in memory is good
+		InvalidateDataCacheRange(data_addr, MMU_CACHE_LINE_SIZE);
+		InvalidateDataCacheRange(data_addr, *(unsigned int *)data_addr);
+	}
+	__asm volatile ("dmb" ::: "memory");
+}
+
 void mailboxWrite(int data_addr, int channel){
 	int mailbox = 0x3f00B880;
+
+	if(channel == PROPERTY_CHANNEL){
+		propertyOut(data_addr);
+	}else{
+		__asm volatile ("dsb" ::: "memory");
+	}
+
 	while(1){
 		if((GET32(mailbox + 0x18)&0x80000000) == 0) break;
 	}
@@ -33,5 +92,306 @@ int mailboxRead(int channel){
 		ra = GET32(mailbox + 0x00);
 		if((ra&0xF) == channel) break;
 	}
+
+	if(channel == PROPERTY_CHANNEL){
+		propertyIn(ra & ~0xF);
+	}else{
+		__asm volatile ("dmb" ::: "memory");
+	}
 	return(ra);
-}
\ No newline at end of file
+}
+
+//property messages, see mailbox.h
+//
+//one message at a time is at the GPU (active), the others wait in a queue
+//behind it.  whoever finds answers in mailbox 0, the interrupt or a caller
+//that polls, takes them out with serviceMailbox(): it finishes the active
+//message and starts the next.  the queue is guarded by masking IRQs and a
+//spinlock for the other cores, and callbacks and wakeups are run after it
+//is let go, so a callback may send another message
+//
+//a task that can block sleeps on its task notification until its message
+//is finished, the status word telling it apart from a notification left
+//over from something else
+static PropertyMessage *pActive = 0;
+static PropertyMessage *pFirst = 0;
+static PropertyMessage *pLast = 0;
+static volatile int iLock = 0;
+static volatile int iInterruptOn = 0;
+
+__attribute__((no_instrument_function))
+static unsigned long lockMailbox(void){
+	unsigned long flags;
+
+	__asm volatile ("mrs %0, cpsr" : "=r" (flags));
+	__asm volatile ("cpsid i" ::: "memory");
+	while(__sync_lock_test_and_set(&iLock, 1)){
+		;
+	}
+	return flags;
+}
+
+__attribute__((no_instrument_function))
+static void unlockMailbox(unsigned long flags){
+	__sync_lock_release(&iLock);
+	if(!(flags & 0x80)){
+		__asm volatile ("cpsie i" ::: "memory");
+	}
+}
+
+__attribute__((no_instrument_function))
+static void startMessage(PropertyMessage *pMessage){
+	propertyOut((unsigned int)pMessage->buffer);
+	while(GET32(MAILBOX_WRITE_STATUS) & MAILBOX_FULL){
+		;
+	}
+	PUT32(MAILBOX_WRITE, (unsigned int)pMessage->buffer | PROPERTY_CHANNEL);
+}
+
+//takes the answers waiting in mailbox 0.  the messages finished are put on
+//pDone, for the caller to pass on once the lock is let go
+__attribute__((no_instrument_function))
+static void serviceMailbox(PropertyMessage **pDone){
+	PropertyMessage *pMessage;
+	unsigned int ra;
+
+	while(!(GET32(MAILBOX_STATUS) & MAILBOX_EMPTY)){
+		ra = GET32(MAILBOX_READ);
+		pMessage = pActive;
+		if((ra & 0xF) != PROPERTY_CHANNEL || pMessage == 0 || (ra & ~0xF) != (unsigned int)pMessage->buffer){
+			//nothing of ours
+			continue;
+		}
+
+		propertyIn(ra & ~0xF);
+		pMessage->pNext = *pDone;
+		*pDone = pMessage;
+
+		pActive = pFirst;
+		if(pActive){
+			pFirst = pActive->pNext;
+			if(pFirst == 0) pLast = 0;
+			startMessage(pActive);
+		}
+	}
+}
+
+__attribute__((no_instrument_function))
+static void finishMessages(PropertyMessage *pDone, portBASE_TYPE *pxWoken){
+	PropertyMessage *pNext;
+	PropertyCallback pfnCallback;
+	void *pParam, *pWaiter;
+
+	while(pDone){
+		//once status is set the waiter may return and take its message off
+		//the stack, so everything needed is read before
+		pNext = pDone->pNext;
+		pfnCallback = pDone->pfnCallback;
+		pParam = pDone->pParam;
+		pWaiter = pDone->pWaiter;
+
+		__asm volatile ("dmb" ::: "memory");
+		pDone->status = pDone->buffer[1] == MAILBOX_RESPONSE_OK ? PROPERTY_OK : PROPERTY_ERROR;
+
+		if(pfnCallback){
+			pfnCallback(pDone, pParam);
+		}
+		if(pWaiter){
+			vTaskNotifyGiveFromISR((xTaskHandle) pWaiter, pxWoken);
+		}
+		pDone = pNext;
+	}
+}
+
+__attribute__((no_instrument_function))
+static void mailboxHandler(int nIRQ, void *pParam){
+	PropertyMessage *pDone = 0;
+	portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+	unsigned long flags;
+
+	flags = lockMailbox();
+	serviceMailbox(&pDone);
+	unlockMailbox(flags);
+
+	finishMessages(pDone, &xHigherPriorityTaskWoken);
+	if(xHigherPriorityTaskWoken){
+		portYIELD_FROM_ISR();
+	}
+}
+
+__attribute__((no_instrument_function))
+void MailboxInit(void){
+	unsigned long flags;
+
+	//RegisterInterrupt() turns IRQs on, put them back as they were
+	__asm volatile ("mrs %0, cpsr" : "=r" (flags));
+	RegisterInterrupt(BCM2835_IRQ_ID_MAILBOX_0, mailboxHandler, 0);
+	if(flags & 0x80){
+		DisableInterrupts();
+	}
+
+	PUT32(MAILBOX_CONFIG, MAILBOX_IRQ_DATA);
+	EnableInterrupt(BCM2835_IRQ_ID_MAILBOX_0);
+	iInterruptOn = 1;
+}
+
+__attribute__((no_instrument_function))
+void PropertyInit(PropertyMessage *pMessage, unsigned int *buffer, unsigned int size){
+	pMessage->buffer = buffer;
+	pMessage->size = size;
+	pMessage->length = 2;
+	pMessage->status = PROPERTY_PENDING;
+	pMessage->pfnCallback = 0;
+	pMessage->pParam = 0;
+	pMessage->pWaiter = 0;
+	pMessage->pNext = 0;
+}
+
+__attribute__((no_instrument_function))
+unsigned int *PropertyAddTag(PropertyMessage *pMessage, unsigned int tag, unsigned int valueBytes, unsigned int requestBytes){
+	unsigned int words = (valueBytes + 3) / 4;
+	unsigned int *value, i;
+
+	//the tag, its value and the end tag after them
+	if(pMessage->length + 3 + words + 1 > pMessage->size){
+		return 0;
+	}
+
+	pMessage->buffer[pMessage->length] = tag;
+	pMessage->buffer[pMessage->length + 1] = valueBytes;
+	pMessage->buffer[pMessage->length + 2] = requestBytes;
+	value = &pMessage->buffer[pMessage->length + 3];
+	for(i = 0; i < words; i++){
+		value[i] = 0;
+	}
+	pMessage->length += 3 + words;
+	return value;
+}
+
+__attribute__((no_instrument_function))
+unsigned int *PropertyGetTag(PropertyMessage *pMessage, unsigned int tag){
+	unsigned int i = 2;
+
+	while(i + 3 <= pMessage->length){
+		if(pMessage->buffer[i] == tag){
+			if(!(pMessage->buffer[i + 2] & PROPERTY_TAG_RESPONSE)) return 0;
+			return &pMessage->buffer[i + 3];
+		}
+		i += 3 + (pMessage->buffer[i + 1] + 3) / 4;
+	}
+	return 0;
+}
+
+//finishes the buffer and puts the message in the queue, or at the GPU if
+//the queue is empty
+__attribute__((no_instrument_function))
+static void queueMessage(PropertyMessage *pMessage){
+	unsigned long flags;
+
+	pMessage->buffer[pMessage->length] = 0;				//end tag
+	pMessage->buffer[0] = (pMessage->length + 1) * 4;	//size
+	pMessage->buffer[1] = 0;							//request
+	pMessage->status = PROPERTY_PENDING;
+	pMessage->pNext = 0;
+
+	flags = lockMailbox();
+	if(pActive == 0){
+		pActive = pMessage;
+		startMessage(pMessage);
+	}else if(pLast){
+		pLast->pNext = pMessage;
+		pLast = pMessage;
+	}else{
+		pFirst = pLast = pMessage;
+	}
+	unlockMailbox(flags);
+}
+
+//a task, with IRQs on and the interrupt to wake it
+__attribute__((no_instrument_function))
+static int canBlock(void){
+	unsigned long flags;
+
+	__asm volatile ("mrs %0, cpsr" : "=r" (flags));
+	return iInterruptOn && !(flags & 0x80) && xTaskGetSchedulerState() == taskSCHEDULER_RUNNING;
+}
+
+__attribute__((no_instrument_function))
+int PropertyCall(PropertyMessage *pMessage){
+	PropertyMessage *pDone;
+	unsigned long flags;
+
+	pMessage->pfnCallback = 0;
+	pMessage->pWaiter = 0;
+
+	if(canBlock()){
+		pMessage->pWaiter = xTaskGetCurrentTaskHandle();
+		queueMessage(pMessage);
+		while(pMessage->status == PROPERTY_PENDING){
+			ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		}
+		return pMessage->status;
+	}
+
+	queueMessage(pMessage);
+	while(pMessage->status == PROPERTY_PENDING){
+		pDone = 0;
+		flags = lockMailbox();
+		serviceMailbox(&pDone);
+		unlockMailbox(flags);
+		finishMessages(pDone, 0);
+	}
+	return pMessage->status;
+}
+
+__attribute__((no_instrument_function))
+void PropertySubmit(PropertyMessage *pMessage, PropertyCallback pfnCallback, void *pParam){
+	PropertyMessage *pDone = 0;
+	unsigned long flags;
+
+	pMessage->pfnCallback = pfnCallback;
+	pMessage->pParam = pParam;
+	pMessage->pWaiter = 0;
+	queueMessage(pMessage);
+
+	if(!iInterruptOn){
+		//nothing else will take the answer
+		while(pMessage->status == PROPERTY_PENDING){
+			flags = lockMailbox();
+			serviceMailbox(&pDone);
+			unlockMailbox(flags);
+			finishMessages(pDone, 0);
+			pDone = 0;
+		}
+	}
+}
+
+__attribute__((no_instrument_function))
+unsigned long PropertyGetClockRate(unsigned int clockId){
+	unsigned int buffer[16] __attribute__((aligned (MMU_CACHE_LINE_SIZE)));	//one whole cache line
+	PropertyMessage message;
+	unsigned int *value;
+
+	PropertyInit(&message, buffer, 16);
+	value = PropertyAddTag(&message, PROPERTY_TAG_GET_CLOCK_RATE, 8, 4);
+	value[0] = clockId;
+	if(PropertyCall(&message) != PROPERTY_OK) return 0;
+
+	value = PropertyGetTag(&message, PROPERTY_TAG_GET_CLOCK_RATE);
+	return value ? value[1] : 0;
+}
+
+__attribute__((no_instrument_function))
+unsigned long PropertyGetTemperature(void){
+	unsigned int buffer[16] __attribute__((aligned (MMU_CACHE_LINE_SIZE)));	//one whole cache line
+	PropertyMessage message;
+	unsigned int *value;
+
+	PropertyInit(&message, buffer, 16);
+	value = PropertyAddTag(&message, PROPERTY_TAG_GET_TEMPERATURE, 8, 4);
+	value[0] = 0;		//temperature id
+	if(PropertyCall(&message) != PROPERTY_OK) return 0;
+
+	value = PropertyGetTag(&message, PROPERTY_TAG_GET_TEMPERATURE);
+	return value ? value[1] : 0;
+}
@@ -4,4 +4,77 @@
 void mailboxWrite(int data_addr, int channel);
 int mailboxRead(int channel);
 
+/* Property channel messages, built tag by tag and answered through the ARM
+ * mailbox interrupt.  Messages are sent to the GPU one at a time, in the
+ * order they were given, and the rest wait in a queue.
+ *
+ * Until MailboxInit() has been called, and whenever the caller cannot
+ * block (scheduler not running, IRQs masked, in an interrupt) a call polls
+ * for its answer instead, so the same functions work at boot.  Once the
+ * interrupt is on, mailboxRead() must not be used on mailbox 0 any more. */
+
+#define MAILBOX_RESPONSE_OK					0x80000000
+
+#define PROPERTY_TAG_GET_MAC_ADDRESS		0x00010003
+#define PROPERTY_TAG_GET_ARM_MEMORY			0x00010005
+#define PROPERTY_TAG_SET_POWER_STATE		0x00028001
+#define PROPERTY_TAG_GET_CLOCK_RATE			0x00030002
+#define PROPERTY_TAG_GET_TEMPERATURE		0x00030006
+#define PROPERTY_TAG_ALLOCATE_BUFFER		0x00040001
+#define PROPERTY_TAG_SET_PHYSICAL_SIZE		0x00048003
+#define PROPERTY_TAG_SET_VIRTUAL_SIZE		0x00048004
+#define PROPERTY_TAG_SET_DEPTH				0x00048005
+#define PROPERTY_TAG_SET_VIRTUAL_OFFSET		0x00048009
+#define PROPERTY_TAG_WAIT_FOR_VSYNC			0x0004800E
+
+#define PROPERTY_PENDING					0
+#define PROPERTY_OK							1
+#define PROPERTY_ERROR						(-1)
+
+typedef struct PropertyMessage PropertyMessage;
+
+/* Called once the answer is in, from the mailbox interrupt, or from
+ * whichever call was polling for it. */
+typedef void (*PropertyCallback)(PropertyMessage *pMessage, void *pParam);
+
+struct PropertyMessage {
+	unsigned int *buffer;		//16 byte aligned, and MMU_COHERENT or a whole number of cache lines
+	unsigned int size;			//of buffer, in words
+	unsigned int length;		//words used, without the end tag
+	volatile int status;		//PROPERTY_PENDING until answered
+	PropertyCallback pfnCallback;
+	void *pParam;
+	void *pWaiter;				//task blocked in PropertyCall()
+	PropertyMessage *pNext;
+};
+
+/* Turns the mailbox interrupt on.  Once, after InitInterruptController(). */
+void MailboxInit			(void);
+
+/* Starts an empty message in buffer, of size words. */
+void PropertyInit			(PropertyMessage *pMessage, unsigned int *buffer, unsigned int size);
+
+/* Adds a tag with valueBytes of value buffer, requestBytes of them holding
+ * the request.  Returns the value buffer, cleared, for the request to be
+ * written into, or 0 if the message has no room for it. */
+unsigned int *PropertyAddTag	(PropertyMessage *pMessage, unsigned int tag, unsigned int valueBytes, unsigned int requestBytes);
+
+/* The value buffer of tag in the answer, or 0 if the GPU did not answer
+ * it. */
+unsigned int *PropertyGetTag	(PropertyMessage *pMessage, unsigned int tag);
+
+/* Sends the message and sleeps until the answer is in.  Returns
+ * PROPERTY_OK or PROPERTY_ERROR. */
+int PropertyCall			(PropertyMessage *pMessage);
+
+/* Queues the message and returns straight away.  pfnCallback is called
+ * with the answer; the message and its buffer must live until then. */
+void PropertySubmit			(PropertyMessage *pMessage, PropertyCallback pfnCallback, void *pParam);
+
+/* Clock rate in Hz of firmware clock clockId, or 0. */
+unsigned long PropertyGetClockRate	(unsigned int clockId);
+
+/* SoC temperature in thousandths of a degree C, or 0. */
+unsigned long PropertyGetTemperature	(void);
+
 #endif
@@ -1,43 +1,316 @@
 //mem.c
 //standard memory functions to avoid using incompatible libraries on ARM
+//
+//the image is built with -mno-unaligned-access and, until the MMU is on,
+//runs with all memory strongly ordered, where an unaligned word access
+//faults.  so the copies here only ever load and store whole words at
+//aligned addresses: a byte head aligns the destination, a source with the
+//same alignment is then copied a word at a time, and any other source is
+//read in aligned words and shifted into place.  a byte tail finishes off
+//
+//copies and fills of memNEON_MIN bytes or more use NEON, which moves 64
+//bytes per loop and may read from any address.  a task's first NEON
+//instruction takes the lazy VFP trap (see port.c), which is why short
+//copies stay on the integer registers
+//
+//the rest of the build is not optimised, so these functions ask for it
+//themselves.  loop pattern distribution stays off, as GCC would otherwise
+//turn the byte loops back into calls to memcpy() and memset()
 
 #include <FreeRTOS.h>
 #include <mem.h>
 
-void *memset(void *s, int c, size_t n){
-    unsigned char* p=s;
-    while(n--)
-        *p++ = (unsigned char)c;
-    return s;
+#if defined( __ARM_NEON__ ) && ( configUSE_VFP == 1 )
+	#include <arm_neon.h>
+	#define memUSE_NEON		1
+#else
+	#define memUSE_NEON		0
+#endif
+
+#define memOPTIMISE			__attribute__((optimize("O2", "no-tree-loop-distribute-patterns"), no_instrument_function))
+
+#define memWORD				( sizeof(unsigned long) )
+#define memWORD_MASK		( memWORD - 1 )
+
+//below this the alignment is not worth working out
+#define memSMALL			( 4 * memWORD )
+
+//smallest copy or fill done with NEON
+#define memNEON_MIN			512
+
+//0x01 and 0x80 in every byte of a word, for finding a zero byte
+#define memONES				( ( unsigned long ) -1 / 0xFF )
+#define memHIGHS			( memONES * 0x80 )
+#define memHAS_ZERO(w)		( ( ( w ) - memONES ) & ~( w ) & memHIGHS )
+
+#define memALIGNED(p)		( ( ( unsigned long ) ( p ) & memWORD_MASK ) == 0 )
+
+/**
+ *	Copies n bytes upwards, to dp from sp, with dp word aligned.  Safe for
+ *	overlapping buffers as long as dp is below sp: nothing is stored over
+ *	source bytes that have not been loaded yet.
+ **/
+memOPTIMISE
+static void prvCopyForward(unsigned char *dp, const unsigned char *sp, size_t n) {
+	unsigned long *dw = (unsigned long *) dp;
+	const unsigned long *sw;
+	unsigned long w0, w1, a0, a1, a2, a3;
+	unsigned int shift;
+
+	if(memALIGNED(sp)) {
+		sw = (const unsigned long *) sp;
+		while(n >= 4 * memWORD) {
+			a0 = sw[0]; a1 = sw[1]; a2 = sw[2]; a3 = sw[3];
+			dw[0] = a0; dw[1] = a1; dw[2] = a2; dw[3] = a3;
+			sw += 4;
+			dw += 4;
+			n -= 4 * memWORD;
+		}
+		while(n >= memWORD) {
+			*dw++ = *sw++;
+			n -= memWORD;
+		}
+		sp = (const unsigned char *) sw;
+	} else {
+		//each destination word is the top of one source word and the
+		//bottom of the next (little endian)
+		shift = ((unsigned long) sp & memWORD_MASK) * 8;
+		sw = (const unsigned long *) (sp - ((unsigned long) sp & memWORD_MASK));
+		w0 = *sw++;
+		while(n >= memWORD) {
+			w1 = *sw++;
+			*dw++ = (w0 >> shift) | (w1 << (memWORD * 8 - shift));
+			w0 = w1;
+			sp += memWORD;
+			n -= memWORD;
+		}
+	}
+
+	dp = (unsigned char *) dw;
+	while(n--) {
+		*dp++ = *sp++;
+	}
 }
 
-void *memmove(void *dest, const void *src, size_t n){
-    unsigned char tmp[n];
-    memcpy2(tmp,src,n);
-    memcpy2(dest,tmp,n);
-    return dest;
+#if ( memUSE_NEON == 1 )
+
+/**
+ *	Copies 64 bytes at a time, to dp aligned to 16 bytes from sp anywhere,
+ *	and returns the number of bytes left over.  As prvCopyForward(), safe
+ *	when dp is below sp.
+ **/
+memOPTIMISE
+static size_t prvCopyNeon(unsigned char *dp, const unsigned char *sp, size_t n) {
+	uint8x16_t q0, q1, q2, q3;
+
+	while(n >= 64) {
+		q0 = vld1q_u8(sp);
+		q1 = vld1q_u8(sp + 16);
+		q2 = vld1q_u8(sp + 32);
+		q3 = vld1q_u8(sp + 48);
+		vst1q_u8(dp, q0);
+		vst1q_u8(dp + 16, q1);
+		vst1q_u8(dp + 32, q2);
+		vst1q_u8(dp + 48, q3);
+		sp += 64;
+		dp += 64;
+		n -= 64;
+	}
+	return n;
 }
 
+#endif
+
+memOPTIMISE
+void *memcpy(void *dest, const void *src, size_t n){
+	unsigned char *dp = dest;
+	const unsigned char *sp = src;
+
+	if(n < memSMALL) {
+		while(n--)
+			*dp++ = *sp++;
+		return dest;
+	}
+
+#if ( memUSE_NEON == 1 )
+	if(n >= memNEON_MIN) {
+		size_t done;
+
+		while((unsigned long) dp & 15) {
+			*dp++ = *sp++;
+			n--;
+		}
+		done = n - prvCopyNeon(dp, sp, n);
+		dp += done;
+		sp += done;
+		n -= done;
+	}
+#endif
+
+	while(!memALIGNED(dp)) {
+		*dp++ = *sp++;
+		n--;
+	}
+	prvCopyForward(dp, sp, n);
+	return dest;
+}
+
+//memcpy(), kept for the callers that were written against the byte loop
+//this used to be.  like it, it still copies upwards, so an overlapping copy
+//to a lower address works
 void *memcpy2(void *dest, const void *src, size_t n){
-	/*unaligned word moves don't work
-	for sizes not a multiple of 4,
-	this function does not work
-	just use a loop inline*/
-    char *dp = dest;
-    const char *sp = src;
-    while (n--)
-        *dp++ = *sp++;
+	return memcpy(dest, src, n);
+}
+
+/**
+ *	Copies n bytes downwards, from the ends of the buffers, for a move to a
+ *	higher address over its own source.  The mirror of prvCopyForward().
+ **/
+memOPTIMISE
+static void prvCopyBackward(unsigned char *dp, const unsigned char *sp, size_t n) {
+	unsigned long *dw;
+	const unsigned long *sw;
+	unsigned long w0, w1, a0, a1, a2, a3;
+	unsigned int shift;
+
+	dp += n;
+	sp += n;
+
+	if(n >= memSMALL) {
+		while(!memALIGNED(dp)) {
+			*--dp = *--sp;
+			n--;
+		}
+
+		dw = (unsigned long *) dp;
+		if(memALIGNED(sp)) {
+			sw = (const unsigned long *) sp;
+			while(n >= 4 * memWORD) {
+				a3 = sw[-1]; a2 = sw[-2]; a1 = sw[-3]; a0 = sw[-4];
+				dw[-1] = a3; dw[-2] = a2; dw[-3] = a1; dw[-4] = a0;
+				sw -= 4;
+				dw -= 4;
+				n -= 4 * memWORD;
+			}
+			while(n >= memWORD) {
+				*--dw = *--sw;
+				n -= memWORD;
+			}
+			sp = (const unsigned char *) sw;
+		} else {
+			shift = ((unsigned long) sp & memWORD_MASK) * 8;
+			sw = (const unsigned long *) (sp - ((unsigned long) sp & memWORD_MASK));
+			w1 = *sw;
+			while(n >= memWORD) {
+				w0 = *--sw;
+				*--dw = (w0 >> shift) | (w1 << (memWORD * 8 - shift));
+				w1 = w0;
+				sp -= memWORD;
+				n -= memWORD;
+			}
+		}
+		dp = (unsigned char *) dw;
+	}
+
+	while(n--) {
+		*--dp = *--sp;
+	}
+}
+
+memOPTIMISE
+void *memmove(void *dest, const void *src, size_t n){
+	unsigned char *dp = dest;
+	const unsigned char *sp = src;
+
+	//an upwards copy only goes wrong when the destination starts inside
+	//the source
+	if(dp <= sp || dp >= sp + n) {
+		return memcpy(dest, src, n);
+	}
+
+	prvCopyBackward(dp, sp, n);
 	return dest;
 }
 
+memOPTIMISE
+void *memset(void *s, int c, size_t n){
+	unsigned char *p = s;
+	unsigned long *pw;
+	unsigned long w;
+
+	if(n >= memSMALL) {
+#if ( memUSE_NEON == 1 )
+		if(n >= memNEON_MIN) {
+			uint8x16_t q = vdupq_n_u8((unsigned char) c);
+
+			while((unsigned long) p & 15) {
+				*p++ = (unsigned char) c;
+				n--;
+			}
+			while(n >= 64) {
+				vst1q_u8(p, q);
+				vst1q_u8(p + 16, q);
+				vst1q_u8(p + 32, q);
+				vst1q_u8(p + 48, q);
+				p += 64;
+				n -= 64;
+			}
+		}
+#endif
+		while(!memALIGNED(p)) {
+			*p++ = (unsigned char) c;
+			n--;
+		}
+
+		w = memONES * (unsigned char) c;
+		pw = (unsigned long *) p;
+		while(n >= 4 * memWORD) {
+			pw[0] = w; pw[1] = w; pw[2] = w; pw[3] = w;
+			pw += 4;
+			n -= 4 * memWORD;
+		}
+		while(n >= memWORD) {
+			*pw++ = w;
+			n -= memWORD;
+		}
+		p = (unsigned char *) pw;
+	}
+
+	while(n--)
+		*p++ = (unsigned char) c;
+	return s;
+}
+
+memOPTIMISE
 int memcmp(const void* s1, const void* s2, size_t n){
-    const unsigned char *p1 = s1, *p2 = s2;
-    while(n--)
-        if( *p1 != *p2 )
-            return *p1 - *p2;
-        else
-            p1++,p2++;
-    return 0;
+	const unsigned char *p1 = s1, *p2 = s2;
+	const unsigned long *w1, *w2;
+
+	//with both on the same alignment, skip the equal words
+	if(n >= memSMALL && (((unsigned long) p1 ^ (unsigned long) p2) & memWORD_MASK) == 0) {
+		while(!memALIGNED(p1)) {
+			if(*p1 != *p2)
+				return *p1 - *p2;
+			p1++, p2++, n--;
+		}
+
+		w1 = (const unsigned long *) p1;
+		w2 = (const unsigned long *) p2;
+		while(n >= memWORD && *w1 == *w2) {
+			w1++, w2++;
+			n -= memWORD;
+		}
+		p1 = (const unsigned char *) w1;
+		p2 = (const unsigned char *) w2;
+	}
+
+	//the bytes that differ, if any, are in the next word
+	while(n--)
+		if( *p1 != *p2 )
+			return *p1 - *p2;
+		else
+			p1++,p2++;
+	return 0;
 }
 
 char *strcpy(char *dest, const char* src){
@@ -58,12 +331,29 @@ char *strncpy(char *dest, const char *src, size_t n){
     return ret;
 }
 
+memOPTIMISE
 size_t strlen(const char *s){
-    size_t i;
-    for (i = 0; s[i] != '\0'; i++) ;
-    return i;
+	const char *p = s;
+	const unsigned long *pw;
+
+	while(!memALIGNED(p)) {
+		if(*p == '\0')
+			return p - s;
+		p++;
+	}
+
+	//an aligned word never crosses into memory that is not there, so
+	//reading past the terminator is harmless
+	pw = (const unsigned long *) p;
+	while(!memHAS_ZERO(*pw))
+		pw++;
+
+	p = (const char *) pw;
+	while(*p != '\0')
+		p++;
+	return p - s;
 }
 
 //this is not random at all
 int next = 1;
-int rand(){return (int)((next = next * 1103515245 + 12345) % ((unsigned long)32767 + 1));}
\ No newline at end of file
+int rand(){return (int)((next = next * 1103515245 + 12345) % ((unsigned long)32767 + 1));}
@@ -5,6 +5,7 @@ void* malloc(unsigned nSize);
 void free(void* pBlock);
 void *memset(void *s, int c, size_t n);
 void *memmove(void *dest, const void *src, size_t n);
+void *memcpy(void *dest, const void *src, size_t n);
 void *memcpy2(void *dest, const void *src, size_t n);
 int memcmp(const void* s1, const void* s2, size_t n);
 char *strcpy(char *dest, const char* src);
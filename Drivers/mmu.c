@@ -0,0 +1,174 @@
+//mmu.c
+//
+//MMU and cache setup.  the whole 4GB is identity mapped with one level of 1MB
+//sections, so addresses mean the same with the MMU on as with it off:
+//
+//  0 - ARM end               normal, write-back write-allocate, shareable
+//    .coherent section       normal, non-cacheable (see mmu.h)
+//  ARM end - 0x3F000000      normal, non-cacheable: the GPU's memory, which
+//                            holds the framebuffer
+//  0x3F000000 - 0x40000000   peripherals, strongly ordered, never executed
+//  0x40000000 - 0x40100000   core local peripherals (timers, mailboxes)
+//  the rest                  not mapped, an access is a data abort
+//
+//the peripherals stay strongly ordered, as they were with the MMU off, so
+//the drivers need no barriers they did not need before.  SCTLR.C turns on
+//the L1 data cache and the unified L2 together.  on SMP builds the cores'
+//caches are kept coherent by the SCU, which the firmware's ARM stub has
+//already joined every core to (CPUECTLR.SMPEN)
+
+#include <FreeRTOS.h>
+
+#include "mmu.h"
+#include "heapregions.h"
+
+#define MMU_SECTION_SIZE		0x100000UL
+#define MMU_SECTION_SHIFT		20
+#define MMU_SECTIONS			4096
+
+//short descriptor section entries, TEX remap off
+#define SECTION					0x00002
+#define SECTION_B				0x00004
+#define SECTION_C				0x00008
+#define SECTION_XN				0x00010
+#define SECTION_AP_RW			0x00C00		//read/write at any privilege
+#define SECTION_TEX(x)			((x) << 12)
+#define SECTION_S				0x10000
+
+#define SECTION_CACHED			(SECTION | SECTION_AP_RW | SECTION_TEX(1) | SECTION_C | SECTION_B | SECTION_S)
+#define SECTION_UNCACHED		(SECTION | SECTION_AP_RW | SECTION_TEX(1) | SECTION_S)
+#define SECTION_STRONGLY_ORDERED	(SECTION | SECTION_AP_RW | SECTION_XN)
+
+//table walks are write-back write-allocate, inner shareable
+#define TTBR_WALK_ATTRIBUTES	0x6A
+
+//every domain a client, so the access permissions apply
+#define DACR_ALL_CLIENT			0x55555555
+
+#define SCTLR_M					(1 << 0)
+#define SCTLR_A					(1 << 1)
+#define SCTLR_C					(1 << 2)
+#define SCTLR_Z					(1 << 11)
+#define SCTLR_I					(1 << 12)
+#define SCTLR_TRE				(1 << 28)
+#define SCTLR_AFE				(1 << 29)
+
+#define PERIPHERAL_BASE			0x3F000000UL
+#define PERIPHERAL_END			0x40000000UL
+#define CORE_LOCAL_BASE			0x40000000UL
+
+extern unsigned char __coherent_start;
+extern unsigned char __coherent_end;
+
+static unsigned long ulTranslationTable[MMU_SECTIONS] __attribute__((aligned (16384)));
+
+__attribute__((no_instrument_function))
+static void MapSections(unsigned long ulStart, unsigned long ulEnd, unsigned long ulAttributes) {
+	unsigned long ulSection;
+
+	for(ulSection = ulStart >> MMU_SECTION_SHIFT; ulSection < (ulEnd >> MMU_SECTION_SHIFT); ulSection++) {
+		ulTranslationTable[ulSection] = (ulSection << MMU_SECTION_SHIFT) | ulAttributes;
+	}
+}
+
+//the L1 data cache holds garbage until invalidated.  by set and way, as
+//there is nothing in it yet to clean.  the L2 is invalidated by the reset and
+//may already hold another core's data, so it is left alone
+__attribute__((no_instrument_function))
+static void InvalidateL1DataCache(void) {
+	unsigned long ulIdentity, ulLineShift, ulWays, ulSets, ulWayShift, ulWay, ulSet;
+
+	__asm volatile ("mcr p15, 2, %0, c0, c0, 0" : : "r" (0));				//CSSELR: L1 data
+	__asm volatile ("isb" ::: "memory");
+	__asm volatile ("mrc p15, 1, %0, c0, c0, 0" : "=r" (ulIdentity));		//CCSIDR
+
+	ulLineShift = (ulIdentity & 7) + 4;
+	ulWays = ((ulIdentity >> 3) & 0x3FF) + 1;
+	ulSets = ((ulIdentity >> 13) & 0x7FFF) + 1;
+	ulWayShift = ulWays > 1 ? __builtin_clz(ulWays - 1) : 0;
+
+	for(ulWay = 0; ulWay < ulWays; ulWay++) {
+		for(ulSet = 0; ulSet < ulSets; ulSet++) {
+			__asm volatile ("mcr p15, 0, %0, c7, c6, 2" : :					//DCISW
+					"r" ((ulWay << ulWayShift) | (ulSet << ulLineShift)) : "memory");
+		}
+	}
+	__asm volatile ("dsb" ::: "memory");
+}
+
+__attribute__((no_instrument_function))
+void MMUEnable(void) {
+	unsigned long ulControl;
+
+	InvalidateL1DataCache();
+
+	__asm volatile ("mcr p15, 0, %0, c7, c5, 0" : : "r" (0) : "memory");	//ICIALLU
+	__asm volatile ("mcr p15, 0, %0, c7, c5, 6" : : "r" (0) : "memory");	//BPIALL
+	__asm volatile ("mcr p15, 0, %0, c8, c7, 0" : : "r" (0) : "memory");	//TLBIALL
+	__asm volatile ("dsb" ::: "memory");
+
+	__asm volatile ("mcr p15, 0, %0, c2, c0, 2" : : "r" (0));				//TTBCR: TTBR0 only
+	__asm volatile ("mcr p15, 0, %0, c2, c0, 0" : :							//TTBR0
+			"r" ((unsigned long) ulTranslationTable | TTBR_WALK_ATTRIBUTES));
+	__asm volatile ("mcr p15, 0, %0, c3, c0, 0" : : "r" (DACR_ALL_CLIENT));
+	__asm volatile ("isb" ::: "memory");
+
+	__asm volatile ("mrc p15, 0, %0, c1, c0, 0" : "=r" (ulControl));		//SCTLR
+	ulControl &= ~(SCTLR_A | SCTLR_TRE | SCTLR_AFE);
+	ulControl |= SCTLR_M | SCTLR_C | SCTLR_Z | SCTLR_I;
+	__asm volatile ("mcr p15, 0, %0, c1, c0, 0" : : "r" (ulControl) : "memory");
+	__asm volatile ("isb" ::: "memory");
+}
+
+__attribute__((no_instrument_function))
+void MMUInit(void) {
+	unsigned long ulArmEnd = GetArmMemoryEnd() & ~(MMU_SECTION_SIZE - 1);
+	unsigned long ulCoherentStart = (unsigned long) &__coherent_start;
+	unsigned long ulCoherentEnd = (unsigned long) &__coherent_end;
+
+	if(ulArmEnd > PERIPHERAL_BASE) {
+		ulArmEnd = PERIPHERAL_BASE;
+	}
+
+	//the table is written with the data cache still off, so it is already
+	//in memory for the table walks
+	MapSections(0, ulArmEnd, SECTION_CACHED);
+	MapSections(ulCoherentStart, ulCoherentEnd, SECTION_UNCACHED);
+	MapSections(ulArmEnd, PERIPHERAL_BASE, SECTION_UNCACHED);
+	MapSections(PERIPHERAL_BASE, PERIPHERAL_END, SECTION_STRONGLY_ORDERED);
+	MapSections(CORE_LOCAL_BASE, CORE_LOCAL_BASE + MMU_SECTION_SIZE, SECTION_STRONGLY_ORDERED);
+
+	MMUEnable();
+}
+
+//by MVA to the point of coherency, one line at a time, then a DSB so the
+//maintenance is done before whatever starts the device
+__attribute__((no_instrument_function))
+void CleanDataCacheRange(unsigned long ulAddress, unsigned long ulLength) {
+	unsigned long ulEnd = ulAddress + ulLength;
+
+	for(ulAddress &= ~(MMU_CACHE_LINE_SIZE - 1); ulAddress < ulEnd; ulAddress += MMU_CACHE_LINE_SIZE) {
+		__asm volatile ("mcr p15, 0, %0, c7, c10, 1" : : "r" (ulAddress) : "memory");	//DCCMVAC
+	}
+	__asm volatile ("dsb" ::: "memory");
+}
+
+__attribute__((no_instrument_function))
+void InvalidateDataCacheRange(unsigned long ulAddress, unsigned long ulLength) {
+	unsigned long ulEnd = ulAddress + ulLength;
+
+	for(ulAddress &= ~(MMU_CACHE_LINE_SIZE - 1); ulAddress < ulEnd; ulAddress += MMU_CACHE_LINE_SIZE) {
+		__asm volatile ("mcr p15, 0, %0, c7, c6, 1" : : "r" (ulAddress) : "memory");	//DCIMVAC
+	}
+	__asm volatile ("dsb" ::: "memory");
+}
+
+__attribute__((no_instrument_function))
+void CleanAndInvalidateDataCacheRange(unsigned long ulAddress, unsigned long ulLength) {
+	unsigned long ulEnd = ulAddress + ulLength;
+
+	for(ulAddress &= ~(MMU_CACHE_LINE_SIZE - 1); ulAddress < ulEnd; ulAddress += MMU_CACHE_LINE_SIZE) {
+		__asm volatile ("mcr p15, 0, %0, c7, c14, 1" : : "r" (ulAddress) : "memory");	//DCCIMVAC
+	}
+	__asm volatile ("dsb" ::: "memory");
+}
@@ -0,0 +1,34 @@
+#ifndef _MMU_H_
+#define _MMU_H_
+
+/* Turns on the MMU and the caches, with the whole address space identity
+ * mapped in 1MB sections (see mmu.c for the memory map).  MMUInit() builds
+ * the table and must be called first thing in main(), before anything is
+ * allocated; the secondary cores call MMUEnable() from Demo/startup.s to use
+ * the same table. */
+
+void MMUInit	(void);
+void MMUEnable	(void);
+
+/* Data cache maintenance by address range, to the point of coherency, for
+ * memory that the GPU or a DMA engine reads or writes behind the CPU's back.
+ * Every cache line the range touches is maintained, so buffers that share a
+ * line with other data should be aligned and padded to MMU_CACHE_LINE_SIZE.
+ *
+ *   Clean            before a device reads the buffer
+ *   Invalidate       before the CPU reads what a device wrote
+ *   CleanAndInvalidate  both, for a buffer going both ways */
+
+#define MMU_CACHE_LINE_SIZE		64
+
+void CleanDataCacheRange				(unsigned long ulAddress, unsigned long ulLength);
+void InvalidateDataCacheRange			(unsigned long ulAddress, unsigned long ulLength);
+void CleanAndInvalidateDataCacheRange	(unsigned long ulAddress, unsigned long ulLength);
+
+/* Puts a static variable in the 1MB section after the kernel image that is
+ * mapped normal non-cacheable, for small buffers shared with the GPU (the
+ * mailbox property buffers) that are not worth maintaining by hand.  The
+ * section is not zeroed at boot. */
+#define MMU_COHERENT			__attribute__((section(".coherent")))
+
+#endif
@@ -0,0 +1,309 @@
+//textmode.c
+//
+//text mode over the framebuffer, see textmode.h
+//
+//the font stores each glyph as 6 columns of 8 bits.  turned around, each of
+//a glyph's 8 rows is a 6 bit pattern, and there are only 64 of those, so a
+//colour is expanded once into the 6 framebuffer words of every pattern.  a
+//cell is then drawn with 8 copies of 6 words, and one row of background for
+//the spacing, without looking at a single font bit.  the last few colours
+//used keep their expansions
+//
+//changed cells are marked in a bitmap per row, and rows with changed cells
+//in another bitmap, so a flush goes straight to them.  clearing the screen
+//writes 16 bytes at a time with NEON when the build has it.  the framebuffer
+//is not cached (see mmu.c), so the stores go out through the write buffer
+//and are not maintained
+//
+//scrolling moves the virtual offset down a row rather than the pixels up,
+//so it only costs the blanking of the new row (see origin below)
+//
+//as mem.c, the functions that draw ask to be optimised themselves
+
+#include <FreeRTOS.h>
+
+#include "textmode.h"
+#include "video.h"
+#include "mem.h"
+
+#if defined( __ARM_NEON__ ) && ( configUSE_VFP == 1 )
+	#include <arm_neon.h>
+	#define textUSE_NEON		1
+#else
+	#define textUSE_NEON		0
+#endif
+
+#define textOPTIMISE			__attribute__((optimize("O2", "no-tree-loop-distribute-patterns"), no_instrument_function))
+
+#define TEXT_GLYPHS				96
+#define TEXT_GLYPH_ROWS			8
+#define TEXT_PATTERNS			( 1 << TEXT_CELL_WIDTH )
+
+//colours whose glyph rows are kept
+#define TEXT_COLOUR_SLOTS		8
+
+#define TEXT_DIRTY_WORDS		( ( TEXT_MAX_COLUMNS + 31 ) / 32 )
+#define TEXT_DIRTY_ROW_WORDS	( ( TEXT_MAX_ROWS + 31 ) / 32 )
+
+typedef struct {
+	unsigned int colour;
+	unsigned long lastUsed;
+	unsigned int rows[TEXT_PATTERNS][TEXT_CELL_WIDTH];
+} TextColourSlot;
+
+//in video.c
+extern const unsigned char font[TEXT_GLYPHS][6];
+
+static unsigned char glyphRows[TEXT_GLYPHS][TEXT_GLYPH_ROWS];
+
+static TextColourSlot colourSlots[TEXT_COLOUR_SLOTS];
+static int colourSlotsUsed = 0;
+static unsigned long colourClock = 0;
+
+static unsigned char cells[TEXT_MAX_ROWS][TEXT_MAX_COLUMNS];
+static unsigned int cellColours[TEXT_MAX_ROWS][TEXT_MAX_COLUMNS];
+static unsigned long dirtyCells[TEXT_MAX_ROWS][TEXT_DIRTY_WORDS];
+static unsigned long dirtyRows[TEXT_DIRTY_ROW_WORDS];
+
+static int columns = 0;
+static int rows = 0;
+
+//the rows are kept in a circle: row 0 of the screen is cells[origin].  with
+//a virtual framebuffer of two screens, every row is drawn in both, at
+//origin + row and at origin + row + rows, so that the screen always shows
+//the rows in order from the virtual offset origin down
+static int origin = 0;
+static int doubled = 0;
+
+//the glyph rows of colour, expanded now if they are not already
+__attribute__((no_instrument_function))
+static const TextColourSlot *getColour(unsigned int colour) {
+	TextColourSlot *slot;
+	int i, pattern, bit;
+
+	colourClock++;
+	for(i = 0; i < colourSlotsUsed; i++) {
+		if(colourSlots[i].colour == colour) {
+			colourSlots[i].lastUsed = colourClock;
+			return &colourSlots[i];
+		}
+	}
+
+	if(colourSlotsUsed < TEXT_COLOUR_SLOTS) {
+		slot = &colourSlots[colourSlotsUsed++];
+	} else {
+		slot = &colourSlots[0];
+		for(i = 1; i < TEXT_COLOUR_SLOTS; i++) {
+			if(colourSlots[i].lastUsed < slot->lastUsed) {
+				slot = &colourSlots[i];
+			}
+		}
+	}
+
+	slot->colour = colour;
+	slot->lastUsed = colourClock;
+	for(pattern = 0; pattern < TEXT_PATTERNS; pattern++) {
+		for(bit = 0; bit < TEXT_CELL_WIDTH; bit++) {
+			slot->rows[pattern][bit] = (pattern & (1 << bit)) ? colour : TEXT_BACKGROUND;
+		}
+	}
+	return slot;
+}
+
+__attribute__((no_instrument_function))
+static int glyphIndex(char c) {
+	c = c & 0x7F;
+	return c < ' ' ? 0 : c - ' ';
+}
+
+textOPTIMISE
+static void drawCellAt(unsigned int *dst, const unsigned char *patterns, const TextColourSlot *colour) {
+	const unsigned int *src;
+	int i;
+
+	for(i = 0; i < TEXT_GLYPH_ROWS; i++) {
+		src = colour->rows[patterns[i]];
+		dst[0] = src[0]; dst[1] = src[1]; dst[2] = src[2];
+		dst[3] = src[3]; dst[4] = src[4]; dst[5] = src[5];
+		dst += SCREEN_WIDTH;
+	}
+
+	//the spacing under the glyph
+	dst[0] = TEXT_BACKGROUND; dst[1] = TEXT_BACKGROUND; dst[2] = TEXT_BACKGROUND;
+	dst[3] = TEXT_BACKGROUND; dst[4] = TEXT_BACKGROUND; dst[5] = TEXT_BACKGROUND;
+}
+
+//cell of cells[row], in both screens when there are two
+textOPTIMISE
+static void drawCell(int row, int column, const TextColourSlot *colour) {
+	unsigned int *dst = framebuffer + (row * TEXT_CELL_HEIGHT) * SCREEN_WIDTH + column * TEXT_CELL_WIDTH;
+
+	drawCellAt(dst, glyphRows[cells[row][column]], colour);
+	if(doubled) {
+		drawCellAt(dst + rows * TEXT_CELL_HEIGHT * SCREEN_WIDTH, glyphRows[cells[row][column]], colour);
+	}
+}
+
+textOPTIMISE
+static void fillWords(unsigned int *p, unsigned int value, unsigned long n) {
+#if ( textUSE_NEON == 1 )
+	uint32x4_t q = vdupq_n_u32(value);
+
+	while(((unsigned long) p & 15) && n) {
+		*p++ = value;
+		n--;
+	}
+	while(n >= 16) {
+		vst1q_u32(p, q);
+		vst1q_u32(p + 4, q);
+		vst1q_u32(p + 8, q);
+		vst1q_u32(p + 12, q);
+		p += 16;
+		n -= 16;
+	}
+#endif
+	while(n >= 4) {
+		p[0] = value; p[1] = value; p[2] = value; p[3] = value;
+		p += 4;
+		n -= 4;
+	}
+	while(n--) {
+		*p++ = value;
+	}
+}
+
+__attribute__((no_instrument_function))
+void TextInit(void) {
+	int glyph, row, column;
+
+	//each row pattern has one bit per column of the glyph
+	for(glyph = 0; glyph < TEXT_GLYPHS; glyph++) {
+		for(row = 0; row < TEXT_GLYPH_ROWS; row++) {
+			glyphRows[glyph][row] = 0;
+			for(column = 0; column < TEXT_CELL_WIDTH; column++) {
+				if(font[glyph][column] & (1 << row)) {
+					glyphRows[glyph][row] |= 1 << column;
+				}
+			}
+		}
+	}
+
+	columns = SCREEN_WIDTH / TEXT_CELL_WIDTH;
+	if(columns > TEXT_MAX_COLUMNS) columns = TEXT_MAX_COLUMNS;
+	rows = SCREEN_HEIGHT / TEXT_CELL_HEIGHT;
+	if(rows > TEXT_MAX_ROWS) rows = TEXT_MAX_ROWS;
+	doubled = SCREEN_VIRTUAL_HEIGHT >= 2 * rows * TEXT_CELL_HEIGHT;
+
+	TextClear();
+}
+
+__attribute__((no_instrument_function))
+int TextColumns(void) {
+	return columns;
+}
+
+__attribute__((no_instrument_function))
+int TextRows(void) {
+	return rows;
+}
+
+__attribute__((no_instrument_function))
+void TextPutChar(int column, int row, char c, int colour) {
+	int glyph = glyphIndex(c);
+
+	if(column < 0 || column >= columns || row < 0 || row >= rows) {
+		return;
+	}
+
+	row += origin;
+	if(row >= rows) row -= rows;
+	if(cells[row][column] == glyph && cellColours[row][column] == (unsigned int) colour) {
+		return;
+	}
+
+	cells[row][column] = glyph;
+	cellColours[row][column] = colour;
+	dirtyCells[row][column / 32] |= 1UL << (column % 32);
+	dirtyRows[row / 32] |= 1UL << (row % 32);
+}
+
+__attribute__((no_instrument_function))
+int TextPutString(int column, int row, const char *str, int colour) {
+	int start = column;
+
+	while(*str && column < columns) {
+		TextPutChar(column++, row, *str++, colour);
+	}
+	return column - start;
+}
+
+__attribute__((no_instrument_function))
+void TextClear(void) {
+	memset(cells, 0, sizeof(cells));
+	memset(cellColours, 0, sizeof(cellColours));
+	memset(dirtyCells, 0, sizeof(dirtyCells));
+	memset(dirtyRows, 0, sizeof(dirtyRows));
+
+	fillWords(framebuffer, TEXT_BACKGROUND, (unsigned long) SCREEN_WIDTH * (doubled ? SCREEN_VIRTUAL_HEIGHT : SCREEN_HEIGHT));
+	if(origin != 0) {
+		origin = 0;
+		setVirtualOffset(0, 0);
+	}
+}
+
+__attribute__((no_instrument_function))
+void TextScroll(void) {
+	unsigned long words = (unsigned long) TEXT_CELL_HEIGHT * SCREEN_WIDTH;
+	int i;
+
+	if(!doubled) {
+		TextClear();
+		return;
+	}
+
+	//the top row becomes the new bottom one, blank
+	memset(cells[origin], 0, sizeof(cells[origin]));
+	memset(cellColours[origin], 0, sizeof(cellColours[origin]));
+	for(i = 0; i < TEXT_DIRTY_WORDS; i++) {
+		dirtyCells[origin][i] = 0;
+	}
+	fillWords(framebuffer + origin * words, TEXT_BACKGROUND, words);
+	fillWords(framebuffer + (origin + rows) * words, TEXT_BACKGROUND, words);
+
+	if(++origin == rows) origin = 0;
+	setVirtualOffset(0, origin * TEXT_CELL_HEIGHT);
+}
+
+textOPTIMISE
+void TextFlush(void) {
+	const TextColourSlot *colour = 0;
+	unsigned long rowBits, cellBits;
+	int rowWord, cellWord, row, column;
+
+	for(rowWord = 0; rowWord < TEXT_DIRTY_ROW_WORDS; rowWord++) {
+		rowBits = dirtyRows[rowWord];
+		dirtyRows[rowWord] = 0;
+
+		while(rowBits) {
+			row = rowWord * 32 + __builtin_ctzl(rowBits);
+			rowBits &= rowBits - 1;
+
+			for(cellWord = 0; cellWord < TEXT_DIRTY_WORDS; cellWord++) {
+				cellBits = dirtyCells[row][cellWord];
+				dirtyCells[row][cellWord] = 0;
+
+				while(cellBits) {
+					column = cellWord * 32 + __builtin_ctzl(cellBits);
+					cellBits &= cellBits - 1;
+
+					//runs of one colour are the rule, so only look it up on
+					//a change
+					if(colour == 0 || colour->colour != cellColours[row][column]) {
+						colour = getColour(cellColours[row][column]);
+					}
+					drawCell(row, column, colour);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,45 @@
+#ifndef _TEXTMODE_H_
+#define _TEXTMODE_H_
+
+/* A text mode over the framebuffer of video.c: a grid of character cells,
+ * each one character of the 6x8 font in a colour, one pixel of spacing
+ * under it.  Writing a cell only records it, and marks it dirty if it
+ * changed.  TextFlush() then draws the dirty cells alone, a row of 6 words
+ * at a time from glyph rows expanded for the colour beforehand.
+ *
+ * Not locked: use it from one task at a time, which for the lines of
+ * println() is the console task (see logring.h). */
+
+#define TEXT_CELL_WIDTH			6
+#define TEXT_CELL_HEIGHT		9
+
+/* Cells for the largest screen, 1920x1080. */
+#define TEXT_MAX_COLUMNS		( 1920 / TEXT_CELL_WIDTH )
+#define TEXT_MAX_ROWS			( 1080 / TEXT_CELL_HEIGHT )
+
+#define TEXT_BACKGROUND			0xFF000000
+
+/* Called by initFB().  Clears the screen. */
+void TextInit		(void);
+
+int TextColumns		(void);
+int TextRows		(void);
+
+void TextPutChar	(int column, int row, char c, int colour);
+
+/* Writes str from the cell given to the end of the row at most, and returns
+ * the number of cells written. */
+int TextPutString	(int column, int row, const char *str, int colour);
+
+/* Blanks the grid and the screen straight away. */
+void TextClear		(void);
+
+/* Moves every row up one and blanks the last, straight away.  With a
+ * virtual framebuffer two screens tall (see initFB()) this is the virtual
+ * offset moving down a row, otherwise the screen is cleared. */
+void TextScroll		(void);
+
+/* Draws the cells changed since the last flush. */
+void TextFlush		(void);
+
+#endif
@@ -0,0 +1,73 @@
+/**
+ *	Polled PL011 UART0 output, for logs that have to be read by a program
+ *	rather than off the screen (see Demo/bench/benchmark.h).
+ **/
+
+#include "uart.h"
+#include "gpio.h"
+
+typedef struct {
+	unsigned long	DR;			///< Data register.
+	unsigned long	RSRECR;
+	unsigned long	Reserved_1[4];
+	unsigned long	FR;			///< Flags, bit 5 is transmit FIFO full.
+	unsigned long	Reserved_2;
+	unsigned long	ILPR;
+	unsigned long	IBRD;		///< Integer baud rate divisor.
+	unsigned long	FBRD;		///< Fractional baud rate divisor.
+	unsigned long	LCRH;		///< Line control.
+	unsigned long	CR;			///< Control.
+	unsigned long	IFLS;
+	unsigned long	IMSC;
+	unsigned long	RIS;
+	unsigned long	MIS;
+	unsigned long	ICR;		///< Interrupt clear.
+} BCM2835_UART_REGS;
+
+static volatile BCM2835_UART_REGS * const pRegs = (BCM2835_UART_REGS *) (0x3f201000);
+
+#define UART_FR_TXFF	(1 << 5)
+#define UART_LCRH_FEN	(1 << 4)
+#define UART_LCRH_8BIT	(3 << 5)
+#define UART_CR_UARTEN	(1 << 0)
+#define UART_CR_TXE		(1 << 8)
+
+/**
+ *	The UART clock is 48MHz on the Pi 3, so 115200 baud is a divisor of
+ *	26 + 3/64.
+ **/
+__attribute__((no_instrument_function))
+void UartInit(void) {
+	pRegs->CR = 0;
+
+	SetGpioFunction(14, 4);		// ALT0, TXD0
+	SetGpioFunction(15, 4);		// ALT0, RXD0
+
+	pRegs->ICR = 0x7FF;
+	pRegs->IBRD = 26;
+	pRegs->FBRD = 3;
+	pRegs->LCRH = UART_LCRH_FEN | UART_LCRH_8BIT;
+	pRegs->IMSC = 0;
+	pRegs->CR = UART_CR_UARTEN | UART_CR_TXE;
+}
+
+__attribute__((no_instrument_function))
+void UartPutc(char c) {
+	while(pRegs->FR & UART_FR_TXFF) {
+		;
+	}
+	pRegs->DR = c;
+}
+
+/**
+ *	Writes s, turning "\n" into "\r\n".
+ **/
+__attribute__((no_instrument_function))
+void UartPuts(const char *s) {
+	while(*s) {
+		if(*s == '\n') {
+			UartPutc('\r');
+		}
+		UartPutc(*s++);
+	}
+}
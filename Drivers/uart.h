@@ -0,0 +1,13 @@
+#ifndef _UART_H_
+#define _UART_H_
+
+/* PL011 UART0 on GPIO 14 (TXD) and 15 (RXD), 115200 8N1, transmit only.
+ * QEMU connects it to -serial.  On a Pi 3 the firmware gives UART0 to the
+ * Bluetooth module unless config.txt has dtoverlay=disable-bt (or
+ * dtoverlay=pi3-disable-bt on older firmware). */
+
+void UartInit		(void);
+void UartPutc		(char c);
+void UartPuts		(const char *s);
+
+#endif
@@ -3,22 +3,31 @@
 //
 //basic text debugging using the framebuffer
 
+#include <FreeRTOS.h>
+#include <task.h>
 #include <video.h>
 #include <mailbox.h>
+#include <mmu.h>
+#include <logring.h>
+#include <textmode.h>
 #include <5x5_font.h>
 char loaded = 0;
 #define CHAR_WIDTH 6
 #define CHAR_HEIGHT 8
 int SCREEN_WIDTH;
 int SCREEN_HEIGHT;
+int SCREEN_VIRTUAL_HEIGHT;	//as the GPU gave it, two screens if it could
 
 void enablelogging(){ loaded = 1;}
 
-//mailbuffer must be 16 byte aligned for GPU
-unsigned int mailbuffer[22] __attribute__((aligned (16)));
+//mailbuffer must be 16 byte aligned for GPU, and is kept out of the cache
+unsigned int mailbuffer[22] MMU_COHERENT __attribute__((aligned (16)));
 unsigned int* framebuffer;
 
 void initFB(){
+	PropertyMessage message;
+	unsigned int *value;
+
 	//get the display size
 	/*mailbuffer[0] = 8 * 4;		//mailbuffer size
 	mailbuffer[1] = 0;		//response code
@@ -49,47 +58,81 @@ void initFB(){
 	SCREEN_WIDTH = 1920;//mailbuffer[5];
 	SCREEN_HEIGHT = 1080;//mailbuffer[6];
 
-	mailbuffer[0] = 22 * 4;		//mail buffer size
-	mailbuffer[1] = 0;		//response code
+	//spam mail the GPU until the response code is ok.  before the
+	//scheduler, so each try polls for its answer
+	do{
+		PropertyInit(&message, mailbuffer, 22);
 
-	mailbuffer[2] = 0x00048003;	//set phys display
-	mailbuffer[3] = 8;		//value buffer size
-	mailbuffer[4] = 8;		//Req. + value length (bytes)
-	mailbuffer[5] = SCREEN_WIDTH;	//screen x
-	mailbuffer[6] = SCREEN_HEIGHT;	//screen y
-
-	mailbuffer[7] = 0x00048004;	//set virtual display
-	mailbuffer[8] = 8;		//value buffer size
-	mailbuffer[9] = 8;		//Req. + value length (bytes)
-	mailbuffer[10] = SCREEN_WIDTH;	//screen x
-	mailbuffer[11] = SCREEN_HEIGHT; //screen y
-
-	mailbuffer[12] = 0x0048005;	//set depth
-	mailbuffer[13] = 4;		//value buffer size
-	mailbuffer[14] = 4;		//Req. + value length (bytes)
-	mailbuffer[15] = 32;		//bits per pixel
-	//pixel format is ARGB, 0xFF0000FF is blue at full alpha transparency
-
-	mailbuffer[16] = 0x00040001;	//allocate buffer
-	mailbuffer[17] = 8;		//value buffer size
-	mailbuffer[18] = 4;		//Req. + value length (bytes)
-	mailbuffer[19] = 0;		//framebuffer address
-	mailbuffer[20] = 0;		//framebuffer size
-
-	mailbuffer[21] = 0;		//terminate buffer
+		value = PropertyAddTag(&message, PROPERTY_TAG_SET_PHYSICAL_SIZE, 8, 8);
+		value[0] = SCREEN_WIDTH;	//screen x
+		value[1] = SCREEN_HEIGHT;	//screen y
 
-	//spam mail the GPU until the response code is ok
-	while(mailbuffer[1] != 0x80000000){
-		mailboxWrite((int)mailbuffer, 8);
-		mailboxRead(8);
-	}
+		value = PropertyAddTag(&message, PROPERTY_TAG_SET_VIRTUAL_SIZE, 8, 8);
+		value[0] = SCREEN_WIDTH;	//screen x
+		value[1] = 2 * SCREEN_HEIGHT;	//screen y, two pages to scroll and flip over
+
+		value = PropertyAddTag(&message, PROPERTY_TAG_SET_DEPTH, 4, 4);
+		value[0] = 32;		//bits per pixel
+		//pixel format is ARGB, 0xFF0000FF is blue at full alpha transparency
+
+		value = PropertyAddTag(&message, PROPERTY_TAG_ALLOCATE_BUFFER, 8, 4);
+		value[0] = 0;		//framebuffer address, and its size after it
+	}while(PropertyCall(&message) != PROPERTY_OK || !PropertyGetTag(&message, PROPERTY_TAG_ALLOCATE_BUFFER));
 
 	//https://github.com/raspberrypi/firmware/wiki/Accessing-mailboxes
 	//shift FB by 0x40000000 if L2 cache is enabled, or 0xC0000000 if disabled
-	framebuffer = (unsigned int*)(mailbuffer[19] - 0xC0000000);
+	framebuffer = (unsigned int*)(PropertyGetTag(&message, PROPERTY_TAG_ALLOCATE_BUFFER)[0] - 0xC0000000);
+	value = PropertyGetTag(&message, PROPERTY_TAG_SET_VIRTUAL_SIZE);
+	SCREEN_VIRTUAL_HEIGHT = value ? value[1] : SCREEN_HEIGHT;
+	TextInit();
 	loaded = 1;
 }
 
+//which part of the virtual framebuffer is shown, with tag 0x00048009 (set
+//virtual offset).  with wait, tag 0x0004800E (wait for vsync) follows it in
+//the same request, so the old part is no longer being scanned out when
+//this returns.  the calling task sleeps meanwhile, rather than the core
+//spinning through most of a frame
+static unsigned int offsetbuffer[12] MMU_COHERENT __attribute__((aligned (16)));
+
+__attribute__((no_instrument_function))
+static void setOffset(int x, int y, int wait){
+	PropertyMessage message;
+	unsigned int *value;
+
+	PropertyInit(&message, offsetbuffer, 12);
+	value = PropertyAddTag(&message, PROPERTY_TAG_SET_VIRTUAL_OFFSET, 8, 8);
+	value[0] = x;
+	value[1] = y;
+	if(wait){
+		PropertyAddTag(&message, PROPERTY_TAG_WAIT_FOR_VSYNC, 4, 4);
+	}
+
+	PropertyCall(&message);
+}
+
+__attribute__((no_instrument_function))
+void setVirtualOffset(int x, int y){
+	setOffset(x, y, 0);
+}
+
+//page flipping over the two screens of the virtual framebuffer.  it takes
+//the screen over from the console, which scrolls over the same two screens
+static int shownPage = 0;
+
+__attribute__((no_instrument_function))
+unsigned int* getBackBuffer(){
+	if(SCREEN_VIRTUAL_HEIGHT < 2 * SCREEN_HEIGHT) return framebuffer;
+	return framebuffer + (shownPage ^ 1) * SCREEN_HEIGHT * SCREEN_WIDTH;
+}
+
+__attribute__((no_instrument_function))
+void flipBuffers(){
+	if(SCREEN_VIRTUAL_HEIGHT < 2 * SCREEN_HEIGHT) return;
+	shownPage ^= 1;
+	setOffset(0, shownPage * SCREEN_HEIGHT, 1);
+}
+
 __attribute__((no_instrument_function))
 void drawPixel(unsigned int x, unsigned int y, int colour) {
     framebuffer[y * SCREEN_WIDTH + x] = colour;
@@ -147,36 +190,44 @@ void drawString(const char* str, int x, int y, int colour){
 	}
 }
 
-int position_x = 0;
-int position_y = 0;
+//the row the next line goes on.  once the screen is full, each line
+//scrolls it up one row (see TextScroll()), without copying any pixels
+static int consoleRow = 0;
+
+//puts one line in the text cells and draws the cells that changed
+__attribute__((no_instrument_function))
+static void drawLine(const char* message, int colour){
+	if(consoleRow >= TextRows()){
+		TextScroll();
+		consoleRow = TextRows() - 1;
+	}
+	TextPutString(0, consoleRow, message, colour);
+	TextFlush();
+	consoleRow++;
+}
+
+//hands the drawing to a task of its own, see logring.h
+void startConsole(unsigned long priority){
+	LogRingStart(drawLine, priority);
+}
+
+//queues the line for the console task once it is started, and until then
+//draws it straight away with IRQs off
 __attribute__((no_instrument_function))
 void println(const char* message, int colour){
 	if(loaded == 0) return; //if video isn't loaded don't bother
 
+	if(LogRingRunning()){
+		LogRingWrite(message, colour);
+		return;
+	}
+
 	int nFlags;
 	__asm volatile ("mrs %0, cpsr" : "=r" (nFlags));
 	char s_bWereEnabled = nFlags & 0x80 ? 0 : 1; 
 	if(s_bWereEnabled) __asm volatile ("cpsid i" : : : "memory");
 
-	drawString(message, position_x, position_y, colour);
-	position_y = position_y + CHAR_HEIGHT + 1;
-	if(position_y >= SCREEN_HEIGHT){
-		if(position_x + 2 * (SCREEN_WIDTH / 8) > SCREEN_WIDTH){
-
-			volatile int* timeStamp = (int*)0x3f003004;
-			int stop = *timeStamp + 5000 * 1000;
-			while (*timeStamp < stop) __asm__("nop");
-
-			for(int x = 0; x < SCREEN_WIDTH * SCREEN_HEIGHT; x++){
-				framebuffer[x] = 0xFF000000;
-			}
-			position_y = 0;
-			position_x = 0;
-		}else{
-			position_y = 0;
-			position_x += SCREEN_WIDTH / 8;
-		}
-	}
+	drawLine(message, colour);
 
 	if(s_bWereEnabled) __asm volatile ("cpsie i" : : : "memory");
 }
@@ -186,9 +237,9 @@ void printHex(const char* message, int hexi, int colour){
 if(loaded == 0) return; //if video isn't loaded don't bother
 	char hex[16] = {'0','1','2','3','4','5','6','7',
 					'8','9','A','B','C','D','E','F'};
-	char m[200];
+	char m[LOG_RING_LINE_LENGTH];
 	int i = 0;
-	while (*message){
+	while (*message && i < LOG_RING_LINE_LENGTH - 9){
 		m[i] = *message++;
 		i++;
 	}
@@ -3,6 +3,22 @@
 char loaded;
 void enablelogging();
 void initFB();
+
+extern unsigned int* framebuffer;
+extern int SCREEN_WIDTH;
+extern int SCREEN_HEIGHT;
+extern int SCREEN_VIRTUAL_HEIGHT;
+
+//the virtual framebuffer is two screens tall where the GPU allows it.  the
+//console scrolls over them (see textmode.h); getBackBuffer() and
+//flipBuffers() instead draw a whole screen on the hidden one and show it
+//once the display is done with the other, which takes the screen over from
+//the console.  with a single screen the back buffer is the front one
+void setVirtualOffset(int x, int y);
+unsigned int* getBackBuffer();
+void flipBuffers();
+
+void startConsole(unsigned long priority);
 void drawChar(unsigned char c, int x, int y, int colour);
 void drawString(const char* str, int x, int y, int colour);
 void println(const char* message, int colour);
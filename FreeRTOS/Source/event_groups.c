@@ -197,6 +197,7 @@ portBASE_TYPE xTimeoutOccurred = pdFALSE;
 	#endif
 
 	vTaskSuspendAll();
+	taskSMP_ENTER_CRITICAL();
 	{
 		uxOriginalBitValue = pxEventBits->uxEventBits;
 
@@ -238,6 +239,7 @@ portBASE_TYPE xTimeoutOccurred = pdFALSE;
 			}
 		}
 	}
+	taskSMP_EXIT_CRITICAL();
 	xAlreadyYielded = xTaskResumeAll();
 
 	if( xTicksToWait != ( portTickType ) 0 )
@@ -316,6 +318,7 @@ portBASE_TYPE xTimeoutOccurred = pdFALSE;
 	#endif
 
 	vTaskSuspendAll();
+	taskSMP_ENTER_CRITICAL();
 	{
 		const EventBits_t uxCurrentEventBits = pxEventBits->uxEventBits;
 
@@ -382,6 +385,7 @@ portBASE_TYPE xTimeoutOccurred = pdFALSE;
 			//traceEVENT_GROUP_WAIT_BITS_BLOCK( xEventGroup, uxBitsToWaitFor );
 		}
 	}
+	taskSMP_EXIT_CRITICAL();
 	xAlreadyYielded = xTaskResumeAll();
 
 	if( xTicksToWait != ( portTickType ) 0 )
@@ -520,6 +524,7 @@ portBASE_TYPE xMatchFound = pdFALSE;
 	pxList = &( pxEventBits->xTasksWaitingForBits );
 	pxListEnd = listGET_END_MARKER( pxList ); /*lint !e826 !e740 The mini list structure is used as the list end to save RAM.  This is checked and valid. */
 	vTaskSuspendAll();
+	taskSMP_ENTER_CRITICAL();
 	{
 		//traceEVENT_GROUP_SET_BITS( xEventGroup, uxBitsToSet );
 
@@ -591,6 +596,7 @@ portBASE_TYPE xMatchFound = pdFALSE;
 		bit was set in the control word. */
 		pxEventBits->uxEventBits &= ~uxBitsToClear;
 	}
+	taskSMP_EXIT_CRITICAL();
 	( void ) xTaskResumeAll();
 
 	return pxEventBits->uxEventBits;
@@ -603,6 +609,7 @@ EventGroup_t *pxEventBits = ( EventGroup_t * ) xEventGroup;
 const xList *pxTasksWaitingForBits = &( pxEventBits->xTasksWaitingForBits );
 
 	vTaskSuspendAll();
+	taskSMP_ENTER_CRITICAL();
 	{
 		//traceEVENT_GROUP_DELETE( xEventGroup );
 
@@ -616,6 +623,7 @@ const xList *pxTasksWaitingForBits = &( pxEventBits->xTasksWaitingForBits );
 
 		vPortFree( pxEventBits );
 	}
+	taskSMP_EXIT_CRITICAL();
 	( void ) xTaskResumeAll();
 }
 /*-----------------------------------------------------------*/
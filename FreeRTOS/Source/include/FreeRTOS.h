@@ -245,6 +245,91 @@ typedef portBASE_TYPE (*pdTASK_HOOK_CODE)( void * );
 	#define portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedStatusValue ) ( void ) uxSavedStatusValue
 #endif
 
+#ifndef configNUM_CORES
+	#define configNUM_CORES 1
+#endif
+
+#if ( configNUM_CORES > 1 )
+
+	/* An SMP port must say which core is executing, and be able to interrupt
+	another core so it reschedules. */
+	#ifndef portGET_CORE_ID
+		#error configNUM_CORES is greater than 1 but the port does not define portGET_CORE_ID().
+	#endif
+
+	#ifndef portYIELD_CORE
+		#error configNUM_CORES is greater than 1 but the port does not define portYIELD_CORE().
+	#endif
+
+#else
+
+	#ifndef portGET_CORE_ID
+		#define portGET_CORE_ID() 0
+	#endif
+
+	#ifndef portYIELD_CORE
+		#define portYIELD_CORE( xCoreID ) ( void ) ( xCoreID )
+	#endif
+
+#endif /* configNUM_CORES */
+
+#ifndef configUSE_PORT_OPTIMISED_TASK_SELECTION
+	#define configUSE_PORT_OPTIMISED_TASK_SELECTION 0
+#endif
+
+#ifndef configUSE_VFP
+	#define configUSE_VFP 0
+#endif
+
+#ifndef configUSE_TRACE_RECORDER
+	#define configUSE_TRACE_RECORDER 0
+#endif
+
+#ifndef configUSE_TICKLESS_IDLE
+	#define configUSE_TICKLESS_IDLE 0
+#endif
+
+#ifndef configUSE_TASK_NOTIFICATIONS
+	#define configUSE_TASK_NOTIFICATIONS 1
+#endif
+
+#ifndef configUSE_TIMING_WHEEL
+	#define configUSE_TIMING_WHEEL 0
+#endif
+
+#ifndef configTIMING_WHEEL_LEVELS
+	#define configTIMING_WHEEL_LEVELS 4
+#endif
+
+#if ( configUSE_TICKLESS_IDLE != 0 )
+
+	/* Only one core can stop the tick while the others still need it. */
+	#if ( configNUM_CORES > 1 )
+		#error configUSE_TICKLESS_IDLE is only supported when configNUM_CORES is 1.
+	#endif
+
+	#ifndef portSUPPRESS_TICKS_AND_SLEEP
+		#error configUSE_TICKLESS_IDLE is set but the port does not define portSUPPRESS_TICKS_AND_SLEEP().
+	#endif
+
+#endif /* configUSE_TICKLESS_IDLE */
+
+#ifndef configEXPECTED_IDLE_TIME_BEFORE_SLEEP
+	#define configEXPECTED_IDLE_TIME_BEFORE_SLEEP 2
+#endif
+
+#if configEXPECTED_IDLE_TIME_BEFORE_SLEEP < 2
+	#error configEXPECTED_IDLE_TIME_BEFORE_SLEEP must not be less than 2
+#endif
+
+#ifndef portSUPPRESS_TICKS_AND_SLEEP
+	#define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime )
+#endif
+
+#ifndef portUSING_FPU_CONTEXT
+	#define portUSING_FPU_CONTEXT 0
+#endif
+
 #ifndef portCLEAN_UP_TCB
 	#define portCLEAN_UP_TCB( pxTCB ) ( void ) pxTCB
 #endif
@@ -454,6 +539,48 @@ typedef portBASE_TYPE (*pdTASK_HOOK_CODE)( void * );
 	#define traceTASK_INCREMENT_TICK( xTickCount )
 #endif
 
+#ifndef traceLOW_POWER_IDLE_BEGIN
+	#define traceLOW_POWER_IDLE_BEGIN()
+#endif
+
+#ifndef traceLOW_POWER_IDLE_END
+	#define traceLOW_POWER_IDLE_END()
+#endif
+
+#ifndef traceTASK_NOTIFY
+	#define traceTASK_NOTIFY( pxTaskToNotify )
+#endif
+
+#ifndef traceTASK_NOTIFY_GIVE_FROM_ISR
+	#define traceTASK_NOTIFY_GIVE_FROM_ISR( pxTaskToNotify )
+#endif
+
+#ifndef traceTASK_NOTIFY_TAKE
+	#define traceTASK_NOTIFY_TAKE()
+#endif
+
+#ifndef traceTASK_NOTIFY_TAKE_BLOCK
+	#define traceTASK_NOTIFY_TAKE_BLOCK()
+#endif
+
+#ifndef traceTASK_NOTIFY_WAIT
+	#define traceTASK_NOTIFY_WAIT()
+#endif
+
+#ifndef traceTASK_NOTIFY_WAIT_BLOCK
+	#define traceTASK_NOTIFY_WAIT_BLOCK()
+#endif
+
+#ifndef traceISR_ENTER
+	/* Called by the port on entry to, and on return from, the interrupt
+	handler, with interrupts disabled. */
+	#define traceISR_ENTER()
+#endif
+
+#ifndef traceISR_EXIT
+	#define traceISR_EXIT()
+#endif
+
 #ifndef traceTIMER_CREATE
 	#define traceTIMER_CREATE( pxNewTimer )
 #endif
@@ -474,6 +601,14 @@ typedef portBASE_TYPE (*pdTASK_HOOK_CODE)( void * );
 	#define traceTIMER_COMMAND_RECEIVED( pxTimer, xMessageID, xMessageValue )
 #endif
 
+#ifndef traceMALLOC
+	#define traceMALLOC( pvAddress, uiSize )
+#endif
+
+#ifndef traceFREE
+	#define traceFREE( pvAddress, uiSize )
+#endif
+
 #ifndef configGENERATE_RUN_TIME_STATS
 	#define configGENERATE_RUN_TIME_STATS 0
 #endif
@@ -496,6 +631,17 @@ typedef portBASE_TYPE (*pdTASK_HOOK_CODE)( void * );
 	#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
 #endif
 
+/* A port can keep the time spent in interrupt handlers out of the task run
+time counters.  It then returns that time here, and returns the total the
+task and interrupt times add up to from portGET_RUN_TIME_TOTAL_VALUE(). */
+#ifndef portGET_INTERRUPT_RUN_TIME_COUNTER_VALUE
+	#define portGET_INTERRUPT_RUN_TIME_COUNTER_VALUE() 0UL
+#endif
+
+#ifndef portGET_RUN_TIME_TOTAL_VALUE
+	#define portGET_RUN_TIME_TOTAL_VALUE() portGET_RUN_TIME_COUNTER_VALUE()
+#endif
+
 #ifndef configUSE_MALLOC_FAILED_HOOK
 	#define configUSE_MALLOC_FAILED_HOOK 0
 #endif
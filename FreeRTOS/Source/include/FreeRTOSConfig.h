@@ -88,13 +88,110 @@
 #define configTICK_RATE_HZ			( ( portTickType ) 1000 )
 #define configMAX_PRIORITIES		( ( unsigned portBASE_TYPE ) 5 )
 #define configMINIMAL_STACK_SIZE	( ( unsigned short ) 128 )
+#ifndef POSIX_SIM
+/* The array of the heaps other than heap_5.c, which the board uses by default
+and which takes the RAM instead (see Drivers/heapregions.c). */
 #define configTOTAL_HEAP_SIZE		( ( size_t ) ( 122880 ) )
+#else
+/* Pointers and stack words are twice the size on a 64 bit host. */
+#define configTOTAL_HEAP_SIZE		( ( size_t ) ( 1048576 ) )
+#endif
 #define configMAX_TASK_NAME_LEN		( 16 )
-#define configUSE_TRACE_FACILITY	0
+#define configUSE_TRACE_FACILITY	1
 #define configUSE_16_BIT_TICKS		0
 #define configIDLE_SHOULD_YIELD		1
 #define configUSE_APPLICATION_TASK_TAG	1
 
+/* Several of the options below have so far only been run in the POSIX
+simulator (make posix-check), so the board build leaves them off until they
+have been run there. */
+
+/* Pick the next task from a bitmap of the ready priorities with the CLZ
+instruction instead of searching down the ready lists.  Limits
+configMAX_PRIORITIES to 32. */
+#ifndef POSIX_SIM
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION	0
+#else
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION	1
+#endif
+
+/* Number of Cortex-A53 cores the scheduler runs on.  1 keeps the original
+single core port, 2-4 brings the secondary cores up from xPortStartScheduler()
+and runs the kernel SMP (see portisr.c for the locking rules). */
+#define configNUM_CORES				1
+
+/* Take the tick from a compare channel of the 1MHz system timer rather than
+the SP804 ARM timer, which QEMU's raspi machines do not model (see port.c).
+Set by make SYSTIMER_TICK=1, and by make qemu. */
+#ifndef configUSE_SYSTEM_TIMER_TICK
+#define configUSE_SYSTEM_TIMER_TICK				0
+#endif
+
+/* Stop the tick interrupt while only the idle task can run, sleeping in WFI
+until the next delayed task is due (see vPortSuppressTicksAndSleep() in
+port.c).  Single core only. */
+#ifndef POSIX_SIM
+#define configUSE_TICKLESS_IDLE					0
+#else
+#define configUSE_TICKLESS_IDLE					1
+#endif
+#define configEXPECTED_IDLE_TIME_BEFORE_SLEEP	2
+
+/* Per task run time statistics, timed by the 1MHz system timer.  Time spent
+in interrupt handlers is counted separately (see port.c). */
+#ifndef POSIX_SIM
+#define configGENERATE_RUN_TIME_STATS			0
+#else
+#define configGENERATE_RUN_TIME_STATS			1
+#endif
+
+/* Give each task that uses the VFP/NEON its own copy of the registers,
+switched lazily on first use (see port.c).  Set by make VFP=1, which also
+lets the compiler use the VFP (see dbuild.config.mk).  Not used by the POSIX
+simulator, where the host saves the floating point registers with the rest of
+a task's context. */
+#ifndef configUSE_VFP
+#define configUSE_VFP							0
+#endif
+
+/* Record scheduler, queue and interrupt events into a binary ring buffer,
+drained over TCP (see Demo/trace.c).  The recorder reads the Pi's system
+timer, so it is left out of the POSIX simulator, and it is off until it has
+been run on the board. */
+#define configUSE_TRACE_RECORDER				0
+
+/* Track the heap's low water mark, largest free block and live allocations
+by call site, and print them periodically (see Demo/heapstats.c).  Needs
+heap_4, heap_5 or heap_tlsf for vPortGetHeapStats(). */
+#define configUSE_HEAP_STATS					0
+
+/* Give each task a 32 bit notification value, a lighter alternative to a
+binary semaphore when only one task waits (see xTaskNotify() in task.h).
+Needed by the mailbox, USB and network drivers, which wait on them. */
+#define configUSE_TASK_NOTIFICATIONS			1
+
+/* Keep delayed tasks and active timers in a hierarchical timing wheel rather
+than sorted lists, so blocking with a timeout costs the same however many other
+tasks are delayed.  Four levels of 32 slots cover 2^20 ticks before the far
+list is used (see wheel.h). */
+#ifndef POSIX_SIM
+#define configUSE_TIMING_WHEEL					0
+#else
+#define configUSE_TIMING_WHEEL					1
+#endif
+#define configTIMING_WHEEL_LEVELS				4
+
+/* Software timers.  Only the simulator uses them so far, where make
+posix-check checks the timer service's wheel (see Demo/Posix/tickcheck.c). */
+#ifndef POSIX_SIM
+#define configUSE_TIMERS						0
+#else
+#define configUSE_TIMERS						1
+#endif
+#define configTIMER_TASK_PRIORITY				( configMAX_PRIORITIES - 1 )
+#define configTIMER_QUEUE_LENGTH				10
+#define configTIMER_TASK_STACK_DEPTH			( configMINIMAL_STACK_SIZE * 2 )
+
 /* Co-routine definitions. */
 #define configUSE_CO_ROUTINES 		0
 #define configMAX_CO_ROUTINE_PRIORITIES ( 2 )
@@ -110,6 +207,7 @@ to exclude the API function. */
 #define INCLUDE_vTaskDelayUntil			1
 #define INCLUDE_vTaskDelay				1
 #define INCLUDE_xTaskGetCurrentTaskHandle 1
+#define INCLUDE_xTaskGetSchedulerState	1
 
 /* This is the raw value as per the Cortex-M3 NVIC.  Values can be 255
 (lowest) to 0 (1?) (highest). */
@@ -125,5 +223,18 @@ configKERNEL_INTERRUPT_PRIORITY setting.  Here 15 corresponds to the lowest
 NVIC value of 255. */
 #define configLIBRARY_KERNEL_INTERRUPT_PRIORITY	15
 
+#if ( configUSE_TRACE_RECORDER == 1 )
+	#include "trace.h"
+#endif
+
+/* Either the heap's live allocations are tracked by call site (see
+Demo/heapstats.c), or the simulator records every pvPortMalloc() and
+vPortFree() for the heap benchmark to replay (see Demo/Posix/heaptrace.c). */
+#if ( configUSE_HEAP_STATS == 1 )
+	#include "heapstats.h"
+#elif defined( POSIX_SIM )
+	#include "heaptrace.h"
+#endif
+
 #endif /* FREERTOS_CONFIG_H */
 
@@ -744,7 +744,7 @@ void vEventGroupSetBitsCallback( void *pvEventGroup, const unsigned int ulBitsTo
 void vEventGroupClearBitsCallback( void *pvEventGroup, const unsigned int ulBitsToClear );
 
 #if (configUSE_TRACE_FACILITY == 1)
-	UportBASE_TYPE uxEventGroupGetNumber( void* xEventGroup );
+	unsigned portBASE_TYPE uxEventGroupGetNumber( void* xEventGroup );
 #endif
 
 #ifdef __cplusplus
@@ -370,6 +370,37 @@ void vPortFree( void *pv ) PRIVILEGED_FUNCTION;
 void vPortInitialiseBlocks( void ) PRIVILEGED_FUNCTION;
 size_t xPortGetFreeHeapSize( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * A block of memory handed to heap_5.c, which takes its memory from an array
+ * of these, in increasing address order and ended by one of size zero.
+ */
+typedef struct xHEAP_REGION
+{
+	unsigned char *pucStartAddress;
+	size_t xSizeInBytes;
+} xHeapRegion;
+
+void vPortDefineHeapRegions( const xHeapRegion * const pxHeapRegions ) PRIVILEGED_FUNCTION;
+
+/*
+ * The state of the heap, as filled in by vPortGetHeapStats() of heap_4.c,
+ * heap_5.c and heap_tlsf.c.  The free blocks are walked with the scheduler
+ * suspended, so the call takes time in proportion to the fragmentation.
+ */
+typedef struct xHEAP_STATS
+{
+	size_t xAvailableHeapSpaceInBytes;		/* As xPortGetFreeHeapSize(). */
+	size_t xSizeOfLargestFreeBlockInBytes;	/* The largest allocation that can succeed, plus its header. */
+	size_t xSizeOfSmallestFreeBlockInBytes;
+	size_t xNumberOfFreeBlocks;
+	size_t xMinimumEverFreeBytesRemaining;	/* As xPortGetMinimumEverFreeHeapSize(). */
+	size_t xNumberOfSuccessfulAllocations;
+	size_t xNumberOfSuccessfulFrees;
+} xHeapStats;
+
+void vPortGetHeapStats( xHeapStats *pxHeapStats ) PRIVILEGED_FUNCTION;
+size_t xPortGetMinimumEverFreeHeapSize( void ) PRIVILEGED_FUNCTION;
+
 /*
  * Setup the hardware ready for the scheduler to take control.  This generally
  * sets up a tick interrupt and sets timers for the correct tick frequency.
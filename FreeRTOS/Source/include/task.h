@@ -107,6 +107,55 @@ typedef struct xTIME_OUT
 	portTickType  xTimeOnEntering;
 } xTimeOutType;
 
+/*
+ * Possible return values for eTaskConfirmSleepModeStatus().
+ */
+typedef enum
+{
+	eAbortSleep = 0,		/* A task has been made ready or a context switch pended since portSUPPRESS_TICKS_AND_SLEEP() was called - abort entering a sleep mode. */
+	eStandardSleep			/* Enter a sleep mode that will not last any longer than the expected idle time. */
+} eSleepModeStatus;
+
+/*
+ * Task states returned in xTaskStatusType by uxTaskGetSystemState().
+ */
+typedef enum
+{
+	eRunning = 0,	/* A task is querying the state of itself, so must be running. */
+	eReady,			/* The task being queried is in a ready or pending ready list. */
+	eBlocked,		/* The task being queried is in the Blocked state. */
+	eSuspended,		/* The task being queried is in the Suspended state, or is in the Blocked state with an infinite time out. */
+	eDeleted		/* The task being queried has been deleted, but its TCB has not yet been freed. */
+} eTaskState;
+
+/*
+ * Actions that can be performed when xTaskNotify() is called.
+ */
+typedef enum
+{
+	eNoAction = 0,				/* Notify the task without updating its notify value. */
+	eSetBits,					/* Set bits in the task's notification value. */
+	eIncrement,					/* Increment the task's notification value. */
+	eSetValueWithOverwrite,		/* Set the task's notification value to a specific value even if the previous value has not yet been read by the task. */
+	eSetValueWithoutOverwrite	/* Set the task's notification value if the previous value has been read by the task. */
+} eNotifyAction;
+
+/*
+ * Used with the uxTaskGetSystemState() function to return the state of each
+ * task in the system.
+ */
+typedef struct xTASK_STATUS
+{
+	xTaskHandle xHandle;						/* The handle of the task to which the rest of the information in the structure relates. */
+	const signed char *pcTaskName;				/* A pointer to the task's name. */
+	unsigned portBASE_TYPE xTaskNumber;			/* A number unique to the task. */
+	eTaskState eCurrentState;					/* The state in which the task existed when the structure was populated. */
+	unsigned portBASE_TYPE uxCurrentPriority;	/* The priority at which the task was running (may be inherited) when the structure was populated. */
+	unsigned portBASE_TYPE uxBasePriority;		/* The priority to which the task will return if the task's current priority has been inherited to avoid unbounded priority inversion when obtaining a mutex.  Only valid if configUSE_MUTEXES is defined as 1 in FreeRTOSConfig.h. */
+	unsigned long ulRunTimeCounter;				/* The total run time allocated to the task so far, as defined by the run time stats clock.  Only valid when configGENERATE_RUN_TIME_STATS is defined as 1 in FreeRTOSConfig.h. */
+	unsigned short usStackHighWaterMark;		/* The minimum amount of stack space that has remained for the task since the task was created.  The closer this value is to zero the closer the task has come to overflowing its stack. */
+} xTaskStatusType;
+
 /*
  * Defines the memory ranges allocated to the task when an MPU is used.
  */
@@ -138,6 +187,14 @@ typedef struct xTASK_PARAMTERS
  */
 #define tskIDLE_PRIORITY			( ( unsigned portBASE_TYPE ) 0U )
 
+/*
+ * Core affinity mask that lets a task run on any core.  Bit n of an affinity
+ * mask set means the task may be scheduled on core n.
+ *
+ * \ingroup Tasks
+ */
+#define tskNO_AFFINITY				( ( unsigned portBASE_TYPE ) ( ( 1UL << configNUM_CORES ) - 1UL ) )
+
 /**
  * task. h
  *
@@ -176,6 +233,20 @@ typedef struct xTASK_PARAMTERS
  */
 #define taskEXIT_CRITICAL()			portEXIT_CRITICAL()
 
+/*
+ * On SMP builds vTaskSuspendAll() only stops the calling core switching
+ * tasks, and the other cores carry on.  Code that relies on the scheduler
+ * being suspended to keep data to itself also takes the kernel lock around
+ * the accesses, with these.  They do nothing on a single core.
+ */
+#if ( configNUM_CORES > 1 )
+	#define taskSMP_ENTER_CRITICAL()	portENTER_CRITICAL()
+	#define taskSMP_EXIT_CRITICAL()		portEXIT_CRITICAL()
+#else
+	#define taskSMP_ENTER_CRITICAL()
+	#define taskSMP_EXIT_CRITICAL()
+#endif
+
 /**
  * task. h
  *
@@ -283,6 +354,70 @@ typedef struct xTASK_PARAMTERS
  */
 #define xTaskCreate( pvTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pxCreatedTask ) xTaskGenericCreate( ( pvTaskCode ), ( pcName ), ( usStackDepth ), ( pvParameters ), ( uxPriority ), ( pxCreatedTask ), ( NULL ), ( NULL ) )
 
+#if ( configNUM_CORES > 1 )
+
+/**
+ * task. h
+ *<pre>
+ portBASE_TYPE xTaskCreateAffinitySet(
+							  pdTASK_CODE pvTaskCode,
+							  const char * const pcName,
+							  unsigned short usStackDepth,
+							  void *pvParameters,
+							  unsigned portBASE_TYPE uxPriority,
+							  unsigned portBASE_TYPE uxCoreAffinityMask,
+							  xTaskHandle *pvCreatedTask
+						  );</pre>
+ *
+ * Only available when configNUM_CORES is greater than 1.
+ *
+ * As xTaskCreate(), but the task is only ever scheduled on the cores whose
+ * bit is set in uxCoreAffinityMask.  The mask is applied before the task is
+ * made ready, so it never runs on a core outside the mask.  tskNO_AFFINITY
+ * gives the same behaviour as xTaskCreate().
+ *
+ * Example usage:
+   <pre>
+ // Keep the Ethernet poll loop on core 1, away from the tick on core 0.
+ xTaskCreateAffinitySet( ethernetPollTask, "poll", 256, NULL, 0, ( 1 << 1 ), NULL );
+   </pre>
+ * \defgroup xTaskCreateAffinitySet xTaskCreateAffinitySet
+ * \ingroup Tasks
+ */
+#define xTaskCreateAffinitySet( pvTaskCode, pcName, usStackDepth, pvParameters, uxPriority, uxCoreAffinityMask, pxCreatedTask ) xTaskGenericCreateAffinitySet( ( pvTaskCode ), ( pcName ), ( usStackDepth ), ( pvParameters ), ( uxPriority ), ( pxCreatedTask ), ( NULL ), ( NULL ), ( uxCoreAffinityMask ) )
+
+/**
+ * task. h
+ * <pre>void vTaskCoreAffinitySet( xTaskHandle xTask, unsigned portBASE_TYPE uxCoreAffinityMask );</pre>
+ *
+ * Only available when configNUM_CORES is greater than 1.
+ *
+ * Changes the set of cores xTask may run on.  Passing xTask as NULL changes
+ * the affinity of the calling task.  If the task is running on a core that
+ * is no longer in the mask it is moved at that core's next reschedule, which
+ * is forced immediately.
+ *
+ * \defgroup vTaskCoreAffinitySet vTaskCoreAffinitySet
+ * \ingroup Tasks
+ */
+void vTaskCoreAffinitySet( xTaskHandle xTask, unsigned portBASE_TYPE uxCoreAffinityMask ) PRIVILEGED_FUNCTION;
+
+/**
+ * task. h
+ * <pre>unsigned portBASE_TYPE uxTaskCoreAffinityGet( xTaskHandle xTask );</pre>
+ *
+ * Only available when configNUM_CORES is greater than 1.
+ *
+ * @return The core affinity mask of xTask, or of the calling task if xTask
+ * is NULL.
+ *
+ * \defgroup uxTaskCoreAffinityGet uxTaskCoreAffinityGet
+ * \ingroup Tasks
+ */
+unsigned portBASE_TYPE uxTaskCoreAffinityGet( xTaskHandle xTask ) PRIVILEGED_FUNCTION;
+
+#endif /* configNUM_CORES */
+
 /**
  * task. h
  *<pre>
@@ -865,6 +1000,10 @@ void vTaskEndScheduler( void ) PRIVILEGED_FUNCTION;
  * without risk of being swapped out until a call to xTaskResumeAll () has been
  * made.
  *
+ * When configNUM_CORES is greater than 1 only the calling core is affected.
+ * Tasks on the other cores keep running, so data shared with them still needs
+ * a critical section (see taskSMP_ENTER_CRITICAL()).
+ *
  * API functions that have the potential to cause a context switch (for example,
  * vTaskDelayUntil(), xQueueSend(), etc.) must not be called while the scheduler
  * is suspended.
@@ -1053,6 +1192,48 @@ signed char *pcTaskGetTaskName( xTaskHandle xTaskToQuery );
  */
 void vTaskList( signed char *pcWriteBuffer ) PRIVILEGED_FUNCTION;
 
+/**
+ * task. h
+ * <PRE>unsigned portBASE_TYPE uxTaskGetSystemState( xTaskStatusType *pxTaskStatusArray, unsigned portBASE_TYPE uxArraySize, unsigned long *pulTotalRunTime );</PRE>
+ *
+ * configUSE_TRACE_FACILITY must be defined as 1 for this function to be
+ * available.  See the configuration section for more information.
+ *
+ * uxTaskGetSystemState() populates an xTaskStatusType structure for each
+ * task in the system.  Unlike vTaskList() it does not format any text, so the
+ * snapshot can be processed or sent on by the application.
+ *
+ * NOTE: This function is intended for debugging use only as its use results
+ * in the scheduler remaining suspended for an extended period.
+ *
+ * @param pxTaskStatusArray A pointer to an array of xTaskStatusType
+ * structures.  The array must contain at least one xTaskStatusType structure
+ * for each task that is under the control of the RTOS.  The number of tasks
+ * under the control of the RTOS can be determined using the
+ * uxTaskGetNumberOfTasks() API function.
+ *
+ * @param uxArraySize The size of the array pointed to by the
+ * pxTaskStatusArray parameter.  The size is specified as the number of
+ * indexes in the array, or the number of xTaskStatusType structures
+ * contained in the array, not by the number of bytes in the array.
+ *
+ * @param pulTotalRunTime If configGENERATE_RUN_TIME_STATS is set to 1 in
+ * FreeRTOSConfig.h then *pulTotalRunTime is set by uxTaskGetSystemState() to
+ * the total run time (as defined by the run time stats clock) since the
+ * target booted, summed over the cores.  Each ulRunTimeCounter can be divided
+ * by it to get the share of the CPU the task has used.  pulTotalRunTime can
+ * be set to NULL to omit the total run time information.
+ *
+ * @return The number of xTaskStatusType structures that were populated by
+ * uxTaskGetSystemState().  This should equal the number returned by the
+ * uxTaskGetNumberOfTasks() API function, but will be zero if the value
+ * passed in the uxArraySize parameter was too small.
+ *
+ * \page uxTaskGetSystemState uxTaskGetSystemState
+ * \ingroup TaskUtils
+ */
+unsigned portBASE_TYPE uxTaskGetSystemState( xTaskStatusType * const pxTaskStatusArray, const unsigned portBASE_TYPE uxArraySize, unsigned long * const pulTotalRunTime ) PRIVILEGED_FUNCTION;
+
 /**
  * task. h
  * <PRE>void vTaskGetRunTimeStats( char *pcWriteBuffer );</PRE>
@@ -1073,7 +1254,10 @@ void vTaskList( signed char *pcWriteBuffer ) PRIVILEGED_FUNCTION;
  * configured by the portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() macro.
  * Calling vTaskGetRunTimeStats() writes the total execution time of each
  * task into a buffer, both as an absolute count value and as a percentage
- * of the total system execution time.
+ * of the total system execution time.  If the port also accounts for the
+ * time spent in interrupt handlers (see
+ * portGET_INTERRUPT_RUN_TIME_COUNTER_VALUE()) that time is left out of the
+ * tasks' counts and written as a final line named "ISR".
  *
  * @param pcWriteBuffer A buffer into which the execution times will be
  * written, in ascii form.  This buffer is assumed to be large enough to
@@ -1085,6 +1269,22 @@ void vTaskList( signed char *pcWriteBuffer ) PRIVILEGED_FUNCTION;
  */
 void vTaskGetRunTimeStats( signed char *pcWriteBuffer ) PRIVILEGED_FUNCTION;
 
+/**
+ * task. h
+ * <PRE>unsigned long ulTaskGetInterruptRunTime( void );</PRE>
+ *
+ * configGENERATE_RUN_TIME_STATS must be defined as 1 for this function
+ * to be available.
+ *
+ * @return The total time spent in interrupt handlers, in run time stats
+ * clock counts, or 0 if the port does not account for interrupts
+ * separately.  Compare it with the total returned by uxTaskGetSystemState().
+ *
+ * \page ulTaskGetInterruptRunTime ulTaskGetInterruptRunTime
+ * \ingroup TaskUtils
+ */
+unsigned long ulTaskGetInterruptRunTime( void ) PRIVILEGED_FUNCTION;
+
 /**
  * task.h
  * <PRE>unsigned portBASE_TYPE uxTaskGetStackHighWaterMark( xTaskHandle xTask );</PRE>
@@ -1154,6 +1354,121 @@ portBASE_TYPE xTaskCallApplicationTaskHook( xTaskHandle xTask, void *pvParameter
  */
 xTaskHandle xTaskGetIdleTaskHandle( void );
 
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+
+/**
+ * task.h
+ * <pre>portBASE_TYPE xTaskNotify( xTaskHandle xTaskToNotify, unsigned long ulValue, eNotifyAction eAction );</pre>
+ *
+ * configUSE_TASK_NOTIFICATIONS must be 1 (the default) for the notification
+ * functions to be available.
+ *
+ * Each task has a 32 bit notification value.  Sending a notification to a
+ * task updates that value and unblocks the task if it is waiting in
+ * xTaskNotifyWait() or ulTaskNotifyTake().  No queue or semaphore object is
+ * involved, so a notification is cheaper than giving a binary semaphore, but
+ * only one task - the one being notified - can ever wait for it.
+ *
+ * @param xTaskToNotify The handle of the task being notified.
+ *
+ * @param ulValue Used to update the notification value of the task, as
+ * described by eAction.
+ *
+ * @param eAction eNoAction leaves the value unchanged, eSetBits ORs ulValue
+ * into it, eIncrement adds one to it (ulValue is unused), and
+ * eSetValueWithOverwrite writes ulValue to it.  eSetValueWithoutOverwrite
+ * only writes ulValue if the task had no notification pending.
+ *
+ * @return pdFAIL if eAction was eSetValueWithoutOverwrite and the value could
+ * not be written, otherwise pdPASS.
+ *
+ * \defgroup xTaskNotify xTaskNotify
+ * \ingroup TaskNotifications
+ */
+portBASE_TYPE xTaskGenericNotify( xTaskHandle xTaskToNotify, unsigned long ulValue, eNotifyAction eAction, unsigned long *pulPreviousNotificationValue ) PRIVILEGED_FUNCTION;
+#define xTaskNotify( xTaskToNotify, ulValue, eAction ) xTaskGenericNotify( ( xTaskToNotify ), ( ulValue ), ( eAction ), NULL )
+#define xTaskNotifyAndQuery( xTaskToNotify, ulValue, eAction, pulPreviousNotifyValue ) xTaskGenericNotify( ( xTaskToNotify ), ( ulValue ), ( eAction ), ( pulPreviousNotifyValue ) )
+
+/**
+ * task.h
+ * <pre>portBASE_TYPE xTaskNotifyGive( xTaskHandle xTaskToNotify );</pre>
+ *
+ * A lighter weight alternative to xSemaphoreGive() for when the semaphore is
+ * only ever taken by one task.  Increments the notification value of the
+ * task, which should be waiting in ulTaskNotifyTake().
+ *
+ * \defgroup xTaskNotifyGive xTaskNotifyGive
+ * \ingroup TaskNotifications
+ */
+#define xTaskNotifyGive( xTaskToNotify ) xTaskGenericNotify( ( xTaskToNotify ), ( 0UL ), eIncrement, NULL )
+
+/**
+ * task.h
+ * <pre>void vTaskNotifyGiveFromISR( xTaskHandle xTaskToNotify, portBASE_TYPE *pxHigherPriorityTaskWoken );</pre>
+ *
+ * Version of xTaskNotifyGive() that can be used from an interrupt service
+ * routine.
+ *
+ * @param pxHigherPriorityTaskWoken Set to pdTRUE if the notified task was
+ * unblocked and should run before the interrupted task, in which case a
+ * context switch should be requested before the interrupt exits.  It is
+ * never set to pdFALSE, so must be initialised by the caller.
+ *
+ * \defgroup vTaskNotifyGiveFromISR vTaskNotifyGiveFromISR
+ * \ingroup TaskNotifications
+ */
+void vTaskNotifyGiveFromISR( xTaskHandle xTaskToNotify, portBASE_TYPE *pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * task.h
+ * <pre>portBASE_TYPE xTaskNotifyWait( unsigned long ulBitsToClearOnEntry, unsigned long ulBitsToClearOnExit, unsigned long *pulNotificationValue, portTickType xTicksToWait );</pre>
+ *
+ * Waits, optionally in the Blocked state, for the calling task to be
+ * notified.
+ *
+ * @param ulBitsToClearOnEntry Bits cleared in the notification value before
+ * waiting, if no notification was already pending.
+ *
+ * @param ulBitsToClearOnExit Bits cleared in the notification value once a
+ * notification has been received.
+ *
+ * @param pulNotificationValue If not NULL, receives the notification value
+ * before ulBitsToClearOnExit is applied.
+ *
+ * @param xTicksToWait The maximum time to wait, in ticks.  portMAX_DELAY
+ * waits indefinitely when INCLUDE_vTaskSuspend is 1.
+ *
+ * @return pdTRUE if a notification was received, pdFALSE on timeout.
+ *
+ * \defgroup xTaskNotifyWait xTaskNotifyWait
+ * \ingroup TaskNotifications
+ */
+portBASE_TYPE xTaskNotifyWait( unsigned long ulBitsToClearOnEntry, unsigned long ulBitsToClearOnExit, unsigned long *pulNotificationValue, portTickType xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * task.h
+ * <pre>unsigned long ulTaskNotifyTake( portBASE_TYPE xClearCountOnExit, portTickType xTicksToWait );</pre>
+ *
+ * The counterpart of xTaskNotifyGive() and vTaskNotifyGiveFromISR(), used
+ * like xSemaphoreTake() on a binary or counting semaphore.  Waits, optionally
+ * in the Blocked state, for the notification value to be non-zero.
+ *
+ * @param xClearCountOnExit pdTRUE to zero the notification value on exit,
+ * making it behave as a binary semaphore, or pdFALSE to decrement it, making
+ * it behave as a counting semaphore.
+ *
+ * @param xTicksToWait The maximum time to wait, in ticks.
+ *
+ * @return The notification value before it was cleared or decremented.  Zero
+ * means the wait timed out.
+ *
+ * \defgroup ulTaskNotifyTake ulTaskNotifyTake
+ * \ingroup TaskNotifications
+ */
+unsigned long ulTaskNotifyTake( portBASE_TYPE xClearCountOnExit, portTickType xTicksToWait ) PRIVILEGED_FUNCTION;
+
+#endif /* configUSE_TASK_NOTIFICATIONS */
+
 /*-----------------------------------------------------------
  * SCHEDULER INTERNALS AVAILABLE FOR PORTING PURPOSES
  *----------------------------------------------------------*/
@@ -1170,6 +1485,31 @@ xTaskHandle xTaskGetIdleTaskHandle( void );
  */
 void vTaskIncrementTick( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS ONLY
+ * INTENDED FOR USE WHEN IMPLEMENTING A PORT OF THE SCHEDULER AND IS
+ * AN INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
+ *
+ * Only available when configUSE_TICKLESS_IDLE is set to 1.  Called by the
+ * port after it has slept with the tick interrupt stopped, to move the tick
+ * count forward by the number of whole tick periods that passed.  Must be
+ * called with the scheduler suspended and interrupts disabled, and must not
+ * move the tick count past the time the next delayed task is due to unblock.
+ */
+void vTaskStepTick( portTickType xTicksToJump ) PRIVILEGED_FUNCTION;
+
+/*
+ * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS ONLY
+ * INTENDED FOR USE WHEN IMPLEMENTING A PORT OF THE SCHEDULER AND IS
+ * AN INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
+ *
+ * Only available when configUSE_TICKLESS_IDLE is set to 1.  Called from
+ * within portSUPPRESS_TICKS_AND_SLEEP() with interrupts disabled, to check
+ * that nothing made a task ready between the idle task deciding to sleep and
+ * the port masking interrupts.
+ */
+eSleepModeStatus eTaskConfirmSleepModeStatus( void ) PRIVILEGED_FUNCTION;
+
 /*
  * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS AN
  * INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
@@ -1240,6 +1580,13 @@ void vTaskSwitchContext( void ) PRIVILEGED_FUNCTION;
  */
 xTaskHandle xTaskGetCurrentTaskHandle( void ) PRIVILEGED_FUNCTION;
 
+#if ( portUSING_FPU_CONTEXT == 1 )
+	/*
+	 * Offset of the port's xFPU_CONTEXT within a task's TCB.
+	 */
+	extern const unsigned long ulTaskFPUContextOffset;
+#endif
+
 /*
  * Capture the current time status for future reference.
  */
@@ -1281,6 +1628,16 @@ void vTaskPriorityDisinherit( xTaskHandle * const pxMutexHolder ) PRIVILEGED_FUN
  */
 signed portBASE_TYPE xTaskGenericCreate( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, xTaskHandle *pxCreatedTask, portSTACK_TYPE *puxStackBuffer, const xMemoryRegion * const xRegions ) PRIVILEGED_FUNCTION;
 
+#if ( configNUM_CORES > 1 )
+
+/*
+ * Version of xTaskGenericCreate() that takes the set of cores the new task
+ * may run on.  Called by the xTaskCreateAffinitySet() macro.
+ */
+signed portBASE_TYPE xTaskGenericCreateAffinitySet( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, xTaskHandle *pxCreatedTask, portSTACK_TYPE *puxStackBuffer, const xMemoryRegion * const xRegions, unsigned portBASE_TYPE uxCoreAffinityMask ) PRIVILEGED_FUNCTION;
+
+#endif
+
 /*
  * Get the uxTCBNumber assigned to the task referenced by the xTask parameter.
  */
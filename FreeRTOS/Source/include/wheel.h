@@ -0,0 +1,105 @@
+/*
+ * Hierarchical timing wheel, used in place of a sorted xList to hold items
+ * that expire at a given tick.  Enabled for the delayed task list and the
+ * timer service by setting configUSE_TIMING_WHEEL to 1 in FreeRTOSConfig.h.
+ *
+ * Each level has wheelSLOTS slots, and each slot is an ordinary unsorted xList.
+ * Slot n of level 0 holds the items expiring in exactly n ticks' time (modulo
+ * wheelSLOTS).  Each level above that covers wheelSLOTS times the span of the
+ * one below, and a slot's items are moved down a level ("cascaded") when time
+ * reaches the start of that slot.  Items due beyond the top level wait in a
+ * single far list which is refiled each time the top level moves on a slot.
+ *
+ * Inserting is therefore constant time, whatever the number of items.  Items
+ * are removed with vListRemove() like any other list item, also in constant
+ * time.  An occupancy bitmap per level lets the wheel skip empty slots, so
+ * expired items are found without stepping through every tick.
+ *
+ * The item value holds the tick at which the item expires, as with the sorted
+ * lists.  Times are compared modulo the tick counter width, so there is no
+ * overflow list to swap when the tick count wraps.
+ *
+ * Access to a wheel must be serialised by the caller, in the same way as
+ * access to a list.
+ */
+
+#ifndef WHEEL_H
+#define WHEEL_H
+
+#ifndef INC_FREERTOS_H
+	#error "include FreeRTOS.h must appear in source files before include wheel.h"
+#endif
+
+#include "list.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if ( configUSE_16_BIT_TICKS == 1 )
+	#error The timing wheel requires 32 bit ticks.
+#endif
+
+#if ( configTIMING_WHEEL_LEVELS < 1 ) || ( configTIMING_WHEEL_LEVELS > 6 )
+	#error configTIMING_WHEEL_LEVELS must be between 1 and 6.
+#endif
+
+#define wheelSLOT_BITS		5
+#define wheelSLOTS			( 1 << wheelSLOT_BITS )
+
+/* All the lists in a wheel.  Level n slot s is xLists[ ( n * wheelSLOTS ) + s ],
+and the far list is last. */
+#define wheelNUM_LISTS		( ( configTIMING_WHEEL_LEVELS * wheelSLOTS ) + 1 )
+
+typedef struct xTIMING_WHEEL
+{
+	xList xLists[ wheelNUM_LISTS ];
+	unsigned long ulOccupied[ configTIMING_WHEEL_LEVELS ];	/*< Bit s is set if slot s of the level may hold items.  Bits are only cleared when the wheel finds the slot empty. */
+	portTickType xLastTick;									/*< The wheel has been advanced up to and including this tick. */
+	portTickType xNextEvent;								/*< No item needs attention before this tick.  Either an item expires, or a slot is cascaded. */
+} xTimingWheel;
+
+/*
+ * Evaluates to pdTRUE if pxWheelGetExpired() could return an item at
+ * xTimeNow.  Cheap enough to be called from the tick interrupt every tick.
+ */
+#define wheelIS_DUE( pxWheel, xTimeNow )	( ( ( portTickType ) ( ( xTimeNow ) - ( pxWheel )->xLastTick ) ) >= ( ( portTickType ) ( ( pxWheel )->xNextEvent - ( pxWheel )->xLastTick ) ) )
+
+/*
+ * The next tick at which the wheel needs attention.  This can be earlier than
+ * the first expiry time, but never later.  It is only after the current time
+ * while wheelIS_DUE() is false.
+ */
+#define wheelGET_NEXT_EVENT( pxWheel )		( ( pxWheel )->xNextEvent )
+
+/*
+ * Must be called before a wheel is used.
+ */
+void vWheelInitialise( xTimingWheel *pxWheel );
+
+/*
+ * Insert pxNewListItem into the wheel.  Its item value must already be set to
+ * the tick at which it expires, which must be no more than portMAX_DELAY
+ * ticks after xTimeNow.  xTimeNow is the current tick, and must not go
+ * backwards between calls.  Unless the wheel is due, it is first moved on to
+ * xTimeNow.
+ */
+void vWheelInsert( xTimingWheel *pxWheel, xListItem *pxNewListItem, portTickType xTimeNow );
+
+/*
+ * Advance the wheel to xTimeNow and remove and return one item that has
+ * expired, or return NULL if there are none.  Call repeatedly until NULL is
+ * returned to collect all the expired items.
+ */
+xListItem *pxWheelGetExpired( xTimingWheel *pxWheel, portTickType xTimeNow );
+
+/*
+ * Returns pdTRUE if there are no items in the wheel.
+ */
+portBASE_TYPE xWheelIsEmpty( xTimingWheel *pxWheel );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
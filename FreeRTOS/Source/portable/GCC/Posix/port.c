@@ -0,0 +1,533 @@
+/*
+ *	POSIX simulator port for FreeRTOS.
+ *
+ *	Runs the kernel, and whatever runs on it, as an ordinary Linux process so
+ *	that changes to the scheduler, the allocators or the TCP stack can be
+ *	measured without flashing an SD card.  Build it with "make posix".
+ *
+ *	Every task is a ucontext with its own host stack, mapped with mmap() when
+ *	the task is created.  All the tasks run in the one thread of the process,
+ *	and a context switch is a swapcontext().  The FreeRTOS stack of a task is
+ *	only used to hold a pointer to its host context.
+ *
+ *	The tick is SIGALRM from an interval timer.  The handler increments the
+ *	tick and, with preemption, switches to the task the kernel picks from
+ *	inside the handler; the preempted task carries on from there when it is
+ *	next switched in.  "Interrupts" are masked with a flag, and a tick that
+ *	arrives while it is set is taken as soon as it is cleared.
+ *
+ *	A preempted task can be holding a lock inside the C library, so library
+ *	calls that take locks (malloc, stdio) should only be made with the
+ *	scheduler suspended or from a critical section.  pvPortMalloc() is safe.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <ucontext.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Host stack given to each task.  Far more than configMINIMAL_STACK_SIZE, as
+C library calls on the host need a lot more room than on the target. */
+#define portHOST_STACK_SIZE						( 256UL * 1024UL )
+
+/* Microseconds per tick. */
+#define portTICK_PERIOD_US						( 1000000UL / configTICK_RATE_HZ )
+
+/* Critical nesting while the scheduler is not running, so that interrupts are
+not enabled by a critical section exited before the first task starts. */
+#define portINITIAL_CRITICAL_NESTING			( 9999UL )
+#define portNO_CRITICAL_NESTING					( 0UL )
+
+#if ( configUSE_TICKLESS_IDLE != 0 )
+
+/* Longest sleep, kept well clear of the microsecond arithmetic overflowing. */
+#define portMAX_SUPPRESSED_TICKS				( ( portTickType ) ( 0x7FFFFFFFUL / portTICK_PERIOD_US ) )
+
+/* Shortest time the tick timer is restarted with, in microseconds. */
+#define portTIMER_MIN_RELOAD					( 2UL )
+
+#endif
+
+/* A task's host context.  The word at the top of its FreeRTOS stack points
+to it. */
+typedef struct xPOSIX_TASK_CONTEXT
+{
+	ucontext_t xContext;
+	unsigned long ulCriticalNesting;	/* Saved while the task is switched out. */
+	pdTASK_CODE pxCode;
+	void *pvParameters;
+	size_t xMappedSize;					/* This structure and the stack, in one mapping. */
+} xPosixContext;
+
+/* The first member of a TCB is its top of stack, and the word there points to
+the task's xPosixContext. */
+#define portCONTEXT_OF( pvTCB )				( *( xPosixContext ** ) ( *( portSTACK_TYPE ** ) ( pvTCB ) ) )
+
+extern void * volatile pxCurrentTCB;
+
+volatile unsigned long ulCriticalNesting = portINITIAL_CRITICAL_NESTING;
+
+/* Set while interrupts are disabled, and while a tick is being handled. */
+static volatile sig_atomic_t xInterruptsMasked = 1;
+
+/* A tick arrived while interrupts were masked. */
+static volatile sig_atomic_t xTickPending = 0;
+
+/* A FromISR call readied a task that should run when the tick handler ends. */
+static volatile sig_atomic_t xSwitchRequired = 0;
+
+/* Set while the tick is processed, up to the switch on its way out. */
+static volatile sig_atomic_t xInsideTick = 0;
+
+/* Where xPortStartScheduler() was called from, resumed by vPortEndScheduler(). */
+static ucontext_t xSchedulerContext;
+
+#if ( configGENERATE_RUN_TIME_STATS == 1 )
+
+/* CLOCK_MONOTONIC when the scheduler started, and time spent handling ticks. */
+static unsigned long ulRunTimeBase;
+static volatile unsigned long ulInterruptRunTime;
+static volatile unsigned long ulInterruptEntryTime;
+static volatile unsigned long ulInInterrupt;
+
+#endif
+
+/*-----------------------------------------------------------*/
+
+/* Setup the timer to generate the tick interrupts. */
+static void prvSetupTimerInterrupt( void );
+
+/* SIGALRM handler, the tick interrupt. */
+static void prvTickSignalHandler( int iSignal );
+
+/* Increment the tick and switch task if the kernel asks for it.  Called with
+interrupts masked. */
+static void prvProcessTick( void );
+
+/* Switch to the task vTaskSwitchContext() selects.  Called with interrupts
+masked, and returns when the calling task is switched back in. */
+static void prvSwitchContext( void );
+
+/* The host entry point of every task. */
+static void prvTaskEntry( void );
+
+/* Microseconds from CLOCK_MONOTONIC, wrapping at 32 bits as the target's
+system timer does. */
+static unsigned long prvMicroseconds( void );
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Map a host stack for the task and set up a context that starts it in
+ * prvTaskEntry().
+ *
+ * See header file for description.
+ */
+__attribute__((no_instrument_function))
+portSTACK_TYPE *pxPortInitialiseStack( portSTACK_TYPE *pxTopOfStack, pdTASK_CODE pxCode, void *pvParameters )
+{
+xPosixContext *pxContext;
+size_t xSize = sizeof( xPosixContext ) + portHOST_STACK_SIZE;
+
+	/* mmap() rather than malloc(), which may be called from a task that has
+	been preempted while holding the allocator's lock. */
+	pxContext = ( xPosixContext * ) mmap( NULL, xSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+	if( pxContext == ( xPosixContext * ) MAP_FAILED )
+	{
+		fprintf( stderr, "FreeRTOS: no memory for a task stack\n" );
+		abort();
+	}
+
+	getcontext( &( pxContext->xContext ) );
+	pxContext->xContext.uc_stack.ss_sp = ( void * ) ( pxContext + 1 );
+	pxContext->xContext.uc_stack.ss_size = portHOST_STACK_SIZE;
+	pxContext->xContext.uc_link = NULL;
+	sigemptyset( &( pxContext->xContext.uc_sigmask ) );
+	makecontext( &( pxContext->xContext ), prvTaskEntry, 0 );
+
+	pxContext->ulCriticalNesting = portNO_CRITICAL_NESTING;
+	pxContext->pxCode = pxCode;
+	pxContext->pvParameters = pvParameters;
+	pxContext->xMappedSize = xSize;
+
+	*pxTopOfStack = ( portSTACK_TYPE ) pxContext;
+
+	return pxTopOfStack;
+}
+/*-----------------------------------------------------------*/
+__attribute__((no_instrument_function))
+static void prvTaskEntry( void )
+{
+xPosixContext *pxContext = portCONTEXT_OF( pxCurrentTCB );
+
+	/* Tasks start with interrupts enabled, and a tick may have come in while
+	the previous task was being switched out. */
+	vPortEnableInterrupts();
+
+	pxContext->pxCode( pxContext->pvParameters );
+
+	/* Tasks should not return, but tidy up if one does. */
+	vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+__attribute__((no_instrument_function))
+void vPortCleanUpTCB( void *pvTCB )
+{
+xPosixContext *pxContext = portCONTEXT_OF( pvTCB );
+
+	/* Tasks are freed by the idle task, so this is never the running one. */
+	munmap( ( void * ) pxContext, pxContext->xMappedSize );
+}
+/*-----------------------------------------------------------*/
+__attribute__((no_instrument_function))
+portBASE_TYPE xPortStartScheduler( void )
+{
+struct sigaction xAction;
+
+	memset( &xAction, 0, sizeof( xAction ) );
+	xAction.sa_handler = prvTickSignalHandler;
+	xAction.sa_flags = SA_RESTART;
+	sigemptyset( &xAction.sa_mask );
+	sigaction( SIGALRM, &xAction, NULL );
+
+	/* Start the timer that generates the tick ISR.  Interrupts are disabled
+	here already. */
+	prvSetupTimerInterrupt();
+
+	/* Start the first task.  prvTaskEntry() enables interrupts. */
+	ulCriticalNesting = portNO_CRITICAL_NESTING;
+	swapcontext( &xSchedulerContext, &( portCONTEXT_OF( pxCurrentTCB )->xContext ) );
+
+	/* Back here once vPortEndScheduler() has been called. */
+	return 0;
+}
+/*-----------------------------------------------------------*/
+__attribute__((no_instrument_function))
+void vPortEndScheduler( void )
+{
+struct itimerval xStop;
+
+	/* Stop the tick and go back to where xPortStartScheduler() was called,
+	so the process can exit normally, for example at the end of a
+	benchmark. */
+	vPortDisableInterrupts();
+	memset( &xStop, 0, sizeof( xStop ) );
+	setitimer( ITIMER_REAL, &xStop, NULL );
+	setcontext( &xSchedulerContext );
+}
+/*-----------------------------------------------------------*/
+__attribute__((no_instrument_function))
+static void prvSetupTimerInterrupt( void )
+{
+struct itimerval xTimer;
+
+	xTimer.it_interval.tv_sec = 0;
+	xTimer.it_interval.tv_usec = portTICK_PERIOD_US;
+	xTimer.it_value = xTimer.it_interval;
+	setitimer( ITIMER_REAL, &xTimer, NULL );
+}
+/*-----------------------------------------------------------*/
+__attribute__((no_instrument_function))
+static void prvSwitchContext( void )
+{
+xPosixContext *pxOld = portCONTEXT_OF( pxCurrentTCB );
+xPosixContext *pxNew;
+
+	vTaskSwitchContext();
+	pxNew = portCONTEXT_OF( pxCurrentTCB );
+
+	if( pxNew != pxOld )
+	{
+		/* The critical nesting depth is part of a task's context, as tasks
+		can yield from inside a critical section. */
+		pxOld->ulCriticalNesting = ulCriticalNesting;
+		ulCriticalNesting = pxNew->ulCriticalNesting;
+		swapcontext( &( pxOld->xContext ), &( pxNew->xContext ) );
+	}
+}
+/*-----------------------------------------------------------*/
+__attribute__((no_instrument_function))
+static void prvProcessTick( void )
+{
+	#if ( configGENERATE_RUN_TIME_STATS == 1 )
+	{
+		ulInterruptEntryTime = prvMicroseconds();
+		ulInInterrupt = 1UL;
+	}
+	#endif
+
+	xInsideTick = 1;
+	vTaskIncrementTick();
+	xInsideTick = 0;
+
+	#if ( configGENERATE_RUN_TIME_STATS == 1 )
+	{
+		ulInterruptRunTime += prvMicroseconds() - ulInterruptEntryTime;
+		ulInInterrupt = 0UL;
+	}
+	#endif
+
+	#if ( configUSE_PREEMPTION == 1 )
+	{
+		xSwitchRequired = 1;
+	}
+	#endif
+
+	if( xSwitchRequired != 0 )
+	{
+		xSwitchRequired = 0;
+		prvSwitchContext();
+	}
+}
+/*-----------------------------------------------------------*/
+__attribute__((no_instrument_function))
+static void prvTickSignalHandler( int iSignal )
+{
+	( void ) iSignal;
+
+	if( xInterruptsMasked != 0 )
+	{
+		/* Taken when interrupts are next enabled. */
+		xTickPending = 1;
+	}
+	else
+	{
+		xInterruptsMasked = 1;
+		prvProcessTick();
+		xInterruptsMasked = 0;
+	}
+}
+/*-----------------------------------------------------------*/
+__attribute__((no_instrument_function))
+void vPortDisableInterrupts( void )
+{
+	xInterruptsMasked = 1;
+	__asm volatile ( "" : : : "memory" );
+}
+/*-----------------------------------------------------------*/
+__attribute__((no_instrument_function))
+void vPortEnableInterrupts( void )
+{
+	__asm volatile ( "" : : : "memory" );
+	xInterruptsMasked = 0;
+	__asm volatile ( "" : : : "memory" );
+
+	/* A tick that came in while masked.  One that comes in from here on is
+	handled by the signal handler itself. */
+	while( xTickPending != 0 )
+	{
+		xInterruptsMasked = 1;
+		xTickPending = 0;
+		prvProcessTick();
+		xInterruptsMasked = 0;
+		__asm volatile ( "" : : : "memory" );
+	}
+}
+/*-----------------------------------------------------------*/
+__attribute__((no_instrument_function))
+void vPortYield( void )
+{
+sig_atomic_t xWasMasked = xInterruptsMasked;
+
+	xInterruptsMasked = 1;
+	prvSwitchContext();
+
+	/* Tasks can yield from inside a critical section, in which case they
+	carry on with interrupts masked. */
+	if( xWasMasked == 0 )
+	{
+		vPortEnableInterrupts();
+	}
+}
+/*-----------------------------------------------------------*/
+__attribute__((no_instrument_function))
+void vPortYieldFromISR( void )
+{
+	/* The only interrupt is the tick, which switches on its way out. */
+	xSwitchRequired = 1;
+}
+/*-----------------------------------------------------------*/
+__attribute__((no_instrument_function))
+portBASE_TYPE xPortIsInsideInterrupt( void )
+{
+	return ( portBASE_TYPE ) xInsideTick;
+}
+/*-----------------------------------------------------------*/
+__attribute__((no_instrument_function))
+void vPortEnterCritical( void )
+{
+	vPortDisableInterrupts();
+
+	/* Now interrupts are disabled ulCriticalNesting can be accessed
+	directly.  Increment ulCriticalNesting to keep a count of how many times
+	portENTER_CRITICAL() has been called. */
+	ulCriticalNesting++;
+}
+/*-----------------------------------------------------------*/
+__attribute__((no_instrument_function))
+void vPortExitCritical( void )
+{
+	if( ulCriticalNesting > portNO_CRITICAL_NESTING )
+	{
+		/* Decrement the nesting count as we are leaving a critical section. */
+		ulCriticalNesting--;
+
+		/* If the nesting level has reached zero then interrupts should be
+		re-enabled. */
+		if( ulCriticalNesting == portNO_CRITICAL_NESTING )
+		{
+			vPortEnableInterrupts();
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+__attribute__((no_instrument_function))
+static unsigned long prvMicroseconds( void )
+{
+struct timespec xNow;
+
+	clock_gettime( CLOCK_MONOTONIC, &xNow );
+	return ( unsigned long ) ( ( ( unsigned long long ) xNow.tv_sec * 1000000ULL ) + ( ( unsigned long long ) xNow.tv_nsec / 1000ULL ) ) & 0xFFFFFFFFUL;
+}
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TICKLESS_IDLE != 0 )
+
+/*
+ *	Called by the idle task, with the scheduler suspended, when no task is due
+ *	for at least configEXPECTED_IDLE_TIME_BEFORE_SLEEP ticks.  Stops the tick
+ *	timer and sleeps in nanosleep() until the tick the next task is due on,
+ *	so an idle simulator does not spin a host CPU.  The only interrupt is the
+ *	tick, so nothing else can end the sleep early.
+ */
+__attribute__((no_instrument_function))
+void vPortSuppressTicksAndSleep( portTickType xExpectedIdleTime )
+{
+struct itimerval xStop, xLeft, xRestart;
+struct timespec xSleep;
+unsigned long ulToFirstTick, ulSleepUs, ulStart, ulElapsed, ulReload;
+portTickType xCompleteTicks;
+
+	if( xExpectedIdleTime > portMAX_SUPPRESSED_TICKS )
+	{
+		xExpectedIdleTime = portMAX_SUPPRESSED_TICKS;
+	}
+
+	vPortDisableInterrupts();
+
+	/* Stop the tick.  The timer gives the time left until the next one. */
+	memset( &xStop, 0, sizeof( xStop ) );
+	setitimer( ITIMER_REAL, &xStop, &xLeft );
+	ulToFirstTick = ( unsigned long ) ( ( xLeft.it_value.tv_sec * 1000000L ) + xLeft.it_value.tv_usec );
+
+	if( ( eTaskConfirmSleepModeStatus() == eAbortSleep ) || ( xTickPending != 0 ) || ( ulToFirstTick == 0UL ) )
+	{
+		/* A task was made ready, or a tick is already pending, since the idle
+		task decided to sleep.  Carry on from where the timer stopped. */
+		ulReload = ulToFirstTick;
+		xCompleteTicks = 0;
+	}
+	else
+	{
+		/* Wake on the tick the next task is due on. */
+		ulSleepUs = ulToFirstTick + ( ( unsigned long ) xExpectedIdleTime - 1UL ) * portTICK_PERIOD_US;
+		xSleep.tv_sec = ( time_t ) ( ulSleepUs / 1000000UL );
+		xSleep.tv_nsec = ( long ) ( ulSleepUs % 1000000UL ) * 1000L;
+
+		ulStart = prvMicroseconds();
+		nanosleep( &xSleep, NULL );
+		ulElapsed = ( prvMicroseconds() - ulStart ) & 0xFFFFFFFFUL;
+
+		if( ulElapsed < ulToFirstTick )
+		{
+			/* Woken by a signal before a tick period ended. */
+			xCompleteTicks = 0;
+			ulReload = ulToFirstTick - ulElapsed;
+		}
+		else
+		{
+			ulElapsed -= ulToFirstTick;
+			xCompleteTicks = ( portTickType ) ( 1UL + ( ulElapsed / portTICK_PERIOD_US ) );
+			ulReload = portTICK_PERIOD_US - ( ulElapsed % portTICK_PERIOD_US );
+
+			if( xCompleteTicks >= xExpectedIdleTime )
+			{
+				/* The tick the sleep was waiting for is due.  Leave it to the
+				tick interrupt, so the delayed task is unblocked as usual. */
+				xCompleteTicks = xExpectedIdleTime - 1;
+				ulReload = portTIMER_MIN_RELOAD;
+			}
+		}
+	}
+
+	if( ulReload < portTIMER_MIN_RELOAD )
+	{
+		ulReload = portTIMER_MIN_RELOAD;
+	}
+
+	vTaskStepTick( xCompleteTicks );
+
+	/* Restart the tick in phase. */
+	xRestart.it_interval.tv_sec = 0;
+	xRestart.it_interval.tv_usec = portTICK_PERIOD_US;
+	xRestart.it_value.tv_sec = 0;
+	xRestart.it_value.tv_usec = ( suseconds_t ) ulReload;
+	setitimer( ITIMER_REAL, &xRestart, NULL );
+
+	vPortEnableInterrupts();
+}
+
+#endif /* configUSE_TICKLESS_IDLE */
+/*-----------------------------------------------------------*/
+
+#if ( configGENERATE_RUN_TIME_STATS == 1 )
+
+/*
+ *	Run time statistics are timed in microseconds with CLOCK_MONOTONIC, which
+ *	keeps running while the process is descheduled by the host.  Time spent
+ *	handling ticks is kept out of the task counters, as on the target.
+ */
+__attribute__((no_instrument_function))
+void vPortConfigureRunTimeStats( void )
+{
+	ulRunTimeBase = prvMicroseconds();
+}
+
+__attribute__((no_instrument_function))
+unsigned long ulPortGetRunTimeCounterValue( void )
+{
+unsigned long ulNow;
+
+	if( ulInInterrupt != 0UL )
+	{
+		ulNow = ulInterruptEntryTime;
+	}
+	else
+	{
+		ulNow = prvMicroseconds();
+	}
+
+	return ( ulNow - ulRunTimeBase - ulInterruptRunTime ) & 0xFFFFFFFFUL;
+}
+
+__attribute__((no_instrument_function))
+unsigned long ulPortGetRunTimeTotal( void )
+{
+	return ( prvMicroseconds() - ulRunTimeBase ) & 0xFFFFFFFFUL;
+}
+
+__attribute__((no_instrument_function))
+unsigned long ulPortGetInterruptRunTime( void )
+{
+	return ulInterruptRunTime;
+}
+
+#endif /* configGENERATE_RUN_TIME_STATS */
+/*-----------------------------------------------------------*/
@@ -0,0 +1,135 @@
+#ifndef PORTMACRO_H
+#define PORTMACRO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*-----------------------------------------------------------
+ * Port specific definitions.
+ *
+ * The settings in this file configure FreeRTOS correctly for the
+ * given hardware and compiler.
+ *
+ * These settings should not be altered.
+ *-----------------------------------------------------------
+ */
+
+/* Type definitions.  long is 64 bits on an LP64 host, which is fine for the
+base and stack types, but the tick count is kept at 32 bits so that it wraps
+exactly as it does on the target. */
+#define portCHAR			char
+#define portFLOAT			float
+#define portDOUBLE		double
+#define portLONG			long
+#define portSHORT			short
+#define portSTACK_TYPE	unsigned portLONG
+#define portBASE_TYPE	portLONG
+
+#if( configUSE_16_BIT_TICKS == 1 )
+	typedef unsigned portSHORT portTickType;
+	#define portMAX_DELAY ( portTickType ) 0xffff
+#else
+	typedef unsigned int portTickType;
+	#define portMAX_DELAY ( portTickType ) 0xffffffff
+#endif
+/*-----------------------------------------------------------*/
+
+/* Architecture specifics. */
+#define portSTACK_GROWTH			( -1 )
+#define portTICK_RATE_MS			( ( portTickType ) 1000 / configTICK_RATE_HZ )
+#define portBYTE_ALIGNMENT			8
+#define portNOP()
+/*-----------------------------------------------------------*/
+
+
+/* Port optimised task selection, as on the target but with the compiler's
+count leading zeros builtin in place of the CLZ instruction. */
+
+#if ( configUSE_PORT_OPTIMISED_TASK_SELECTION == 1 )
+
+	#define portRECORD_READY_PRIORITY( uxPriority, uxReadyPriorities )	( uxReadyPriorities ) |= ( 1UL << ( uxPriority ) )
+	#define portRESET_READY_PRIORITY( uxPriority, uxReadyPriorities )	( uxReadyPriorities ) &= ~( 1UL << ( uxPriority ) )
+
+	#define portGET_HIGHEST_PRIORITY( uxTopPriority, uxReadyPriorities )	( uxTopPriority ) = 31UL - ( unsigned long ) __builtin_clz( ( unsigned int ) ( uxReadyPriorities ) )
+
+#endif /* configUSE_PORT_OPTIMISED_TASK_SELECTION */
+/*-----------------------------------------------------------*/
+
+#if ( configNUM_CORES > 1 )
+	#error The POSIX port runs the kernel on a single core.
+#endif
+
+
+/* Scheduler utilities. */
+
+/*
+ * Each task runs on its own host stack as a ucontext, all in the one thread of
+ * the process.  The tick is SIGALRM, see port.c.
+ */
+extern void vPortYield( void );
+extern void vPortYieldFromISR( void );
+#define portYIELD()					vPortYield()
+#define portYIELD_FROM_ISR()		vPortYieldFromISR()
+
+/* Whether the caller is the tick handler, the only interrupt, so code called
+from tasks and interrupts can tell whether to use the FromISR API. */
+extern portBASE_TYPE xPortIsInsideInterrupt( void );
+#define portIS_INSIDE_INTERRUPT()	xPortIsInsideInterrupt()
+/*-----------------------------------------------------------*/
+
+
+/* Critical section management. */
+
+/*
+ * Interrupts are masked with a flag rather than with sigprocmask(), which
+ * would cost a system call each time.  A tick that arrives while the flag is
+ * set is held pending until interrupts are enabled again.
+ */
+extern void vPortDisableInterrupts( void );
+extern void vPortEnableInterrupts( void );
+#define portDISABLE_INTERRUPTS()	vPortDisableInterrupts()
+#define portENABLE_INTERRUPTS()		vPortEnableInterrupts()
+
+extern void vPortEnterCritical( void );
+extern void vPortExitCritical( void );
+
+#define portENTER_CRITICAL()		vPortEnterCritical();
+#define portEXIT_CRITICAL()		vPortExitCritical();
+/*-----------------------------------------------------------*/
+
+/* Run time statistics, timed with CLOCK_MONOTONIC in microseconds, see port.c. */
+#if ( configGENERATE_RUN_TIME_STATS == 1 )
+	extern void vPortConfigureRunTimeStats( void );
+	extern unsigned long ulPortGetRunTimeCounterValue( void );
+	extern unsigned long ulPortGetRunTimeTotal( void );
+	extern unsigned long ulPortGetInterruptRunTime( void );
+	#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()		vPortConfigureRunTimeStats()
+	#define portGET_RUN_TIME_COUNTER_VALUE()				ulPortGetRunTimeCounterValue()
+	#define portGET_RUN_TIME_TOTAL_VALUE()					ulPortGetRunTimeTotal()
+	#define portGET_INTERRUPT_RUN_TIME_COUNTER_VALUE()		ulPortGetInterruptRunTime()
+#endif
+/*-----------------------------------------------------------*/
+
+/* Tickless idle, see port.c. */
+#if ( configUSE_TICKLESS_IDLE != 0 )
+	extern void vPortSuppressTicksAndSleep( portTickType xExpectedIdleTime );
+	#define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime )	vPortSuppressTicksAndSleep( xExpectedIdleTime )
+#endif
+/*-----------------------------------------------------------*/
+
+/* The host stack of a deleted task is unmapped when the idle task frees its
+TCB. */
+extern void vPortCleanUpTCB( void *pvTCB );
+#define portCLEAN_UP_TCB( pxTCB )	vPortCleanUpTCB( pxTCB )
+/*-----------------------------------------------------------*/
+
+/* Task function macros as described on the FreeRTOS.org WEB site. */
+#define portTASK_FUNCTION_PROTO( vFunction, pvParameters ) void vFunction( void *pvParameters )
+#define portTASK_FUNCTION( vFunction, pvParameters ) void vFunction( void *pvParameters )
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PORTMACRO_H */
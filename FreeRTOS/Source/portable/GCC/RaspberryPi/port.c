@@ -32,6 +32,91 @@ typedef struct _BCM2835_TIMER_REGS {
 
 static volatile BCM2835_TIMER_REGS * const pRegs = (BCM2835_TIMER_REGS *) (portTIMER_BASE);
 
+/* The prescaler runs the timer at 1MHz. */
+#define portTIMER_COUNTS_PER_TICK				( 1000000UL / configTICK_RATE_HZ )
+#define portTIMER_CTL_ENABLE					( ( unsigned long ) 0x80 )
+
+/* The free running 1MHz BCM system timer. */
+#define portSYSTIMER_BASE						( ( unsigned long ) 0x3f003000 )
+
+typedef struct _BCM2835_SYSTIMER_REGS {
+	unsigned long CS;
+	unsigned long CLO;
+	unsigned long CHI;
+	unsigned long C[4];
+} BCM2835_SYSTIMER_REGS;
+
+static volatile BCM2835_SYSTIMER_REGS * const pSysTimer = (BCM2835_SYSTIMER_REGS *) (portSYSTIMER_BASE);
+
+#if ( configUSE_SYSTEM_TIMER_TICK == 1 )
+
+/* The tick comes from a system timer compare channel instead of the SP804,
+which QEMU does not model.  Channels 0 and 2 are used by the GPU, and
+channel 3 by the interrupt latency benchmark (Demo/bench/bench_irq.c). */
+#define portSYSTIMER_TICK_CHANNEL				1
+#define portSYSTIMER_TICK_IRQ					1		/* System timer match n is IRQ n. */
+
+/* The system timer count the next tick is due at. */
+static unsigned long ulNextTick;
+
+#endif
+
+/* Shortest count the tick timer is restarted with, or that a system timer
+compare is set ahead of the counter by. */
+#define portTIMER_MIN_RELOAD					( 2UL )
+
+#if ( configUSE_TICKLESS_IDLE != 0 )
+
+#if ( configUSE_SYSTEM_TIMER_TICK == 0 )
+/* The system timer wakes the core from a tickless sleep.  Compare channels 0
+and 2 are used by the GPU, channel 1 is free for the ARM. */
+#define portSYSTIMER_WAKE_CHANNEL				1
+#define portSYSTIMER_WAKE_IRQ					1		/* System timer match n is IRQ n. */
+#endif
+
+/* Longest sleep, kept well clear of the 32 bit counter wrapping. */
+#define portMAX_SUPPRESSED_TICKS				( ( portTickType ) ( 0x7FFFFFFFUL / portTIMER_COUNTS_PER_TICK ) )
+
+
+#endif
+
+#if ( configGENERATE_RUN_TIME_STATS == 1 )
+
+/* System timer value when the scheduler started. */
+static unsigned long ulRunTimeBase;
+
+/* Time each core has spent in vFreeRTOS_ISR(), and when the interrupt it is
+handling now, if any, was taken. */
+static volatile unsigned long ulInterruptRunTime[ configNUM_CORES ];
+static volatile unsigned long ulInterruptEntryTime[ configNUM_CORES ];
+static volatile unsigned long ulInInterrupt[ configNUM_CORES ];
+
+#endif
+
+#if ( configNUM_CORES > 1 )
+
+/* BCM2836/7 core local peripherals (QA7), used for inter core signalling. */
+#define portCORE_LOCAL_BASE						( ( unsigned long ) 0x40000000 )
+#define portCORE_MAILBOX_IRQ_CTRL( n )			( *( volatile unsigned long * ) ( portCORE_LOCAL_BASE + 0x50 + ( 4 * ( n ) ) ) )
+#define portCORE_IRQ_SOURCE( n )				( *( volatile unsigned long * ) ( portCORE_LOCAL_BASE + 0x60 + ( 4 * ( n ) ) ) )
+#define portCORE_MAILBOX_SET( n, m )			( *( volatile unsigned long * ) ( portCORE_LOCAL_BASE + 0x80 + ( 0x10 * ( n ) ) + ( 4 * ( m ) ) ) )
+#define portCORE_MAILBOX_CLR( n, m )			( *( volatile unsigned long * ) ( portCORE_LOCAL_BASE + 0xC0 + ( 0x10 * ( n ) ) + ( 4 * ( m ) ) ) )
+
+#define portIPI_MAILBOX							0		/* Yield requests. */
+#define portBOOT_MAILBOX						3		/* The firmware parks the secondary cores polling this one. */
+#define portIRQ_SOURCE_IPI						( 1UL << ( 4 + portIPI_MAILBOX ) )
+#define portIRQ_SOURCE_GPU						( 1UL << 8 )
+
+/* Set by each core, for itself, once it is ready to take yield requests. */
+static volatile unsigned long ulCoreOnline[ configNUM_CORES ];
+
+extern void * volatile pxCurrentTCBs[];
+extern void _secondary_start( void );
+extern void irqHandler( void );
+extern void vPortSwitchContext( void );
+
+#endif
+
 /*-----------------------------------------------------------*/
 
 /* Setup the timer to generate the tick interrupts. */
@@ -126,9 +211,122 @@ portSTACK_TYPE *pxOriginalTOS;
 	return pxTopOfStack;
 }
 /*-----------------------------------------------------------*/
+#if ( configNUM_CORES > 1 )
+
+/*
+ *	Makes this core ready to take yield requests and picks its first task.
+ *	Interrupts are disabled.
+ */
+__attribute__((no_instrument_function))
+static void prvStartCore( unsigned long ulCore )
+{
+	portCORE_MAILBOX_CLR( ulCore, portIPI_MAILBOX ) = 0xFFFFFFFF;
+	portCORE_MAILBOX_IRQ_CTRL( ulCore ) = ( 1UL << portIPI_MAILBOX );
+	ulCoreOnline[ ulCore ] = 1UL;
+
+	/* The task chosen when it was created may not be the best one for this
+	core, or may not even be allowed on it. */
+	vPortSwitchContext();
+}
+
+/*
+ *	Entered from _secondary_start in startup.s, in SVC mode with the stacks
+ *	set up and interrupts disabled.
+ */
+__attribute__((no_instrument_function))
+void vPortSecondaryCoreStart( void )
+{
+unsigned long ulCore = portGET_CORE_ID();
+
+	/* vTaskStartScheduler() made this core's idle task its current task. */
+	portSET_CURRENT_TCB( pxCurrentTCBs[ ulCore ] );
+
+	prvStartCore( ulCore );
+	vPortISRStartFirstTask();
+}
+
+/*
+ *	Releases the secondary cores from the firmware's spin loop.  Each one polls
+ *	its mailbox 3 for an address to jump to.
+ */
+__attribute__((no_instrument_function))
+static void prvStartSecondaryCores( void )
+{
+unsigned long ulCore;
+
+	__asm volatile ( "DSB" : : : "memory" );
+
+	for( ulCore = 1; ulCore < configNUM_CORES; ulCore++ )
+	{
+		portCORE_MAILBOX_SET( ulCore, portBOOT_MAILBOX ) = ( unsigned long ) _secondary_start;
+	}
+
+	__asm volatile ( "SEV" );
+}
+
+__attribute__((no_instrument_function))
+void vPortYieldCore( portBASE_TYPE xCoreID )
+{
+	if( ulCoreOnline[ xCoreID ] != 0UL )
+	{
+		/* The kernel data the target core is about to read must be visible
+		before the interrupt reaches it. */
+		__asm volatile ( "DSB" : : : "memory" );
+		portCORE_MAILBOX_SET( xCoreID, portIPI_MAILBOX ) = 1UL;
+	}
+}
+
+__attribute__((no_instrument_function))
+void vPortYieldOtherCores( void )
+{
+portBASE_TYPE xCoreID, xThisCore = portGET_CORE_ID();
+
+	for( xCoreID = 0; xCoreID < configNUM_CORES; xCoreID++ )
+	{
+		if( xCoreID != xThisCore )
+		{
+			vPortYieldCore( xCoreID );
+		}
+	}
+}
+
+/*
+ *	Called by vFreeRTOS_ISR() in place of irqHandler().  Yield requests from
+ *	other cores arrive through the core mailbox, and the peripheral interrupts
+ *	are only routed to core 0.
+ */
+__attribute__((no_instrument_function))
+void vPortCoreIRQHandler( void )
+{
+unsigned long ulCore = portGET_CORE_ID();
+unsigned long ulSource = portCORE_IRQ_SOURCE( ulCore );
+
+	if( ( ulSource & portIRQ_SOURCE_IPI ) != 0UL )
+	{
+		portCORE_MAILBOX_CLR( ulCore, portIPI_MAILBOX ) = 0xFFFFFFFF;
+		vPortSwitchContext();
+	}
+
+	if( ( ulSource & portIRQ_SOURCE_GPU ) != 0UL )
+	{
+		irqHandler();
+	}
+}
+
+#endif /* configNUM_CORES */
+/*-----------------------------------------------------------*/
 __attribute__((no_instrument_function))
 portBASE_TYPE xPortStartScheduler( void )
 {
+	#if ( configNUM_CORES > 1 )
+	{
+		/* Core 0 must have its first task before the tick can fire, then the
+		other cores can join in. */
+		prvStartCore( 0 );
+		prvStartSecondaryCores();
+	}
+	#endif
+
 	/* Start the timer that generates the tick ISR.  Interrupts are disabled
 	here already. */
 	prvSetupTimerInterrupt();
@@ -157,13 +355,42 @@ void vPortEndScheduler( void )
 __attribute__((no_instrument_function))
 void vTickISR(int nIRQ, void *pParam )
 {
+	#if ( configNUM_CORES > 1 )
+	{
+		/* The tick only arrives on core 0, so hand the time slice on to the
+		other cores as well. */
+		portENTER_CRITICAL();
+		vTaskIncrementTick();
+		portEXIT_CRITICAL();
+
+		#if configUSE_PREEMPTION == 1
+		vPortYieldOtherCores();
+		#endif
+	}
+	#else
 	vTaskIncrementTick();
+	#endif
 
 	#if configUSE_PREEMPTION == 1
-	vTaskSwitchContext();
+	portYIELD_FROM_ISR();
 	#endif
 
+	#if ( configUSE_SYSTEM_TIMER_TICK == 1 )
+	{
+		/* Acknowledge the match and set the next one.  Ticks that are
+		already late are dropped, as a compare the counter has passed would
+		not match again until it wraps. */
+		pSysTimer->CS = ( 1UL << portSYSTIMER_TICK_CHANNEL );
+		ulNextTick += portTIMER_COUNTS_PER_TICK;
+		if( ( long ) ( ulNextTick - pSysTimer->CLO ) < ( long ) portTIMER_MIN_RELOAD )
+		{
+			ulNextTick = pSysTimer->CLO + portTIMER_COUNTS_PER_TICK;
+		}
+		pSysTimer->C[ portSYSTIMER_TICK_CHANNEL ] = ulNextTick;
+	}
+	#else
 	pRegs->CLI = 0;			// Acknowledge the timer interrupt.
+	#endif
 }
 
 /*
@@ -188,18 +415,511 @@ static void prvSetupTimerInterrupt( void )
 
 	DisableInterrupts();
 
-	pRegs->CTL = 0x003E0000;
-	pRegs->LOD = 1000 - 1;
-	pRegs->RLD = 1000 - 1;
-	pRegs->DIV = portTIMER_PRESCALE;
-	pRegs->CLI = 0;
-	pRegs->CTL = 0x003E00A2;
+	#if ( configUSE_SYSTEM_TIMER_TICK == 1 )
+	{
+		ulNextTick = pSysTimer->CLO + portTIMER_COUNTS_PER_TICK;
+		pSysTimer->C[ portSYSTIMER_TICK_CHANNEL ] = ulNextTick;
+		pSysTimer->CS = ( 1UL << portSYSTIMER_TICK_CHANNEL );
 
-	RegisterInterrupt(64, vTickISR, NULL);
+		RegisterInterrupt(portSYSTIMER_TICK_IRQ, vTickISR, NULL);
 
-	EnableInterrupt(64);
+		EnableInterrupt(portSYSTIMER_TICK_IRQ);
+	}
+	#else
+	{
+		pRegs->CTL = 0x003E0000;
+		pRegs->LOD = portTIMER_COUNTS_PER_TICK - 1;
+		pRegs->RLD = portTIMER_COUNTS_PER_TICK - 1;
+		pRegs->DIV = portTIMER_PRESCALE;
+		pRegs->CLI = 0;
+		pRegs->CTL = 0x003E00A2;
+
+		RegisterInterrupt(64, vTickISR, NULL);
+
+		EnableInterrupt(64);
+	}
+	#endif
 
 	EnableInterrupts();
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_TICKLESS_IDLE != 0 ) && ( configUSE_SYSTEM_TIMER_TICK == 1 )
+
+/*
+ *	Called from the idle task, with the scheduler suspended, when no task is
+ *	due to run for at least xExpectedIdleTime ticks.  The tick's compare is
+ *	moved on to the tick the next task is due on, and the core waits in WFI
+ *	until that match, or any other interrupt, wakes it.  The ticks slept
+ *	through are stepped, but the last one is left to vTickISR() so the
+ *	delayed task is unblocked as usual.
+ */
+__attribute__((no_instrument_function))
+void vPortSuppressTicksAndSleep( portTickType xExpectedIdleTime )
+{
+unsigned long ulWake, ulNow;
+portTickType xCompleteTicks;
+
+	if( xExpectedIdleTime > portMAX_SUPPRESSED_TICKS )
+	{
+		xExpectedIdleTime = portMAX_SUPPRESSED_TICKS;
+	}
+
+	portDISABLE_INTERRUPTS();
+
+	if( eTaskConfirmSleepModeStatus() == eAbortSleep )
+	{
+		portENABLE_INTERRUPTS();
+		return;
+	}
+
+	ulWake = ulNextTick + ( ( unsigned long ) xExpectedIdleTime - 1UL ) * portTIMER_COUNTS_PER_TICK;
+	pSysTimer->C[ portSYSTIMER_TICK_CHANNEL ] = ulWake;
+
+	if( ( pSysTimer->CS & ( 1UL << portSYSTIMER_TICK_CHANNEL ) ) != 0UL )
+	{
+		/* The tick matched before its compare was moved.  It is still
+		pending, and vTickISR() sets the compare again from ulNextTick. */
+		portENABLE_INTERRUPTS();
+		return;
+	}
+
+	/* A pending interrupt ends the WFI even though the CPSR masks it. */
+	__asm volatile ( "DSB\n\t"
+					 "WFI\n\t"
+					 "ISB" : : : "memory" );
+
+	/* Read the counter before the match flag, so that with the flag clear the
+	counter was still short of ulWake. */
+	ulNow = pSysTimer->CLO;
+
+	if( ( pSysTimer->CS & ( 1UL << portSYSTIMER_TICK_CHANNEL ) ) != 0UL )
+	{
+		/* The tick the sleep was waiting for is due, and pending. */
+		xCompleteTicks = xExpectedIdleTime - 1;
+		ulNextTick = ulWake;
+	}
+	else
+	{
+		/* Woken by another interrupt.  Count the ticks that passed, and move
+		the compare back to the first tick still to come. */
+		if( ( long ) ( ulNow - ulNextTick ) < 0L )
+		{
+			xCompleteTicks = 0;
+		}
+		else
+		{
+			xCompleteTicks = ( portTickType ) ( 1UL + ( ( ulNow - ulNextTick ) / portTIMER_COUNTS_PER_TICK ) );
+		}
+		ulNextTick += ( unsigned long ) xCompleteTicks * portTIMER_COUNTS_PER_TICK;
+
+		if( ( ulNextTick != ulWake ) && ( ( long ) ( ulNextTick - pSysTimer->CLO ) < ( long ) portTIMER_MIN_RELOAD ) )
+		{
+			/* Too close to set without missing it.  It is before ulWake, so
+			it can be stepped with the others. */
+			xCompleteTicks++;
+			ulNextTick += portTIMER_COUNTS_PER_TICK;
+		}
+		pSysTimer->C[ portSYSTIMER_TICK_CHANNEL ] = ulNextTick;
+	}
+
+	vTaskStepTick( xCompleteTicks );
+
+	portENABLE_INTERRUPTS();
+}
+
+#elif ( configUSE_TICKLESS_IDLE != 0 )
+
+/*
+ *	Called from the idle task, with the scheduler suspended, when no task is
+ *	due to run for at least xExpectedIdleTime ticks.  The tick timer is stopped
+ *	and the core waits in WFI until a system timer compare at the time the next
+ *	task is due, or any other interrupt, wakes it.
+ *
+ *	The wake interrupt is only enabled while IRQs are masked in the CPSR, and
+ *	is cleared again before they are unmasked, so it never reaches irqHandler().
+ */
+__attribute__((no_instrument_function))
+void vPortSuppressTicksAndSleep( portTickType xExpectedIdleTime )
+{
+unsigned long ulToFirstTick, ulSleepCounts, ulStart, ulElapsed, ulReload;
+portTickType xCompleteTicks;
+
+	if( xExpectedIdleTime > portMAX_SUPPRESSED_TICKS )
+	{
+		xExpectedIdleTime = portMAX_SUPPRESSED_TICKS;
+	}
+
+	portDISABLE_INTERRUPTS();
+
+	/* Stop the tick.  The counter holds the time left until the next one. */
+	pRegs->CTL &= ~portTIMER_CTL_ENABLE;
+	ulToFirstTick = pRegs->VAL + 1UL;
+
+	if( ( eTaskConfirmSleepModeStatus() == eAbortSleep ) || ( pRegs->RIS != 0UL ) )
+	{
+		/* A task was made ready, or a tick is already pending, since the idle
+		task decided to sleep.  Carry on from where the timer stopped. */
+		pRegs->CTL |= portTIMER_CTL_ENABLE;
+		portENABLE_INTERRUPTS();
+	}
+	else
+	{
+		/* Wake on the tick the next task is due on. */
+		ulSleepCounts = ulToFirstTick + ( ( unsigned long ) xExpectedIdleTime - 1UL ) * portTIMER_COUNTS_PER_TICK;
+
+		ulStart = pSysTimer->CLO;
+		pSysTimer->CS = ( 1UL << portSYSTIMER_WAKE_CHANNEL );
+		pSysTimer->C[ portSYSTIMER_WAKE_CHANNEL ] = ulStart + ulSleepCounts;
+		EnableInterrupt( portSYSTIMER_WAKE_IRQ );
+
+		/* A pending interrupt ends the WFI even though the CPSR masks it. */
+		__asm volatile ( "DSB\n\t"
+						 "WFI\n\t"
+						 "ISB" : : : "memory" );
+
+		ulElapsed = pSysTimer->CLO - ulStart;
+		DisableInterrupt( portSYSTIMER_WAKE_IRQ );
+		pSysTimer->CS = ( 1UL << portSYSTIMER_WAKE_CHANNEL );
+
+		if( ulElapsed < ulToFirstTick )
+		{
+			/* Woken by another interrupt before a tick period ended. */
+			xCompleteTicks = 0;
+			ulReload = ulToFirstTick - ulElapsed;
+		}
+		else
+		{
+			ulElapsed -= ulToFirstTick;
+			xCompleteTicks = ( portTickType ) ( 1UL + ( ulElapsed / portTIMER_COUNTS_PER_TICK ) );
+			ulReload = portTIMER_COUNTS_PER_TICK - ( ulElapsed % portTIMER_COUNTS_PER_TICK );
+
+			if( xCompleteTicks >= xExpectedIdleTime )
+			{
+				/* The tick the sleep was waiting for is due.  Leave it to the
+				tick interrupt, so the delayed task is unblocked as usual. */
+				xCompleteTicks = xExpectedIdleTime - 1;
+				ulReload = portTIMER_MIN_RELOAD;
+			}
+		}
+
+		if( ulReload < portTIMER_MIN_RELOAD )
+		{
+			ulReload = portTIMER_MIN_RELOAD;
+		}
+
+		vTaskStepTick( xCompleteTicks );
+
+		/* Restart the tick in phase.  A write to LOD reloads the counter
+		straight away, RLD only sets the value used once it reaches 0. */
+		pRegs->LOD = ulReload - 1UL;
+		pRegs->RLD = portTIMER_COUNTS_PER_TICK - 1UL;
+		pRegs->CTL |= portTIMER_CTL_ENABLE;
+
+		portENABLE_INTERRUPTS();
+	}
+}
+
+#endif /* configUSE_TICKLESS_IDLE */
+/*-----------------------------------------------------------*/
+
+#if ( configGENERATE_RUN_TIME_STATS == 1 )
+
+/*
+ *	Run time statistics are timed with the 1MHz system timer.  Time spent in
+ *	vFreeRTOS_ISR() is accumulated per core and kept out of the task counters,
+ *	so an interrupt storm shows up as "ISR" time rather than as time used by
+ *	whichever task it happened to interrupt (usually the idle task).
+ *
+ *	Counts are in microseconds since the scheduler started, so they wrap after
+ *	about 71 minutes (the total over all cores after 71 / configNUM_CORES).
+ */
+__attribute__((no_instrument_function))
+void vPortConfigureRunTimeStats( void )
+{
+	ulRunTimeBase = pSysTimer->CLO;
+}
+
+/*
+ *	The run time clock of the calling core, which stands still while the core
+ *	is handling an interrupt.
+ */
+__attribute__((no_instrument_function))
+unsigned long ulPortGetRunTimeCounterValue( void )
+{
+unsigned long ulCore = portGET_CORE_ID();
+unsigned long ulNow;
+
+	if( ulInInterrupt[ ulCore ] != 0UL )
+	{
+		ulNow = ulInterruptEntryTime[ ulCore ];
+	}
+	else
+	{
+		ulNow = pSysTimer->CLO;
+	}
+
+	return ulNow - ulRunTimeBase - ulInterruptRunTime[ ulCore ];
+}
+
+/*
+ *	Time the task and interrupt counters add up to, over all the cores.
+ */
+__attribute__((no_instrument_function))
+unsigned long ulPortGetRunTimeTotal( void )
+{
+	return ( pSysTimer->CLO - ulRunTimeBase ) * ( unsigned long ) configNUM_CORES;
+}
+
+__attribute__((no_instrument_function))
+unsigned long ulPortGetInterruptRunTime( void )
+{
+unsigned long ulTotal = 0UL;
+portBASE_TYPE xCore;
+
+	for( xCore = 0; xCore < configNUM_CORES; xCore++ )
+	{
+		ulTotal += ulInterruptRunTime[ xCore ];
+	}
+
+	return ulTotal;
+}
+
+/*
+ *	Called by vFreeRTOS_ISR() either side of the interrupt dispatch.  IRQs do
+ *	not nest in this port.
+ */
+__attribute__((no_instrument_function))
+void vPortInterruptEnter( void )
+{
+unsigned long ulCore = portGET_CORE_ID();
+
+	ulInterruptEntryTime[ ulCore ] = pSysTimer->CLO;
+	ulInInterrupt[ ulCore ] = 1UL;
+}
+
+__attribute__((no_instrument_function))
+void vPortInterruptExit( void )
+{
+unsigned long ulCore = portGET_CORE_ID();
+
+	ulInterruptRunTime[ ulCore ] += pSysTimer->CLO - ulInterruptEntryTime[ ulCore ];
+	ulInInterrupt[ ulCore ] = 0UL;
+}
+
+#endif /* configGENERATE_RUN_TIME_STATS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_VFP == 1 )
+
+/*
+ *	Lazy VFP/NEON context switching.
+ *
+ *	The VFP is left off (FPEXC.EN clear) for any task that does not own the
+ *	registers, so its first VFP or NEON instruction takes the undefined
+ *	instruction trap, vPortUndefinedHandler() in portisr.c.  ulPortFPUTrap()
+ *	then saves the registers into the TCB of the task that owned them, loads
+ *	the trapping task's own and turns the VFP on.  Tasks that never use the
+ *	VFP cost nothing, and while only one task uses it its registers stay
+ *	live across any number of switches.
+ *
+ *	A task can move between cores on SMP builds, so there the owner's
+ *	registers are saved when it is switched out, by vPortFPUSwitchOut(), and
+ *	only the restore is lazy.
+ *
+ *	The VFP is also off while the kernel and interrupt handlers run.  If
+ *	they use it they trap the same way, and get it once the owning task's
+ *	registers are saved.
+ */
+
+#define portFPEXC_EN							( 0x40000000UL )
+#define portCPSR_MODE_MASK						( 0x1fUL )
+#define portCPSR_SYSTEM_MODE					( 0x1fUL )
+
+/* The context is kept in the TCB, at ulTaskFPUContextOffset (tasks.c). */
+#define portFPU_CONTEXT( pvTCB )				( ( xFPU_CONTEXT * ) ( ( ( unsigned char * ) ( pvTCB ) ) + ulTaskFPUContextOffset ) )
+
+#if ( configNUM_CORES > 1 )
+	#define portFPU_CURRENT_TCB()				portGET_CURRENT_TCB()
+#else
+	extern void * volatile pxCurrentTCB;
+	#define portFPU_CURRENT_TCB()				pxCurrentTCB
+#endif
+
+/* The task whose registers are in each core's VFP, if any. */
+static void * volatile pvFPUOwner[ configNUM_CORES ];
+
+__attribute__((no_instrument_function))
+static inline unsigned long prvGetFPEXC( void )
+{
+unsigned long ulFPEXC;
+
+	__asm volatile ( "VMRS	%0, FPEXC" : "=r" ( ulFPEXC ) );
+	return ulFPEXC;
+}
+
+__attribute__((no_instrument_function))
+static inline void prvSetFPEXC( unsigned long ulFPEXC )
+{
+	__asm volatile ( "VMSR	FPEXC, %0" : : "r" ( ulFPEXC ) : "memory" );
+}
+
+/* Both need the VFP turned on. */
+__attribute__((no_instrument_function))
+static void prvFPUSave( xFPU_CONTEXT *pxContext )
+{
+unsigned long *pulRegisters = pxContext->ulRegisters;
+unsigned long ulFPSCR;
+
+	__asm volatile (
+		"VSTMIA	%0!, {D0-D15}		\n\t"
+#if ( portFPU_DOUBLE_REGISTERS == 32 )
+		"VSTMIA	%0!, {D16-D31}		\n\t"
+#endif
+		"VMRS	%1, FPSCR			\n\t"
+		: "+r" ( pulRegisters ), "=r" ( ulFPSCR ) : : "memory" );
+
+	pxContext->ulFPSCR = ulFPSCR;
+}
+
+__attribute__((no_instrument_function))
+static void prvFPULoad( xFPU_CONTEXT *pxContext )
+{
+unsigned long *pulRegisters = pxContext->ulRegisters;
+unsigned long x;
+
+	if( pxContext->ulUsed == 0UL )
+	{
+		/* First use, start from zeroed registers and the default FPSCR. */
+		for( x = 0; x < sizeof( pxContext->ulRegisters ) / sizeof( unsigned long ); x++ )
+		{
+			pxContext->ulRegisters[ x ] = 0UL;
+		}
+		pxContext->ulFPSCR = 0UL;
+		pxContext->ulUsed = 1UL;
+	}
+
+	__asm volatile (
+		"VLDMIA	%0!, {D0-D15}		\n\t"
+#if ( portFPU_DOUBLE_REGISTERS == 32 )
+		"VLDMIA	%0!, {D16-D31}		\n\t"
+#endif
+		"VMSR	FPSCR, %1			\n\t"
+		: "+r" ( pulRegisters ) : "r" ( pxContext->ulFPSCR ) : "memory" );
+}
+
+/*
+ *	Called by vPortUndefinedHandler() with the SPSR of the trapping code.
+ *	Returns non zero if the instruction should be retried with the VFP on.
+ */
+__attribute__((no_instrument_function))
+unsigned long ulPortFPUTrap( unsigned long ulSPSR )
+{
+unsigned long ulCore = portGET_CORE_ID();
+void *pvTask = NULL;
+
+	/* The VFP was already on, so this is a genuinely undefined instruction.
+	Anything else that traps with it off takes this path a second time. */
+	if( ( prvGetFPEXC() & portFPEXC_EN ) != 0UL )
+	{
+		return 0UL;
+	}
+
+	prvSetFPEXC( portFPEXC_EN );
+
+	/* Tasks run in system mode, anything else is the kernel or an interrupt
+	handler, which do not keep their registers. */
+	if( ( ulSPSR & portCPSR_MODE_MASK ) == portCPSR_SYSTEM_MODE )
+	{
+		pvTask = portFPU_CURRENT_TCB();
+	}
+
+	if( pvFPUOwner[ ulCore ] != pvTask )
+	{
+		if( pvFPUOwner[ ulCore ] != NULL )
+		{
+			prvFPUSave( portFPU_CONTEXT( pvFPUOwner[ ulCore ] ) );
+		}
+
+		if( pvTask != NULL )
+		{
+			prvFPULoad( portFPU_CONTEXT( pvTask ) );
+		}
+
+		pvFPUOwner[ ulCore ] = pvTask;
+	}
+
+	return 1UL;
+}
+
+/*
+ *	Called on entry to the IRQ and yield handlers, so kernel code cannot
+ *	touch a task's live registers without trapping first.
+ */
+__attribute__((no_instrument_function))
+void vPortFPUSuspend( void )
+{
+	prvSetFPEXC( 0UL );
+}
+
+/*
+ *	Called just before a task's context is restored.  The VFP is turned back
+ *	on only for the task whose registers it holds.
+ */
+__attribute__((no_instrument_function))
+void vPortFPUResume( void )
+{
+void *pvTask = portFPU_CURRENT_TCB();
+
+	if( ( pvTask != NULL ) && ( pvFPUOwner[ portGET_CORE_ID() ] == pvTask ) )
+	{
+		prvSetFPEXC( portFPEXC_EN );
+	}
+	else
+	{
+		prvSetFPEXC( 0UL );
+	}
+}
+
+#if ( configNUM_CORES > 1 )
+
+/*
+ *	Called by vPortSwitchContext(), holding the kernel lock, before the task
+ *	being switched out can be picked up by another core.
+ */
+__attribute__((no_instrument_function))
+void vPortFPUSwitchOut( void )
+{
+unsigned long ulCore = portGET_CORE_ID();
+
+	if( pvFPUOwner[ ulCore ] != NULL )
+	{
+		prvSetFPEXC( portFPEXC_EN );
+		prvFPUSave( portFPU_CONTEXT( pvFPUOwner[ ulCore ] ) );
+		prvSetFPEXC( 0UL );
+		pvFPUOwner[ ulCore ] = NULL;
+	}
+}
+
+#endif /* configNUM_CORES */
+
+/*
+ *	portCLEAN_UP_TCB(), so a deleted task's registers are never saved over
+ *	its freed TCB.
+ */
+__attribute__((no_instrument_function))
+void vPortFPUTaskDeleted( void *pvTCB )
+{
+portBASE_TYPE xCore;
+
+	for( xCore = 0; xCore < configNUM_CORES; xCore++ )
+	{
+		if( pvFPUOwner[ xCore ] == pvTCB )
+		{
+			pvFPUOwner[ xCore ] = NULL;
+		}
+	}
+}
+
+#endif /* configUSE_VFP */
+/*-----------------------------------------------------------*/
@@ -25,6 +25,7 @@
 
 /* Scheduler includes. */
 #include "FreeRTOS.h"
+#include "task.h"
 
 /* Constants required to handle interrupts. */
 #define portTIMER_MATCH_ISR_BIT		( ( unsigned char ) 0x01 )
@@ -32,7 +33,15 @@
 
 /* Constants required to handle critical sections. */
 #define portNO_CRITICAL_NESTING		( ( unsigned long ) 0 )
-volatile unsigned long ulCriticalNesting = 9999UL;
+#if ( configNUM_CORES > 1 )
+	volatile unsigned long ulCriticalNesting[ configNUM_CORES ] = { [ 0 ... configNUM_CORES - 1 ] = 9999UL };
+#else
+	volatile unsigned long ulCriticalNesting = 9999UL;
+#endif
+
+/* CPSR fields. */
+#define portMODE_MASK				( ( unsigned long ) 0x1f )
+#define portSYSTEM_MODE				( ( unsigned long ) 0x1f )
 
 /*-----------------------------------------------------------*/
 
@@ -59,6 +68,10 @@ void vPortISRStartFirstTask( void )
 
 	g_bStarted++;
 
+#if ( configUSE_VFP == 1 )
+	vPortFPUResume();
+#endif
+
 	__asm volatile("mrs 	r0,cpsr");		// Read in the cpsr register.
 	__asm volatile("bic		r0,r0,#0x80");	// Clear bit 8, (0x80) -- Causes IRQs to be enabled
 	__asm volatile("msr		cpsr_c, r0");	// Write it back to the CPSR register
@@ -97,8 +110,20 @@ void vPortYieldProcessor( void )
 	/* Perform the context switch.  First save the context of the current task. */
 	portSAVE_CONTEXT();
 
+#if ( configUSE_VFP == 1 )
+	__asm volatile ( "bl vPortFPUSuspend" );
+#endif
+
 	/* Find the highest priority task that is ready to run. */
+#if ( configNUM_CORES > 1 )
+	__asm volatile ( "bl vPortSwitchContext" );
+#else
 	__asm volatile ( "bl vTaskSwitchContext" );
+#endif
+
+#if ( configUSE_VFP == 1 )
+	__asm volatile ( "bl vPortFPUResume" );
+#endif
 
 	/* Restore the context of the new task. */
 	portRESTORE_CONTEXT();	
@@ -122,18 +147,67 @@ void vPortYieldProcessor( void )
  **/
 
 extern void irqHandler(void);
+extern void vPortCoreIRQHandler(void);
 #include <video.h>
 void vFreeRTOS_ISR( void ) __attribute__((naked, no_instrument_function));
 void vFreeRTOS_ISR( void ) {												
 	portSAVE_CONTEXT();
 //if(loaded != 0) println("vFreeRTOS_ISR", 0xFFFFFFFF);
+#if ( configUSE_VFP == 1 )
+	vPortFPUSuspend();
+#endif
+#if ( configGENERATE_RUN_TIME_STATS == 1 )
+	vPortInterruptEnter();
+#endif
+	traceISR_ENTER();
+#if ( configNUM_CORES > 1 )
+	vPortCoreIRQHandler();
+#else
 	irqHandler();
+#endif
+	traceISR_EXIT();
+#if ( configGENERATE_RUN_TIME_STATS == 1 )
+	vPortInterruptExit();
+#endif
 //if(loaded == 2) println("vFreeRTOS_ISR", 0xFFFFFFFF);
+#if ( configUSE_VFP == 1 )
+	vPortFPUResume();
+#endif
 	portRESTORE_CONTEXT();
 	//shouldn't get here, but if it does just return
 	__asm volatile("subs pc, lr, #4");
 }
 
+/**
+ *	Undefined instruction exception.
+ *
+ *	With configUSE_VFP set this is how a task's first VFP or NEON instruction
+ *	gets the VFP (see ulPortFPUTrap() in port.c), after which the instruction
+ *	is run again.  The VFP instructions are 4 bytes in both ARM and Thumb
+ *	state, so LR - 4 is the one that trapped.  Anything else stops here, as
+ *	it always has.
+ **/
+#if ( configUSE_VFP == 1 )
+extern unsigned long ulPortFPUTrap( unsigned long ulSPSR );
+#endif
+void vPortUndefinedHandler( void ) __attribute__((naked, no_instrument_function));
+void vPortUndefinedHandler( void ) {
+#if ( configUSE_VFP == 1 )
+	__asm volatile (
+		"STMDB	SP!, {R0-R3, R12, LR}		\n\t"
+		"MRS	R0, SPSR					\n\t"
+		"BL		ulPortFPUTrap				\n\t"
+		"CMP	R0, #0						\n\t"
+		"LDMIA	SP!, {R0-R3, R12, LR}		\n\t"
+		"BEQ	1f							\n\t"
+		"SUBS	PC, LR, #4					\n\t"	/* Retry it with the VFP on. */
+		"1:								\n\t"
+	);
+#endif
+	__asm volatile ( "2:	B	2b" );
+}
+/*-----------------------------------------------------------*/
+
 /*
  * The interrupt management utilities can only be called from ARM mode.  When
  * THUMB_INTERWORK is defined the utilities are defined as functions here to
@@ -169,6 +243,131 @@ void vFreeRTOS_ISR( void ) {
 
 #endif /* THUMB_INTERWORK */
 
+#if ( configNUM_CORES > 1 )
+
+/*
+ *	SMP kernel locking.
+ *
+ *	All kernel data is protected by one lock, built on LDREX/STREX.  A core
+ *	holds it while its current task is inside a critical section (the per core
+ *	ulCriticalNesting is non zero), and while it is switching context.  Having
+ *	the scheduler suspended is only a count on the core that did it (see
+ *	vTaskSuspendAll()), and does not hold the lock.  The critical nesting word
+ *	is part of every task's saved context, so a task that yields inside a
+ *	critical section gets the lock back when it is switched in again, on
+ *	whichever core that is.
+ *
+ *	Taking the lock when the core already owns it is a no-op, so interrupt
+ *	handlers can use critical sections on top of the task they interrupted.
+ *
+ *	Note the exclusive monitor only works on real silicon once the data cache
+ *	is enabled.  QEMU's raspi machines do not have that restriction.
+ */
+
+/* 0 when free, otherwise the number of the owning core plus one. */
+static volatile unsigned long ulKernelLock = 0UL;
+
+__attribute__((no_instrument_function))
+static inline void prvKernelLockTake( unsigned long ulCore )
+{
+unsigned long ulStatus;
+
+	if( ulKernelLock != ulCore + 1UL )
+	{
+		__asm volatile (
+			"1:	LDREX	%0, [%1]		\n\t"	/* Read the lock and open the monitor.		*/
+			"	CMP		%0, #0			\n\t"
+			"	WFENE					\n\t"	/* Owned, sleep until the owner's SEV.		*/
+			"	BNE		1b				\n\t"
+			"	STREX	%0, %2, [%1]	\n\t"	/* Free, try to claim it.					*/
+			"	CMP		%0, #0			\n\t"
+			"	BNE		1b				\n\t"	/* Another core got there first.			*/
+			"	DMB						\n\t"
+			: "=&r" ( ulStatus )
+			: "r" ( &ulKernelLock ), "r" ( ulCore + 1UL )
+			: "cc", "memory" );
+	}
+}
+
+/* Drops the lock once nothing on this core needs it any more. */
+__attribute__((no_instrument_function))
+static inline void prvKernelLockRelease( unsigned long ulCore )
+{
+	if( ulCriticalNesting[ ulCore ] == portNO_CRITICAL_NESTING )
+	{
+		__asm volatile ( "DMB" : : : "memory" );
+		ulKernelLock = 0UL;
+		__asm volatile ( "DSB	\n\t"
+						 "SEV" : : : "memory" );
+	}
+}
+
+/*
+ *	Called, with interrupts disabled, in place of vTaskSwitchContext() by the
+ *	yield SWI, the IRQ handler and portYIELD_FROM_ISR().
+ */
+__attribute__((no_instrument_function))
+void vPortSwitchContext( void )
+{
+unsigned long ulCore = portGET_CORE_ID();
+
+	prvKernelLockTake( ulCore );
+
+#if ( configUSE_VFP == 1 )
+	vPortFPUSwitchOut();
+#endif
+
+	vTaskSwitchContext();
+
+	/* The first word of the incoming task's saved context is its critical
+	nesting depth.  Adopt it now, so critical sections used by the rest of an
+	interrupt handler nest on top of it and the lock stays held if the task
+	was switched out inside a critical section. */
+	ulCriticalNesting[ ulCore ] = **( unsigned long ** ) portGET_CURRENT_TCB();
+
+	prvKernelLockRelease( ulCore );
+}
+
+__attribute__((no_instrument_function))
+void vPortEnterCritical( void )
+{
+unsigned long ulCore;
+
+	portDISABLE_INTERRUPTS();
+
+	ulCore = portGET_CORE_ID();
+	prvKernelLockTake( ulCore );
+	ulCriticalNesting[ ulCore ]++;
+}
+
+__attribute__((no_instrument_function))
+void vPortExitCritical( void )
+{
+unsigned long ulCore = portGET_CORE_ID();
+unsigned long ulCPSR;
+
+	if( ulCriticalNesting[ ulCore ] > portNO_CRITICAL_NESTING )
+	{
+		ulCriticalNesting[ ulCore ]--;
+
+		if( ulCriticalNesting[ ulCore ] == portNO_CRITICAL_NESTING )
+		{
+			prvKernelLockRelease( ulCore );
+
+			/* Only tasks run in system mode.  Interrupt handlers, and main()
+			before the scheduler starts, must not have interrupts turned back
+			on underneath them. */
+			__asm volatile ( "MRS	%0, CPSR" : "=r" ( ulCPSR ) );
+			if( ( ulCPSR & portMODE_MASK ) == portSYSTEM_MODE )
+			{
+				portENABLE_INTERRUPTS();
+			}
+		}
+	}
+}
+
+#else
+
 /* The code generated by the GCC compiler uses the stack in different ways at
 different optimisation levels.  The interrupt flags can therefore not always
 be saved to the stack.  Instead the critical section nesting level is stored
@@ -217,3 +416,5 @@ void vPortExitCritical( void ){
 		}
 	}
 }
+
+#endif /* configNUM_CORES */
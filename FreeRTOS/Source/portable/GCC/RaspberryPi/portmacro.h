@@ -41,6 +41,75 @@ extern "C" {
 /*-----------------------------------------------------------*/	
 
 
+/* Port optimised task selection.  The kernel keeps a bitmap of the priorities
+that have ready tasks and the top one is found with a single CLZ.  The bitmap
+is one word, so configMAX_PRIORITIES must not be more than 32. */
+
+#if ( configUSE_PORT_OPTIMISED_TASK_SELECTION == 1 )
+
+	#define portRECORD_READY_PRIORITY( uxPriority, uxReadyPriorities )	( uxReadyPriorities ) |= ( 1UL << ( uxPriority ) )
+	#define portRESET_READY_PRIORITY( uxPriority, uxReadyPriorities )	( uxReadyPriorities ) &= ~( 1UL << ( uxPriority ) )
+
+	#define portGET_HIGHEST_PRIORITY( uxTopPriority, uxReadyPriorities )					\
+	{																						\
+		unsigned long __ulLeadingZeros;														\
+		__asm volatile ( "CLZ	%0, %1" : "=r" ( __ulLeadingZeros ) : "r" ( uxReadyPriorities ) );	\
+		( uxTopPriority ) = 31UL - __ulLeadingZeros;										\
+	}
+
+#endif /* configUSE_PORT_OPTIMISED_TASK_SELECTION */
+/*-----------------------------------------------------------*/
+
+
+/* Multi-core support. */
+
+#if ( configNUM_CORES > 1 )
+
+	/* Core number from the affinity level 0 field of MPIDR. */
+	#define portGET_CORE_ID()											\
+	({																	\
+		unsigned long __ulMPIDR;										\
+		__asm volatile ( "MRC	p15, 0, %0, c0, c0, 5" : "=r" ( __ulMPIDR ) );	\
+		( portBASE_TYPE ) ( __ulMPIDR & 0x3UL );						\
+	})
+
+	/* Each core keeps its current TCB in TPIDRPRW.  A single MRC always
+	returns the TCB of the task executing it, even if that task is moved to
+	another core straight afterwards. */
+	#define portGET_CURRENT_TCB()										\
+	({																	\
+		void *__pvTCB;													\
+		__asm volatile ( "MRC	p15, 0, %0, c13, c0, 4" : "=r" ( __pvTCB ) );	\
+		__pvTCB;														\
+	})
+
+	#define portSET_CURRENT_TCB( pvTCB )	__asm volatile ( "MCR	p15, 0, %0, c13, c0, 4" : : "r" ( pvTCB ) : "memory" )
+
+	/* Cross core yields are sent through the core local mailboxes. */
+	extern void vPortYieldCore( portBASE_TYPE xCoreID );
+	extern void vPortYieldOtherCores( void );
+	#define portYIELD_CORE( xCoreID )		vPortYieldCore( xCoreID )
+	#define portYIELD_OTHER_CORES()		vPortYieldOtherCores()
+
+	/* Interrupt handlers on one core still race the other cores, so the
+	FromISR API takes the kernel lock as well. */
+	extern void vPortEnterCritical( void );
+	extern void vPortExitCritical( void );
+	#define portSET_INTERRUPT_MASK_FROM_ISR()					( vPortEnterCritical(), 0 )
+	#define portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedStatus )	{ ( void ) ( uxSavedStatus ); vPortExitCritical(); }
+
+	/* The critical nesting word of the executing core, indexed from the
+	MPIDR read into Rcore.  Used by the context switch macros below. */
+	#define portCORE_CRITICAL_NESTING( Rdst, Rcore )				\
+	"MRC	p15, 0, " #Rcore ", c0, c0, 5						\n\t"	\
+	"AND	" #Rcore ", " #Rcore ", #3							\n\t"	\
+	"LDR	" #Rdst ", =ulCriticalNesting						\n\t"	\
+	"ADD	" #Rdst ", " #Rdst ", " #Rcore ", LSL #2			\n\t"
+
+#endif /* configNUM_CORES */
+/*-----------------------------------------------------------*/
+
+
 /* Scheduler utilities. */
 
 /*
@@ -50,6 +119,93 @@ extern "C" {
  * THUMB mode code will result in a compile time error.
  */
 
+#if ( configNUM_CORES > 1 )
+
+/*
+ * SMP versions of the context switch macros.  The stack frame is the same as
+ * the single core one, but the current TCB comes from TPIDRPRW and the
+ * critical nesting word is the executing core's entry of ulCriticalNesting[].
+ */
+#define portRESTORE_CONTEXT()															\
+{																						\
+	extern volatile unsigned portLONG ulCriticalNesting[];								\
+																						\
+	__asm volatile (																	\
+	/* This core's current TCB, whose first member is the top of stack. */			\
+	"MRC		p15, 0, R0, c13, c0, 4										\n\t"		\
+	"LDR		LR, [R0]													\n\t"		\
+																						\
+	/* The critical nesting depth is the first item on the stack. */				\
+	portCORE_CRITICAL_NESTING( R0, R1 )													\
+	"LDMFD		LR!, {R1}													\n\t"		\
+	"STR		R1, [R0]													\n\t"		\
+																						\
+	/* Get the SPSR from the stack. */													\
+	"LDMFD		LR!, {R0}													\n\t"		\
+	"MSR		SPSR_cxsf, R0												\n\t"		\
+																						\
+	/* Restore all system mode registers for the task. */								\
+	"LDMFD	LR, {R0-R14}^													\n\t"		\
+	"NOP																	\n\t"		\
+																						\
+	/* Restore the return address. */													\
+	"LDR		LR, [LR, #+60]												\n\t"		\
+																						\
+	/* And return - correcting the offset in the LR to obtain the */					\
+	/* correct address. */																\
+	"SUBS		PC, LR, #4													\n\t"		\
+	"NOP																	\n\t"		\
+	"NOP																	\n\t"		\
+	);																					\
+	( void ) ulCriticalNesting;															\
+}
+/*-----------------------------------------------------------*/
+
+#define portSAVE_CONTEXT()													\
+{																			\
+	extern volatile unsigned portLONG ulCriticalNesting[];					\
+																			\
+	/* Push R0 as we are going to use the register. */						\
+	__asm volatile (														\
+	"STMDB	SP!, {R0}												\n\t"	\
+																			\
+	/* Set R0 to point to the task stack pointer. */						\
+	"STMDB	SP,{SP}^	\n\t"	/* ^ means get the user mode SP value. */	\
+	"SUB	SP, SP, #4												\n\t"	\
+	"LDMIA	SP!,{R0}												\n\t"	\
+																			\
+	/* Push the return address onto the stack. */							\
+	"STMDB	R0!, {LR}												\n\t"	\
+																			\
+	/* Now we have saved LR we can use it instead of R0. */					\
+	"MOV	LR, R0													\n\t"	\
+																			\
+	/* Pop R0 so we can save it onto the system mode stack. */				\
+	"LDMIA	SP!, {R0}												\n\t"	\
+																			\
+	/* Push all the system mode registers onto the task stack. */			\
+	"STMDB	LR,{R0-LR}^												\n\t"	\
+	"NOP															\n\t"	\
+	"SUB	LR, LR, #60												\n\t"	\
+																			\
+	/* Push the SPSR onto the task stack. */								\
+	"MRS	R0, SPSR												\n\t"	\
+	"STMDB	LR!, {R0}												\n\t"	\
+																			\
+	/* R1 has been saved, so it can hold the core number. */				\
+	portCORE_CRITICAL_NESTING( R0, R1 )										\
+	"LDR	R0, [R0]												\n\t"	\
+	"STMDB	LR!, {R0}												\n\t"	\
+																			\
+	/* Store the new top of stack for the task. */							\
+	"MRC	p15, 0, R0, c13, c0, 4									\n\t"	\
+	"STR	LR, [R0]												\n\t"	\
+	);																		\
+	( void ) ulCriticalNesting;												\
+}
+
+#else
+
 #define portRESTORE_CONTEXT()															\
 {																						\
 	extern volatile void * volatile pxCurrentTCB;										\
@@ -140,9 +296,26 @@ extern "C" {
 	( void ) pxCurrentTCB;													\
 }
 
-extern void vTaskSwitchContext( void );
-#define portYIELD_FROM_ISR()		vTaskSwitchContext()
+#endif /* configNUM_CORES */
+
+#if ( configNUM_CORES > 1 )
+	/* Takes the kernel lock around the switch, see portisr.c. */
+	extern void vPortSwitchContext( void );
+	#define portYIELD_FROM_ISR()		vPortSwitchContext()
+#else
+	extern void vTaskSwitchContext( void );
+	#define portYIELD_FROM_ISR()		vTaskSwitchContext()
+#endif
 #define portYIELD()					__asm volatile ( "SWI 0" )
+
+/* Interrupt handlers run in IRQ mode and tasks in system mode, so code called
+from both can tell whether to use the FromISR API. */
+#define portIS_INSIDE_INTERRUPT()									\
+({																	\
+	unsigned long __ulCPSR;											\
+	__asm volatile ( "MRS	%0, CPSR" : "=r" ( __ulCPSR ) );		\
+	( ( __ulCPSR & 0x1fUL ) == 0x12UL );							\
+})
 /*-----------------------------------------------------------*/
 
 
@@ -190,6 +363,67 @@ extern void vPortExitCritical( void );
 #define portEXIT_CRITICAL()		vPortExitCritical();
 /*-----------------------------------------------------------*/
 
+/* Run time statistics, see port.c. */
+#if ( configGENERATE_RUN_TIME_STATS == 1 )
+	extern void vPortConfigureRunTimeStats( void );
+	extern unsigned long ulPortGetRunTimeCounterValue( void );
+	extern unsigned long ulPortGetRunTimeTotal( void );
+	extern unsigned long ulPortGetInterruptRunTime( void );
+	extern void vPortInterruptEnter( void );
+	extern void vPortInterruptExit( void );
+	#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()		vPortConfigureRunTimeStats()
+	#define portGET_RUN_TIME_COUNTER_VALUE()				ulPortGetRunTimeCounterValue()
+	#define portGET_RUN_TIME_TOTAL_VALUE()					ulPortGetRunTimeTotal()
+	#define portGET_INTERRUPT_RUN_TIME_COUNTER_VALUE()		ulPortGetInterruptRunTime()
+#endif
+/*-----------------------------------------------------------*/
+
+/* Tickless idle, see port.c. */
+#if ( configUSE_TICKLESS_IDLE != 0 )
+	extern void vPortSuppressTicksAndSleep( portTickType xExpectedIdleTime );
+	#define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime )	vPortSuppressTicksAndSleep( xExpectedIdleTime )
+#endif
+/*-----------------------------------------------------------*/
+
+/* Lazy VFP/NEON context switching, see port.c. */
+#if ( configUSE_VFP == 1 )
+
+	#if !defined( __ARM_FP ) || defined( __SOFTFP__ )
+		#error configUSE_VFP needs a compiler targeting the VFP, build with -mfpu set (see dbuild.config.mk).
+	#endif
+
+	/* D16-D31 only exist on the NEON (VFPv3/v4-D32) units. */
+	#if defined( __ARM_NEON__ )
+		#define portFPU_DOUBLE_REGISTERS	32
+	#else
+		#define portFPU_DOUBLE_REGISTERS	16
+	#endif
+
+	/* A task's VFP registers while another task owns the VFP.  Kept in the
+	TCB, see tasks.c. */
+	typedef struct xFPU_CONTEXT
+	{
+		unsigned long ulRegisters[ portFPU_DOUBLE_REGISTERS * 2 ];
+		unsigned long ulFPSCR;
+		unsigned long ulUsed;			/* Non zero once the task has used the VFP. */
+	} xFPU_CONTEXT;
+
+	#define portUSING_FPU_CONTEXT		1
+
+	extern void vPortFPUSuspend( void );
+	extern void vPortFPUResume( void );
+	extern void vPortFPUTaskDeleted( void *pvTCB );
+	#define portCLEAN_UP_TCB( pxTCB )	vPortFPUTaskDeleted( pxTCB )
+
+	#if ( configNUM_CORES > 1 )
+		extern void vPortFPUSwitchOut( void );
+	#endif
+
+#elif defined( __ARM_FP ) && !defined( __SOFTFP__ )
+	#error The compiler may use the VFP, which only works with configUSE_VFP set to 1.
+#endif
+/*-----------------------------------------------------------*/
+
 /* Task function macros as described on the FreeRTOS.org WEB site. */
 #define portTASK_FUNCTION_PROTO( vFunction, pvParameters ) void vFunction( void *pvParameters )
 #define portTASK_FUNCTION( vFunction, pvParameters ) void vFunction( void *pvParameters )
@@ -113,6 +113,7 @@ void *pvReturn = NULL;
 	#endif
 
 	vTaskSuspendAll();
+	taskSMP_ENTER_CRITICAL();
 	{
 		/* Check there is enough room left for the allocation. */
 		if( ( ( xNextFreeByte + xWantedSize ) < configTOTAL_HEAP_SIZE ) &&
@@ -124,6 +125,7 @@ void *pvReturn = NULL;
 			xNextFreeByte += xWantedSize;			
 		}	
 	}
+	taskSMP_EXIT_CRITICAL();
 	xTaskResumeAll();
 	
 	#if( configUSE_MALLOC_FAILED_HOOK == 1 )
@@ -172,6 +172,7 @@ static portBASE_TYPE xHeapHasBeenInitialised = pdFALSE;
 void *pvReturn = NULL;
 
 	vTaskSuspendAll();
+	taskSMP_ENTER_CRITICAL();
 	{
 		/* If this is the first call to malloc then the heap will require
 		initialisation to setup the list of free blocks. */
@@ -239,6 +240,7 @@ void *pvReturn = NULL;
 			}
 		}
 	}
+	taskSMP_EXIT_CRITICAL();
 	xTaskResumeAll();
 
 	#if( configUSE_MALLOC_FAILED_HOOK == 1 )
@@ -270,11 +272,13 @@ xBlockLink *pxLink;
 		pxLink = ( void * ) puc;
 
 		vTaskSuspendAll();
+		taskSMP_ENTER_CRITICAL();
 		{
 			/* Add this block to the list of free blocks. */
 			prvInsertBlockIntoFreeList( ( ( xBlockLink * ) pxLink ) );
 			xFreeBytesRemaining += pxLink->xBlockSize;
 		}
+		taskSMP_EXIT_CRITICAL();
 		xTaskResumeAll();
 	}
 }
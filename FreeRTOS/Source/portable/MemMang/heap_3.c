@@ -95,9 +95,11 @@ void *pvPortMalloc( size_t xWantedSize )
 void *pvReturn;
 
 	vTaskSuspendAll();
+	taskSMP_ENTER_CRITICAL();
 	{
 		pvReturn = malloc( xWantedSize );
 	}
+	taskSMP_EXIT_CRITICAL();
 	xTaskResumeAll();
 
 	#if( configUSE_MALLOC_FAILED_HOOK == 1 )
@@ -119,9 +121,11 @@ void vPortFree( void *pv )
 	if( pv )
 	{
 		vTaskSuspendAll();
+		taskSMP_ENTER_CRITICAL();
 		{
 			free( pv );
 		}
+		taskSMP_EXIT_CRITICAL();
 		xTaskResumeAll();
 	}
 }
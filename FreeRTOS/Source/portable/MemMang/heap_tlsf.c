@@ -0,0 +1,499 @@
+/*
+ * An implementation of pvPortMalloc() and vPortFree() with constant time
+ * allocation and release, after the Two Level Segregated Fit allocator of
+ * Masmano, Ripoll, Crespo and Real.  Select it in place of heap_4.c with
+ * "make HEAP=heap_tlsf".
+ *
+ * heap_4.c keeps one free list in address order, so both pvPortMalloc() and
+ * vPortFree() walk it, and take longer the more fragmented the heap becomes.
+ * Here free blocks are kept in size classes instead.  The first level splits
+ * sizes by powers of two, and the second level splits each power of two into
+ * heapSL_COUNT equal ranges.  A bitmap per level records which classes have a
+ * free block, so a class at least as big as the request is found with a
+ * couple of count leading zeros instructions rather than a search.
+ *
+ * Every block starts with a header holding its size and the address of the
+ * block physically before it, so a freed block is merged with both its
+ * neighbours straight away, again without a search.  Allocations are taken
+ * from a class whose every block is big enough ("good fit"), which keeps the
+ * fragmentation bounded.  The cost is that a request can fail while a block
+ * that is just big enough sits in the class below, which is why the head of
+ * that class is also tried.
+ *
+ * The overhead per allocation is the same as heap_4.c: two words.
+ *
+ * See heap_1.c, heap_2.c, heap_3.c and heap_4.c for alternative
+ * implementations, and the memory management pages of
+ * http://www.FreeRTOS.org for more information.
+ */
+#include <stdlib.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* Second level classes per power of two. */
+#define heapSL_COUNT_LOG2		4
+#define heapSL_COUNT			( 1 << heapSL_COUNT_LOG2 )
+
+/* Blocks smaller than heapSMALL_BLOCK_SIZE all go in first level class 0,
+whose second level classes are portBYTE_ALIGNMENT bytes apart. */
+#if portBYTE_ALIGNMENT == 8
+	#define heapALIGN_LOG2		3
+#else
+	#define heapALIGN_LOG2		2
+#endif
+#define heapFL_SHIFT			( heapSL_COUNT_LOG2 + heapALIGN_LOG2 )
+#define heapSMALL_BLOCK_SIZE	( ( size_t ) 1 << heapFL_SHIFT )
+
+/* Largest block is just under 1 << heapFL_MAX, raise it for a bigger heap. */
+#define heapFL_MAX				24
+#define heapFL_COUNT			( heapFL_MAX - heapFL_SHIFT + 1 )
+
+/* Low bit of xSize, set while the block is free.  Sizes are always a multiple
+of portBYTE_ALIGNMENT. */
+#define heapBLOCK_FREE			( ( size_t ) 1 )
+#define heapBLOCK_SIZE( pxBlock )	( ( pxBlock )->xSize & ~heapBLOCK_FREE )
+#define heapBLOCK_IS_FREE( pxBlock )	( ( ( pxBlock )->xSize & heapBLOCK_FREE ) != 0 )
+#define heapNEXT_BLOCK( pxBlock )	( ( xTlsfBlock * ) ( ( ( unsigned char * ) ( pxBlock ) ) + heapBLOCK_SIZE( pxBlock ) ) )
+
+/* Bit scans on the bitmaps, which are unsigned longs. */
+#define heapFLS( ulValue )		( ( int ) ( sizeof( unsigned long ) * 8 ) - 1 - __builtin_clzl( ulValue ) )
+#define heapFFS( ulValue )		__builtin_ctzl( ulValue )
+
+/* Allocate the memory for the heap.  The struct is used to force byte
+alignment without using any non-portable code. */
+static union xRTOS_HEAP
+{
+	#if portBYTE_ALIGNMENT == 8
+		volatile portDOUBLE dDummy;
+	#else
+		volatile unsigned long ulDummy;
+	#endif
+	unsigned char ucHeap[ configTOTAL_HEAP_SIZE ];
+} xHeap;
+
+/* The header at the start of every block.  The free list links are only
+valid while the block is free, and overlay the start of the memory handed
+out by pvPortMalloc(). */
+typedef struct A_TLSF_BLOCK
+{
+	struct A_TLSF_BLOCK *pxPrevPhysBlock;	/*<< The block immediately below this one in memory, NULL for the first. */
+	size_t xSize;							/*<< The size of the block including this header, and heapBLOCK_FREE. */
+	struct A_TLSF_BLOCK *pxNextFree;		/*<< The next free block in the same class. */
+	struct A_TLSF_BLOCK *pxPrevFree;		/*<< The previous free block in the same class, NULL for the first. */
+} xTlsfBlock;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Called automatically to setup the required heap structures the first time
+ * pvPortMalloc() is called.
+ */
+static void prvHeapInit( void );
+
+/*
+ * The class a block of xSize bytes is filed in.
+ */
+static void prvMappingInsert( size_t xSize, int *piFL, int *piSL );
+
+/*
+ * The smallest class whose blocks are all at least xSize bytes.
+ */
+static void prvMappingSearch( size_t xSize, int *piFL, int *piSL );
+
+/*
+ * Remove and return a free block from class iFL/iSL or the next non empty
+ * class above it, or return NULL if there is none.
+ */
+static xTlsfBlock *prvTakeSuitableBlock( int iFL, int iSL );
+
+static void prvInsertFreeBlock( xTlsfBlock *pxBlock );
+static void prvRemoveFreeBlock( xTlsfBlock *pxBlock );
+
+/*-----------------------------------------------------------*/
+
+/* The part of the header before the memory handed out, correctly aligned. */
+static const size_t heapSTRUCT_SIZE = ( ( offsetof( xTlsfBlock, pxNextFree ) + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) );
+
+/* Blocks must be big enough to hold the free list links when freed. */
+#define heapMINIMUM_BLOCK_SIZE	( ( sizeof( xTlsfBlock ) + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+
+/* Ensure the end marker will end up on the correct byte alignment. */
+static const size_t xTotalHeapSize = ( ( size_t ) configTOTAL_HEAP_SIZE ) & ( ( size_t ) ~portBYTE_ALIGNMENT_MASK );
+
+/* Bit n of ulFLBitmap is set when first level class n has a free block, and
+bit m of ulSLBitmap[ n ] when second level class m of it does. */
+static unsigned long ulFLBitmap = 0UL;
+static unsigned long ulSLBitmap[ heapFL_COUNT ];
+static xTlsfBlock *pxFreeLists[ heapFL_COUNT ][ heapSL_COUNT ];
+
+/* Set once the heap has been initialised. */
+static xTlsfBlock *pxEnd = NULL;
+
+/* Keeps track of the number of free bytes remaining, but says nothing about
+fragmentation. */
+static size_t xFreeBytesRemaining = 0;
+
+/* The lowest xFreeBytesRemaining has been, and the calls that succeeded, for
+vPortGetHeapStats(). */
+static size_t xMinimumEverFreeBytesRemaining = 0;
+static size_t xNumberOfSuccessfulAllocations = 0;
+static size_t xNumberOfSuccessfulFrees = 0;
+
+/*-----------------------------------------------------------*/
+__attribute__((no_instrument_function))
+void *pvPortMalloc( size_t xWantedSize )
+{
+xTlsfBlock *pxBlock = NULL, *pxRemainder;
+void *pvReturn = NULL;
+int iFL, iSL;
+
+	vTaskSuspendAll();
+	taskSMP_ENTER_CRITICAL();
+	{
+		/* If this is the first call to malloc then the heap will require
+		initialisation to setup the free lists. */
+		if( pxEnd == NULL )
+		{
+			prvHeapInit();
+		}
+
+		/* The wanted size is increased so it can contain the header in
+		addition to the requested amount of bytes, and rounded up so that
+		blocks are always aligned to the required number of bytes. */
+		if( ( xWantedSize > 0 ) && ( xWantedSize < xTotalHeapSize ) )
+		{
+			xWantedSize = ( xWantedSize + heapSTRUCT_SIZE + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+			if( xWantedSize < heapMINIMUM_BLOCK_SIZE )
+			{
+				xWantedSize = heapMINIMUM_BLOCK_SIZE;
+			}
+
+			/* Any block in the class found by the search is big enough. */
+			prvMappingSearch( xWantedSize, &iFL, &iSL );
+			if( iFL < heapFL_COUNT )
+			{
+				pxBlock = prvTakeSuitableBlock( iFL, iSL );
+			}
+
+			if( pxBlock == NULL )
+			{
+				/* Only the class the size itself falls in is left, where a
+				block may or may not be big enough.  Try its head. */
+				prvMappingInsert( xWantedSize, &iFL, &iSL );
+				if( iFL < heapFL_COUNT )
+				{
+					pxBlock = pxFreeLists[ iFL ][ iSL ];
+					if( ( pxBlock != NULL ) && ( heapBLOCK_SIZE( pxBlock ) >= xWantedSize ) )
+					{
+						prvRemoveFreeBlock( pxBlock );
+					}
+					else
+					{
+						pxBlock = NULL;
+					}
+				}
+			}
+
+			if( pxBlock != NULL )
+			{
+				/* If the block is larger than required it can be split into
+				two, and the remainder goes back on a free list. */
+				if( ( heapBLOCK_SIZE( pxBlock ) - xWantedSize ) >= heapMINIMUM_BLOCK_SIZE )
+				{
+					pxRemainder = ( xTlsfBlock * ) ( ( ( unsigned char * ) pxBlock ) + xWantedSize );
+					pxRemainder->xSize = heapBLOCK_SIZE( pxBlock ) - xWantedSize;
+					pxRemainder->pxPrevPhysBlock = pxBlock;
+					heapNEXT_BLOCK( pxRemainder )->pxPrevPhysBlock = pxRemainder;
+					pxBlock->xSize = xWantedSize;
+					prvInsertFreeBlock( pxRemainder );
+				}
+
+				pxBlock->xSize &= ~heapBLOCK_FREE;
+				xFreeBytesRemaining -= pxBlock->xSize;
+				if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+				{
+					xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+				}
+				xNumberOfSuccessfulAllocations++;
+
+				/* Return the memory space - jumping over the header. */
+				pvReturn = ( void * ) ( ( ( unsigned char * ) pxBlock ) + heapSTRUCT_SIZE );
+			}
+		}
+
+		traceMALLOC( pvReturn, xWantedSize );
+	}
+	taskSMP_EXIT_CRITICAL();
+	xTaskResumeAll();
+
+	#if( configUSE_MALLOC_FAILED_HOOK == 1 )
+	{
+		if( pvReturn == NULL )
+		{
+			extern void vApplicationMallocFailedHook( void );
+			vApplicationMallocFailedHook();
+		}
+	}
+	#endif
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+__attribute__((no_instrument_function))
+void vPortFree( void *pv )
+{
+xTlsfBlock *pxBlock, *pxNeighbour;
+
+	if( pv != NULL )
+	{
+		/* The memory being freed will have a header immediately before it. */
+		pxBlock = ( xTlsfBlock * ) ( ( ( unsigned char * ) pv ) - heapSTRUCT_SIZE );
+
+		vTaskSuspendAll();
+		taskSMP_ENTER_CRITICAL();
+		{
+			xFreeBytesRemaining += heapBLOCK_SIZE( pxBlock );
+			xNumberOfSuccessfulFrees++;
+			traceFREE( pv, heapBLOCK_SIZE( pxBlock ) );
+
+			/* Merge with the block below, if that is free. */
+			pxNeighbour = pxBlock->pxPrevPhysBlock;
+			if( ( pxNeighbour != NULL ) && heapBLOCK_IS_FREE( pxNeighbour ) )
+			{
+				prvRemoveFreeBlock( pxNeighbour );
+				pxNeighbour->xSize = heapBLOCK_SIZE( pxNeighbour ) + heapBLOCK_SIZE( pxBlock );
+				pxBlock = pxNeighbour;
+			}
+
+			/* And with the block above.  The end marker is never free. */
+			pxNeighbour = heapNEXT_BLOCK( pxBlock );
+			if( heapBLOCK_IS_FREE( pxNeighbour ) )
+			{
+				prvRemoveFreeBlock( pxNeighbour );
+				pxBlock->xSize = heapBLOCK_SIZE( pxBlock ) + heapBLOCK_SIZE( pxNeighbour );
+			}
+
+			heapNEXT_BLOCK( pxBlock )->pxPrevPhysBlock = pxBlock;
+			prvInsertFreeBlock( pxBlock );
+		}
+		taskSMP_EXIT_CRITICAL();
+		xTaskResumeAll();
+	}
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetFreeHeapSize( void )
+{
+	return xFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetMinimumEverFreeHeapSize( void )
+{
+	return xMinimumEverFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapStats( xHeapStats *pxHeapStats )
+{
+xTlsfBlock *pxBlock;
+size_t xBlocks = 0, xMaxSize = 0, xMinSize = ~( ( size_t ) 0 );
+int iFL, iSL;
+
+	vTaskSuspendAll();
+	taskSMP_ENTER_CRITICAL();
+	{
+		/* Only the classes with their bitmap bit set have free blocks. */
+		for( iFL = 0; iFL < heapFL_COUNT; iFL++ )
+		{
+			if( ( ulFLBitmap & ( 1UL << iFL ) ) == 0UL )
+			{
+				continue;
+			}
+
+			for( iSL = 0; iSL < heapSL_COUNT; iSL++ )
+			{
+				for( pxBlock = pxFreeLists[ iFL ][ iSL ]; pxBlock != NULL; pxBlock = pxBlock->pxNextFree )
+				{
+					xBlocks++;
+					if( heapBLOCK_SIZE( pxBlock ) > xMaxSize )
+					{
+						xMaxSize = heapBLOCK_SIZE( pxBlock );
+					}
+					if( heapBLOCK_SIZE( pxBlock ) < xMinSize )
+					{
+						xMinSize = heapBLOCK_SIZE( pxBlock );
+					}
+				}
+			}
+		}
+
+		pxHeapStats->xAvailableHeapSpaceInBytes = xFreeBytesRemaining;
+		pxHeapStats->xSizeOfLargestFreeBlockInBytes = xMaxSize;
+		pxHeapStats->xSizeOfSmallestFreeBlockInBytes = ( xBlocks > 0 ) ? xMinSize : 0;
+		pxHeapStats->xNumberOfFreeBlocks = xBlocks;
+		pxHeapStats->xMinimumEverFreeBytesRemaining = xMinimumEverFreeBytesRemaining;
+		pxHeapStats->xNumberOfSuccessfulAllocations = xNumberOfSuccessfulAllocations;
+		pxHeapStats->xNumberOfSuccessfulFrees = xNumberOfSuccessfulFrees;
+	}
+	taskSMP_EXIT_CRITICAL();
+	xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+void vPortInitialiseBlocks( void )
+{
+	/* This just exists to keep the linker quiet. */
+}
+/*-----------------------------------------------------------*/
+
+static void prvHeapInit( void )
+{
+xTlsfBlock *pxFirstFreeBlock;
+
+	/* Ensure the start of the heap is aligned, and that the heap fits the
+	first level classes. */
+	configASSERT( ( ( ( unsigned long ) xHeap.ucHeap ) & ( ( unsigned long ) portBYTE_ALIGNMENT_MASK ) ) == 0UL );
+	configASSERT( xTotalHeapSize < ( ( size_t ) 1 << heapFL_MAX ) );
+
+	/* The end marker is a zero sized block that is never free, so nothing is
+	ever merged with it.  Its header is all that is needed. */
+	pxEnd = ( xTlsfBlock * ) ( xHeap.ucHeap + xTotalHeapSize - heapSTRUCT_SIZE );
+
+	/* To start with there is a single free block that is sized to take up the
+	entire heap space, minus the space taken by the end marker. */
+	pxFirstFreeBlock = ( xTlsfBlock * ) xHeap.ucHeap;
+	pxFirstFreeBlock->pxPrevPhysBlock = NULL;
+	pxFirstFreeBlock->xSize = xTotalHeapSize - heapSTRUCT_SIZE;
+
+	pxEnd->pxPrevPhysBlock = pxFirstFreeBlock;
+	pxEnd->xSize = 0;
+
+	xFreeBytesRemaining = pxFirstFreeBlock->xSize;
+	xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+	prvInsertFreeBlock( pxFirstFreeBlock );
+}
+/*-----------------------------------------------------------*/
+__attribute__((no_instrument_function))
+static void prvMappingInsert( size_t xSize, int *piFL, int *piSL )
+{
+int iFL;
+
+	if( xSize < heapSMALL_BLOCK_SIZE )
+	{
+		*piFL = 0;
+		*piSL = ( int ) ( xSize >> heapALIGN_LOG2 );
+	}
+	else
+	{
+		iFL = heapFLS( ( unsigned long ) xSize );
+		*piSL = ( int ) ( ( xSize >> ( iFL - heapSL_COUNT_LOG2 ) ) ^ ( ( size_t ) 1 << heapSL_COUNT_LOG2 ) );
+		*piFL = iFL - ( heapFL_SHIFT - 1 );
+	}
+}
+/*-----------------------------------------------------------*/
+__attribute__((no_instrument_function))
+static void prvMappingSearch( size_t xSize, int *piFL, int *piSL )
+{
+	/* Round up to the start of the next class, unless already on one. */
+	if( xSize >= heapSMALL_BLOCK_SIZE )
+	{
+		xSize += ( ( size_t ) 1 << ( heapFLS( ( unsigned long ) xSize ) - heapSL_COUNT_LOG2 ) ) - 1;
+	}
+
+	prvMappingInsert( xSize, piFL, piSL );
+}
+/*-----------------------------------------------------------*/
+__attribute__((no_instrument_function))
+static xTlsfBlock *prvTakeSuitableBlock( int iFL, int iSL )
+{
+unsigned long ulMap;
+xTlsfBlock *pxBlock;
+
+	/* A non empty class at or above iSL in the same power of two? */
+	ulMap = ulSLBitmap[ iFL ] & ( ~0UL << iSL );
+	if( ulMap == 0UL )
+	{
+		/* No, so the smallest non empty power of two above it. */
+		if( iFL + 1 >= heapFL_COUNT )
+		{
+			return NULL;
+		}
+
+		ulMap = ulFLBitmap & ( ~0UL << ( iFL + 1 ) );
+		if( ulMap == 0UL )
+		{
+			return NULL;
+		}
+
+		iFL = heapFFS( ulMap );
+		ulMap = ulSLBitmap[ iFL ];
+	}
+	iSL = heapFFS( ulMap );
+
+	pxBlock = pxFreeLists[ iFL ][ iSL ];
+	prvRemoveFreeBlock( pxBlock );
+
+	return pxBlock;
+}
+/*-----------------------------------------------------------*/
+__attribute__((no_instrument_function))
+static void prvInsertFreeBlock( xTlsfBlock *pxBlock )
+{
+int iFL, iSL;
+
+	prvMappingInsert( heapBLOCK_SIZE( pxBlock ), &iFL, &iSL );
+
+	pxBlock->xSize |= heapBLOCK_FREE;
+	pxBlock->pxPrevFree = NULL;
+	pxBlock->pxNextFree = pxFreeLists[ iFL ][ iSL ];
+	if( pxBlock->pxNextFree != NULL )
+	{
+		pxBlock->pxNextFree->pxPrevFree = pxBlock;
+	}
+	pxFreeLists[ iFL ][ iSL ] = pxBlock;
+
+	ulFLBitmap |= ( 1UL << iFL );
+	ulSLBitmap[ iFL ] |= ( 1UL << iSL );
+}
+/*-----------------------------------------------------------*/
+__attribute__((no_instrument_function))
+static void prvRemoveFreeBlock( xTlsfBlock *pxBlock )
+{
+int iFL, iSL;
+
+	prvMappingInsert( heapBLOCK_SIZE( pxBlock ), &iFL, &iSL );
+
+	if( pxBlock->pxNextFree != NULL )
+	{
+		pxBlock->pxNextFree->pxPrevFree = pxBlock->pxPrevFree;
+	}
+
+	if( pxBlock->pxPrevFree != NULL )
+	{
+		pxBlock->pxPrevFree->pxNextFree = pxBlock->pxNextFree;
+	}
+	else
+	{
+		/* It was the head of its class. */
+		pxFreeLists[ iFL ][ iSL ] = pxBlock->pxNextFree;
+		if( pxBlock->pxNextFree == NULL )
+		{
+			ulSLBitmap[ iFL ] &= ~( 1UL << iSL );
+			if( ulSLBitmap[ iFL ] == 0UL )
+			{
+				ulFLBitmap &= ~( 1UL << iFL );
+			}
+		}
+	}
+
+	pxBlock->xSize &= ~heapBLOCK_FREE;
+}
@@ -649,10 +649,15 @@ xTimeOutType xTimeOut;
 		/* Update the timeout state to see if it has expired yet. */
 		if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE )
 		{
+			/* On SMP a task on another core could receive from the queue
+			between the check and this task joining the event list, and find
+			no one to wake.  The kernel lock keeps the two together. */
+			taskSMP_ENTER_CRITICAL();
 			if( prvIsQueueFull( pxQueue ) != pdFALSE )
 			{
 				traceBLOCKING_ON_QUEUE_SEND( pxQueue );
 				vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToSend ), xTicksToWait );
+				taskSMP_EXIT_CRITICAL();
 
 				/* Unlocking the queue means queue events can effect the
 				event list.  It is possible	that interrupts occurring now
@@ -673,6 +678,8 @@ xTimeOutType xTimeOut;
 			}
 			else
 			{
+				taskSMP_EXIT_CRITICAL();
+
 				/* Try again. */
 				prvUnlockQueue( pxQueue );
 				( void ) xTaskResumeAll();
@@ -1065,6 +1072,9 @@ signed char *pcOriginalReadPosition;
 		/* Update the timeout state to see if it has expired yet. */
 		if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE )
 		{
+			/* As when sending, on SMP a send from another core must not
+			come between the check and joining the event list. */
+			taskSMP_ENTER_CRITICAL();
 			if( prvIsQueueEmpty( pxQueue ) != pdFALSE )
 			{
 				traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue );
@@ -1083,6 +1093,7 @@ signed char *pcOriginalReadPosition;
 				#endif
 
 				vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToReceive ), xTicksToWait );
+				taskSMP_EXIT_CRITICAL();
 				prvUnlockQueue( pxQueue );
 				if( xTaskResumeAll() == pdFALSE )
 				{
@@ -1091,6 +1102,8 @@ signed char *pcOriginalReadPosition;
 			}
 			else
 			{
+				taskSMP_EXIT_CRITICAL();
+
 				/* Try again. */
 				prvUnlockQueue( pxQueue );
 				( void ) xTaskResumeAll();
@@ -1670,11 +1683,13 @@ signed portBASE_TYPE xReturn;
 		the queue is locked, and the calling task blocks on the queue, then the
 		calling task will be immediately unblocked when the queue is unlocked. */
 		prvLockQueue( pxQueue );
+		taskSMP_ENTER_CRITICAL();
 		if( pxQueue->uxMessagesWaiting == ( unsigned portBASE_TYPE ) 0U )
 		{
 			/* There is nothing in the queue, block for the specified period. */
 			vTaskPlaceOnEventListRestricted( &( pxQueue->xTasksWaitingToReceive ), xTicksToWait );
 		}
+		taskSMP_EXIT_CRITICAL();
 		prvUnlockQueue( pxQueue );
 	}
 
@@ -68,6 +68,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stddef.h>
 
 /* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
 all the API functions to use the MPU wrappers.  That should only be done when
@@ -79,6 +80,10 @@ task.h is included from an application file. */
 #include "timers.h"
 #include "StackMacros.h"
 
+#if ( configUSE_TIMING_WHEEL == 1 )
+#include "wheel.h"
+#endif
+
 #if ( configBLUETHUNDER == 1 )
 #include <bluethunder.h>
 
@@ -95,6 +100,13 @@ BT_TRACE_EVENT *pTraceEventMax 	= NULL;
  */
 #define tskIDLE_STACK_SIZE	configMINIMAL_STACK_SIZE
 
+/*
+ * Values that can be assigned to the ucNotifyState member of the TCB.
+ */
+#define taskNOT_WAITING_NOTIFICATION	( ( unsigned char ) 0 )
+#define taskWAITING_NOTIFICATION		( ( unsigned char ) 1 )
+#define taskNOTIFICATION_RECEIVED		( ( unsigned char ) 2 )
+
 /*
  * Task control block.  A task control block (TCB) is allocated to each task,
  * and stores the context of the task.
@@ -107,6 +119,10 @@ typedef struct tskTaskControlBlock
 		xMPU_SETTINGS xMPUSettings;				/*< The MPU settings are defined as part of the port layer.  THIS MUST BE THE SECOND MEMBER OF THE STRUCT. */
 	#endif
 
+	#if ( portUSING_FPU_CONTEXT == 1 )
+		xFPU_CONTEXT xFPUContext;				/*< The saved VFP registers, defined as part of the port layer.  The port finds them through ulTaskFPUContextOffset. */
+	#endif
+
 	xListItem				xGenericListItem;	/*< List item used to place the TCB in ready and blocked queues. */
 	xListItem				xEventListItem;		/*< List item used to place the TCB in event lists. */
 	unsigned portBASE_TYPE	uxPriority;			/*< The priority of the task where 0 is the lowest priority. */
@@ -138,6 +154,16 @@ typedef struct tskTaskControlBlock
 		unsigned long ulRunTimeCounter;		/*< Used for calculating how much CPU time each task is utilising. */
 	#endif
 
+	#if ( configNUM_CORES > 1 )
+		unsigned portBASE_TYPE uxCoreAffinityMask;	/*< Bit n is set if the task may run on core n. */
+		volatile portBASE_TYPE xRunningOnCore;		/*< The core executing the task, or tskNOT_RUNNING.  A task stays marked until its context has been saved, so no other core can pick it up early. */
+	#endif
+
+	#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+		volatile unsigned long ulNotifiedValue;		/*< The value sent to the task by xTaskGenericNotify() and friends. */
+		volatile unsigned char ucNotifyState;		/*< One of the taskNOT_WAITING_NOTIFICATION group of values below. */
+	#endif
+
     #if (configBLUETHUNDER == 1)
 	BT_TRACE_EVENT *pTraceEvent;
 	BT_TRACE_EVENT *pTraceEventMin;
@@ -156,15 +182,42 @@ typedef struct tskTaskControlBlock
 #endif
 
 /*lint -e956 */
-PRIVILEGED_DATA tskTCB * volatile pxCurrentTCB = NULL;
+#if ( configNUM_CORES > 1 )
+
+	/* Each core has its own current task.  The port keeps a copy of this
+	core's entry in a CPU register so the running task can find its own TCB
+	without racing against being moved to another core. */
+	PRIVILEGED_DATA tskTCB * volatile pxCurrentTCBs[ configNUM_CORES ] = { NULL };
+	#define pxCurrentTCB					( ( tskTCB * ) portGET_CURRENT_TCB() )
+	#define taskSET_CURRENT_TCB( pxTCB )	{ pxCurrentTCBs[ portGET_CORE_ID() ] = ( pxTCB ); portSET_CURRENT_TCB( pxTCB ); }
+
+	/* Value of xRunningOnCore for a task that is not executing. */
+	#define tskNOT_RUNNING					( ( portBASE_TYPE ) -1 )
+
+#else
+
+	PRIVILEGED_DATA tskTCB * volatile pxCurrentTCB = NULL;
+	#define taskSET_CURRENT_TCB( pxTCB )	pxCurrentTCB = ( pxTCB )
+
+#endif
 
 /* Lists for ready and blocked tasks. --------------------*/
 
 PRIVILEGED_DATA static xList pxReadyTasksLists[ configMAX_PRIORITIES ];	/*< Prioritised ready tasks. */
-PRIVILEGED_DATA static xList xDelayedTaskList1;							/*< Delayed tasks. */
-PRIVILEGED_DATA static xList xDelayedTaskList2;							/*< Delayed tasks (two lists are used - one for delays that have overflowed the current tick count. */
-PRIVILEGED_DATA static xList * volatile pxDelayedTaskList ;				/*< Points to the delayed task list currently being used. */
-PRIVILEGED_DATA static xList * volatile pxOverflowDelayedTaskList;		/*< Points to the delayed task list currently being used to hold tasks that have overflowed the current tick count. */
+
+#if ( configUSE_TIMING_WHEEL == 1 )
+
+	PRIVILEGED_DATA static xTimingWheel xDelayedTaskWheel;				/*< Delayed tasks, filed by wake time.  The wheel copes with the tick count overflowing itself. */
+
+#else
+
+	PRIVILEGED_DATA static xList xDelayedTaskList1;						/*< Delayed tasks. */
+	PRIVILEGED_DATA static xList xDelayedTaskList2;						/*< Delayed tasks (two lists are used - one for delays that have overflowed the current tick count. */
+	PRIVILEGED_DATA static xList * volatile pxDelayedTaskList ;			/*< Points to the delayed task list currently being used. */
+	PRIVILEGED_DATA static xList * volatile pxOverflowDelayedTaskList;	/*< Points to the delayed task list currently being used to hold tasks that have overflowed the current tick count. */
+
+#endif
+
 PRIVILEGED_DATA static xList xPendingReadyList;							/*< Tasks that have been readied while the scheduler was suspended.  They will be moved to the ready queue when the scheduler is resumed. */
 
 #if ( INCLUDE_vTaskDelete == 1 )
@@ -180,30 +233,51 @@ PRIVILEGED_DATA static xList xPendingReadyList;							/*< Tasks that have been r
 
 #endif
 
-#if ( INCLUDE_xTaskGetIdleTaskHandle == 1 )
+#if ( INCLUDE_xTaskGetIdleTaskHandle == 1 ) || ( configNUM_CORES > 1 )
 
 	PRIVILEGED_DATA static xTaskHandle xIdleTaskHandle = NULL;
 
 #endif
 
+#if ( configNUM_CORES > 1 )
+
+	PRIVILEGED_DATA static xTaskHandle xIdleTaskHandles[ configNUM_CORES ];	/*< One idle task is pinned to each core. */
+
+#endif
+
 /* File private variables. --------------------------------*/
 PRIVILEGED_DATA static volatile unsigned portBASE_TYPE uxCurrentNumberOfTasks 	= ( unsigned portBASE_TYPE ) 0U;
 PRIVILEGED_DATA static volatile portTickType xTickCount 						= ( portTickType ) 0U;
 PRIVILEGED_DATA static unsigned portBASE_TYPE uxTopUsedPriority	 				= tskIDLE_PRIORITY;
 PRIVILEGED_DATA static volatile unsigned portBASE_TYPE uxTopReadyPriority 		= tskIDLE_PRIORITY;
 PRIVILEGED_DATA static volatile signed portBASE_TYPE xSchedulerRunning 			= pdFALSE;
-PRIVILEGED_DATA static volatile unsigned portBASE_TYPE uxSchedulerSuspended	 	= ( unsigned portBASE_TYPE ) pdFALSE;
 PRIVILEGED_DATA static volatile unsigned portBASE_TYPE uxMissedTicks 			= ( unsigned portBASE_TYPE ) 0U;
-PRIVILEGED_DATA static volatile portBASE_TYPE xMissedYield 						= ( portBASE_TYPE ) pdFALSE;
+#if ( configNUM_CORES > 1 )
+
+	/* Each core suspends only its own scheduler, and keeps its own missed
+	yield.  A task only uses its core's entries with interrupts disabled or
+	with that core's scheduler suspended, so it cannot be moved to another
+	core in between. */
+	PRIVILEGED_DATA static volatile unsigned portBASE_TYPE uxSchedulerSuspendedOnCore[ configNUM_CORES ] = { 0U };
+	PRIVILEGED_DATA static volatile portBASE_TYPE xMissedYieldOnCore[ configNUM_CORES ] = { pdFALSE };
+	#define uxSchedulerSuspended			uxSchedulerSuspendedOnCore[ portGET_CORE_ID() ]
+	#define xMissedYield					xMissedYieldOnCore[ portGET_CORE_ID() ]
+
+#else
+
+	PRIVILEGED_DATA static volatile unsigned portBASE_TYPE uxSchedulerSuspended	 	= ( unsigned portBASE_TYPE ) pdFALSE;
+	PRIVILEGED_DATA static volatile portBASE_TYPE xMissedYield 						= ( portBASE_TYPE ) pdFALSE;
+
+#endif
 PRIVILEGED_DATA static volatile portBASE_TYPE xNumOfOverflows 					= ( portBASE_TYPE ) 0;
 PRIVILEGED_DATA static unsigned portBASE_TYPE uxTaskNumber 						= ( unsigned portBASE_TYPE ) 0U;
 PRIVILEGED_DATA static portTickType xNextTaskUnblockTime						= ( portTickType ) portMAX_DELAY;
 
 #if ( configGENERATE_RUN_TIME_STATS == 1 )
 
-	PRIVILEGED_DATA static char pcStatsString[ 50 ] ;
-	PRIVILEGED_DATA static unsigned long ulTaskSwitchedInTime = 0UL;	/*< Holds the value of a timer/counter the last time a task was switched in. */
+	PRIVILEGED_DATA static unsigned long ulTaskSwitchedInTime[ configNUM_CORES ] = { 0UL };	/*< Holds the value of a timer/counter the last time a task was switched in, per core. */
 	static void prvGenerateRunTimeStatsForTasksInList( const signed char *pcWriteBuffer, xList *pxList, unsigned long ulTotalRunTime ) PRIVILEGED_FUNCTION;
+	static void prvWriteRunTimeStatsLine( const signed char *pcWriteBuffer, const signed char *pcName, unsigned long ulRunTime, unsigned long ulTotalRunTime ) PRIVILEGED_FUNCTION;
 
 #endif
 
@@ -225,6 +299,60 @@ PRIVILEGED_DATA static portTickType xNextTaskUnblockTime						= ( portTickType )
 
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_PORT_OPTIMISED_TASK_SELECTION == 0 )
+
+	/* uxTopReadyPriority holds the priority of the highest priority ready
+	state task, or a priority above it, and is lowered lazily by
+	taskFIND_TOP_READY_PRIORITY(). */
+	#define taskRECORD_READY_PRIORITY( uxPriority )										\
+	{																					\
+		if( ( uxPriority ) > uxTopReadyPriority )										\
+		{																				\
+			uxTopReadyPriority = ( uxPriority );										\
+		}																				\
+	}
+
+	/* Find the highest priority queue that contains ready tasks. */
+	#define taskFIND_TOP_READY_PRIORITY( uxTopPriority )								\
+	{																					\
+		while( listLIST_IS_EMPTY( &( pxReadyTasksLists[ uxTopReadyPriority ] ) ) )		\
+		{																				\
+			configASSERT( uxTopReadyPriority );											\
+			--uxTopReadyPriority;														\
+		}																				\
+		( uxTopPriority ) = uxTopReadyPriority;											\
+	}
+
+	/* Nothing to do, the search above skips the empty lists. */
+	#define taskRESET_READY_PRIORITY( uxPriority )
+
+#else
+
+	/* uxTopReadyPriority holds a bitmap with bit n set while the ready list of
+	priority n is not empty, so the port can find the top priority in one
+	instruction. */
+	#define taskRECORD_READY_PRIORITY( uxPriority )	portRECORD_READY_PRIORITY( ( uxPriority ), uxTopReadyPriority )
+
+	#define taskFIND_TOP_READY_PRIORITY( uxTopPriority )								\
+	{																					\
+		configASSERT( uxTopReadyPriority );												\
+		portGET_HIGHEST_PRIORITY( ( uxTopPriority ), uxTopReadyPriority );				\
+	}
+
+	/* Called after a task has been removed from a list that may be the ready
+	list of uxPriority.  The list is checked, as the task may equally have been
+	in a delayed or suspended list. */
+	#define taskRESET_READY_PRIORITY( uxPriority )										\
+	{																					\
+		if( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ ( uxPriority ) ] ) ) == 0 )	\
+		{																				\
+			portRESET_READY_PRIORITY( ( uxPriority ), uxTopReadyPriority );				\
+		}																				\
+	}
+
+#endif /* configUSE_PORT_OPTIMISED_TASK_SELECTION */
+/*-----------------------------------------------------------*/
+
 /*
  * Place the task represented by pxTCB into the appropriate ready queue for
  * the task.  It is inserted at the end of the list.  One quirk of this is
@@ -234,13 +362,66 @@ PRIVILEGED_DATA static portTickType xNextTaskUnblockTime						= ( portTickType )
  */
 #define prvAddTaskToReadyQueue( pxTCB )																					\
 	traceMOVED_TASK_TO_READY_STATE( pxTCB )																				\
-	if( ( pxTCB )->uxPriority > uxTopReadyPriority )																	\
-	{																													\
-		uxTopReadyPriority = ( pxTCB )->uxPriority;																		\
-	}																													\
+	taskRECORD_READY_PRIORITY( ( pxTCB )->uxPriority );																	\
 	vListInsertEnd( ( xList * ) &( pxReadyTasksLists[ ( pxTCB )->uxPriority ] ), &( ( pxTCB )->xGenericListItem ) )
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_TIMING_WHEEL == 1 )
+
+/*
+ * Macro that sets xNextTaskUnblockTime from the delayed task wheel.  As with
+ * the delayed lists it is never before xTickCount, and is portMAX_DELAY while
+ * the next event is on the far side of a tick count overflow.  It is set again
+ * when the tick count overflows.
+ */
+#define prvResetNextTaskUnblockTime()													\
+{																						\
+	if( wheelIS_DUE( &xDelayedTaskWheel, xTickCount ) )									\
+	{																					\
+		xNextTaskUnblockTime = xTickCount;												\
+	}																					\
+	else if( wheelGET_NEXT_EVENT( &xDelayedTaskWheel ) < xTickCount )					\
+	{																					\
+		xNextTaskUnblockTime = portMAX_DELAY;											\
+	}																					\
+	else																				\
+	{																					\
+		xNextTaskUnblockTime = wheelGET_NEXT_EVENT( &xDelayedTaskWheel );				\
+	}																					\
+}
+
+/*
+ * Macro that asks the delayed task wheel for the tasks that require waking.
+ *
+ * The wheel keeps the tick at which it next needs attention, so on most ticks
+ * this is a single comparison.  The comparison is made relative to the wheel's
+ * own position, so it stays correct when the tick count overflows.
+ */
+#define prvCheckDelayedTasks()															\
+{																						\
+xListItem *pxExpired;																	\
+																						\
+	if( wheelIS_DUE( &xDelayedTaskWheel, xTickCount ) )									\
+	{																					\
+		while( ( pxExpired = pxWheelGetExpired( &xDelayedTaskWheel, xTickCount ) ) != NULL )	\
+		{																				\
+			/* The wheel has already removed the task from the Blocked state. */		\
+			pxTCB = ( tskTCB * ) listGET_LIST_ITEM_OWNER( pxExpired );					\
+																						\
+			/* Is the task waiting on an event also? */									\
+			if( pxTCB->xEventListItem.pvContainer != NULL )								\
+			{																			\
+				vListRemove( &( pxTCB->xEventListItem ) );								\
+			}																			\
+			prvAddTaskToReadyQueue( pxTCB );											\
+		}																				\
+																						\
+		prvResetNextTaskUnblockTime();													\
+	}																					\
+}
+
+#else
+
 /*
  * Macro that looks at the list of tasks that are currently delayed to see if
  * any require waking.
@@ -300,6 +481,20 @@ portTickType xItemValue;																\
 		}																				\
 	}																					\
 }
+
+
+#endif/*-----------------------------------------------------------*/
+
+/*
+ * Evaluates to pdTRUE if pxTCB, which has just been made ready, should
+ * preempt the calling task.  On SMP the task may instead belong on another
+ * core, which is then interrupted to reschedule.
+ */
+#if ( configNUM_CORES > 1 )
+	#define prvTaskShouldPreempt( pxTCB )	prvYieldCoreForTask( pxTCB )
+#else
+	#define prvTaskShouldPreempt( pxTCB )	( ( pxTCB )->uxPriority >= pxCurrentTCB->uxPriority )
+#endif
 /*-----------------------------------------------------------*/
 
 /*
@@ -367,6 +562,39 @@ static void prvCheckTasksWaitingTermination( void ) PRIVILEGED_FUNCTION;
  */
 static void prvAddCurrentTaskToDelayedList( portTickType xTimeToWake ) PRIVILEGED_FUNCTION;
 
+/*
+ * Body of xTaskGenericCreate(), with the set of cores the new task may run on.
+ */
+static signed portBASE_TYPE prvTaskGenericCreate( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, xTaskHandle *pxCreatedTask, portSTACK_TYPE *puxStackBuffer, const xMemoryRegion * const xRegions, unsigned portBASE_TYPE uxCoreAffinityMask ) PRIVILEGED_FUNCTION;
+
+/*
+ * Return the amount of time, in ticks, that will pass before the kernel will
+ * next move a task from the Blocked state to the Running state.  Returns 0 if
+ * a task other than the idle task can run.
+ *
+ * This conditional compilation should use inequality to 0, not equality to 1.
+ * This is to ensure portSUPPRESS_TICKS_AND_SLEEP() can be called when user
+ * defined low power mode implementations require configUSE_TICKLESS_IDLE to be
+ * set to a value other than 1.
+ */
+#if ( configUSE_TICKLESS_IDLE != 0 )
+
+	static portTickType prvGetExpectedIdleTime( void ) PRIVILEGED_FUNCTION;
+
+#endif
+
+/*
+ * Picks a core for a task that has just been made ready.  Returns pdTRUE if
+ * the calling core should yield to it, otherwise interrupts the core that is
+ * running the lowest priority task below it, if there is one.  Must be called
+ * with the kernel locked.
+ */
+#if ( configNUM_CORES > 1 )
+
+	static portBASE_TYPE prvYieldCoreForTask( const tskTCB * const pxTCB ) PRIVILEGED_FUNCTION;
+
+#endif
+
 /*
  * Allocates memory from the heap for a TCB and associated stack.  Checks the
  * allocation was successful.
@@ -386,6 +614,13 @@ static tskTCB *prvAllocateTCBAndStack( unsigned short usStackDepth, portSTACK_TY
 
 	static void prvListTaskWithinSingleList( const signed char *pcWriteBuffer, xList *pxList, signed char cStatus ) PRIVILEGED_FUNCTION;
 
+	/*
+	 * Fills an xTaskStatusType structure with information on each task that
+	 * is referenced from the pxList list (which may be a ready list, a delayed
+	 * list, a suspended list, etc.).  Called from uxTaskGetSystemState().
+	 */
+	static unsigned portBASE_TYPE prvListTasksWithinSingleList( xTaskStatusType *pxTaskStatusArray, xList *pxList, eTaskState eState ) PRIVILEGED_FUNCTION;
+
 #endif
 
 /*
@@ -399,6 +634,18 @@ static tskTCB *prvAllocateTCBAndStack( unsigned short usStackDepth, portSTACK_TY
 
 #endif
 
+/*
+ * Write a string, or an unsigned number in decimal, to pcBuffer and return a
+ * pointer to the terminating NULL.  Used by the debug listing functions in
+ * place of sprintf(), which would pull the C library's stdio into the image.
+ */
+#if ( ( configUSE_TRACE_FACILITY == 1 ) || ( configGENERATE_RUN_TIME_STATS == 1 ) )
+
+	static char *prvWriteString( char *pcBuffer, const char *pcString ) PRIVILEGED_FUNCTION;
+	static char *prvWriteDecimal( char *pcBuffer, unsigned long ulValue ) PRIVILEGED_FUNCTION;
+
+#endif
+
 
 /*lint +e956 */
 
@@ -409,8 +656,26 @@ static tskTCB *prvAllocateTCBAndStack( unsigned short usStackDepth, portSTACK_TY
  *----------------------------------------------------------*/
 __attribute__((no_instrument_function))
 signed portBASE_TYPE xTaskGenericCreate( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, xTaskHandle *pxCreatedTask, portSTACK_TYPE *puxStackBuffer, const xMemoryRegion * const xRegions )
+{
+	return prvTaskGenericCreate( pxTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pxCreatedTask, puxStackBuffer, xRegions, tskNO_AFFINITY );
+}
+/*-----------------------------------------------------------*/
+
+#if ( configNUM_CORES > 1 )
+__attribute__((no_instrument_function))
+	signed portBASE_TYPE xTaskGenericCreateAffinitySet( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, xTaskHandle *pxCreatedTask, portSTACK_TYPE *puxStackBuffer, const xMemoryRegion * const xRegions, unsigned portBASE_TYPE uxCoreAffinityMask )
+	{
+		configASSERT( ( uxCoreAffinityMask & tskNO_AFFINITY ) != 0U );
+		return prvTaskGenericCreate( pxTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pxCreatedTask, puxStackBuffer, xRegions, uxCoreAffinityMask );
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+__attribute__((no_instrument_function))
+static signed portBASE_TYPE prvTaskGenericCreate( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, xTaskHandle *pxCreatedTask, portSTACK_TYPE *puxStackBuffer, const xMemoryRegion * const xRegions, unsigned portBASE_TYPE uxCoreAffinityMask )
 {
 signed portBASE_TYPE xReturn;
+portBASE_TYPE xYieldRequired = pdFALSE;
 tskTCB * pxNewTCB;
 
 	configASSERT( pxTaskCode );
@@ -467,6 +732,16 @@ tskTCB * pxNewTCB;
 		/* Setup the newly allocated TCB with the initial state of the task. */
 		prvInitialiseTCBVariables( pxNewTCB, pcName, uxPriority, xRegions, usStackDepth );
 
+		#if ( configNUM_CORES > 1 )
+		{
+			pxNewTCB->uxCoreAffinityMask = uxCoreAffinityMask;
+		}
+		#else
+		{
+			( void ) uxCoreAffinityMask;
+		}
+		#endif
+
 		/* Initialize the TCB stack to look as if the task was already running,
 		but had been interrupted by the scheduler.  The return address is set
 		to the start of the task function. Once the stack has been initialised
@@ -501,7 +776,7 @@ tskTCB * pxNewTCB;
 			{
 				/* There are no other tasks, or all the other tasks are in
 				the suspended state - make this the current task. */
-				pxCurrentTCB =  pxNewTCB;
+				taskSET_CURRENT_TCB( pxNewTCB );
 
 				if( uxCurrentNumberOfTasks == ( unsigned portBASE_TYPE ) 1 )
 				{
@@ -520,7 +795,7 @@ tskTCB * pxNewTCB;
 				{
 					if( pxCurrentTCB->uxPriority <= uxPriority )
 					{
-						pxCurrentTCB = pxNewTCB;
+						taskSET_CURRENT_TCB( pxNewTCB );
 					}
 				}
 			}
@@ -542,6 +817,21 @@ tskTCB * pxNewTCB;
 
 			prvAddTaskToReadyQueue( pxNewTCB );
 
+			if( xSchedulerRunning != pdFALSE )
+			{
+				/* If the created task is of a higher priority than the current
+				task then it should run now. */
+				#if ( configNUM_CORES > 1 )
+				{
+					xYieldRequired = prvYieldCoreForTask( pxNewTCB );
+				}
+				#else
+				{
+					xYieldRequired = ( pxCurrentTCB->uxPriority < uxPriority );
+				}
+				#endif
+			}
+
 			xReturn = pdPASS;
 			portSETUP_TCB( pxNewTCB );
 			traceTASK_CREATE( pxNewTCB );
@@ -554,17 +844,9 @@ tskTCB * pxNewTCB;
 		traceTASK_CREATE_FAILED();
 	}
 
-	if( xReturn == pdPASS )
+	if( xYieldRequired != pdFALSE )
 	{
-		if( xSchedulerRunning != pdFALSE )
-		{
-			/* If the created task is of a higher priority than the current task
-			then it should run now. */
-			if( pxCurrentTCB->uxPriority < uxPriority )
-			{
-				portYIELD_WITHIN_API();
-			}
-		}
+		portYIELD_WITHIN_API();
 	}
 
 	return xReturn;
@@ -593,7 +875,10 @@ __attribute__((no_instrument_function))
 			This will stop the task from be scheduled.  The idle task will check
 			the termination list and free up any memory allocated by the
 			scheduler for the TCB and stack. */
-			vListRemove( &( pxTCB->xGenericListItem ) );
+			if( vListRemove( &( pxTCB->xGenericListItem ) ) == ( unsigned portBASE_TYPE ) 0 )
+			{
+				taskRESET_READY_PRIORITY( pxTCB->uxPriority );
+			}
 
 			/* Is the task waiting on an event also? */
 			if( pxTCB->xEventListItem.pvContainer != NULL )
@@ -612,6 +897,17 @@ __attribute__((no_instrument_function))
 			can detect that the task lists need re-generating. */
 			uxTaskNumber++;
 
+			#if ( configNUM_CORES > 1 )
+			{
+				/* The task may be executing on another core right now.  Make
+				that core switch away from it. */
+				if( ( pxTCB->xRunningOnCore != tskNOT_RUNNING ) && ( pxTCB->xRunningOnCore != portGET_CORE_ID() ) )
+				{
+					portYIELD_CORE( pxTCB->xRunningOnCore );
+				}
+			}
+			#endif
+
 			traceTASK_DELETE( pxTCB );
 		}
 		taskEXIT_CRITICAL();
@@ -648,6 +944,7 @@ __attribute__((no_instrument_function))
 		configASSERT( ( xTimeIncrement > 0U ) );
 
 		vTaskSuspendAll();
+		taskSMP_ENTER_CRITICAL();
 		{
 			/* Generate the tick time at which the task wants to wake. */
 			xTimeToWake = *pxPreviousWakeTime + xTimeIncrement;
@@ -685,10 +982,14 @@ __attribute__((no_instrument_function))
 				/* We must remove ourselves from the ready list before adding
 				ourselves to the blocked list as the same list item is used for
 				both lists. */
-				vListRemove( ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+				if( vListRemove( ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) ) == ( unsigned portBASE_TYPE ) 0 )
+				{
+					taskRESET_READY_PRIORITY( pxCurrentTCB->uxPriority );
+				}
 				prvAddCurrentTaskToDelayedList( xTimeToWake );
 			}
 		}
+		taskSMP_EXIT_CRITICAL();
 		xAlreadyYielded = xTaskResumeAll();
 
 		/* Force a reschedule if xTaskResumeAll has not already done so, we may
@@ -713,6 +1014,7 @@ __attribute__((no_instrument_function))
 		if( xTicksToDelay > ( portTickType ) 0U )
 		{
 			vTaskSuspendAll();
+			taskSMP_ENTER_CRITICAL();
 			{
 				traceTASK_DELAY();
 
@@ -731,9 +1033,13 @@ __attribute__((no_instrument_function))
 				/* We must remove ourselves from the ready list before adding
 				ourselves to the blocked list as the same list item is used for
 				both lists. */
-				vListRemove( ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+				if( vListRemove( ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) ) == ( unsigned portBASE_TYPE ) 0 )
+				{
+					taskRESET_READY_PRIORITY( pxCurrentTCB->uxPriority );
+				}
 				prvAddCurrentTaskToDelayedList( xTimeToWake );
 			}
+			taskSMP_EXIT_CRITICAL();
 			xAlreadyYielded = xTaskResumeAll();
 		}
 
@@ -862,7 +1168,10 @@ __attribute__((no_instrument_function))
 					/* The task is currently in its ready list - remove before adding
 					it to it's new ready list.  As we are in a critical section we
 					can do this even if the scheduler is suspended. */
-					vListRemove( &( pxTCB->xGenericListItem ) );
+					if( vListRemove( &( pxTCB->xGenericListItem ) ) == ( unsigned portBASE_TYPE ) 0 )
+					{
+						taskRESET_READY_PRIORITY( uxCurrentPriority );
+					}
 					prvAddTaskToReadyQueue( pxTCB );
 				}
 
@@ -899,7 +1208,10 @@ __attribute__((no_instrument_function))
 			traceTASK_SUSPEND( pxTCB );
 
 			/* Remove task from the ready/delayed list and place in the	suspended list. */
-			vListRemove( &( pxTCB->xGenericListItem ) );
+			if( vListRemove( &( pxTCB->xGenericListItem ) ) == ( unsigned portBASE_TYPE ) 0 )
+			{
+				taskRESET_READY_PRIORITY( pxTCB->uxPriority );
+			}
 
 			/* Is the task waiting on an event also? */
 			if( pxTCB->xEventListItem.pvContainer != NULL )
@@ -908,6 +1220,17 @@ __attribute__((no_instrument_function))
 			}
 
 			vListInsertEnd( ( xList * ) &xSuspendedTaskList, &( pxTCB->xGenericListItem ) );
+
+			#if ( configNUM_CORES > 1 )
+			{
+				/* The task may be executing on another core right now.  Make
+				that core switch away from it. */
+				if( ( pxTCB->xRunningOnCore != tskNOT_RUNNING ) && ( pxTCB->xRunningOnCore != portGET_CORE_ID() ) )
+				{
+					portYIELD_CORE( pxTCB->xRunningOnCore );
+				}
+			}
+			#endif
 		}
 		taskEXIT_CRITICAL();
 
@@ -929,7 +1252,7 @@ __attribute__((no_instrument_function))
 					NULL so when the next task is created pxCurrentTCB will
 					be set to point to it no matter what its relative priority
 					is. */
-					pxCurrentTCB = NULL;
+					taskSET_CURRENT_TCB( NULL );
 				}
 				else
 				{
@@ -1005,7 +1328,7 @@ __attribute__((no_instrument_function))
 					prvAddTaskToReadyQueue( pxTCB );
 
 					/* We may have just resumed a higher priority task. */
-					if( pxTCB->uxPriority >= pxCurrentTCB->uxPriority )
+					if( prvTaskShouldPreempt( pxTCB ) != pdFALSE )
 					{
 						/* This yield may not cause the task just resumed to run, but
 						will leave the lists in the correct state for the next yield. */
@@ -1041,7 +1364,7 @@ __attribute__((no_instrument_function))
 
 				if( uxSchedulerSuspended == ( unsigned portBASE_TYPE ) pdFALSE )
 				{
-					xYieldRequired = ( pxTCB->uxPriority >= pxCurrentTCB->uxPriority );
+					xYieldRequired = prvTaskShouldPreempt( pxTCB );
 					vListRemove(  &( pxTCB->xGenericListItem ) );
 					prvAddTaskToReadyQueue( pxTCB );
 				}
@@ -1074,7 +1397,28 @@ void vTaskStartScheduler( void )
 portBASE_TYPE xReturn;
 
 	/* Add the idle task at the lowest priority. */
-	#if ( INCLUDE_xTaskGetIdleTaskHandle == 1 )
+	#if ( configNUM_CORES > 1 )
+	{
+	portBASE_TYPE xCoreID;
+
+		/* Every core gets an idle task of its own, pinned to it, so there is
+		always something a core is allowed to run. */
+		xReturn = pdPASS;
+		for( xCoreID = 0; ( xCoreID < configNUM_CORES ) && ( xReturn == pdPASS ); xCoreID++ )
+		{
+			xReturn = xTaskGenericCreateAffinitySet( prvIdleTask, ( signed char * ) "IDLE", tskIDLE_STACK_SIZE, ( void * ) NULL, ( tskIDLE_PRIORITY | portPRIVILEGE_BIT ), &( xIdleTaskHandles[ xCoreID ] ), NULL, NULL, ( 1UL << xCoreID ) );
+		}
+
+		/* The secondary cores start out on their own idle task.  Core 0 keeps
+		whatever task was last chosen as the current task above. */
+		for( xCoreID = 1; ( xCoreID < configNUM_CORES ) && ( xReturn == pdPASS ); xCoreID++ )
+		{
+			pxCurrentTCBs[ xCoreID ] = ( tskTCB * ) xIdleTaskHandles[ xCoreID ];
+		}
+
+		xIdleTaskHandle = xIdleTaskHandles[ 0 ];
+	}
+	#elif ( INCLUDE_xTaskGetIdleTaskHandle == 1 )
 	{
 		/* Create the idle task, storing its handle in xIdleTaskHandle so it can
 		be returned by the xTaskGetIdleTaskHandle() function. */
@@ -1147,9 +1491,12 @@ void vTaskEndScheduler( void )
 __attribute__((no_instrument_function))
 void vTaskSuspendAll( void )
 {
-	/* A critical section is not required as the variable is of type
-	portBASE_TYPE. */
+	/* A critical section is not required on a single core as the variable is
+	of type portBASE_TYPE.  On SMP the task must not move cores between
+	finding its core's count and incrementing it. */
+	taskSMP_ENTER_CRITICAL();
 	++uxSchedulerSuspended;
+	taskSMP_EXIT_CRITICAL();
 }
 /*----------------------------------------------------------*/
 __attribute__((no_instrument_function))
@@ -1188,7 +1535,7 @@ signed portBASE_TYPE xAlreadyYielded = pdFALSE;
 
 					/* If we have moved a task that has a priority higher than
 					the current task then we should yield. */
-					if( pxTCB->uxPriority >= pxCurrentTCB->uxPriority )
+					if( prvTaskShouldPreempt( pxTCB ) != pdFALSE )
 					{
 						xYieldRequired = pdTRUE;
 					}
@@ -1301,6 +1648,7 @@ __attribute__((no_instrument_function))
 		It leaves interrupts disabled for a LONG time. */
 
 		vTaskSuspendAll();
+		taskSMP_ENTER_CRITICAL();
 		{
 			/* Run through all the lists that could potentially contain a TCB and
 			report the task name, state and stack high water mark. */
@@ -1320,15 +1668,31 @@ __attribute__((no_instrument_function))
 				}
 			}while( uxQueue > ( unsigned short ) tskIDLE_PRIORITY );
 
-			if( listLIST_IS_EMPTY( pxDelayedTaskList ) == pdFALSE )
+			#if ( configUSE_TIMING_WHEEL == 1 )
 			{
-				prvListTaskWithinSingleList( pcWriteBuffer, ( xList * ) pxDelayedTaskList, tskBLOCKED_CHAR );
-			}
+			unsigned portBASE_TYPE uxList;
 
-			if( listLIST_IS_EMPTY( pxOverflowDelayedTaskList ) == pdFALSE )
+				for( uxList = 0; uxList < wheelNUM_LISTS; uxList++ )
+				{
+					if( listLIST_IS_EMPTY( &( xDelayedTaskWheel.xLists[ uxList ] ) ) == pdFALSE )
+					{
+						prvListTaskWithinSingleList( pcWriteBuffer, &( xDelayedTaskWheel.xLists[ uxList ] ), tskBLOCKED_CHAR );
+					}
+				}
+			}
+			#else
 			{
-				prvListTaskWithinSingleList( pcWriteBuffer, ( xList * ) pxOverflowDelayedTaskList, tskBLOCKED_CHAR );
+				if( listLIST_IS_EMPTY( pxDelayedTaskList ) == pdFALSE )
+				{
+					prvListTaskWithinSingleList( pcWriteBuffer, ( xList * ) pxDelayedTaskList, tskBLOCKED_CHAR );
+				}
+
+				if( listLIST_IS_EMPTY( pxOverflowDelayedTaskList ) == pdFALSE )
+				{
+					prvListTaskWithinSingleList( pcWriteBuffer, ( xList * ) pxOverflowDelayedTaskList, tskBLOCKED_CHAR );
+				}
 			}
+			#endif
 
 			#if( INCLUDE_vTaskDelete == 1 )
 			{
@@ -1348,9 +1712,95 @@ __attribute__((no_instrument_function))
 			}
 			#endif
 		}
+		taskSMP_EXIT_CRITICAL();
 		xTaskResumeAll();
 	}
 
+/*----------------------------------------------------------*/
+
+#if ( configUSE_TRACE_FACILITY == 1 )
+__attribute__((no_instrument_function))
+	unsigned portBASE_TYPE uxTaskGetSystemState( xTaskStatusType * const pxTaskStatusArray, const unsigned portBASE_TYPE uxArraySize, unsigned long * const pulTotalRunTime )
+	{
+	unsigned portBASE_TYPE uxTask = 0, uxQueue = configMAX_PRIORITIES;
+
+		vTaskSuspendAll();
+		taskSMP_ENTER_CRITICAL();
+		{
+			/* Is there a space in the array for each task in the system? */
+			if( uxArraySize >= uxCurrentNumberOfTasks )
+			{
+				/* Fill in an xTaskStatusType structure with information on
+				each task in the Ready state. */
+				do
+				{
+					uxQueue--;
+					uxTask += prvListTasksWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), ( xList * ) &( pxReadyTasksLists[ uxQueue ] ), eReady );
+
+				} while( uxQueue > ( unsigned portBASE_TYPE ) tskIDLE_PRIORITY );
+
+				/* Fill in an xTaskStatusType structure with information on
+				each task in the Blocked state. */
+				#if ( configUSE_TIMING_WHEEL == 1 )
+				{
+				unsigned portBASE_TYPE uxList;
+
+					for( uxList = 0; uxList < wheelNUM_LISTS; uxList++ )
+					{
+						uxTask += prvListTasksWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), &( xDelayedTaskWheel.xLists[ uxList ] ), eBlocked );
+					}
+				}
+				#else
+				{
+					uxTask += prvListTasksWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), ( xList * ) pxDelayedTaskList, eBlocked );
+					uxTask += prvListTasksWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), ( xList * ) pxOverflowDelayedTaskList, eBlocked );
+				}
+				#endif
+
+				#if ( INCLUDE_vTaskDelete == 1 )
+				{
+					/* Fill in an xTaskStatusType structure with information on
+					each task that has been deleted but not yet cleaned up. */
+					uxTask += prvListTasksWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), &xTasksWaitingTermination, eDeleted );
+				}
+				#endif
+
+				#if ( INCLUDE_vTaskSuspend == 1 )
+				{
+					/* Fill in an xTaskStatusType structure with information on
+					each task in the Suspended state. */
+					uxTask += prvListTasksWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), &xSuspendedTaskList, eSuspended );
+				}
+				#endif
+
+				#if ( configGENERATE_RUN_TIME_STATS == 1 )
+				{
+					if( pulTotalRunTime != NULL )
+					{
+						#ifdef portALT_GET_RUN_TIME_COUNTER_VALUE
+							portALT_GET_RUN_TIME_COUNTER_VALUE( ( *pulTotalRunTime ) );
+						#else
+							*pulTotalRunTime = portGET_RUN_TIME_TOTAL_VALUE();
+						#endif
+					}
+				}
+				#else
+				{
+					if( pulTotalRunTime != NULL )
+					{
+						*pulTotalRunTime = 0;
+					}
+				}
+				#endif
+			}
+		}
+		taskSMP_EXIT_CRITICAL();
+		( void ) xTaskResumeAll();
+
+		return uxTask;
+	}
+
+#endif
 #endif
 /*----------------------------------------------------------*/
 
@@ -1359,17 +1809,18 @@ __attribute__((no_instrument_function))
 	void vTaskGetRunTimeStats( signed char *pcWriteBuffer )
 	{
 	unsigned portBASE_TYPE uxQueue;
-	unsigned long ulTotalRunTime;
+	unsigned long ulTotalRunTime, ulInterruptRunTime;
 
 		/* This is a VERY costly function that should be used for debug only.
 		It leaves interrupts disabled for a LONG time. */
 
 		vTaskSuspendAll();
+		taskSMP_ENTER_CRITICAL();
 		{
 			#ifdef portALT_GET_RUN_TIME_COUNTER_VALUE
 				portALT_GET_RUN_TIME_COUNTER_VALUE( ulTotalRunTime );
 			#else
-				ulTotalRunTime = portGET_RUN_TIME_COUNTER_VALUE();
+				ulTotalRunTime = portGET_RUN_TIME_TOTAL_VALUE();
 			#endif
 
 			/* Divide ulTotalRunTime by 100 to make the percentage caluclations
@@ -1395,17 +1846,33 @@ __attribute__((no_instrument_function))
 				}
 			}while( uxQueue > ( unsigned short ) tskIDLE_PRIORITY );
 
-			if( listLIST_IS_EMPTY( pxDelayedTaskList ) == pdFALSE )
-			{
-				prvGenerateRunTimeStatsForTasksInList( pcWriteBuffer, ( xList * ) pxDelayedTaskList, ulTotalRunTime );
-			}
-
-			if( listLIST_IS_EMPTY( pxOverflowDelayedTaskList ) == pdFALSE )
+			#if ( configUSE_TIMING_WHEEL == 1 )
 			{
-				prvGenerateRunTimeStatsForTasksInList( pcWriteBuffer, ( xList * ) pxOverflowDelayedTaskList, ulTotalRunTime );
-			}
+			unsigned portBASE_TYPE uxList;
 
-			#if ( INCLUDE_vTaskDelete == 1 )
+				for( uxList = 0; uxList < wheelNUM_LISTS; uxList++ )
+				{
+					if( listLIST_IS_EMPTY( &( xDelayedTaskWheel.xLists[ uxList ] ) ) == pdFALSE )
+					{
+						prvGenerateRunTimeStatsForTasksInList( pcWriteBuffer, &( xDelayedTaskWheel.xLists[ uxList ] ), ulTotalRunTime );
+					}
+				}
+			}
+			#else
+			{
+				if( listLIST_IS_EMPTY( pxDelayedTaskList ) == pdFALSE )
+				{
+					prvGenerateRunTimeStatsForTasksInList( pcWriteBuffer, ( xList * ) pxDelayedTaskList, ulTotalRunTime );
+				}
+
+				if( listLIST_IS_EMPTY( pxOverflowDelayedTaskList ) == pdFALSE )
+				{
+					prvGenerateRunTimeStatsForTasksInList( pcWriteBuffer, ( xList * ) pxOverflowDelayedTaskList, ulTotalRunTime );
+				}
+			}
+			#endif
+
+			#if ( INCLUDE_vTaskDelete == 1 )
 			{
 				if( listLIST_IS_EMPTY( &xTasksWaitingTermination ) == pdFALSE )
 				{
@@ -1422,13 +1889,31 @@ __attribute__((no_instrument_function))
 				}
 			}
 			#endif
+
+			/* Time the port kept out of the tasks' counters. */
+			ulInterruptRunTime = portGET_INTERRUPT_RUN_TIME_COUNTER_VALUE();
+			if( ulInterruptRunTime > 0UL )
+			{
+				prvWriteRunTimeStatsLine( pcWriteBuffer, ( const signed char * ) "ISR", ulInterruptRunTime, ulTotalRunTime );
+			}
 		}
+		taskSMP_EXIT_CRITICAL();
 		xTaskResumeAll();
 	}
 
 #endif
 /*----------------------------------------------------------*/
 
+#if ( configGENERATE_RUN_TIME_STATS == 1 )
+__attribute__((no_instrument_function))
+	unsigned long ulTaskGetInterruptRunTime( void )
+	{
+		return portGET_INTERRUPT_RUN_TIME_COUNTER_VALUE();
+	}
+
+#endif
+/*----------------------------------------------------------*/
+
 #if ( INCLUDE_xTaskGetIdleTaskHandle == 1 )
 __attribute__((no_instrument_function))
 	xTaskHandle xTaskGetIdleTaskHandle( void )
@@ -1456,39 +1941,54 @@ tskTCB * pxTCB;
 	if( uxSchedulerSuspended == ( unsigned portBASE_TYPE ) pdFALSE )
 	{
 		++xTickCount;
-		if( xTickCount == ( portTickType ) 0U )
+		#if ( configUSE_TIMING_WHEEL == 1 )
 		{
-			xList *pxTemp;
-
-			/* Tick count has overflowed so we need to swap the delay lists.
-			If there are any items in pxDelayedTaskList here then there is
-			an error! */
-			configASSERT( ( listLIST_IS_EMPTY( pxDelayedTaskList ) ) );
-
-			pxTemp = pxDelayedTaskList;
-			pxDelayedTaskList = pxOverflowDelayedTaskList;
-			pxOverflowDelayedTaskList = pxTemp;
-			xNumOfOverflows++;
-
-			if( listLIST_IS_EMPTY( pxDelayedTaskList ) != pdFALSE )
+			/* The wheel compares times relative to its own position, so
+			there are no lists to swap when the tick count overflows.  Only
+			an event after the overflow needs bringing into range. */
+			if( xTickCount == ( portTickType ) 0U )
 			{
-				/* The new current delayed list is empty.  Set
-				xNextTaskUnblockTime to the maximum possible value so it is
-				extremely unlikely that the
-				if( xTickCount >= xNextTaskUnblockTime ) test will pass until
-				there is an item in the delayed list. */
-				xNextTaskUnblockTime = portMAX_DELAY;
+				xNumOfOverflows++;
+				prvResetNextTaskUnblockTime();
 			}
-			else
+		}
+		#else
+		{
+			if( xTickCount == ( portTickType ) 0U )
 			{
-				/* The new current delayed list is not empty, get the value of
-				the item at the head of the delayed list.  This is the time at
-				which the task at the head of the delayed list should be removed
-				from the Blocked state. */
-				pxTCB = ( tskTCB * ) listGET_OWNER_OF_HEAD_ENTRY( pxDelayedTaskList );
-				xNextTaskUnblockTime = listGET_LIST_ITEM_VALUE( &( pxTCB->xGenericListItem ) );
+				xList *pxTemp;
+
+				/* Tick count has overflowed so we need to swap the delay lists.
+				If there are any items in pxDelayedTaskList here then there is
+				an error! */
+				configASSERT( ( listLIST_IS_EMPTY( pxDelayedTaskList ) ) );
+
+				pxTemp = pxDelayedTaskList;
+				pxDelayedTaskList = pxOverflowDelayedTaskList;
+				pxOverflowDelayedTaskList = pxTemp;
+				xNumOfOverflows++;
+
+				if( listLIST_IS_EMPTY( pxDelayedTaskList ) != pdFALSE )
+				{
+					/* The new current delayed list is empty.  Set
+					xNextTaskUnblockTime to the maximum possible value so it is
+					extremely unlikely that the
+					if( xTickCount >= xNextTaskUnblockTime ) test will pass until
+					there is an item in the delayed list. */
+					xNextTaskUnblockTime = portMAX_DELAY;
+				}
+				else
+				{
+					/* The new current delayed list is not empty, get the value of
+					the item at the head of the delayed list.  This is the time at
+					which the task at the head of the delayed list should be removed
+					from the Blocked state. */
+					pxTCB = ( tskTCB * ) listGET_OWNER_OF_HEAD_ENTRY( pxDelayedTaskList );
+					xNextTaskUnblockTime = listGET_LIST_ITEM_VALUE( &( pxTCB->xGenericListItem ) );
+				}
 			}
 		}
+		#endif
 
 		/* See if this tick has made a timeout expire. */
 		prvCheckDelayedTasks();
@@ -1521,6 +2021,20 @@ tskTCB * pxTCB;
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_TICKLESS_IDLE != 0 )
+__attribute__((no_instrument_function))
+	void vTaskStepTick( portTickType xTicksToJump )
+	{
+		/* Correct the tick count value after a period during which the tick
+		was suppressed.  Note this does *not* call the tick hook function for
+		each stepped tick. */
+		configASSERT( ( xTickCount + xTicksToJump ) <= xNextTaskUnblockTime );
+		xTickCount += xTicksToJump;
+	}
+
+#endif /* configUSE_TICKLESS_IDLE */
+/*-----------------------------------------------------------*/
+
 #if ( configUSE_APPLICATION_TASK_TAG == 1 )
 __attribute__((no_instrument_function))
 	void vTaskSetApplicationTaskTag( xTaskHandle xTask, pdTASK_HOOK_CODE pxHookFunction )
@@ -1610,6 +2124,8 @@ __attribute__((no_instrument_function))
 __attribute__((no_instrument_function))
 void vTaskSwitchContext( void )
 {
+unsigned portBASE_TYPE uxTopPriority;
+
 	if( uxSchedulerSuspended != ( unsigned portBASE_TYPE ) pdFALSE )
 	{
 		/* The scheduler is currently suspended - do not allow a context
@@ -1635,8 +2151,8 @@ void vTaskSwitchContext( void )
 				ulTaskSwitchedInTime.  Note that there is no overflow protection here
 				so count values are only valid until the timer overflows.  Generally
 				this will be about 1 hour assuming a 1uS timer increment. */
-				pxCurrentTCB->ulRunTimeCounter += ( ulTempCounter - ulTaskSwitchedInTime );
-				ulTaskSwitchedInTime = ulTempCounter;
+				pxCurrentTCB->ulRunTimeCounter += ( ulTempCounter - ulTaskSwitchedInTime[ portGET_CORE_ID() ] );
+				ulTaskSwitchedInTime[ portGET_CORE_ID() ] = ulTempCounter;
 		}
 		#endif
 
@@ -1644,11 +2160,7 @@ void vTaskSwitchContext( void )
 		taskSECOND_CHECK_FOR_STACK_OVERFLOW();
 
 		/* Find the highest priority queue that contains ready tasks. */
-		while( listLIST_IS_EMPTY( &( pxReadyTasksLists[ uxTopReadyPriority ] ) ) )
-		{
-			configASSERT( uxTopReadyPriority );
-			--uxTopReadyPriority;
-		}
+		taskFIND_TOP_READY_PRIORITY( uxTopPriority );
 
 		/* listGET_OWNER_OF_NEXT_ENTRY walks through the list, so the tasks of the
 		same priority get an equal share of the processor time. */
@@ -1657,7 +2169,51 @@ void vTaskSwitchContext( void )
 		pxCurrentTCB->pTraceEvent = pTraceEvent;	// Save Trace event pointer state to TCB.
 #endif
 
-		listGET_OWNER_OF_NEXT_ENTRY( pxCurrentTCB, &( pxReadyTasksLists[ uxTopReadyPriority ] ) );
+		#if ( configNUM_CORES > 1 )
+		{
+		portBASE_TYPE xCoreID = portGET_CORE_ID();
+		unsigned portBASE_TYPE uxPriority, uxTasksToCheck;
+		tskTCB *pxTCB, *pxNextTCB = NULL;
+		xList *pxReadyList;
+
+			/* The outgoing task may now be picked up by another core.  It is
+			still marked if it has been readied again by another core in the
+			meantime, in which case the mark is cleared here, not there. */
+			if( pxCurrentTCB->xRunningOnCore == xCoreID )
+			{
+				pxCurrentTCB->xRunningOnCore = tskNOT_RUNNING;
+			}
+
+			/* Take the highest priority ready task that is not running on
+			another core and is allowed on this one.  Each ready list is
+			rotated as it is searched so equal priority tasks still share the
+			cores.  This core's idle task always qualifies, so the search ends
+			at the idle priority at the latest. */
+			for( uxPriority = uxTopPriority + 1U; ( pxNextTCB == NULL ) && ( uxPriority > 0U ); )
+			{
+				pxReadyList = &( pxReadyTasksLists[ --uxPriority ] );
+
+				for( uxTasksToCheck = listCURRENT_LIST_LENGTH( pxReadyList ); uxTasksToCheck > 0U; uxTasksToCheck-- )
+				{
+					listGET_OWNER_OF_NEXT_ENTRY( pxTCB, pxReadyList );
+
+					if( ( pxTCB->xRunningOnCore == tskNOT_RUNNING ) && ( ( pxTCB->uxCoreAffinityMask & ( 1UL << xCoreID ) ) != 0U ) )
+					{
+						pxNextTCB = pxTCB;
+						break;
+					}
+				}
+			}
+
+			configASSERT( pxNextTCB );
+			pxNextTCB->xRunningOnCore = xCoreID;
+			taskSET_CURRENT_TCB( pxNextTCB );
+		}
+		#else
+		{
+			listGET_OWNER_OF_NEXT_ENTRY( pxCurrentTCB, &( pxReadyTasksLists[ uxTopPriority ] ) );
+		}
+		#endif
 
 #if (configBLUETHUNDER == 1)
 		pTraceEvent = pxCurrentTCB->pTraceEvent;	// Restore Trace event pointer state to TCB.
@@ -1685,7 +2241,10 @@ portTickType xTimeToWake;
 	/* We must remove ourselves from the ready list before adding ourselves
 	to the blocked list as the same list item is used for both lists.  We have
 	exclusive access to the ready lists as the scheduler is locked. */
-	vListRemove( ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+	if( vListRemove( ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) ) == ( unsigned portBASE_TYPE ) 0 )
+	{
+		taskRESET_READY_PRIORITY( pxCurrentTCB->uxPriority );
+	}
 
 
 	#if ( INCLUDE_vTaskSuspend == 1 )
@@ -1759,7 +2318,11 @@ portTickType xTimeToWake;
 	{
 		/* The current task must be in a ready list, so there is no need to
 		check, and the port reset macro can be called directly. */
-		//portRESET_READY_PRIORITY( pxCurrentTCB->uxPriority, uxTopReadyPriority );
+		#if ( configUSE_PORT_OPTIMISED_TASK_SELECTION == 1 )
+		{
+			portRESET_READY_PRIORITY( pxCurrentTCB->uxPriority, uxTopReadyPriority );
+		}
+		#endif
 	}
 	else
 	{
@@ -1819,7 +2382,10 @@ __attribute__((no_instrument_function))
 		/* We must remove this task from the ready list before adding it to the
 		blocked list as the same list item is used for both lists.  This
 		function is called form a critical section. */
-		vListRemove( ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+		if( vListRemove( ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) ) == ( unsigned portBASE_TYPE ) 0 )
+		{
+			taskRESET_READY_PRIORITY( pxCurrentTCB->uxPriority );
+		}
 
 		/* Calculate the time at which the task should be woken if the event does
 		not occur.  This may overflow but this doesn't matter. */
@@ -1864,7 +2430,7 @@ portBASE_TYPE xReturn;
 		vListInsertEnd( ( xList * ) &( xPendingReadyList ), &( pxUnblockedTCB->xEventListItem ) );
 	}
 
-	if( pxUnblockedTCB->uxPriority >= pxCurrentTCB->uxPriority )
+	if( prvTaskShouldPreempt( pxUnblockedTCB ) != pdFALSE )
 	{
 		/* Return true if the task removed from the event list has
 		a higher priority than the calling task.  This allows
@@ -2065,8 +2631,9 @@ static portTASK_FUNCTION( prvIdleTask, pvParameters )
 			A critical region is not required here as we are just reading from
 			the list, and an occasional incorrect value will not matter.  If
 			the ready list at the idle priority contains more than one task
-			then a task other than the idle task is ready to execute. */
-			if( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ tskIDLE_PRIORITY ] ) ) > ( unsigned portBASE_TYPE ) 1 )
+			per core then a task other than the idle tasks is ready to
+			execute. */
+			if( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ tskIDLE_PRIORITY ] ) ) > ( unsigned portBASE_TYPE ) configNUM_CORES )
 			{
 				taskYIELD();
 			}
@@ -2085,6 +2652,43 @@ static portTASK_FUNCTION( prvIdleTask, pvParameters )
 			vApplicationIdleHook();
 		}
 		#endif
+
+		/* This conditional compilation should use inequality to 0, not equality
+		to 1.  This is to ensure portSUPPRESS_TICKS_AND_SLEEP() is called when
+		user defined low power mode implementations require
+		configUSE_TICKLESS_IDLE to be set to a value other than 1. */
+		#if ( configUSE_TICKLESS_IDLE != 0 )
+		{
+		portTickType xExpectedIdleTime;
+
+			/* It is not desirable to suspend then resume the scheduler on
+			each iteration of the idle task.  Therefore, a preliminary
+			test of the expected idle time is performed without the
+			scheduler suspended.  The result here is not necessarily
+			valid. */
+			xExpectedIdleTime = prvGetExpectedIdleTime();
+
+			if( xExpectedIdleTime >= configEXPECTED_IDLE_TIME_BEFORE_SLEEP )
+			{
+				vTaskSuspendAll();
+				{
+					/* Now the scheduler is suspended, the expected idle
+					time can be sampled again, and this time its value can
+					be used. */
+					configASSERT( xNextTaskUnblockTime >= xTickCount );
+					xExpectedIdleTime = prvGetExpectedIdleTime();
+
+					if( xExpectedIdleTime >= configEXPECTED_IDLE_TIME_BEFORE_SLEEP )
+					{
+						traceLOW_POWER_IDLE_BEGIN();
+						portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime );
+						traceLOW_POWER_IDLE_END();
+					}
+				}
+				( void ) xTaskResumeAll();
+			}
+		}
+		#endif /* configUSE_TICKLESS_IDLE */
 	}
 } /*lint !e715 pvParameters is not accessed but all task functions require the same prototype. */
 
@@ -2094,11 +2698,69 @@ static portTASK_FUNCTION( prvIdleTask, pvParameters )
 
 
 
+#if ( configUSE_TICKLESS_IDLE != 0 )
+__attribute__((no_instrument_function))
+	eSleepModeStatus eTaskConfirmSleepModeStatus( void )
+	{
+	eSleepModeStatus eReturn = eStandardSleep;
+
+		if( listCURRENT_LIST_LENGTH( &xPendingReadyList ) != 0 )
+		{
+			/* A task was made ready while the scheduler was suspended. */
+			eReturn = eAbortSleep;
+		}
+		else if( xMissedYield != pdFALSE )
+		{
+			/* A yield was pended while the scheduler was suspended. */
+			eReturn = eAbortSleep;
+		}
+
+		return eReturn;
+	}
+
+#endif /* configUSE_TICKLESS_IDLE */
+/*-----------------------------------------------------------*/
+
 /*-----------------------------------------------------------
  * File private functions documented at the top of the file.
  *----------------------------------------------------------*/
 
 
+#if ( configUSE_TICKLESS_IDLE != 0 )
+__attribute__((no_instrument_function))
+	static portTickType prvGetExpectedIdleTime( void )
+	{
+	portTickType xReturn;
+
+		if( pxCurrentTCB->uxPriority > tskIDLE_PRIORITY )
+		{
+			xReturn = 0;
+		}
+		else if( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ tskIDLE_PRIORITY ] ) ) > 1 )
+		{
+			/* There are other idle priority tasks in the ready state.  If
+			time slicing is used then the very next tick interrupt must be
+			processed. */
+			xReturn = 0;
+		}
+		#if ( configUSE_TIMING_WHEEL == 1 )
+			else if( wheelIS_DUE( &xDelayedTaskWheel, xTickCount ) )
+			{
+				/* Tasks are to be woken, the next tick must be processed. */
+				xReturn = 0;
+			}
+		#endif
+		else
+		{
+			xReturn = xNextTaskUnblockTime - xTickCount;
+		}
+
+		return xReturn;
+	}
+
+#endif /* configUSE_TICKLESS_IDLE */
+/*-----------------------------------------------------------*/
+
 __attribute__((no_instrument_function))
 static void prvInitialiseTCBVariables( tskTCB *pxTCB, const signed char * const pcName, unsigned portBASE_TYPE uxPriority, const xMemoryRegion * const xRegions, unsigned short usStackDepth )
 {
@@ -2148,12 +2810,33 @@ static void prvInitialiseTCBVariables( tskTCB *pxTCB, const signed char * const
 	}
 	#endif
 
+	#if ( configNUM_CORES > 1 )
+	{
+		pxTCB->uxCoreAffinityMask = tskNO_AFFINITY;
+		pxTCB->xRunningOnCore = tskNOT_RUNNING;
+	}
+	#endif
+
 	#if ( configGENERATE_RUN_TIME_STATS == 1 )
 	{
 		pxTCB->ulRunTimeCounter = 0UL;
 	}
 	#endif
 
+	#if ( portUSING_FPU_CONTEXT == 1 )
+	{
+		/* The registers are only saved once the task has used the FPU. */
+		pxTCB->xFPUContext.ulUsed = 0UL;
+	}
+	#endif
+
+	#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+	{
+		pxTCB->ulNotifiedValue = 0UL;
+		pxTCB->ucNotifyState = taskNOT_WAITING_NOTIFICATION;
+	}
+	#endif
+
 	#if ( portUSING_MPU_WRAPPERS == 1 )
 	{
 		vPortStoreTaskMPUSettings( &( pxTCB->xMPUSettings ), xRegions, pxTCB->pxStack, usStackDepth );
@@ -2190,13 +2873,29 @@ static void prvInitialiseTaskLists( void )
 {
 unsigned portBASE_TYPE uxPriority;
 
+	#if ( configUSE_PORT_OPTIMISED_TASK_SELECTION == 1 )
+	{
+		/* There is one bit per priority in uxTopReadyPriority. */
+		configASSERT( configMAX_PRIORITIES <= ( sizeof( uxTopReadyPriority ) * 8U ) );
+	}
+	#endif
+
 	for( uxPriority = ( unsigned portBASE_TYPE ) 0U; uxPriority < configMAX_PRIORITIES; uxPriority++ )
 	{
 		vListInitialise( ( xList * ) &( pxReadyTasksLists[ uxPriority ] ) );
 	}
 
-	vListInitialise( ( xList * ) &xDelayedTaskList1 );
-	vListInitialise( ( xList * ) &xDelayedTaskList2 );
+	#if ( configUSE_TIMING_WHEEL == 1 )
+	{
+		vWheelInitialise( &xDelayedTaskWheel );
+	}
+	#else
+	{
+		vListInitialise( ( xList * ) &xDelayedTaskList1 );
+		vListInitialise( ( xList * ) &xDelayedTaskList2 );
+	}
+	#endif
+
 	vListInitialise( ( xList * ) &xPendingReadyList );
 
 	#if ( INCLUDE_vTaskDelete == 1 )
@@ -2211,10 +2910,14 @@ unsigned portBASE_TYPE uxPriority;
 	}
 	#endif
 
-	/* Start with pxDelayedTaskList using list1 and the pxOverflowDelayedTaskList
-	using list2. */
-	pxDelayedTaskList = &xDelayedTaskList1;
-	pxOverflowDelayedTaskList = &xDelayedTaskList2;
+	#if ( configUSE_TIMING_WHEEL == 0 )
+	{
+		/* Start with pxDelayedTaskList using list1 and the
+		pxOverflowDelayedTaskList using list2. */
+		pxDelayedTaskList = &xDelayedTaskList1;
+		pxOverflowDelayedTaskList = &xDelayedTaskList2;
+	}
+	#endif
 }
 /*-----------------------------------------------------------*/
 __attribute__((no_instrument_function))
@@ -2239,13 +2942,32 @@ static void prvCheckTasksWaitingTermination( void )
 				taskENTER_CRITICAL();
 				{
 					pxTCB = ( tskTCB * ) listGET_OWNER_OF_HEAD_ENTRY( ( ( xList * ) &xTasksWaitingTermination ) );
-					vListRemove( &( pxTCB->xGenericListItem ) );
-					--uxCurrentNumberOfTasks;
-					--uxTasksDeleted;
+
+					#if ( configNUM_CORES > 1 )
+					{
+						/* A task that deleted itself keeps running on its
+						core until that core switches away.  Its stack cannot
+						be freed before then, so try again next time round. */
+						if( pxTCB->xRunningOnCore != tskNOT_RUNNING )
+						{
+							pxTCB = NULL;
+						}
+					}
+					#endif
+
+					if( pxTCB != NULL )
+					{
+						vListRemove( &( pxTCB->xGenericListItem ) );
+						--uxCurrentNumberOfTasks;
+						--uxTasksDeleted;
+					}
 				}
 				taskEXIT_CRITICAL();
 
-				prvDeleteTCB( pxTCB );
+				if( pxTCB != NULL )
+				{
+					prvDeleteTCB( pxTCB );
+				}
 			}
 		}
 	}
@@ -2258,6 +2980,14 @@ static void prvAddCurrentTaskToDelayedList( portTickType xTimeToWake )
 	/* The list item will be inserted in wake time order. */
 	listSET_LIST_ITEM_VALUE( &( pxCurrentTCB->xGenericListItem ), xTimeToWake );
 
+	#if ( configUSE_TIMING_WHEEL == 1 )
+	{
+		/* The wheel files the task in constant time, whatever the number of
+		tasks already delayed, and keeps track of the next wake time. */
+		vWheelInsert( &xDelayedTaskWheel, ( xListItem * ) &( pxCurrentTCB->xGenericListItem ), xTickCount );
+		prvResetNextTaskUnblockTime();
+	}
+	#else
 	if( xTimeToWake < xTickCount )
 	{
 		/* Wake time has overflowed.  Place this item in the overflow list. */
@@ -2276,6 +3006,7 @@ static void prvAddCurrentTaskToDelayedList( portTickType xTimeToWake )
 			xNextTaskUnblockTime = xTimeToWake;
 		}
 	}
+	#endif
 }
 /*-----------------------------------------------------------*/
 __attribute__((no_instrument_function))
@@ -2323,9 +3054,10 @@ __attribute__((no_instrument_function))
 	{
 	volatile tskTCB *pxNextTCB, *pxFirstTCB;
 	unsigned short usStackRemaining;
-	PRIVILEGED_DATA static char pcStatusString[ configMAX_TASK_NAME_LEN + 30 ];
+	char *pcEnd;
 
 		/* Write the details of all the TCB's in pxList into the buffer. */
+		pcEnd = ( char * ) pcWriteBuffer + strlen( ( const char * ) pcWriteBuffer );
 		listGET_OWNER_OF_NEXT_ENTRY( pxFirstTCB, pxList );
 		do
 		{
@@ -2340,119 +3072,242 @@ __attribute__((no_instrument_function))
 			}
 			#endif
 
-			sprintf( pcStatusString, ( char * ) "%s\t\t%c\t%u\t%u\t%u\r\n", pxNextTCB->pcTaskName, cStatus, ( unsigned int ) pxNextTCB->uxPriority, usStackRemaining, ( unsigned int ) pxNextTCB->uxTCBNumber );
-			strcat( ( char * ) pcWriteBuffer, ( char * ) pcStatusString );
+			/* "<name>\t\t<state>\t<priority>\t<stack>\t<number>\r\n" */
+			pcEnd = prvWriteString( pcEnd, ( const char * ) pxNextTCB->pcTaskName );
+			pcEnd = prvWriteString( pcEnd, "\t\t" );
+			*pcEnd++ = ( char ) cStatus;
+			pcEnd = prvWriteString( pcEnd, "\t" );
+			pcEnd = prvWriteDecimal( pcEnd, ( unsigned long ) pxNextTCB->uxPriority );
+			pcEnd = prvWriteString( pcEnd, "\t" );
+			pcEnd = prvWriteDecimal( pcEnd, ( unsigned long ) usStackRemaining );
+			pcEnd = prvWriteString( pcEnd, "\t" );
+			pcEnd = prvWriteDecimal( pcEnd, ( unsigned long ) pxNextTCB->uxTCBNumber );
+			pcEnd = prvWriteString( pcEnd, "\r\n" );
 
 		} while( pxNextTCB != pxFirstTCB );
 	}
-
-#endif
 /*-----------------------------------------------------------*/
-
-#if ( configGENERATE_RUN_TIME_STATS == 1 )
 __attribute__((no_instrument_function))
-	static void prvGenerateRunTimeStatsForTasksInList( const signed char *pcWriteBuffer, xList *pxList, unsigned long ulTotalRunTime )
+	static unsigned portBASE_TYPE prvListTasksWithinSingleList( xTaskStatusType *pxTaskStatusArray, xList *pxList, eTaskState eState )
 	{
 	volatile tskTCB *pxNextTCB, *pxFirstTCB;
-	unsigned long ulStatsAsPercentage;
+	unsigned portBASE_TYPE uxTask = 0;
 
-		/* Write the run time stats of all the TCB's in pxList into the buffer. */
-		listGET_OWNER_OF_NEXT_ENTRY( pxFirstTCB, pxList );
-		do
+		if( listCURRENT_LIST_LENGTH( pxList ) > ( unsigned portBASE_TYPE ) 0 )
 		{
-			/* Get next TCB in from the list. */
-			listGET_OWNER_OF_NEXT_ENTRY( pxNextTCB, pxList );
+			listGET_OWNER_OF_NEXT_ENTRY( pxFirstTCB, pxList );
 
-			/* Divide by zero check. */
-			if( ulTotalRunTime > 0UL )
+			/* Populate an xTaskStatusType structure within the
+			pxTaskStatusArray array for each task that is referenced from
+			pxList.  See the definition of xTaskStatusType in task.h for the
+			meaning of each xTaskStatusType structure member. */
+			do
 			{
-				/* Has the task run at all? */
-				if( pxNextTCB->ulRunTimeCounter == 0UL )
+				listGET_OWNER_OF_NEXT_ENTRY( pxNextTCB, pxList );
+
+				pxTaskStatusArray[ uxTask ].xHandle = ( xTaskHandle ) pxNextTCB;
+				pxTaskStatusArray[ uxTask ].pcTaskName = ( const signed char * ) &( pxNextTCB->pcTaskName [ 0 ] );
+				pxTaskStatusArray[ uxTask ].xTaskNumber = pxNextTCB->uxTCBNumber;
+				pxTaskStatusArray[ uxTask ].eCurrentState = eState;
+				pxTaskStatusArray[ uxTask ].uxCurrentPriority = pxNextTCB->uxPriority;
+
+				#if ( configNUM_CORES > 1 )
 				{
-					/* The task has used no CPU time at all. */
-					sprintf( pcStatsString, ( char * ) "%s\t\t0\t\t0%%\r\n", pxNextTCB->pcTaskName );
+					if( pxNextTCB->xRunningOnCore != tskNOT_RUNNING )
+					{
+						pxTaskStatusArray[ uxTask ].eCurrentState = eRunning;
+					}
 				}
-				else
+				#else
 				{
-					/* What percentage of the total run time has the task used?
-					This will always be rounded down to the nearest integer.
-					ulTotalRunTime has already been divided by 100. */
-					ulStatsAsPercentage = pxNextTCB->ulRunTimeCounter / ulTotalRunTime;
-
-					if( ulStatsAsPercentage > 0UL )
+					if( pxNextTCB == pxCurrentTCB )
 					{
-						#ifdef portLU_PRINTF_SPECIFIER_REQUIRED
-						{
-							sprintf( pcStatsString, ( char * ) "%s\t\t%lu\t\t%lu%%\r\n", pxNextTCB->pcTaskName, pxNextTCB->ulRunTimeCounter, ulStatsAsPercentage );
-						}
-						#else
-						{
-							/* sizeof( int ) == sizeof( long ) so a smaller
-							printf() library can be used. */
-							sprintf( pcStatsString, ( char * ) "%s\t\t%u\t\t%u%%\r\n", pxNextTCB->pcTaskName, ( unsigned int ) pxNextTCB->ulRunTimeCounter, ( unsigned int ) ulStatsAsPercentage );
-						}
-						#endif
+						pxTaskStatusArray[ uxTask ].eCurrentState = eRunning;
 					}
-					else
+				}
+				#endif
+
+				#if ( INCLUDE_vTaskSuspend == 1 )
+				{
+					/* If the task is in the suspended list then there is a chance
+					it is actually just blocked indefinitely - so really it should
+					be reported as being in the Blocked state. */
+					if( eState == eSuspended )
 					{
-						/* If the percentage is zero here then the task has
-						consumed less than 1% of the total run time. */
-						#ifdef portLU_PRINTF_SPECIFIER_REQUIRED
-						{
-							sprintf( pcStatsString, ( char * ) "%s\t\t%lu\t\t<1%%\r\n", pxNextTCB->pcTaskName, pxNextTCB->ulRunTimeCounter );
-						}
-						#else
+						if( listLIST_ITEM_CONTAINER( &( pxNextTCB->xEventListItem ) ) != NULL )
 						{
-							/* sizeof( int ) == sizeof( long ) so a smaller
-							printf() library can be used. */
-							sprintf( pcStatsString, ( char * ) "%s\t\t%u\t\t<1%%\r\n", pxNextTCB->pcTaskName, ( unsigned int ) pxNextTCB->ulRunTimeCounter );
+							pxTaskStatusArray[ uxTask ].eCurrentState = eBlocked;
 						}
-						#endif
 					}
 				}
+				#endif
 
-				strcat( ( char * ) pcWriteBuffer, ( char * ) pcStatsString );
-			}
+				#if ( configUSE_MUTEXES == 1 )
+				{
+					pxTaskStatusArray[ uxTask ].uxBasePriority = pxNextTCB->uxBasePriority;
+				}
+				#else
+				{
+					pxTaskStatusArray[ uxTask ].uxBasePriority = 0;
+				}
+				#endif
 
-		} while( pxNextTCB != pxFirstTCB );
+				#if ( configGENERATE_RUN_TIME_STATS == 1 )
+				{
+					pxTaskStatusArray[ uxTask ].ulRunTimeCounter = pxNextTCB->ulRunTimeCounter;
+				}
+				#else
+				{
+					pxTaskStatusArray[ uxTask ].ulRunTimeCounter = 0;
+				}
+				#endif
+
+				#if ( portSTACK_GROWTH > 0 )
+				{
+					pxTaskStatusArray[ uxTask ].usStackHighWaterMark = usTaskCheckFreeStackSpace( ( unsigned char * ) pxNextTCB->pxEndOfStack );
+				}
+				#else
+				{
+					pxTaskStatusArray[ uxTask ].usStackHighWaterMark = usTaskCheckFreeStackSpace( ( unsigned char * ) pxNextTCB->pxStack );
+				}
+				#endif
+
+				uxTask++;
+
+			} while( pxNextTCB != pxFirstTCB );
+		}
+
+		return uxTask;
 	}
 
 #endif
 /*-----------------------------------------------------------*/
 
-#if ( ( configUSE_TRACE_FACILITY == 1 ) || ( INCLUDE_uxTaskGetStackHighWaterMark == 1 ) )
+#if ( configGENERATE_RUN_TIME_STATS == 1 )
 __attribute__((no_instrument_function))
-	static unsigned short usTaskCheckFreeStackSpace( const unsigned char * pucStackByte )
+	static void prvGenerateRunTimeStatsForTasksInList( const signed char *pcWriteBuffer, xList *pxList, unsigned long ulTotalRunTime )
 	{
-	register unsigned short usCount = 0U;
+	volatile tskTCB *pxNextTCB, *pxFirstTCB;
 
-		while( *pucStackByte == tskSTACK_FILL_BYTE )
+		/* Write the run time stats of all the TCB's in pxList into the buffer. */
+		listGET_OWNER_OF_NEXT_ENTRY( pxFirstTCB, pxList );
+		do
 		{
-			pucStackByte -= portSTACK_GROWTH;
-			usCount++;
-		}
-
-		usCount /= sizeof( portSTACK_TYPE );
+			/* Get next TCB in from the list. */
+			listGET_OWNER_OF_NEXT_ENTRY( pxNextTCB, pxList );
+			prvWriteRunTimeStatsLine( pcWriteBuffer, ( const signed char * ) pxNextTCB->pcTaskName, pxNextTCB->ulRunTimeCounter, ulTotalRunTime );
 
-		return usCount;
+		} while( pxNextTCB != pxFirstTCB );
 	}
-
-#endif
 /*-----------------------------------------------------------*/
-
-#if ( INCLUDE_uxTaskGetStackHighWaterMark == 1 )
 __attribute__((no_instrument_function))
-	unsigned portBASE_TYPE uxTaskGetStackHighWaterMark( xTaskHandle xTask )
+	static void prvWriteRunTimeStatsLine( const signed char *pcWriteBuffer, const signed char *pcName, unsigned long ulRunTime, unsigned long ulTotalRunTime )
 	{
-	tskTCB *pxTCB;
-	unsigned char *pcEndOfStack;
-	unsigned portBASE_TYPE uxReturn;
-
-		pxTCB = prvGetTCBFromHandle( xTask );
+	unsigned long ulStatsAsPercentage;
+	char *pcEnd;
 
-		#if portSTACK_GROWTH < 0
+		/* Divide by zero check. */
+		if( ulTotalRunTime > 0UL )
 		{
-			pcEndOfStack = ( unsigned char * ) pxTCB->pxStack;
+			/* "<name>\t\t<count>\t\t<percent>%\r\n" */
+			pcEnd = ( char * ) pcWriteBuffer + strlen( ( const char * ) pcWriteBuffer );
+			pcEnd = prvWriteString( pcEnd, ( const char * ) pcName );
+			pcEnd = prvWriteString( pcEnd, "\t\t" );
+			pcEnd = prvWriteDecimal( pcEnd, ulRunTime );
+			pcEnd = prvWriteString( pcEnd, "\t\t" );
+
+			/* What percentage of the total run time has the task used?
+			This will always be rounded down to the nearest integer.
+			ulTotalRunTime has already been divided by 100. */
+			ulStatsAsPercentage = ulRunTime / ulTotalRunTime;
+
+			if( ( ulStatsAsPercentage > 0UL ) || ( ulRunTime == 0UL ) )
+			{
+				pcEnd = prvWriteDecimal( pcEnd, ulStatsAsPercentage );
+				( void ) prvWriteString( pcEnd, "%\r\n" );
+			}
+			else
+			{
+				/* If the percentage is zero here then the task has
+				consumed less than 1% of the total run time. */
+				( void ) prvWriteString( pcEnd, "<1%\r\n" );
+			}
+		}
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( ( configUSE_TRACE_FACILITY == 1 ) || ( configGENERATE_RUN_TIME_STATS == 1 ) )
+__attribute__((no_instrument_function))
+	static char *prvWriteString( char *pcBuffer, const char *pcString )
+	{
+		while( *pcString != '\0' )
+		{
+			*pcBuffer++ = *pcString++;
+		}
+
+		*pcBuffer = '\0';
+		return pcBuffer;
+	}
+/*-----------------------------------------------------------*/
+__attribute__((no_instrument_function))
+	static char *prvWriteDecimal( char *pcBuffer, unsigned long ulValue )
+	{
+	char cDigits[ 10 ];
+	unsigned portBASE_TYPE uxDigits = 0U;
+
+		do
+		{
+			cDigits[ uxDigits++ ] = ( char ) ( '0' + ( ulValue % 10UL ) );
+			ulValue /= 10UL;
+		} while( ulValue != 0UL );
+
+		while( uxDigits > 0U )
+		{
+			*pcBuffer++ = cDigits[ --uxDigits ];
+		}
+
+		*pcBuffer = '\0';
+		return pcBuffer;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( ( configUSE_TRACE_FACILITY == 1 ) || ( INCLUDE_uxTaskGetStackHighWaterMark == 1 ) )
+__attribute__((no_instrument_function))
+	static unsigned short usTaskCheckFreeStackSpace( const unsigned char * pucStackByte )
+	{
+	register unsigned short usCount = 0U;
+
+		while( *pucStackByte == tskSTACK_FILL_BYTE )
+		{
+			pucStackByte -= portSTACK_GROWTH;
+			usCount++;
+		}
+
+		usCount /= sizeof( portSTACK_TYPE );
+
+		return usCount;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( INCLUDE_uxTaskGetStackHighWaterMark == 1 )
+__attribute__((no_instrument_function))
+	unsigned portBASE_TYPE uxTaskGetStackHighWaterMark( xTaskHandle xTask )
+	{
+	tskTCB *pxTCB;
+	unsigned char *pcEndOfStack;
+	unsigned portBASE_TYPE uxReturn;
+
+		pxTCB = prvGetTCBFromHandle( xTask );
+
+		#if portSTACK_GROWTH < 0
+		{
+			pcEndOfStack = ( unsigned char * ) pxTCB->pxStack;
 		}
 		#else
 		{
@@ -2488,6 +3343,15 @@ __attribute__((no_instrument_function))
 
 /*-----------------------------------------------------------*/
 
+#if ( portUSING_FPU_CONTEXT == 1 )
+
+	/* Where xFPUContext sits in a TCB, so the port can reach a task's saved
+	VFP registers without knowing the TCB layout. */
+	const unsigned long ulTaskFPUContextOffset = offsetof( tskTCB, xFPUContext );
+
+#endif
+/*-----------------------------------------------------------*/
+
 #if ( ( INCLUDE_xTaskGetCurrentTaskHandle == 1 ) || ( configUSE_MUTEXES == 1 ) )
 __attribute__((no_instrument_function))
 	xTaskHandle xTaskGetCurrentTaskHandle( void )
@@ -2518,14 +3382,19 @@ __attribute__((no_instrument_function))
 		}
 		else
 		{
-			if( uxSchedulerSuspended == ( unsigned portBASE_TYPE ) pdFALSE )
+			/* The calling core's count, so the task must stay on it. */
+			taskSMP_ENTER_CRITICAL();
 			{
-				xReturn = taskSCHEDULER_RUNNING;
-			}
-			else
-			{
-				xReturn = taskSCHEDULER_SUSPENDED;
+				if( uxSchedulerSuspended == ( unsigned portBASE_TYPE ) pdFALSE )
+				{
+					xReturn = taskSCHEDULER_RUNNING;
+				}
+				else
+				{
+					xReturn = taskSCHEDULER_SUSPENDED;
+				}
 			}
+			taskSMP_EXIT_CRITICAL();
 		}
 
 		return xReturn;
@@ -2551,7 +3420,10 @@ __attribute__((no_instrument_function))
 			be moved in to a new list. */
 			if( listIS_CONTAINED_WITHIN( &( pxReadyTasksLists[ pxTCB->uxPriority ] ), &( pxTCB->xGenericListItem ) ) != pdFALSE )
 			{
-				vListRemove( &( pxTCB->xGenericListItem ) );
+				if( vListRemove( &( pxTCB->xGenericListItem ) ) == ( unsigned portBASE_TYPE ) 0 )
+				{
+					taskRESET_READY_PRIORITY( pxTCB->uxPriority );
+				}
 
 				/* Inherit the priority before being moved into the new list. */
 				pxTCB->uxPriority = pxCurrentTCB->uxPriority;
@@ -2582,7 +3454,10 @@ __attribute__((no_instrument_function))
 			{
 				/* We must be the running task to be able to give the mutex back.
 				Remove ourselves from the ready list we currently appear in. */
-				vListRemove( &( pxTCB->xGenericListItem ) );
+				if( vListRemove( &( pxTCB->xGenericListItem ) ) == ( unsigned portBASE_TYPE ) 0 )
+				{
+					taskRESET_READY_PRIORITY( pxTCB->uxPriority );
+				}
 
 				/* Disinherit the priority before adding the task into the new
 				ready list. */
@@ -2633,6 +3508,116 @@ void vTaskExitCritical( void )
 #endif
 /*-----------------------------------------------------------*/
 
+#if ( configNUM_CORES > 1 )
+__attribute__((no_instrument_function))
+	static portBASE_TYPE prvYieldCoreForTask( const tskTCB * const pxTCB )
+	{
+	portBASE_TYPE xReturn = pdFALSE, xCoreID, xThisCore, xLowestCore = tskNOT_RUNNING;
+	unsigned portBASE_TYPE uxLowestPriority;
+	const tskTCB *pxRunningTCB;
+
+		xThisCore = portGET_CORE_ID();
+
+		if( ( ( pxTCB->uxCoreAffinityMask & ( 1UL << xThisCore ) ) != 0U ) && ( pxTCB->uxPriority >= pxCurrentTCB->uxPriority ) )
+		{
+			/* Same decision the single core scheduler makes. */
+			xReturn = pdTRUE;
+		}
+		else
+		{
+			/* Look for the core, among those the task may use, that is
+			running the lowest priority task below the one just readied. */
+			uxLowestPriority = pxTCB->uxPriority;
+
+			for( xCoreID = 0; xCoreID < configNUM_CORES; xCoreID++ )
+			{
+				pxRunningTCB = pxCurrentTCBs[ xCoreID ];
+
+				if( ( xCoreID != xThisCore ) && ( ( pxTCB->uxCoreAffinityMask & ( 1UL << xCoreID ) ) != 0U ) && ( pxRunningTCB != NULL ) )
+				{
+					if( pxRunningTCB->uxPriority < uxLowestPriority )
+					{
+						uxLowestPriority = pxRunningTCB->uxPriority;
+						xLowestCore = xCoreID;
+					}
+				}
+			}
+
+			if( ( xLowestCore != tskNOT_RUNNING ) && ( xSchedulerRunning != pdFALSE ) )
+			{
+				portYIELD_CORE( xLowestCore );
+			}
+		}
+
+		return xReturn;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( configNUM_CORES > 1 )
+__attribute__((no_instrument_function))
+	void vTaskCoreAffinitySet( xTaskHandle xTask, unsigned portBASE_TYPE uxCoreAffinityMask )
+	{
+	tskTCB *pxTCB;
+	portBASE_TYPE xCoreID;
+
+		configASSERT( ( uxCoreAffinityMask & tskNO_AFFINITY ) != 0U );
+
+		taskENTER_CRITICAL();
+		{
+			pxTCB = prvGetTCBFromHandle( xTask );
+			pxTCB->uxCoreAffinityMask = uxCoreAffinityMask;
+			xCoreID = pxTCB->xRunningOnCore;
+
+			if( xCoreID != tskNOT_RUNNING )
+			{
+				/* Move the task off a core it is no longer allowed on. */
+				if( ( uxCoreAffinityMask & ( 1UL << xCoreID ) ) == 0U )
+				{
+					if( xCoreID == portGET_CORE_ID() )
+					{
+						portYIELD_WITHIN_API();
+					}
+					else
+					{
+						portYIELD_CORE( xCoreID );
+					}
+				}
+			}
+			else if( listIS_CONTAINED_WITHIN( &( pxReadyTasksLists[ pxTCB->uxPriority ] ), &( pxTCB->xGenericListItem ) ) != pdFALSE )
+			{
+				/* A ready task may now be allowed on a core it can preempt. */
+				if( prvYieldCoreForTask( pxTCB ) != pdFALSE )
+				{
+					portYIELD_WITHIN_API();
+				}
+			}
+		}
+		taskEXIT_CRITICAL();
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( configNUM_CORES > 1 )
+__attribute__((no_instrument_function))
+	unsigned portBASE_TYPE uxTaskCoreAffinityGet( xTaskHandle xTask )
+	{
+	unsigned portBASE_TYPE uxReturn;
+
+		taskENTER_CRITICAL();
+		{
+			uxReturn = prvGetTCBFromHandle( xTask )->uxCoreAffinityMask;
+		}
+		taskEXIT_CRITICAL();
+
+		return uxReturn;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
 portTickType uxTaskResetEventItemValue( void )
 {
 portTickType uxReturn;
@@ -2647,3 +3632,273 @@ portTickType uxReturn;
 }
 /*-----------------------------------------------------------*/
 
+
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+__attribute__((no_instrument_function))
+	static void prvBlockOnNotification( portTickType xTicksToWait )
+	{
+		/* MUST BE CALLED FROM WITHIN A CRITICAL SECTION.  The task is moved
+		off the ready list directly, as no event list is involved, and is
+		placed back by xTaskGenericNotify() or vTaskNotifyGiveFromISR(). */
+		if( vListRemove( ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) ) == ( unsigned portBASE_TYPE ) 0 )
+		{
+			taskRESET_READY_PRIORITY( pxCurrentTCB->uxPriority );
+		}
+
+		#if ( INCLUDE_vTaskSuspend == 1 )
+		{
+			if( xTicksToWait == portMAX_DELAY )
+			{
+				/* Not woken by a timeout, so keep off the delayed lists. */
+				vListInsertEnd( ( xList * ) &xSuspendedTaskList, ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+			}
+			else
+			{
+				prvAddCurrentTaskToDelayedList( xTickCount + xTicksToWait );
+			}
+		}
+		#else
+		{
+			prvAddCurrentTaskToDelayedList( xTickCount + xTicksToWait );
+		}
+		#endif
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+__attribute__((no_instrument_function))
+	unsigned long ulTaskNotifyTake( portBASE_TYPE xClearCountOnExit, portTickType xTicksToWait )
+	{
+	unsigned long ulReturn;
+
+		taskENTER_CRITICAL();
+		{
+			/* Only block if the notification count is not already non-zero. */
+			if( pxCurrentTCB->ulNotifiedValue == 0UL )
+			{
+				pxCurrentTCB->ucNotifyState = taskWAITING_NOTIFICATION;
+
+				if( xTicksToWait > ( portTickType ) 0 )
+				{
+					traceTASK_NOTIFY_TAKE_BLOCK();
+					prvBlockOnNotification( xTicksToWait );
+
+					/* The port saves the critical nesting with the task, so
+					it is fine to yield here.  The task runs again with
+					interrupts still disabled, once it has been notified or
+					has timed out. */
+					portYIELD_WITHIN_API();
+				}
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		taskENTER_CRITICAL();
+		{
+			traceTASK_NOTIFY_TAKE();
+			ulReturn = pxCurrentTCB->ulNotifiedValue;
+
+			if( ulReturn != 0UL )
+			{
+				if( xClearCountOnExit != pdFALSE )
+				{
+					pxCurrentTCB->ulNotifiedValue = 0UL;
+				}
+				else
+				{
+					pxCurrentTCB->ulNotifiedValue = ulReturn - 1UL;
+				}
+			}
+
+			pxCurrentTCB->ucNotifyState = taskNOT_WAITING_NOTIFICATION;
+		}
+		taskEXIT_CRITICAL();
+
+		return ulReturn;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+__attribute__((no_instrument_function))
+	portBASE_TYPE xTaskNotifyWait( unsigned long ulBitsToClearOnEntry, unsigned long ulBitsToClearOnExit, unsigned long *pulNotificationValue, portTickType xTicksToWait )
+	{
+	portBASE_TYPE xReturn;
+
+		taskENTER_CRITICAL();
+		{
+			/* Only block if a notification is not already pending. */
+			if( pxCurrentTCB->ucNotifyState != taskNOTIFICATION_RECEIVED )
+			{
+				pxCurrentTCB->ulNotifiedValue &= ~ulBitsToClearOnEntry;
+				pxCurrentTCB->ucNotifyState = taskWAITING_NOTIFICATION;
+
+				if( xTicksToWait > ( portTickType ) 0 )
+				{
+					traceTASK_NOTIFY_WAIT_BLOCK();
+					prvBlockOnNotification( xTicksToWait );
+					portYIELD_WITHIN_API();
+				}
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		taskENTER_CRITICAL();
+		{
+			traceTASK_NOTIFY_WAIT();
+
+			if( pulNotificationValue != NULL )
+			{
+				/* Output the value whether or not a notification arrived. */
+				*pulNotificationValue = pxCurrentTCB->ulNotifiedValue;
+			}
+
+			if( pxCurrentTCB->ucNotifyState == taskWAITING_NOTIFICATION )
+			{
+				/* Timed out, or was not asked to wait at all. */
+				xReturn = pdFALSE;
+			}
+			else
+			{
+				pxCurrentTCB->ulNotifiedValue &= ~ulBitsToClearOnExit;
+				xReturn = pdTRUE;
+			}
+
+			pxCurrentTCB->ucNotifyState = taskNOT_WAITING_NOTIFICATION;
+		}
+		taskEXIT_CRITICAL();
+
+		return xReturn;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+__attribute__((no_instrument_function))
+	portBASE_TYPE xTaskGenericNotify( xTaskHandle xTaskToNotify, unsigned long ulValue, eNotifyAction eAction, unsigned long *pulPreviousNotificationValue )
+	{
+	tskTCB *pxTCB;
+	portBASE_TYPE xReturn = pdPASS;
+	unsigned char ucOriginalNotifyState;
+
+		configASSERT( xTaskToNotify );
+		pxTCB = ( tskTCB * ) xTaskToNotify;
+
+		taskENTER_CRITICAL();
+		{
+			if( pulPreviousNotificationValue != NULL )
+			{
+				*pulPreviousNotificationValue = pxTCB->ulNotifiedValue;
+			}
+
+			ucOriginalNotifyState = pxTCB->ucNotifyState;
+			pxTCB->ucNotifyState = taskNOTIFICATION_RECEIVED;
+
+			switch( eAction )
+			{
+				case eSetBits :
+					pxTCB->ulNotifiedValue |= ulValue;
+					break;
+
+				case eIncrement :
+					( pxTCB->ulNotifiedValue )++;
+					break;
+
+				case eSetValueWithOverwrite :
+					pxTCB->ulNotifiedValue = ulValue;
+					break;
+
+				case eSetValueWithoutOverwrite :
+					if( ucOriginalNotifyState != taskNOTIFICATION_RECEIVED )
+					{
+						pxTCB->ulNotifiedValue = ulValue;
+					}
+					else
+					{
+						/* The value could not be written to the task. */
+						xReturn = pdFAIL;
+					}
+					break;
+
+				case eNoAction :
+				default :
+					/* The task is being notified without its value being
+					updated. */
+					break;
+			}
+
+			traceTASK_NOTIFY( pxTCB );
+
+			/* If the task is blocked specifically to wait for a notification
+			then unblock it now.  It cannot be on an event list. */
+			if( ucOriginalNotifyState == taskWAITING_NOTIFICATION )
+			{
+				vListRemove( &( pxTCB->xGenericListItem ) );
+				prvAddTaskToReadyQueue( pxTCB );
+
+				if( prvTaskShouldPreempt( pxTCB ) != pdFALSE )
+				{
+					portYIELD_WITHIN_API();
+				}
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		return xReturn;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+__attribute__((no_instrument_function))
+	void vTaskNotifyGiveFromISR( xTaskHandle xTaskToNotify, portBASE_TYPE *pxHigherPriorityTaskWoken )
+	{
+	tskTCB *pxTCB;
+	unsigned char ucOriginalNotifyState;
+	unsigned portBASE_TYPE uxSavedInterruptStatus;
+
+		configASSERT( xTaskToNotify );
+		pxTCB = ( tskTCB * ) xTaskToNotify;
+
+		uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+		{
+			ucOriginalNotifyState = pxTCB->ucNotifyState;
+			pxTCB->ucNotifyState = taskNOTIFICATION_RECEIVED;
+
+			/* 'Giving' is equivalent to incrementing a count in a counting
+			semaphore. */
+			( pxTCB->ulNotifiedValue )++;
+
+			traceTASK_NOTIFY_GIVE_FROM_ISR( pxTCB );
+
+			if( ucOriginalNotifyState == taskWAITING_NOTIFICATION )
+			{
+				if( uxSchedulerSuspended == ( unsigned portBASE_TYPE ) pdFALSE )
+				{
+					vListRemove( &( pxTCB->xGenericListItem ) );
+					prvAddTaskToReadyQueue( pxTCB );
+				}
+				else
+				{
+					/* The delayed and ready lists cannot be accessed, so hold
+					the task pending until the scheduler is resumed.  The event
+					list item is free while waiting for a notification. */
+					vListInsertEnd( ( xList * ) &( xPendingReadyList ), &( pxTCB->xEventListItem ) );
+				}
+
+				if( ( prvTaskShouldPreempt( pxTCB ) != pdFALSE ) && ( pxHigherPriorityTaskWoken != NULL ) )
+				{
+					*pxHigherPriorityTaskWoken = pdTRUE;
+				}
+			}
+		}
+		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+	}
+
+#endif
+/*-----------------------------------------------------------*/
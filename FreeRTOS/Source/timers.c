@@ -74,6 +74,10 @@ task.h is included from an application file. */
 #include "queue.h"
 #include "timers.h"
 
+#if ( configUSE_TIMING_WHEEL == 1 )
+	#include "wheel.h"
+#endif
+
 #undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
 
 /* This entire source file will be skipped if the application is not configured
@@ -106,13 +110,23 @@ typedef struct tmrTimerQueueMessage
 } xTIMER_MESSAGE;
 
 
-/* The list in which active timers are stored.  Timers are referenced in expire
-time order, with the nearest expiry time at the front of the list.  Only the
-timer service task is allowed to access xActiveTimerList. */
-PRIVILEGED_DATA static xList xActiveTimerList1;
-PRIVILEGED_DATA static xList xActiveTimerList2;
-PRIVILEGED_DATA static xList *pxCurrentTimerList;
-PRIVILEGED_DATA static xList *pxOverflowTimerList;
+#if ( configUSE_TIMING_WHEEL == 1 )
+
+	/* The wheel in which active timers are stored, filed by expiry time.  Only
+	the timer service task is allowed to access xActiveTimerWheel. */
+	PRIVILEGED_DATA static xTimingWheel xActiveTimerWheel;
+
+#else
+
+	/* The list in which active timers are stored.  Timers are referenced in expire
+	time order, with the nearest expiry time at the front of the list.  Only the
+	timer service task is allowed to access xActiveTimerList. */
+	PRIVILEGED_DATA static xList xActiveTimerList1;
+	PRIVILEGED_DATA static xList xActiveTimerList2;
+	PRIVILEGED_DATA static xList *pxCurrentTimerList;
+	PRIVILEGED_DATA static xList *pxOverflowTimerList;
+
+#endif
 
 /* A queue that is used to send commands to the timer service task. */
 PRIVILEGED_DATA static xQueueHandle xTimerQueue = NULL;
@@ -158,9 +172,14 @@ static void prvProcessExpiredTimer( portTickType xNextExpireTime, portTickType x
 
 /*
  * The tick count has overflowed.  Switch the timer lists after ensuring the
- * current timer list does not still reference some timers.
+ * current timer list does not still reference some timers.  Not needed when
+ * the timers are held in a timing wheel.
  */
-static void prvSwitchTimerLists( portTickType xLastTime ) PRIVILEGED_FUNCTION;
+#if ( configUSE_TIMING_WHEEL == 0 )
+
+	static void prvSwitchTimerLists( portTickType xLastTime ) PRIVILEGED_FUNCTION;
+
+#endif
 
 /*
  * Obtain the current tick count, setting *pxTimerListsWereSwitched to pdTRUE
@@ -309,10 +328,30 @@ static void prvProcessExpiredTimer( portTickType xNextExpireTime, portTickType x
 xTIMER *pxTimer;
 portBASE_TYPE xResult;
 
-	/* Remove the timer from the list of active timers.  A check has already
-	been performed to ensure the list is not empty. */
-	pxTimer = ( xTIMER * ) listGET_OWNER_OF_HEAD_ENTRY( pxCurrentTimerList );
-	vListRemove( &( pxTimer->xTimerListItem ) );
+	#if ( configUSE_TIMING_WHEEL == 1 )
+	{
+	xListItem *pxExpired;
+
+		/* Take an expired timer from the wheel.  The wheel may only have
+		needed to move timers between its levels, in which case there is
+		nothing to do yet. */
+		pxExpired = pxWheelGetExpired( &xActiveTimerWheel, xTimeNow );
+		if( pxExpired == NULL )
+		{
+			return;
+		}
+
+		pxTimer = ( xTIMER * ) listGET_LIST_ITEM_OWNER( pxExpired );
+		xNextExpireTime = listGET_LIST_ITEM_VALUE( pxExpired );
+	}
+	#else
+	{
+		/* Remove the timer from the list of active timers.  A check has already
+		been performed to ensure the list is not empty. */
+		pxTimer = ( xTIMER * ) listGET_OWNER_OF_HEAD_ENTRY( pxCurrentTimerList );
+		vListRemove( &( pxTimer->xTimerListItem ) );
+	}
+	#endif
 	traceTIMER_EXPIRED( pxTimer );
 
 	/* If the timer is an auto reload timer then calculate the next
@@ -380,7 +419,11 @@ portBASE_TYPE xTimerListsWereSwitched;
 		if( xTimerListsWereSwitched == pdFALSE )
 		{
 			/* The tick count has not overflowed, has the timer expired? */
-			if( ( xListWasEmpty == pdFALSE ) && ( xNextExpireTime <= xTimeNow ) )
+			#if ( configUSE_TIMING_WHEEL == 1 )
+				if( ( xListWasEmpty == pdFALSE ) && ( wheelIS_DUE( &xActiveTimerWheel, xTimeNow ) ) )
+			#else
+				if( ( xListWasEmpty == pdFALSE ) && ( xNextExpireTime <= xTimeNow ) )
+			#endif
 			{
 				xTaskResumeAll();
 				prvProcessExpiredTimer( xNextExpireTime, xTimeNow );
@@ -393,6 +436,16 @@ portBASE_TYPE xTimerListsWereSwitched;
 				received - whichever comes first.  The following line cannot
 				be reached unless xNextExpireTime > xTimeNow, except in the
 				case when the current timer list is empty. */
+				#if ( configUSE_TIMING_WHEEL == 1 )
+				{
+					/* There is no overflow to wake up for when the wheel is
+					empty. */
+					if( xListWasEmpty != pdFALSE )
+					{
+						xNextExpireTime = xTimeNow + portMAX_DELAY;
+					}
+				}
+				#endif
 				vQueueWaitForMessageRestricted( xTimerQueue, ( xNextExpireTime - xTimeNow ) );
 
 				if( xTaskResumeAll() == pdFALSE )
@@ -424,16 +477,27 @@ portTickType xNextExpireTime;
 	this task to unblock when the tick count overflows, at which point the
 	timer lists will be switched and the next expiry time can be
 	re-assessed.  */
-	*pxListWasEmpty = listLIST_IS_EMPTY( pxCurrentTimerList );
-	if( *pxListWasEmpty == pdFALSE )
+	#if ( configUSE_TIMING_WHEEL == 1 )
 	{
-		xNextExpireTime = listGET_ITEM_VALUE_OF_HEAD_ENTRY( pxCurrentTimerList );
+		/* The wheel gives the time at which it next needs attention, which
+		may be before the first timer expires. */
+		*pxListWasEmpty = xWheelIsEmpty( &xActiveTimerWheel );
+		xNextExpireTime = wheelGET_NEXT_EVENT( &xActiveTimerWheel );
 	}
-	else
+	#else
 	{
-		/* Ensure the task unblocks when the tick count rolls over. */
-		xNextExpireTime = ( portTickType ) 0U;
+		*pxListWasEmpty = listLIST_IS_EMPTY( pxCurrentTimerList );
+		if( *pxListWasEmpty == pdFALSE )
+		{
+			xNextExpireTime = listGET_ITEM_VALUE_OF_HEAD_ENTRY( pxCurrentTimerList );
+		}
+		else
+		{
+			/* Ensure the task unblocks when the tick count rolls over. */
+			xNextExpireTime = ( portTickType ) 0U;
+		}
 	}
+	#endif
 
 	return xNextExpireTime;
 }
@@ -442,21 +506,31 @@ portTickType xNextExpireTime;
 static portTickType prvSampleTimeNow( portBASE_TYPE *pxTimerListsWereSwitched )
 {
 portTickType xTimeNow;
-PRIVILEGED_DATA static portTickType xLastTime = ( portTickType ) 0U;
 
 	xTimeNow = xTaskGetTickCount();
-	
-	if( xTimeNow < xLastTime )
+
+	#if ( configUSE_TIMING_WHEEL == 1 )
 	{
-		prvSwitchTimerLists( xLastTime );
-		*pxTimerListsWereSwitched = pdTRUE;
+		/* The wheel copes with the tick count overflowing by itself. */
+		*pxTimerListsWereSwitched = pdFALSE;
 	}
-	else
+	#else
 	{
-		*pxTimerListsWereSwitched = pdFALSE;
+	PRIVILEGED_DATA static portTickType xLastTime = ( portTickType ) 0U;
+
+		if( xTimeNow < xLastTime )
+		{
+			prvSwitchTimerLists( xLastTime );
+			*pxTimerListsWereSwitched = pdTRUE;
+		}
+		else
+		{
+			*pxTimerListsWereSwitched = pdFALSE;
+		}
+
+		xLastTime = xTimeNow;
 	}
-	
-	xLastTime = xTimeNow;
+	#endif
 	
 	return xTimeNow;
 }
@@ -468,7 +542,22 @@ portBASE_TYPE xProcessTimerNow = pdFALSE;
 
 	listSET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ), xNextExpiryTime );
 	listSET_LIST_ITEM_OWNER( &( pxTimer->xTimerListItem ), pxTimer );
-	
+
+	#if ( configUSE_TIMING_WHEEL == 1 )
+	{
+		/* Has the expiry time elapsed between the command to start/reset a
+		timer being issued, and the command being processed?  Measuring from
+		the command time makes the test safe across a tick count overflow. */
+		if( ( ( portTickType ) ( xTimeNow - xCommandTime ) ) >= pxTimer->xTimerPeriodInTicks )
+		{
+			xProcessTimerNow = pdTRUE;
+		}
+		else
+		{
+			vWheelInsert( &xActiveTimerWheel, &( pxTimer->xTimerListItem ), xTimeNow );
+		}
+	}
+	#else
 	if( xNextExpiryTime <= xTimeNow )
 	{
 		/* Has the expiry time elapsed between the command to start/reset a
@@ -498,6 +587,7 @@ portBASE_TYPE xProcessTimerNow = pdFALSE;
 			vListInsert( pxCurrentTimerList, &( pxTimer->xTimerListItem ) );
 		}
 	}
+	#endif
 
 	return xProcessTimerNow;
 }
@@ -576,6 +666,8 @@ portTickType xTimeNow;
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_TIMING_WHEEL == 0 )
+
 static void prvSwitchTimerLists( portTickType xLastTime )
 {
 portTickType xNextExpireTime, xReloadTime;
@@ -631,6 +723,8 @@ portBASE_TYPE xResult;
 	pxCurrentTimerList = pxOverflowTimerList;
 	pxOverflowTimerList = pxTemp;
 }
+
+#endif /* configUSE_TIMING_WHEEL == 0 */
 /*-----------------------------------------------------------*/
 
 static void prvCheckForValidListAndQueue( void )
@@ -642,10 +736,18 @@ static void prvCheckForValidListAndQueue( void )
 	{
 		if( xTimerQueue == NULL )
 		{
-			vListInitialise( &xActiveTimerList1 );
-			vListInitialise( &xActiveTimerList2 );
-			pxCurrentTimerList = &xActiveTimerList1;
-			pxOverflowTimerList = &xActiveTimerList2;
+			#if ( configUSE_TIMING_WHEEL == 1 )
+			{
+				vWheelInitialise( &xActiveTimerWheel );
+			}
+			#else
+			{
+				vListInitialise( &xActiveTimerList1 );
+				vListInitialise( &xActiveTimerList2 );
+				pxCurrentTimerList = &xActiveTimerList1;
+				pxOverflowTimerList = &xActiveTimerList2;
+			}
+			#endif
 			xTimerQueue = xQueueCreate( ( unsigned portBASE_TYPE ) configTIMER_QUEUE_LENGTH, sizeof( xTIMER_MESSAGE ) );
 		}
 	}
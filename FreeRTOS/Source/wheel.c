@@ -0,0 +1,338 @@
+/*
+ * Hierarchical timing wheel, see wheel.h.
+ */
+
+#include <stdlib.h>
+#include "FreeRTOS.h"
+#include "list.h"
+
+/* This entire source file will be skipped if the application is not configured
+to use the timing wheel. */
+#if ( configUSE_TIMING_WHEEL == 1 )
+
+#include "wheel.h"
+
+#define wheelSLOT_MASK				( ( portTickType ) ( wheelSLOTS - 1 ) )
+#define wheelLEVEL_SHIFT( uxLevel )	( ( uxLevel ) * wheelSLOT_BITS )
+#define wheelTOP_SHIFT				wheelLEVEL_SHIFT( configTIMING_WHEEL_LEVELS - 1 )
+#define wheelFAR_LIST				( wheelNUM_LISTS - 1 )
+
+/* Distance returned by prvWheelNextEvent() when the wheel is empty. */
+#define wheelNO_EVENT				portMAX_DELAY
+
+/*
+ * Add pxItem to the back of pxList in constant time.
+ */
+static void prvWheelAppend( xList *pxList, xListItem *pxItem );
+
+/*
+ * Place pxItem in the slot for its expiry time, relative to xLastTick.
+ * Returns the number of ticks after xLastTick at which the slot next needs
+ * attention.
+ */
+static portTickType prvWheelFile( xTimingWheel *pxWheel, xListItem *pxItem );
+
+/*
+ * Refile every item in pxList, relative to the current xLastTick.
+ */
+static void prvWheelCascade( xTimingWheel *pxWheel, xList *pxList );
+
+/*
+ * Returns the number of ticks after xLastTick at which the first occupied
+ * slot needs attention, or wheelNO_EVENT.
+ */
+static portTickType prvWheelNextEvent( const xTimingWheel *pxWheel );
+
+/*
+ * Rotate the 32 bit occupancy bitmap ulBits right by uxBits, so that bit 0
+ * of the result is bit uxBits of ulBits.
+ */
+#define prvRotateRight( ulBits, uxBits )	( ( ( ( ulBits ) >> ( uxBits ) ) | ( ( ulBits ) << ( ( 32U - ( uxBits ) ) & 31U ) ) ) & 0xffffffffUL )
+
+/*-----------------------------------------------------------*/
+__attribute__((no_instrument_function))
+void vWheelInitialise( xTimingWheel *pxWheel )
+{
+unsigned portBASE_TYPE ux;
+
+	for( ux = 0; ux < ( unsigned portBASE_TYPE ) wheelNUM_LISTS; ux++ )
+	{
+		vListInitialise( &( pxWheel->xLists[ ux ] ) );
+	}
+
+	for( ux = 0; ux < ( unsigned portBASE_TYPE ) configTIMING_WHEEL_LEVELS; ux++ )
+	{
+		pxWheel->ulOccupied[ ux ] = 0UL;
+	}
+
+	pxWheel->xLastTick = ( portTickType ) 0U;
+	pxWheel->xNextEvent = wheelNO_EVENT;
+}
+/*-----------------------------------------------------------*/
+__attribute__((no_instrument_function))
+void vWheelInsert( xTimingWheel *pxWheel, xListItem *pxNewListItem, portTickType xTimeNow )
+{
+portTickType xDistance;
+
+	if( xWheelIsEmpty( pxWheel ) != pdFALSE )
+	{
+		/* Nothing is waiting, so the wheel can be moved straight to the
+		current time rather than catching up later. */
+		pxWheel->xLastTick = xTimeNow;
+		pxWheel->xNextEvent = xTimeNow + wheelNO_EVENT;
+	}
+	else if( !wheelIS_DUE( pxWheel, xTimeNow ) )
+	{
+		/* Nothing needs attention up to xTimeNow, so the wheel can be moved on
+		to it, as pxWheelGetExpired() would.  Filed relative to a wheel left
+		behind, the item could land in a slot that is cascaded before xTimeNow,
+		and the next event would be a time that has already gone. */
+		pxWheel->xLastTick = xTimeNow;
+	}
+
+	/* The wheel can lag behind the current time by up to the span of its top
+	level, which must not push the expiry time out of range. */
+	configASSERT( ( ( portTickType ) ( listGET_LIST_ITEM_VALUE( pxNewListItem ) - pxWheel->xLastTick ) ) >= ( ( portTickType ) ( listGET_LIST_ITEM_VALUE( pxNewListItem ) - xTimeNow ) ) );
+
+	xDistance = prvWheelFile( pxWheel, pxNewListItem );
+
+	if( xDistance < ( portTickType ) ( pxWheel->xNextEvent - pxWheel->xLastTick ) )
+	{
+		pxWheel->xNextEvent = pxWheel->xLastTick + xDistance;
+	}
+}
+/*-----------------------------------------------------------*/
+__attribute__((no_instrument_function))
+xListItem *pxWheelGetExpired( xTimingWheel *pxWheel, portTickType xTimeNow )
+{
+xList *pxList;
+xListItem *pxItem;
+portTickType xDistance, xTick;
+unsigned portBASE_TYPE uxLevel, uxSlot;
+
+	for( ;; )
+	{
+		/* The items in the current level 0 slot are due. */
+		uxSlot = ( unsigned portBASE_TYPE ) ( pxWheel->xLastTick & wheelSLOT_MASK );
+		pxList = &( pxWheel->xLists[ uxSlot ] );
+
+		if( listLIST_IS_EMPTY( pxList ) == pdFALSE )
+		{
+			pxItem = listGET_HEAD_ENTRY( pxList );
+			vListRemove( pxItem );
+
+			/* Keep wheelIS_DUE() true until the slot has been emptied. */
+			pxWheel->xNextEvent = pxWheel->xLastTick;
+			return pxItem;
+		}
+
+		pxWheel->ulOccupied[ 0 ] &= ~( 1UL << uxSlot );
+
+		/* Jump straight to the next tick at which something needs doing,
+		unless that is still in the future. */
+		xDistance = prvWheelNextEvent( pxWheel );
+
+		if( xDistance == wheelNO_EVENT )
+		{
+			pxWheel->xLastTick = xTimeNow;
+			pxWheel->xNextEvent = xTimeNow + wheelNO_EVENT;
+			return NULL;
+		}
+
+		if( xDistance > ( portTickType ) ( xTimeNow - pxWheel->xLastTick ) )
+		{
+			/* Every slot that needs attention is after xTimeNow, so no
+			cascade is skipped by moving the wheel on to xTimeNow. */
+			pxWheel->xNextEvent = pxWheel->xLastTick + xDistance;
+			pxWheel->xLastTick = xTimeNow;
+			return NULL;
+		}
+
+		pxWheel->xLastTick += xDistance;
+		xTick = pxWheel->xLastTick;
+
+		/* Moving onto the start of a slot of a higher level brings its items
+		down a level.  The start of a level n slot is also the start of a slot
+		on every level below it. */
+		for( uxLevel = 1; uxLevel < ( unsigned portBASE_TYPE ) configTIMING_WHEEL_LEVELS; uxLevel++ )
+		{
+			if( ( xTick & ( ( ( portTickType ) 1U << wheelLEVEL_SHIFT( uxLevel ) ) - 1U ) ) != 0U )
+			{
+				break;
+			}
+
+			uxSlot = ( unsigned portBASE_TYPE ) ( ( xTick >> wheelLEVEL_SHIFT( uxLevel ) ) & wheelSLOT_MASK );
+
+			if( ( pxWheel->ulOccupied[ uxLevel ] & ( 1UL << uxSlot ) ) != 0UL )
+			{
+				pxWheel->ulOccupied[ uxLevel ] &= ~( 1UL << uxSlot );
+				prvWheelCascade( pxWheel, &( pxWheel->xLists[ ( uxLevel * wheelSLOTS ) + uxSlot ] ) );
+			}
+		}
+
+		if( uxLevel == ( unsigned portBASE_TYPE ) configTIMING_WHEEL_LEVELS )
+		{
+			/* The top level has moved on a slot, see if anything in the far
+			list has come within its range. */
+			prvWheelCascade( pxWheel, &( pxWheel->xLists[ wheelFAR_LIST ] ) );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+__attribute__((no_instrument_function))
+portBASE_TYPE xWheelIsEmpty( xTimingWheel *pxWheel )
+{
+unsigned portBASE_TYPE uxLevel, uxSlot;
+unsigned long ulBits;
+
+	if( listLIST_IS_EMPTY( &( pxWheel->xLists[ wheelFAR_LIST ] ) ) == pdFALSE )
+	{
+		return pdFALSE;
+	}
+
+	for( uxLevel = 0; uxLevel < ( unsigned portBASE_TYPE ) configTIMING_WHEEL_LEVELS; uxLevel++ )
+	{
+		ulBits = pxWheel->ulOccupied[ uxLevel ];
+
+		while( ulBits != 0UL )
+		{
+			uxSlot = ( unsigned portBASE_TYPE ) __builtin_ctzl( ulBits );
+			ulBits &= ulBits - 1UL;
+
+			if( listLIST_IS_EMPTY( &( pxWheel->xLists[ ( uxLevel * wheelSLOTS ) + uxSlot ] ) ) == pdFALSE )
+			{
+				return pdFALSE;
+			}
+
+			/* The items were removed with vListRemove(). */
+			pxWheel->ulOccupied[ uxLevel ] &= ~( 1UL << uxSlot );
+		}
+	}
+
+	return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+__attribute__((no_instrument_function))
+static void prvWheelAppend( xList *pxList, xListItem *pxItem )
+{
+	/* vListInsertEnd() inserts behind pxIndex, which may have been moved by
+	listGET_OWNER_OF_NEXT_ENTRY() or vListRemove().  Point it at the tail so
+	the item goes on the back, which prvWheelCascade() relies on. */
+	pxList->pxIndex = pxList->xListEnd.pxPrevious;
+	vListInsertEnd( pxList, pxItem );
+}
+/*-----------------------------------------------------------*/
+__attribute__((no_instrument_function))
+static portTickType prvWheelFile( xTimingWheel *pxWheel, xListItem *pxItem )
+{
+portTickType xExpiryTime, xLastTick, xSlots;
+unsigned portBASE_TYPE uxLevel, uxSlot;
+
+	xExpiryTime = listGET_LIST_ITEM_VALUE( pxItem );
+	xLastTick = pxWheel->xLastTick;
+
+	/* Level 0 takes the next wheelSLOTS ticks, starting with xLastTick itself
+	for items that are already due.  The slot xLastTick + wheelSLOTS would
+	share is left for the level above. */
+	if( ( portTickType ) ( xExpiryTime - xLastTick ) < ( portTickType ) wheelSLOTS )
+	{
+		uxSlot = ( unsigned portBASE_TYPE ) ( xExpiryTime & wheelSLOT_MASK );
+		prvWheelAppend( &( pxWheel->xLists[ uxSlot ] ), pxItem );
+		pxWheel->ulOccupied[ 0 ] |= 1UL << uxSlot;
+
+		return xExpiryTime - xLastTick;
+	}
+
+	for( uxLevel = 1; uxLevel < ( unsigned portBASE_TYPE ) configTIMING_WHEEL_LEVELS; uxLevel++ )
+	{
+		/* How many slots of this level ahead of the current one the item
+		falls in.  This is at least 1, as the item did not fit the level below.
+		A full turn of the wheel lands back on the current slot, which has
+		already been cascaded. */
+		xSlots = ( ( xExpiryTime >> wheelLEVEL_SHIFT( uxLevel ) ) - ( xLastTick >> wheelLEVEL_SHIFT( uxLevel ) ) ) & ( portMAX_DELAY >> wheelLEVEL_SHIFT( uxLevel ) );
+
+		if( xSlots <= ( portTickType ) wheelSLOTS )
+		{
+			uxSlot = ( unsigned portBASE_TYPE ) ( ( xExpiryTime >> wheelLEVEL_SHIFT( uxLevel ) ) & wheelSLOT_MASK );
+			prvWheelAppend( &( pxWheel->xLists[ ( uxLevel * wheelSLOTS ) + uxSlot ] ), pxItem );
+			pxWheel->ulOccupied[ uxLevel ] |= 1UL << uxSlot;
+
+			/* The slot is cascaded when time reaches its start. */
+			return ( ( xExpiryTime >> wheelLEVEL_SHIFT( uxLevel ) ) << wheelLEVEL_SHIFT( uxLevel ) ) - xLastTick;
+		}
+	}
+
+	/* Beyond the top level.  Looked at again each time the top level moves on
+	a slot. */
+	prvWheelAppend( &( pxWheel->xLists[ wheelFAR_LIST ] ), pxItem );
+
+	return ( ( ( xLastTick >> wheelTOP_SHIFT ) + 1U ) << wheelTOP_SHIFT ) - xLastTick;
+}
+/*-----------------------------------------------------------*/
+__attribute__((no_instrument_function))
+static void prvWheelCascade( xTimingWheel *pxWheel, xList *pxList )
+{
+unsigned portBASE_TYPE uxItems;
+xListItem *pxItem;
+
+	/* Items refiled into the same list go on the back, so only take as many
+	as were there to start with. */
+	uxItems = listCURRENT_LIST_LENGTH( pxList );
+
+	while( uxItems > ( unsigned portBASE_TYPE ) 0U )
+	{
+		pxItem = listGET_HEAD_ENTRY( pxList );
+		vListRemove( pxItem );
+		( void ) prvWheelFile( pxWheel, pxItem );
+		uxItems--;
+	}
+}
+/*-----------------------------------------------------------*/
+__attribute__((no_instrument_function))
+static portTickType prvWheelNextEvent( const xTimingWheel *pxWheel )
+{
+portTickType xBest = wheelNO_EVENT, xDistance, xLastTick = pxWheel->xLastTick;
+unsigned portBASE_TYPE uxLevel, uxCurrent;
+unsigned long ulBits;
+
+	/* Level 0 slots are single ticks, starting with the current one. */
+	ulBits = prvRotateRight( pxWheel->ulOccupied[ 0 ], ( unsigned portBASE_TYPE ) ( xLastTick & wheelSLOT_MASK ) );
+
+	if( ulBits != 0UL )
+	{
+		xBest = ( portTickType ) __builtin_ctzl( ulBits );
+	}
+
+	/* Higher levels need attention at the start of their first occupied slot
+	after the current one. */
+	for( uxLevel = 1; uxLevel < ( unsigned portBASE_TYPE ) configTIMING_WHEEL_LEVELS; uxLevel++ )
+	{
+		if( pxWheel->ulOccupied[ uxLevel ] != 0UL )
+		{
+			uxCurrent = ( unsigned portBASE_TYPE ) ( ( xLastTick >> wheelLEVEL_SHIFT( uxLevel ) ) & wheelSLOT_MASK );
+			ulBits = prvRotateRight( pxWheel->ulOccupied[ uxLevel ], ( uxCurrent + 1U ) & wheelSLOT_MASK );
+
+			xDistance = ( ( ( xLastTick >> wheelLEVEL_SHIFT( uxLevel ) ) + ( portTickType ) __builtin_ctzl( ulBits ) + 1U ) << wheelLEVEL_SHIFT( uxLevel ) ) - xLastTick;
+
+			if( xDistance < xBest )
+			{
+				xBest = xDistance;
+			}
+		}
+	}
+
+	if( listLIST_IS_EMPTY( &( pxWheel->xLists[ wheelFAR_LIST ] ) ) == pdFALSE )
+	{
+		xDistance = ( ( ( xLastTick >> wheelTOP_SHIFT ) + 1U ) << wheelTOP_SHIFT ) - xLastTick;
+
+		if( xDistance < xBest )
+		{
+			xBest = xDistance;
+		}
+	}
+
+	return xBest;
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configUSE_TIMING_WHEEL == 1 */
@@ -1,17 +1,50 @@
 RASPPI	?= 2
 
 ifeq ($(strip $(RASPPI)),1)
-ARCH	?= -march=armv6j -mtune=arm1176jzf-s -mfloat-abi=hard 
+ARCH	?= -march=armv6j -mtune=arm1176jzf-s
 else
-ARCH	?= -march=armv7-a -mtune=cortex-a7 -mfloat-abi=hard
+ARCH	?= -march=armv7-a -mtune=cortex-a7
 endif
 
-AFLAGS ?= $(ARCH) -DRASPPI=$(RASPPI)
-CFLAGS += $(ARCH) -g -std=gnu99 -Wno-psabi -fsigned-char -DRASPPI=$(RASPPI) -nostdlib -Wno-implicit -mfloat-abi=softfp 
+## VFP/NEON unit to generate code for when the VFP is used.
+ifeq ($(strip $(RASPPI)),1)
+FPU		?= vfp
+else
+FPU		?= neon-vfpv4
+endif
+
+## make VFP=1 lets the compiler use the VFP/NEON and sets configUSE_VFP, so
+## that tasks get their own VFP registers, switched lazily (see port.c).  Not
+## yet run on the board, so the default stays soft-float.
+VFP		?= 0
+ifeq ($(strip $(VFP)),1)
+CFLAGS += -DconfigUSE_VFP=1
+## make VFP=1 FLOAT_ABI=hard passes floating point arguments in VFP
+## registers.  The whole image, including libc and libgcc, must then be
+## hard-float.
+FLOAT_ABI ?= softfp
+else
+FLOAT_ABI ?= soft
+endif
+
+AFLAGS ?= $(ARCH) -mfloat-abi=$(FLOAT_ABI) -mfpu=$(FPU) -DRASPPI=$(RASPPI)
+CFLAGS += $(ARCH) -g -std=gnu99 -Wno-psabi -fsigned-char -DRASPPI=$(RASPPI) -nostdlib -Wno-implicit -mfloat-abi=$(FLOAT_ABI) -mfpu=$(FPU)
 ## CFLAGS += -finstrument-functions
 CFLAGS += -mno-unaligned-access
+
+## make BENCHMARK=1 runs the benchmarks in Demo/bench instead of the demo
+ifeq ($(strip $(BENCHMARK)),1)
+CFLAGS += -DBENCHMARK
+endif
+
+## make SYSTIMER_TICK=1 ticks from the system timer instead of the SP804,
+## for QEMU (see make qemu)
+ifeq ($(strip $(SYSTIMER_TICK)),1)
+CFLAGS += -DconfigUSE_SYSTEM_TIMER_TICK=1
+endif
 CFLAGS += -I $(BASE)FreeRTOS/Source/portable/GCC/RaspberryPi/
 CFLAGS += -I $(BASE)FreeRTOS/Source/include/
+CFLAGS += -I $(BASE)Demo/
 CFLAGS += -I $(BASE)Drivers/
 CFLAGS += -I $(BASE)Drivers/lan9514/include/
 CFLAGS += -I $(BASE)Drivers/FreeRTOS-Plus-TCP/include/
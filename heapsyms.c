@@ -0,0 +1,160 @@
+// heapsyms.c
+//
+// Host side helper for the heap dumps of Demo/heapstats.c.  Copies its input
+// through, naming the address in every "site=0x..." with the function it is
+// in, from the symbol table the build writes to kernel.syms (objdump -t).
+//
+//   gcc -o heapsyms heapsyms.c
+//   heapsyms kernel.syms < console.log
+//
+// The sites are return addresses, so they are looked up one byte back, in
+// the call instruction rather than whatever follows it.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LINE_MAX_LENGTH		512
+
+typedef struct {
+	unsigned long address;
+	unsigned long size;
+	char *name;
+} symbol_t;
+
+static symbol_t *symbols = NULL;
+static size_t symbol_count = 0;
+
+static int compare_symbols(const void *a, const void *b) {
+	const symbol_t *sa = a, *sb = b;
+
+	if(sa->address != sb->address) {
+		return sa->address < sb->address ? -1 : 1;
+	}
+	//the sized symbol wins over a label at the same address
+	return sa->size > sb->size ? -1 : (sa->size < sb->size);
+}
+
+//reads the function symbols of an "objdump -t" listing, lines of the form
+//"0000a2b4 g     F .text	00000120 vTaskDelay"
+static int load_symbols(const char *path) {
+	char line[LINE_MAX_LENGTH];
+	size_t capacity = 0;
+	char *tab, *flags, *end, *name;
+	unsigned long address, size;
+	FILE *f = fopen(path, "r");
+
+	if(f == NULL) {
+		perror(path);
+		return -1;
+	}
+
+	while(fgets(line, sizeof(line), f) != NULL) {
+		tab = strchr(line, '\t');
+		if(tab == NULL) {
+			continue;
+		}
+		*tab = '\0';
+
+		address = strtoul(line, &end, 16);
+		if(end == line || *end != ' ') {
+			continue;
+		}
+
+		//the flags are 7 characters after the address, F for a function
+		flags = end + 1;
+		if(strlen(flags) < 7 || flags[6] != 'F') {
+			continue;
+		}
+
+		size = strtoul(tab + 1, &name, 16);
+		while(*name == ' ') {
+			name++;
+		}
+		name[strcspn(name, "\r\n")] = '\0';
+		if(*name == '\0') {
+			continue;
+		}
+
+		if(symbol_count == capacity) {
+			capacity = capacity ? capacity * 2 : 1024;
+			symbols = realloc(symbols, capacity * sizeof(symbol_t));
+			if(symbols == NULL) {
+				perror("realloc");
+				exit(1);
+			}
+		}
+		symbols[symbol_count].address = address;
+		symbols[symbol_count].size = size;
+		symbols[symbol_count].name = strdup(name);
+		symbol_count++;
+	}
+
+	fclose(f);
+	qsort(symbols, symbol_count, sizeof(symbol_t), compare_symbols);
+	return 0;
+}
+
+//the function holding address, or NULL
+static const symbol_t *find_symbol(unsigned long address) {
+	size_t low = 0, high = symbol_count;
+	const symbol_t *s;
+
+	//the last symbol starting at or before the address
+	while(low < high) {
+		size_t mid = (low + high) / 2;
+		if(symbols[mid].address <= address) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+	if(low == 0) {
+		return NULL;
+	}
+
+	s = &symbols[low - 1];
+	while(s > symbols && s[-1].address == s->address) {
+		s--;
+	}
+	if(s->size != 0 && address >= s->address + s->size) {
+		return NULL;
+	}
+	return s;
+}
+
+int main(int argc, char *argv[]) {
+	char line[LINE_MAX_LENGTH];
+	const symbol_t *s;
+	unsigned long site;
+	char *p, *end;
+
+	if(argc != 2) {
+		fprintf(stderr, "usage: %s kernel.syms < console.log\n", argv[0]);
+		return 1;
+	}
+	if(load_symbols(argv[1]) < 0) {
+		return 1;
+	}
+
+	while(fgets(line, sizeof(line), stdin) != NULL) {
+		p = strstr(line, "site=0x");
+		if(p == NULL) {
+			fputs(line, stdout);
+			continue;
+		}
+
+		site = strtoul(p + 5, &end, 16);
+		fwrite(line, 1, end - line, stdout);
+
+		s = site ? find_symbol(site - 1) : NULL;
+		if(s != NULL) {
+			printf(" %s+0x%lx", s->name, site - s->address);
+		} else {
+			fputs(" ?", stdout);
+		}
+		fputs(end, stdout);
+	}
+
+	return 0;
+}
@@ -0,0 +1,219 @@
+// membench.c
+//
+// Host side version of Demo/bench/bench_mem.c: the routines of Drivers/mem.c
+// against the byte loops they replaced, in bytes per thousand cycles of the
+// time stamp counter (nanoseconds where there is none).  The host has no
+// NEON, so this measures the word paths, and checks every result against
+// the C library on the way.
+//
+//   gcc -O2 -I Drivers -I FreeRTOS/Source/include -o membench membench.c
+//   ./membench
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+//mem.c under other names, without the kernel headers
+#define FREERTOS_CONFIG_H
+#define INC_FREERTOS_H
+#define MEM_H
+#define configUSE_VFP	0
+
+#define memcpy		mem_memcpy
+#define memcpy2		mem_memcpy2
+#define memmove		mem_memmove
+#define memset		mem_memset
+#define memcmp		mem_memcmp
+#define strcpy		mem_strcpy
+#define strncpy		mem_strncpy
+#define strlen		mem_strlen
+#define rand		mem_rand
+#define next		mem_next
+#include "Drivers/mem.c"
+#undef memcpy
+#undef memcpy2
+#undef memmove
+#undef memset
+#undef memcmp
+#undef strcpy
+#undef strncpy
+#undef strlen
+#undef rand
+#undef next
+
+#define BYTES		(16UL * 1024UL * 1024UL)
+#define MAX_SIZE	65536UL
+
+enum { MEMCPY, MEMCPY_ODD, MEMMOVE, MEMSET, MEMCMP, STRLEN, OPS };
+
+static const char *op_names[OPS] = {
+	"memcpy", "memcpy.odd", "memmove", "memset", "memcmp", "strlen"
+};
+
+static const size_t sizes[] = { 4, 64, 1514, 4096, MAX_SIZE };
+
+static unsigned char source[MAX_SIZE + 64] __attribute__((aligned(64)));
+static unsigned char dest[MAX_SIZE + 64] __attribute__((aligned(64)));
+static unsigned char check[MAX_SIZE + 64] __attribute__((aligned(64)));
+
+//what Drivers/mem.c used to do, kept out of line and as plain byte loops,
+//which GCC would otherwise vectorise or turn into library calls
+#define BYTE_LOOP	__attribute__((noinline, optimize("no-tree-vectorize", "no-tree-loop-distribute-patterns")))
+
+BYTE_LOOP
+static void loop_copy(void *d, const void *s, size_t n) {
+	char *dp = d;
+	const char *sp = s;
+	while(n--)
+		*dp++ = *sp++;
+}
+
+BYTE_LOOP
+static void loop_move(void *d, const void *s, size_t n) {
+	char *dp = (char *)d + n;
+	const char *sp = (const char *)s + n;
+	while(n--)
+		*--dp = *--sp;
+}
+
+BYTE_LOOP
+static void loop_set(void *s, int c, size_t n) {
+	unsigned char *p = s;
+	while(n--)
+		*p++ = (unsigned char)c;
+}
+
+BYTE_LOOP
+static int loop_compare(const void *s1, const void *s2, size_t n) {
+	const unsigned char *p1 = s1, *p2 = s2;
+	while(n--)
+		if(*p1 != *p2)
+			return *p1 - *p2;
+		else
+			p1++, p2++;
+	return 0;
+}
+
+BYTE_LOOP
+static size_t loop_length(const char *s) {
+	size_t i;
+	for(i = 0; s[i] != '\0'; i++) ;
+	return i;
+}
+
+static unsigned long long ticks(void) {
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+static void setup(size_t size) {
+	memset(source, 0x5A, size + 8);
+	source[size] = '\0';
+	memset(dest, 0x5A, size + 8);
+}
+
+static unsigned long long run(int op, int loop, size_t size) {
+	unsigned long calls = BYTES / size, i;
+	volatile size_t sink = 0;
+	unsigned long long start;
+
+	setup(size);
+	start = ticks();
+	for(i = 0; i < calls; i++) {
+		switch(op) {
+		case MEMCPY:
+			loop ? loop_copy(dest, source, size) : (void)mem_memcpy(dest, source, size);
+			break;
+		case MEMCPY_ODD:
+			loop ? loop_copy(dest, source + 1, size) : (void)mem_memcpy(dest, source + 1, size);
+			break;
+		case MEMMOVE:
+			loop ? loop_move(dest + 4, dest, size) : (void)mem_memmove(dest + 4, dest, size);
+			break;
+		case MEMSET:
+			loop ? loop_set(dest, (int)i, size) : (void)mem_memset(dest, (int)i, size);
+			break;
+		case MEMCMP:
+			sink += loop ? loop_compare(dest, source, size) : mem_memcmp(dest, source, size);
+			break;
+		default:
+			sink += loop ? loop_length((const char *)source) : mem_strlen((const char *)source);
+			break;
+		}
+	}
+	return ticks() - start;
+}
+
+//one call of each routine on size bytes, against the C library
+static int verify(int op, size_t size) {
+	size_t i;
+
+	for(i = 0; i < size + 8; i++) {
+		source[i] = (unsigned char)(i * 7 + 1);
+		dest[i] = (unsigned char)(i * 13);
+	}
+	memcpy(check, dest, size + 8);
+
+	switch(op) {
+	case MEMCPY:
+		mem_memcpy(dest, source, size);
+		memcpy(check, source, size);
+		break;
+	case MEMCPY_ODD:
+		mem_memcpy(dest, source + 1, size);
+		memcpy(check, source + 1, size);
+		break;
+	case MEMMOVE:
+		mem_memmove(dest + 4, dest, size);
+		memmove(check + 4, check, size);
+		break;
+	case MEMSET:
+		mem_memset(dest, 0xA5, size);
+		memset(check, 0xA5, size);
+		break;
+	case MEMCMP:
+		source[size / 2] ^= 1;
+		memcpy(dest, source, size);
+		dest[size / 2] ^= 1;
+		return (mem_memcmp(dest, source, size) > 0) == (memcmp(dest, source, size) > 0);
+	default:
+		source[size] = '\0';
+		return mem_strlen((const char *)source) == strlen((const char *)source);
+	}
+	return memcmp(dest, check, size + 8) == 0;
+}
+
+int main(void) {
+	unsigned long long loop_ticks, mem_ticks, bytes;
+	size_t s;
+	int op;
+
+	printf("%-12s %6s %12s %12s %8s\n", "routine", "size", "loop b/kc", "mem b/kc", "speedup");
+	for(op = 0; op < OPS; op++) {
+		for(s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+			if(!verify(op, sizes[s])) {
+				printf("%s of %zu bytes does not match the C library\n", op_names[op], sizes[s]);
+				return 1;
+			}
+
+			loop_ticks = run(op, 1, sizes[s]);
+			mem_ticks = run(op, 0, sizes[s]);
+			bytes = (unsigned long long)(BYTES / sizes[s]) * sizes[s];
+			printf("%-12s %6zu %12llu %12llu %7.1fx\n", op_names[op], sizes[s],
+					bytes * 1000 / (loop_ticks ? loop_ticks : 1),
+					bytes * 1000 / (mem_ticks ? mem_ticks : 1),
+					(double)loop_ticks / (mem_ticks ? mem_ticks : 1));
+		}
+	}
+	return 0;
+}
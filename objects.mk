@@ -11,6 +11,8 @@ OBJECTS += $(BUILD_DIR)FreeRTOS/Source/croutine.o
 OBJECTS += $(BUILD_DIR)FreeRTOS/Source/list.o
 OBJECTS += $(BUILD_DIR)FreeRTOS/Source/queue.o
 OBJECTS += $(BUILD_DIR)FreeRTOS/Source/tasks.o
+OBJECTS += $(BUILD_DIR)FreeRTOS/Source/timers.o
+OBJECTS += $(BUILD_DIR)FreeRTOS/Source/wheel.o
 OBJECTS += $(BUILD_DIR)FreeRTOS/Source/event_groups.o
 
 #
@@ -18,13 +20,18 @@ OBJECTS += $(BUILD_DIR)FreeRTOS/Source/event_groups.o
 #
 OBJECTS += $(BUILD_DIR)Drivers/interrupts.o
 OBJECTS += $(BUILD_DIR)Drivers/gpio.o
+OBJECTS += $(BUILD_DIR)Drivers/uart.o
+OBJECTS += $(BUILD_DIR)Drivers/heapregions.o
+OBJECTS += $(BUILD_DIR)Drivers/mmu.o
 
 $(BUILD_DIR)FreeRTOS/Source/portable/GCC/RaspberryPi/port.o: CFLAGS += -I $(BASE)Demo/
 
 #
-#	Selected HEAP implementation for FreeRTOS.
+#	Selected HEAP implementation for FreeRTOS, heap_5 on the board's RAM (see
+#	Drivers/heapregions.c) unless overridden (make HEAP=heap_tlsf).
 #
-OBJECTS += $(BUILD_DIR)FreeRTOS/Source/portable/MemMang/heap_4.o
+HEAP ?= heap_5
+OBJECTS += $(BUILD_DIR)FreeRTOS/Source/portable/MemMang/$(HEAP).o
 
 #
 #	Startup and platform initialisation code.
@@ -40,10 +47,30 @@ OBJECTS += $(BUILD_DIR)Demo/main.o
 #things
 OBJECTS += $(BUILD_DIR)Drivers/mailbox.o
 OBJECTS += $(BUILD_DIR)Demo/trace.o
+OBJECTS += $(BUILD_DIR)Demo/heapstats.o
 OBJECTS += $(BUILD_DIR)Drivers/mem.o
 
+#benchmarks, see Demo/bench/benchmark.h
+ifeq ($(strip $(BENCHMARK)),1)
+OBJECTS += $(BUILD_DIR)Demo/bench/bench.o
+OBJECTS += $(BUILD_DIR)Demo/bench/bench_switch.o
+OBJECTS += $(BUILD_DIR)Demo/bench/bench_notify.o
+OBJECTS += $(BUILD_DIR)Demo/bench/bench_queue.o
+OBJECTS += $(BUILD_DIR)Demo/bench/bench_mutex.o
+OBJECTS += $(BUILD_DIR)Demo/bench/bench_delay.o
+OBJECTS += $(BUILD_DIR)Demo/bench/bench_irq.o
+OBJECTS += $(BUILD_DIR)Demo/bench/bench_wheel.o
+OBJECTS += $(BUILD_DIR)Demo/bench/bench_heap.o
+OBJECTS += $(BUILD_DIR)Demo/bench/bench_heap_4.o
+OBJECTS += $(BUILD_DIR)Demo/bench/bench_heap_tlsf.o
+OBJECTS += $(BUILD_DIR)Demo/bench/bench_pool.o
+OBJECTS += $(BUILD_DIR)Demo/bench/bench_mem.o
+endif
+
 #video stuff
 OBJECTS += $(BUILD_DIR)Drivers/video.o
+OBJECTS += $(BUILD_DIR)Drivers/textmode.o
+OBJECTS += $(BUILD_DIR)Drivers/logring.o
 
 #smsc9514 (LAN and USB)
 OBJECTS += $(BUILD_DIR)Drivers/lan9514/uspibind.o
@@ -51,6 +78,8 @@ OBJECTS += $(BUILD_DIR)Drivers/lan9514/lib/uspilibrary.o
 OBJECTS += $(BUILD_DIR)Drivers/lan9514/lib/dwhcidevice.o
 OBJECTS += $(BUILD_DIR)Drivers/lan9514/lib/dwhciregister.o
 OBJECTS += $(BUILD_DIR)Drivers/lan9514/lib/dwhcixferstagedata.o
+OBJECTS += $(BUILD_DIR)Drivers/lan9514/lib/dwhcipools.o
+OBJECTS += $(BUILD_DIR)Drivers/lan9514/lib/objectpool.o
 OBJECTS += $(BUILD_DIR)Drivers/lan9514/lib/usbconfigparser.o
 OBJECTS += $(BUILD_DIR)Drivers/lan9514/lib/usbdevice.o
 OBJECTS += $(BUILD_DIR)Drivers/lan9514/lib/usbdevicefactory.o
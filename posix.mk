@@ -0,0 +1,84 @@
+#
+#	POSIX simulator: the kernel and FreeRTOS+TCP built as a Linux executable
+#	with the host compiler, see FreeRTOS/Source/portable/GCC/Posix/port.c.
+#
+#	make posix			builds freertos-posix
+#	make posix-check	builds it and runs its checks, see Demo/Posix/tickcheck.c
+#	make posix-clean
+#
+BASE=$(shell pwd)/
+POSIX_BUILD_DIR=$(BASE)build/posix/
+POSIX_TARGET=freertos-posix
+
+HOSTCC ?= cc
+
+## Demo/Posix comes before Drivers, for its mem.h.  -fcommon for the
+## tentative definition of "loaded" in video.h.
+POSIX_CFLAGS = -g -O2 -std=gnu99 -fcommon -DPOSIX_SIM
+POSIX_CFLAGS += -Wno-implicit-function-declaration -Wno-pointer-sign -Wno-int-to-pointer-cast -Wno-pointer-to-int-cast
+POSIX_CFLAGS += -I $(BASE)FreeRTOS/Source/portable/GCC/Posix/
+POSIX_CFLAGS += -I $(BASE)FreeRTOS/Source/include/
+POSIX_CFLAGS += -I $(BASE)Demo/Posix/
+POSIX_CFLAGS += -I $(BASE)Demo/
+POSIX_CFLAGS += -I $(BASE)Drivers/
+POSIX_CFLAGS += -I $(BASE)Drivers/FreeRTOS-Plus-TCP/include/
+
+#
+#	FreeRTOS Core, POSIX port and heap
+#
+POSIX_SOURCES += FreeRTOS/Source/croutine.c
+POSIX_SOURCES += FreeRTOS/Source/list.c
+POSIX_SOURCES += FreeRTOS/Source/queue.c
+POSIX_SOURCES += FreeRTOS/Source/tasks.c
+POSIX_SOURCES += FreeRTOS/Source/timers.c
+POSIX_SOURCES += FreeRTOS/Source/wheel.c
+POSIX_SOURCES += FreeRTOS/Source/event_groups.c
+POSIX_SOURCES += FreeRTOS/Source/portable/GCC/Posix/port.c
+HEAP ?= heap_4
+POSIX_SOURCES += FreeRTOS/Source/portable/MemMang/$(HEAP).c
+
+#
+#	freeRTOS-TCP, on a TAP device
+#
+POSIX_SOURCES += Drivers/FreeRTOS-Plus-TCP/FreeRTOS_ARP.c
+POSIX_SOURCES += Drivers/FreeRTOS-Plus-TCP/FreeRTOS_DHCP.c
+POSIX_SOURCES += Drivers/FreeRTOS-Plus-TCP/FreeRTOS_DNS.c
+POSIX_SOURCES += Drivers/FreeRTOS-Plus-TCP/FreeRTOS_IP.c
+POSIX_SOURCES += Drivers/FreeRTOS-Plus-TCP/FreeRTOS_Sockets.c
+POSIX_SOURCES += Drivers/FreeRTOS-Plus-TCP/FreeRTOS_Stream_Buffer.c
+POSIX_SOURCES += Drivers/FreeRTOS-Plus-TCP/FreeRTOS_TCP_IP.c
+POSIX_SOURCES += Drivers/FreeRTOS-Plus-TCP/FreeRTOS_TCP_WIN.c
+POSIX_SOURCES += Drivers/FreeRTOS-Plus-TCP/FreeRTOS_UDP_IP.c
+POSIX_SOURCES += Drivers/FreeRTOS-Plus-TCP/portable/BufferManagement/BufferAllocation_2.c
+POSIX_SOURCES += Drivers/FreeRTOS-Plus-TCP/portable/NetworkInterfacePosix.c
+
+#
+#	Simulator main and console
+#
+POSIX_SOURCES += Demo/Posix/main.c
+POSIX_SOURCES += Demo/Posix/console.c
+POSIX_SOURCES += Drivers/logring.c
+POSIX_SOURCES += Demo/Posix/mem.c
+POSIX_SOURCES += Demo/Posix/heaptrace.c
+POSIX_SOURCES += Demo/Posix/tickcheck.c
+POSIX_SOURCES += Demo/heapstats.c
+
+POSIX_OBJECTS = $(addprefix $(POSIX_BUILD_DIR),$(POSIX_SOURCES:.c=.o))
+
+$(POSIX_TARGET): $(POSIX_OBJECTS)
+	$(HOSTCC) -o $@ $(POSIX_OBJECTS)
+
+$(POSIX_BUILD_DIR)%.o: $(BASE)%.c
+	@mkdir -p $(dir $@)
+	$(HOSTCC) $(POSIX_CFLAGS) -MMD -MP -c $< -o $@
+
+## a task that is never woken leaves the simulator asleep, hence the timeout
+posix-check: $(POSIX_TARGET)
+	timeout 10 ./$(POSIX_TARGET) check
+
+posix-clean:
+	rm -rf $(POSIX_BUILD_DIR) $(POSIX_TARGET)
+
+.PHONY: posix-check posix-clean
+
+-include $(POSIX_OBJECTS:.o=.d)
@@ -0,0 +1,358 @@
+// tracedump.c
+//
+// Host side decoder for the binary trace served by Demo/trace.c.  Writes
+// Chrome trace event JSON, which chrome://tracing and ui.perfetto.dev open.
+//
+//   gcc -o tracedump tracedump.c
+//   tracedump <host> <port> > trace.json     (stop with ctrl-c)
+//   tracedump -f capture.bin > trace.json
+//
+// Every core gets a row for its tasks, one for interrupts and one for
+// instrumented functions.  Queue events are instants on the task row.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netdb.h>
+
+/* Keep in step with Demo/trace.h. */
+#define TRACE_MAGIC			0x52545246UL
+#define TRACE_VERSION		1
+#define TRACE_HEADER_SIZE	16
+
+#define EV_TASK_SWITCHED_IN		1
+#define EV_TASK_CREATE			2
+#define EV_TASK_NAME			3
+#define EV_TASK_DELETE			4
+#define EV_QUEUE_SEND			5
+#define EV_QUEUE_SEND_FROM_ISR	6
+#define EV_QUEUE_RECEIVE		7
+#define EV_BLOCKING_ON_QUEUE_SEND		8
+#define EV_BLOCKING_ON_QUEUE_RECEIVE	9
+#define EV_ISR_ENTER			10
+#define EV_ISR_EXIT				11
+#define EV_FUNC_ENTER			12
+#define EV_FUNC_EXIT			13
+#define EV_LOST					14
+
+#define MAX_CORES	4
+#define MAX_TASKS	256
+#define NAME_LEN	32
+
+/* Rows per core in the output. */
+#define ROW_TASKS	0
+#define ROW_ISR		1
+#define ROW_FUNCS	2
+#define ROWS		3
+
+struct task {
+	unsigned long tcb;
+	char name[NAME_LEN];
+};
+
+struct core {
+	int running;				/* a task slice is open */
+	unsigned long tcb;
+	unsigned long long start;
+};
+
+static struct task tasks[MAX_TASKS];
+static int ntasks;
+static struct core cores[MAX_CORES];
+static unsigned long long last_time;
+static int have_time;
+static int first_event = 1;
+static volatile sig_atomic_t stop;
+
+static void error(const char *msg)
+{
+	perror(msg);
+	exit(1);
+}
+
+static void on_signal(int sig)
+{
+	stop = 1;
+}
+
+static unsigned long le16(const unsigned char *p)
+{
+	return p[0] | (p[1] << 8);
+}
+
+static unsigned long le32(const unsigned char *p)
+{
+	return (unsigned long)p[0] | ((unsigned long)p[1] << 8) |
+		((unsigned long)p[2] << 16) | ((unsigned long)p[3] << 24);
+}
+
+/* Reads exactly len bytes, 0 at the end of the stream. */
+static int read_all(int fd, unsigned char *buf, int len)
+{
+	int got = 0, n;
+
+	while (got < len) {
+		n = read(fd, buf + got, len - got);
+		if (n <= 0)
+			return 0;
+		got += n;
+	}
+	return 1;
+}
+
+static struct task *find_task(unsigned long tcb, int create)
+{
+	int i;
+
+	for (i = 0; i < ntasks; i++)
+		if (tasks[i].tcb == tcb)
+			return &tasks[i];
+	if (!create || ntasks == MAX_TASKS)
+		return NULL;
+	memset(&tasks[ntasks], 0, sizeof(tasks[ntasks]));
+	tasks[ntasks].tcb = tcb;
+	return &tasks[ntasks++];
+}
+
+static const char *task_name(unsigned long tcb)
+{
+	static char buf[NAME_LEN];
+	struct task *t = find_task(tcb, 0);
+
+	if (t && t->name[0])
+		return t->name;
+	snprintf(buf, sizeof(buf), "task 0x%08lx", tcb);
+	return buf;
+}
+
+/*
+ * The target stamps records with the low 32 bits of a microsecond counter.
+ * Extend them to 64 bits, allowing the small steps back that come from the
+ * rings of different cores being drained in turn.
+ */
+static unsigned long long extend_time(unsigned long stamp)
+{
+	if (!have_time) {
+		last_time = stamp;
+		have_time = 1;
+	} else {
+		last_time += (long long)(int)(stamp - (unsigned long)(unsigned int)last_time);
+	}
+	return last_time;
+}
+
+static void begin_event(void)
+{
+	if (!first_event)
+		printf(",\n");
+	first_event = 0;
+}
+
+static void json_string(const char *s)
+{
+	putchar('"');
+	for (; *s; s++) {
+		if (*s == '"' || *s == '\\')
+			printf("\\%c", *s);
+		else if ((unsigned char)*s < 0x20)
+			printf("\\u%04x", *s);
+		else
+			putchar(*s);
+	}
+	putchar('"');
+}
+
+static void emit_metadata(int ncores)
+{
+	static const char *rows[ROWS] = { "tasks", "interrupts", "functions" };
+	int c, r;
+
+	begin_event();
+	printf("{\"ph\":\"M\",\"pid\":0,\"name\":\"process_name\",\"args\":{\"name\":\"FreeRTOS\"}}");
+	for (c = 0; c < ncores; c++) {
+		for (r = 0; r < ROWS; r++) {
+			begin_event();
+			printf("{\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"name\":\"thread_name\",\"args\":{\"name\":\"core %d %s\"}}",
+				c * ROWS + r, c, rows[r]);
+		}
+	}
+}
+
+static void close_slice(int core, unsigned long long now)
+{
+	struct core *c = &cores[core];
+
+	if (!c->running)
+		return;
+	begin_event();
+	printf("{\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%llu,\"dur\":%llu,\"name\":",
+		core * ROWS + ROW_TASKS, c->start, now - c->start);
+	json_string(task_name(c->tcb));
+	printf(",\"args\":{\"tcb\":\"0x%08lx\"}}", c->tcb);
+	c->running = 0;
+}
+
+static void emit_instant(int core, unsigned long long now, const char *name,
+	unsigned long queue, unsigned long waiting)
+{
+	begin_event();
+	printf("{\"ph\":\"i\",\"s\":\"t\",\"pid\":0,\"tid\":%d,\"ts\":%llu,\"name\":\"%s\","
+		"\"args\":{\"queue\":\"0x%08lx\",\"waiting\":%lu}}",
+		core * ROWS + ROW_TASKS, now, name, queue, waiting);
+}
+
+static void decode(const unsigned char *r)
+{
+	unsigned long long now = extend_time(le32(r));
+	int event = r[4];
+	int core = r[5] < MAX_CORES ? r[5] : 0;
+	unsigned long arg16 = le16(r + 6);
+	unsigned long object = le32(r + 8);
+	unsigned long arg = le32(r + 12);
+	struct task *t;
+	int i;
+
+	switch (event) {
+	case EV_TASK_SWITCHED_IN:
+		close_slice(core, now);
+		cores[core].running = 1;
+		cores[core].tcb = object;
+		cores[core].start = now;
+		break;
+	case EV_TASK_CREATE:
+		find_task(object, 1);
+		break;
+	case EV_TASK_NAME:
+		t = find_task(object, 1);
+		if (t && arg16 + 4 < NAME_LEN) {
+			for (i = 0; i < 4; i++)
+				t->name[arg16 + i] = (arg >> (i * 8)) & 0xff;
+			t->name[arg16 + 4] = '\0';
+		}
+		break;
+	case EV_TASK_DELETE:
+		begin_event();
+		printf("{\"ph\":\"i\",\"s\":\"t\",\"pid\":0,\"tid\":%d,\"ts\":%llu,\"name\":\"delete ",
+			core * ROWS + ROW_TASKS, now);
+		printf("0x%08lx\"}", object);
+		break;
+	case EV_QUEUE_SEND:
+		emit_instant(core, now, "queue send", object, arg);
+		break;
+	case EV_QUEUE_SEND_FROM_ISR:
+		emit_instant(core, now, "queue send from isr", object, arg);
+		break;
+	case EV_QUEUE_RECEIVE:
+		emit_instant(core, now, "queue receive", object, arg);
+		break;
+	case EV_BLOCKING_ON_QUEUE_SEND:
+		emit_instant(core, now, "block on send", object, arg);
+		break;
+	case EV_BLOCKING_ON_QUEUE_RECEIVE:
+		emit_instant(core, now, "block on receive", object, arg);
+		break;
+	case EV_ISR_ENTER:
+	case EV_ISR_EXIT:
+		begin_event();
+		printf("{\"ph\":\"%s\",\"pid\":0,\"tid\":%d,\"ts\":%llu,\"name\":\"ISR\"}",
+			event == EV_ISR_ENTER ? "B" : "E", core * ROWS + ROW_ISR, now);
+		break;
+	case EV_FUNC_ENTER:
+	case EV_FUNC_EXIT:
+		begin_event();
+		printf("{\"ph\":\"%s\",\"pid\":0,\"tid\":%d,\"ts\":%llu,\"name\":\"0x%08lx\"}",
+			event == EV_FUNC_ENTER ? "B" : "E", core * ROWS + ROW_FUNCS, now, object);
+		break;
+	case EV_LOST:
+		begin_event();
+		printf("{\"ph\":\"i\",\"s\":\"g\",\"pid\":0,\"tid\":%d,\"ts\":%llu,\"name\":\"lost %lu records\"}",
+			core * ROWS + ROW_TASKS, now, arg);
+		break;
+	default:
+		fprintf(stderr, "tracedump: unknown event %d\n", event);
+		break;
+	}
+}
+
+static int open_tcp(const char *host, const char *port)
+{
+	struct sockaddr_in serv_addr;
+	struct hostent *server;
+	int sockfd;
+
+	sockfd = socket(AF_INET, SOCK_STREAM, 0);
+	if (sockfd < 0)
+		error("ERROR opening socket");
+	server = gethostbyname(host);
+	if (server == NULL) {
+		fprintf(stderr, "ERROR, no such host\n");
+		exit(1);
+	}
+	memset(&serv_addr, 0, sizeof(serv_addr));
+	serv_addr.sin_family = AF_INET;
+	memcpy(&serv_addr.sin_addr.s_addr, server->h_addr, server->h_length);
+	serv_addr.sin_port = htons(atoi(port));
+	if (connect(sockfd, (struct sockaddr *)&serv_addr, sizeof(serv_addr)) < 0)
+		error("ERROR connecting");
+	return sockfd;
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned char header[TRACE_HEADER_SIZE];
+	unsigned char record[64];
+	unsigned long size, ncores, records = 0;
+	struct sigaction sa;
+	int fd, c;
+
+	if (argc == 3 && strcmp(argv[1], "-f") == 0) {
+		fd = open(argv[2], O_RDONLY);
+		if (fd < 0)
+			error("ERROR opening file");
+	} else if (argc == 3) {
+		fd = open_tcp(argv[1], argv[2]);
+	} else {
+		fprintf(stderr, "usage %s hostname port | -f file\n", argv[0]);
+		exit(1);
+	}
+
+	/* ctrl-c ends a live capture with the JSON still well formed. */
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = on_signal;
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+
+	if (!read_all(fd, header, sizeof(header)) || le32(header) != TRACE_MAGIC) {
+		fprintf(stderr, "tracedump: not a trace stream\n");
+		exit(1);
+	}
+	size = le16(header + 6);
+	ncores = le32(header + 12);
+	if (le16(header + 4) != TRACE_VERSION || size < 16 || size > sizeof(record)
+		|| ncores == 0 || ncores > MAX_CORES) {
+		fprintf(stderr, "tracedump: unsupported stream version %lu\n", le16(header + 4));
+		exit(1);
+	}
+
+	printf("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+	emit_metadata(ncores);
+
+	while (!stop && read_all(fd, record, size)) {
+		decode(record);
+		records++;
+	}
+
+	for (c = 0; c < MAX_CORES; c++)
+		close_slice(c, last_time);
+	printf("\n]}\n");
+
+	fprintf(stderr, "tracedump: %lu records\n", records);
+	close(fd);
+	return 0;
+}